@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <utility>
+#include "ret.h"
+#include "sql/sort_key.h"
+#include "storage/bplus_tree.h"
+
+/*
+ * 存储层基准共用的校验、随机数、临时目录与B+树辅助函数。
+ *
+ * 每个基准是单独的可执行文件，只有一个源文件包含这个头文件。
+ */
+
+using Entry = std::pair<std::string, uint64_t>;  ///< B+树的(键, 值)
+
+inline unsigned int seed = 12345;  ///< next_random的状态
+
+inline unsigned int next_random()
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+/**
+ * @brief 条件不成立时打印what
+ */
+inline bool check(bool ok, const char* what)
+{
+    if (!ok) fprintf(stderr, "check failed: %s\n", what);
+    return ok;
+}
+
+/**
+ * @brief /tmp下的临时目录，析构时连同其中的文件删除
+ *
+ * 在使用目录的对象之前构造，这些对象析构之后才删除目录。
+ */
+class TempDir
+{
+  public:
+    /**
+     * @param name 目录名前缀，后面加上随机后缀
+     */
+    explicit TempDir(const char* name)
+    {
+        std::string tmpl = std::string("/tmp/") + name + "_XXXXXX";
+        if (mkdtemp(tmpl.data())) path_ = tmpl;
+    }
+
+    ~TempDir()
+    {
+        if (!path_.empty()) std::filesystem::remove_all(path_);
+    }
+
+    TempDir(const TempDir&)            = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    /**
+     * @brief 是否创建成功
+     */
+    bool valid() const { return !path_.empty(); }
+
+    const std::string& path() const { return path_; }
+
+  private:
+    std::string path_;  ///< 目录路径，创建失败时为空
+};
+
+/**
+ * @brief 把整数编码为BIGINTS排序键
+ */
+inline std::string int_key(int64_t v)
+{
+    static const KeyEncoder encoder({{0, BIGINTS, false, true, 0}});
+    RC                      rc;
+    SortKeyBuffer           keys;
+    encoder.encode({Value(v, rc)}, keys, rc);
+    return std::string(reinterpret_cast<const char*>(keys.key(0)), keys.length(0));
+}
+
+inline const uint8_t* bytes(const std::string& s) { return reinterpret_cast<const uint8_t*>(s.data()); }
+
+/**
+ * @brief 全树遍历的结果与expected一致
+ */
+inline bool same_as(BPlusTree& tree, const std::set<Entry>& expected)
+{
+    RC   rc;
+    auto want = expected.begin();
+    for (BPlusTreeIterator it = tree.begin(rc); it.valid(); it.next(rc), ++want)
+    {
+        if (want == expected.end()) return false;
+        if (it.key_len() != want->first.size() || memcmp(it.key(), want->first.data(), it.key_len()) != 0) return false;
+        if (it.value() != want->second) return false;
+    }
+    return rc == RC::SUCCESS && want == expected.end();
+}
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Thread/ThreadPool.h"
+#include "bench_util.h"
+#include "ret.h"
+#include "sql/sort_key.h"
+#include "storage/bplus_tree.h"
+
+/**
+ * @brief B+树测试与基准
+ *
+ * 以std::set为参照校验插入、重复键、查找、范围遍历、删除与合并、变长键、重新打开与批量查找，
+ * 再让多个线程并发插入删除后校验结果；最后测量1到64个线程下读多写少负载的吞吐。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static bool check_basic(BufferPool& pool)
+{
+    bool      ok = true;
+    RC        rc;
+    file_id_t file = pool.disk().open_file("basic", rc);
+    BPlusTree tree(pool, file, rc);
+    ok &= check(rc == RC::SUCCESS && tree.height() == 1, "create tree");
+
+    std::set<Entry> expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        int64_t  k     = next_random() % 5000;
+        uint64_t value = next_random() % 100;
+        bool     fresh = expected.emplace(int_key(k), value).second;
+        tree.insert(bytes(int_key(k)), 9, value, rc);
+        if (!check(fresh == (rc == RC::SUCCESS), "insert reports duplicates")) return false;
+    }
+    ok &= check(tree.height() > 2 && tree.stats().splits > 0, "tree grows");
+    ok &= check(same_as(tree, expected), "full scan after inserts");
+
+    for (int64_t k = 0; k < 5000; k += 7)
+    {
+        std::string           key = int_key(k);
+        std::vector<uint64_t> values;
+        tree.lookup(bytes(key), key.size(), values, rc);
+        std::vector<uint64_t> want;
+        for (auto it = expected.lower_bound({key, 0}); it != expected.end() && it->first == key; ++it)
+            want.push_back(it->second);
+        if (!check(values == want, "lookup returns every value in order")) return false;
+    }
+
+    {
+        std::string       from  = int_key(2500);
+        BPlusTreeIterator range = tree.lower_bound(bytes(from), from.size(), rc);
+        auto              want  = expected.lower_bound({from, 0});
+        ok &= check(range.valid() && range.value() == want->second &&
+                        memcmp(range.key(), want->first.data(), want->first.size()) == 0,
+            "lower_bound");
+    }
+
+    std::vector<Entry> all(expected.begin(), expected.end());
+    for (std::size_t i = all.size(); i > 1; --i) std::swap(all[i - 1], all[next_random() % i]);
+    for (std::size_t i = 0; i < all.size(); ++i)
+    {
+        tree.remove(bytes(all[i].first), all[i].first.size(), all[i].second, rc);
+        if (!check(rc == RC::SUCCESS, "remove existing entry")) return false;
+        expected.erase(all[i]);
+        if (i == all.size() / 2) ok &= check(same_as(tree, expected), "full scan after removing half");
+    }
+    tree.remove(bytes(all[0].first), all[0].first.size(), all[0].second, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "remove missing entry");
+    ok &= check(tree.height() == 1 && tree.stats().merges > 0, "tree shrinks back to one leaf");
+    ok &= check(same_as(tree, expected), "empty tree");
+
+    // 释放的页被复用，文件不再增长
+    uint32_t pages = pool.disk().page_count(file);
+    for (int64_t k = 0; k < 5000; ++k) tree.insert(bytes(int_key(k)), 9, 0, rc);
+    ok &= check(pool.disk().page_count(file) == pages, "freed pages are reused");
+    return ok;
+}
+
+static bool check_strings(BufferPool& pool)
+{
+    RC        rc;
+    file_id_t file = pool.disk().open_file("strings", rc);
+    BPlusTree tree(pool, file, rc);
+
+    std::set<Entry> expected;
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string key(next_random() % tree.max_key_size(), '\0');
+        for (auto& c : key) c = static_cast<char>(next_random() % 4);
+        expected.emplace(key, i);
+        tree.insert(bytes(key), key.size(), i, rc);
+        if (!check(rc == RC::SUCCESS, "insert variable-length key")) return false;
+    }
+    std::string too_long(tree.max_key_size() + 1, 'x');
+    tree.insert(bytes(too_long), too_long.size(), 0, rc);
+    if (!check(rc == RC::INVALID_ARGUMENT, "reject oversized key")) return false;
+    if (!check(same_as(tree, expected), "variable-length keys in order")) return false;
+
+    for (auto it = expected.begin(); it != expected.end();)
+    {
+        if (next_random() % 3 == 0)
+        {
+            ++it;
+            continue;
+        }
+        tree.remove(bytes(it->first), it->first.size(), it->second, rc);
+        it = expected.erase(it);
+    }
+    return check(same_as(tree, expected), "variable-length keys after removes");
+}
+
+static bool check_reopen(DiskManager& disk)
+{
+    RC              rc;
+    std::set<Entry> expected;
+    file_id_t       file = disk.open_file("reopen", rc);
+    {
+        BufferPool pool(disk, 64, ReplacerKind::LRU_K, rc);
+        BPlusTree  tree(pool, file, rc);
+        for (int64_t k = 0; k < 3000; ++k)
+        {
+            expected.emplace(int_key(k * 3), k);
+            tree.insert(bytes(int_key(k * 3)), 9, k, rc);
+        }
+        // 删掉后一半，合并出的空闲页随元数据页写回
+        for (int64_t k = 1500; k < 3000; ++k)
+        {
+            expected.erase({int_key(k * 3), k});
+            tree.remove(bytes(int_key(k * 3)), 9, k, rc);
+        }
+        pool.flush_all(rc);
+    }
+    page_no_t  pages = disk.page_count(file);
+    BufferPool pool(disk, 64, ReplacerKind::LRU_K, rc);
+    BPlusTree  tree(pool, file, rc);
+    bool       ok = check(rc == RC::SUCCESS && same_as(tree, expected), "reopen from disk");
+
+    // 重新打开后先复用链表中的空闲页
+    for (int64_t k = 1500; k < 2500; ++k)
+    {
+        expected.emplace(int_key(k * 3), k);
+        tree.insert(bytes(int_key(k * 3)), 9, k, rc);
+    }
+    ok &= check(disk.page_count(file) == pages, "free pages are reused after reopen");
+    return ok && check(same_as(tree, expected), "inserts into reused pages");
+}
+
+static bool check_batch(BufferPool& pool)
+{
+    RC         rc;
+    ThreadPool threads(4);
+    file_id_t  file = pool.disk().open_file("batch", rc);
+    BPlusTree  tree(pool, file, rc);
+    for (int64_t k = 0; k < 4000; ++k)
+        for (uint64_t v = 0; v < static_cast<uint64_t>(k % 3); ++v) tree.insert(bytes(int_key(k)), 9, v, rc);
+
+    KeyEncoder         encoder({{0, BIGINTS, false, true, 0}});
+    SortKeyBuffer      keys;
+    std::vector<Value> row(1);
+    for (int64_t k = 0; k < 4000; ++k)
+    {
+        row[0].set_bigint(k, rc);
+        encoder.encode(row, keys, rc);
+    }
+    std::vector<std::vector<uint64_t>> values;
+    tree.lookup_batch(keys, values, threads, rc);
+    bool ok = rc == RC::SUCCESS && values.size() == 4000;
+    for (int64_t k = 0; ok && k < 4000; ++k) ok = values[k].size() == static_cast<std::size_t>(k % 3);
+    return check(ok, "lookup_batch");
+}
+
+static bool check_concurrent(BufferPool& pool)
+{
+    RC        rc;
+    file_id_t file = pool.disk().open_file("concurrent", rc);
+    BPlusTree tree(pool, file, rc);
+
+    // 每个线程插入自己的一组键，再删除其中的奇数键，其他线程同时在做同样的事
+    const int                threads = 8, per_thread = 4000;
+    std::vector<std::thread> workers;
+    std::atomic<int>         failures{0};
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            RC trc;
+            for (int i = 0; i < per_thread; ++i)
+            {
+                tree.insert(bytes(int_key(i * threads + t)), 9, t, trc);
+                if (trc != RC::SUCCESS) ++failures;
+            }
+            for (int i = 1; i < per_thread; i += 2)
+            {
+                tree.remove(bytes(int_key(i * threads + t)), 9, t, trc);
+                if (trc != RC::SUCCESS) ++failures;
+                std::vector<uint64_t> values;
+                tree.lookup(bytes(int_key((i - 1) * threads + t)), 9, values, trc);
+                if (values.size() != 1) ++failures;
+            }
+        });
+    for (auto& worker : workers) worker.join();
+
+    std::set<Entry> expected;
+    for (int t = 0; t < threads; ++t)
+        for (int i = 0; i < per_thread; i += 2) expected.emplace(int_key(i * threads + t), t);
+    bool ok = check(failures == 0 && same_as(tree, expected), "concurrent inserts and removes");
+
+    // 一半线程删空自己的键，多层合并释放节点时还持有节点写锁；另一半线程同时插入新键，分裂时分配节点
+    // 复用这些空闲页
+    for (int t = 0; t < threads; ++t)
+        workers[t] = std::thread([&, t] {
+            RC trc;
+            for (int i = 0; i < per_thread; i += 2)
+                if (t % 2 == 0)
+                    tree.remove(bytes(int_key(i * threads + t)), 9, t, trc);
+                else
+                    tree.insert(bytes(int_key((per_thread + i) * threads + t)), 9, t, trc);
+        });
+    for (auto& worker : workers) worker.join();
+    for (int t = 0; t < threads; ++t)
+        for (int i = 0; i < per_thread; i += 2)
+        {
+            if (t % 2 == 0)
+                expected.erase({int_key(i * threads + t), t});
+            else
+                expected.emplace(int_key((per_thread + i) * threads + t), t);
+        }
+    return ok && check(same_as(tree, expected), "removes that free nodes race with splits that allocate them");
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t ops = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    TempDir tmp("bplus_tree_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    RC          rc;
+    DiskManager small_pages(dir + "/small", 512, 64, rc);
+    bool        ok = true;
+    {
+        BufferPool pool(small_pages, 128, ReplacerKind::LRU_K, rc);
+        ok = check_basic(pool) && check_strings(pool) && check_reopen(small_pages) && check_batch(pool) &&
+             check_concurrent(pool);
+    }
+    if (!ok) return 1;
+    printf("correctness checks passed\n");
+
+    // 读多写少：90%点查，10%插入新键
+    DiskManager disk(dir + "/bench", 4096, 64, rc);
+    BufferPool  pool(disk, 16384, ReplacerKind::CLOCK, rc);
+    BPlusTree   tree(pool, disk.open_file("bench", rc), rc);
+    const int                preload = 1 << 18;
+    std::vector<std::string> loaded(preload);
+    for (int64_t k = 0; k < preload; ++k)
+    {
+        loaded[k] = int_key(k * 2);
+        tree.insert(bytes(loaded[k]), 9, k, rc);
+    }
+    printf("preloaded %d keys, height %u\n", preload, tree.height());
+
+    std::atomic<int64_t> next_key{preload};
+    for (unsigned int threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u})
+    {
+        BPlusTreeStats           before = tree.stats();
+        std::vector<std::thread> workers;
+        auto                     begin = Clock::now();
+        for (unsigned int t = 0; t < threads; ++t)
+            workers.emplace_back([&, t] {
+                unsigned int          state = t * 7919 + 1;
+                RC                    trc;
+                std::vector<uint64_t> values;
+                for (std::size_t i = 0; i < ops / threads; ++i)
+                {
+                    state = state * 1103515245u + 12345u;
+                    if ((state >> 8) % 10 == 0)
+                    {
+                        tree.insert(bytes(int_key(next_key.fetch_add(1) * 2 + 1)), 9, i, trc);
+                        continue;
+                    }
+                    values.clear();
+                    tree.lookup(bytes(loaded[(state >> 8) % preload]), 9, values, trc);
+                }
+            });
+        for (auto& worker : workers) worker.join();
+        double         seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        BPlusTreeStats after   = tree.stats();
+        printf("%2u threads  %.2f Mops/s  (splits %llu, restarts %llu)\n", threads, ops / seconds / 1e6,
+            static_cast<unsigned long long>(after.splits - before.splits),
+            static_cast<unsigned long long>(after.restarts - before.restarts));
+    }
+
+    return 0;
+}
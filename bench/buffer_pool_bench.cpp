@@ -0,0 +1,201 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Thread/ThreadPool.h"
+#include "bench_util.h"
+#include "ret.h"
+#include "storage/buffer_pool.h"
+
+/**
+ * @brief 缓冲池测试与基准
+ *
+ * 校验淘汰时写回脏页、全部钉住时报错、LRU-K在全表扫描后保留热页面、后台刷写线程写回脏页，
+ * 以及多线程在页锁保护下并发修改页面的结果；再测量不同线程数下命中路径的吞吐。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 创建pages个页，每页开头写入页号
+ */
+static void create_pages(BufferPool& pool, file_id_t file, std::size_t pages)
+{
+    RC rc;
+    for (std::size_t i = 0; i < pages; ++i)
+    {
+        PageGuard page = pool.new_page(file, rc);
+        page_no_t no   = page.id().page;
+        memcpy(page.data(), &no, sizeof(no));
+    }
+}
+
+static bool check_eviction(DiskManager& disk)
+{
+    bool       ok = true;
+    RC         rc;
+    BufferPool pool(disk, 8, ReplacerKind::LRU_K, rc);
+    file_id_t  file = disk.open_file("eviction", rc);
+    create_pages(pool, file, 64);
+    ok &= check(pool.stats().evictions == 56 && pool.stats().writebacks == 56, "dirty pages written back on eviction");
+
+    for (page_no_t no = 1; no <= 64; ++no)
+    {
+        PageGuard page = pool.fetch_page({file, no}, rc);
+        page_no_t stored;
+        memcpy(&stored, page.data(), sizeof(stored));
+        if (!check(rc == RC::SUCCESS && stored == no, "page content after eviction")) return false;
+    }
+
+    std::vector<PageGuard> pinned;
+    for (page_no_t no = 1; no <= 8; ++no) pinned.push_back(pool.fetch_page({file, no}, rc));
+    PageGuard extra = pool.fetch_page({file, 9}, rc);
+    ok &= check(rc == RC::LOCKED && !extra.valid(), "all frames pinned");
+    pinned.pop_back();
+    extra = pool.fetch_page({file, 9}, rc);
+    ok &= check(rc == RC::SUCCESS && extra.valid(), "frame available after unpin");
+    pinned.clear();
+
+    pool.fetch_page({file, 1000}, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "page past the end");
+    return ok;
+}
+
+/**
+ * @brief 热页面反复访问后做一次全表扫描，返回扫描后热页面的命中数
+ */
+static uint64_t hot_hits_after_scan(DiskManager& disk, ReplacerKind kind, const char* name)
+{
+    RC         rc;
+    BufferPool pool(disk, 64, kind, rc);
+    file_id_t  file = disk.open_file(name, rc);
+    create_pages(pool, file, 1024);
+    RC flush_rc;
+    pool.flush_all(flush_rc);
+
+    for (int round = 0; round < 4; ++round)
+        for (page_no_t no = 1; no <= 32; ++no) pool.fetch_page({file, no}, rc);
+    for (page_no_t no = 33; no <= 1024; ++no) pool.fetch_page({file, no}, rc);
+
+    pool.reset_stats();
+    for (page_no_t no = 1; no <= 32; ++no) pool.fetch_page({file, no}, rc);
+    return pool.stats().hits;
+}
+
+static bool check_flusher(DiskManager& disk)
+{
+    RC         rc;
+    ThreadPool threads(2);
+    BufferPool pool(disk, 64, ReplacerKind::CLOCK, rc);
+    file_id_t  file = disk.open_file("flusher", rc);
+    create_pages(pool, file, 32);
+
+    pool.start_flusher(threads, std::chrono::milliseconds(1), 8);
+    for (int i = 0; i < 1000 && pool.stats().flushes < 32; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    pool.stop_flusher();
+    return check(pool.stats().flushes == 32, "flusher writes back every dirty page once");
+}
+
+static bool check_concurrent(DiskManager& disk)
+{
+    RC         rc;
+    BufferPool pool(disk, 16, ReplacerKind::LRU_K, rc);
+    file_id_t  file = disk.open_file("concurrent", rc);
+    create_pages(pool, file, 64);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] {
+            unsigned int state = t * 7919 + 1;
+            RC           trc;
+            for (int i = 0; i < 20000; ++i)
+            {
+                state          = state * 1103515245u + 12345u;
+                PageGuard page = pool.fetch_page({file, static_cast<page_no_t>((state >> 8) % 64 + 1)}, trc);
+                if (!page.valid()) continue;
+                WriteGuard latch = page.latch().write();
+                uint64_t   count;
+                memcpy(&count, page.data() + 8, sizeof(count));
+                ++count;
+                memcpy(page.data() + 8, &count, sizeof(count));
+                page.mark_dirty();
+            }
+        });
+    for (auto& thread : threads) thread.join();
+
+    uint64_t total = 0;
+    for (page_no_t no = 1; no <= 64; ++no)
+    {
+        PageGuard page = pool.fetch_page({file, no}, rc);
+        uint64_t  count;
+        memcpy(&count, page.data() + 8, sizeof(count));
+        total += count;
+    }
+    return check(total == 80000, "concurrent increments under page latches");
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t ops = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    TempDir tmp("buffer_pool_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    RC          rc;
+    DiskManager disk(dir, 4096, 64, rc);
+    bool        ok = check_eviction(disk) && check_flusher(disk) && check_concurrent(disk);
+
+    uint64_t lru_k = hot_hits_after_scan(disk, ReplacerKind::LRU_K, "scan_lru_k");
+    uint64_t clock = hot_hits_after_scan(disk, ReplacerKind::CLOCK, "scan_clock");
+    printf("hot pages still cached after a full scan: LRU-K %llu/32, CLOCK %llu/32\n",
+        static_cast<unsigned long long>(lru_k), static_cast<unsigned long long>(clock));
+    ok &= check(lru_k == 32, "LRU-K keeps the hot set across a scan");
+    if (!ok) return 1;
+    printf("correctness checks passed\n");
+
+    for (ReplacerKind kind : {ReplacerKind::CLOCK, ReplacerKind::LRU_K})
+    {
+        BufferPool pool(disk, 4096, kind, rc);
+        file_id_t  file = disk.open_file(kind == ReplacerKind::CLOCK ? "bench_clock" : "bench_lru_k", rc);
+        create_pages(pool, file, 2048);
+        for (unsigned int threads : {1u, 2u, 4u})
+        {
+            std::vector<std::thread> workers;
+            auto                     begin = Clock::now();
+            for (unsigned int t = 0; t < threads; ++t)
+                workers.emplace_back([&, t] {
+                    unsigned int state = t + 1;
+                    RC           trc;
+                    for (std::size_t i = 0; i < ops / threads; ++i)
+                    {
+                        state          = state * 1103515245u + 12345u;
+                        PageGuard page = pool.fetch_page({file, static_cast<page_no_t>((state >> 8) % 2048 + 1)}, trc);
+                    }
+                });
+            for (auto& worker : workers) worker.join();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / ops;
+            const char* name = kind == ReplacerKind::CLOCK ? "CLOCK" : "LRU-K";
+            printf("%-6s hit path %u threads  %.1f ns/fetch\n", name, threads, ns);
+        }
+    }
+
+    BufferPool pool(disk, 256, ReplacerKind::CLOCK, rc);
+    file_id_t  file = disk.open_file("bench_miss", rc);
+    create_pages(pool, file, 4096);
+    pool.reset_stats();
+    auto begin = Clock::now();
+    for (std::size_t i = 0; i < ops / 16; ++i)
+        pool.fetch_page({file, static_cast<page_no_t>(next_random() % 4096 + 1)}, rc);
+    double          ns    = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / (ops / 16);
+    BufferPoolStats stats = pool.stats();
+    printf("miss path %.1f ns/fetch (hits %llu, misses %llu, evictions %llu, writebacks %llu)\n", ns,
+        static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+        static_cast<unsigned long long>(stats.evictions), static_cast<unsigned long long>(stats.writebacks));
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Thread/ThreadPool.h"
+#include "bench_util.h"
+#include "ret.h"
+#include "sql/sort_key.h"
+#include "storage/bplus_builder.h"
+
+/**
+ * @brief B+树批量构建测试与基准
+ *
+ * 校验有序与乱序输入构建出的树与std::set一致、填充率生效、重复条目与非空树被拒绝、
+ * 构建后仍能正常插入删除并从磁盘重新打开；再对比逐条插入、有序批量构建与乱序批量构建的耗时与页数。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static const KeyEncoder Encoder({{0, BIGINTS, false, true, 0}});
+
+/**
+ * @brief 把整数依次编码为BIGINTS排序键追加到keys
+ */
+static void encode_ints(const std::vector<int64_t>& ints, SortKeyBuffer& keys)
+{
+    RC                 rc;
+    std::vector<Value> row(1);
+    for (int64_t v : ints)
+    {
+        row[0].set_bigint(v, rc);
+        Encoder.encode(row, keys, rc);
+    }
+}
+
+static std::set<Entry> to_set(const SortKeyBuffer& keys, const std::vector<uint64_t>& values)
+{
+    std::set<Entry> entries;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        entries.emplace(std::string(reinterpret_cast<const char*>(keys.key(i)), keys.length(i)), values[i]);
+    return entries;
+}
+
+static bool check_load(DiskManager& disk, ThreadPool& threads)
+{
+    bool       ok = true;
+    RC         rc;
+    BufferPool pool(disk, 64, ReplacerKind::LRU_K, rc);
+
+    // 有序输入，每个键3个值
+    std::vector<int64_t>  ints;
+    std::vector<uint64_t> values;
+    for (int64_t k = 0; k < 20000; ++k)
+        for (uint64_t v = 0; v < 3; ++v)
+        {
+            ints.push_back(k);
+            values.push_back(v);
+        }
+    SortKeyBuffer sorted_keys;
+    encode_ints(ints, sorted_keys);
+    file_id_t file = disk.open_file("sorted", rc);
+    {
+        BPlusTree tree(pool, file, rc);
+        bulk_load(tree, sorted_keys, values, 1.0, threads, rc);
+        ok &= check(rc == RC::SUCCESS && same_as(tree, to_set(sorted_keys, values)), "sorted input");
+        bulk_load(tree, sorted_keys, values, 1.0, threads, rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT, "reject non-empty tree");
+
+        // 构建后的树仍可正常修改
+        std::set<Entry> expected = to_set(sorted_keys, values);
+        for (std::size_t i = 0; i < sorted_keys.size(); i += 5)
+        {
+            std::string key(reinterpret_cast<const char*>(sorted_keys.key(i)), sorted_keys.length(i));
+            tree.remove(sorted_keys.key(i), sorted_keys.length(i), values[i], rc);
+            expected.erase({key, values[i]});
+            tree.insert(sorted_keys.key(i), sorted_keys.length(i), values[i] + 100, rc);
+            expected.emplace(key, values[i] + 100);
+        }
+        ok &= check(same_as(tree, expected), "modify after bulk load");
+        pool.flush_all(rc);
+        BPlusTree reopened(pool, file, rc);
+        ok &= check(rc == RC::SUCCESS && same_as(reopened, expected), "reopen after bulk load");
+    }
+
+    // 乱序输入，键有重复
+    std::vector<int64_t> shuffled;
+    values.clear();
+    for (int i = 0; i < 100000; ++i)
+    {
+        shuffled.push_back(next_random() % 30000 - 15000);
+        values.push_back(i);
+    }
+    SortKeyBuffer shuffled_keys;
+    encode_ints(shuffled, shuffled_keys);
+    {
+        BPlusTree tree(pool, disk.open_file("shuffled", rc), rc);
+        bulk_load(tree, shuffled_keys, values, 0.7, threads, rc);
+        ok &= check(rc == RC::SUCCESS && same_as(tree, to_set(shuffled_keys, values)), "unsorted input");
+    }
+
+    // 重复的(键, 值)
+    values[7]   = values[3];
+    shuffled[7] = shuffled[3];
+    shuffled_keys.clear();
+    encode_ints(shuffled, shuffled_keys);
+    {
+        BPlusTree tree(pool, disk.open_file("duplicate", rc), rc);
+        bulk_load(tree, shuffled_keys, values, 0.7, threads, rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT && tree.height() == 1, "reject duplicate entries");
+        BPlusTreeBuilder bad(tree, 1.5, rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT, "reject fill factor above 1");
+    }
+    return ok;
+}
+
+/**
+ * @brief 不同填充率下的叶子页数应大致与填充率成反比
+ */
+static bool check_fill(DiskManager& disk, ThreadPool& threads)
+{
+    RC                    rc;
+    BufferPool            pool(disk, 64, ReplacerKind::CLOCK, rc);
+    std::vector<int64_t>  ints;
+    std::vector<uint64_t> values;
+    for (int64_t k = 0; k < 50000; ++k)
+    {
+        ints.push_back(k);
+        values.push_back(0);
+    }
+    SortKeyBuffer keys;
+    encode_ints(ints, keys);
+
+    uint32_t pages[2];
+    double   fills[2] = {1.0, 0.5};
+    for (int i = 0; i < 2; ++i)
+    {
+        file_id_t file = disk.open_file(i ? "fill_half" : "fill_full", rc);
+        BPlusTree tree(pool, file, rc);
+        bulk_load(tree, keys, values, fills[i], threads, rc);
+        pages[i] = disk.page_count(file);
+    }
+    printf("50000 entries: %u pages at fill factor 1.0, %u pages at 0.5\n", pages[0], pages[1]);
+    return check(pages[1] > pages[0] * 18 / 10 && pages[1] < pages[0] * 22 / 10, "fill factor controls node size");
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t rows = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 21;
+
+    TempDir tmp("bulk_load_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    RC          rc;
+    ThreadPool  threads(4);
+    DiskManager small_pages(dir + "/small", 512, 64, rc);
+    if (!check_load(small_pages, threads) || !check_fill(small_pages, threads)) return 1;
+    printf("correctness checks passed\n");
+
+    DiskManager           disk(dir + "/bench", 4096, 1024, rc);
+    BufferPool            pool(disk, 4096, ReplacerKind::CLOCK, rc);
+    std::vector<int64_t>  ints(rows);
+    std::vector<uint64_t> values(rows);
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        ints[i]   = static_cast<int64_t>(next_random()) << 16 | (i & 0xFFFF);
+        values[i] = i;
+    }
+    SortKeyBuffer keys;
+    encode_ints(ints, keys);
+
+    auto report = [&](const char* name, file_id_t file, Clock::time_point begin) {
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        printf("%-22s %.3f s  %.2f M rows/s  %u pages\n", name, seconds, rows / seconds / 1e6, disk.page_count(file));
+    };
+
+    {
+        file_id_t file  = disk.open_file("insert", rc);
+        BPlusTree tree(pool, file, rc);
+        auto      begin = Clock::now();
+        for (std::size_t i = 0; i < rows; ++i) tree.insert(keys.key(i), keys.length(i), values[i], rc);
+        pool.flush_all(rc);
+        report("insert one by one", file, begin);
+    }
+    {
+        file_id_t file  = disk.open_file("bulk_unsorted", rc);
+        BPlusTree tree(pool, file, rc);
+        auto      begin = Clock::now();
+        bulk_load(tree, keys, values, 0.9, threads, rc);
+        pool.flush_all(rc);
+        report("bulk load, unsorted", file, begin);
+    }
+
+    std::vector<SortEntry> entries;
+    make_entries(keys, entries);
+    radix_sort(entries);
+    SortKeyBuffer         sorted_keys;
+    std::vector<uint64_t> sorted_values;
+    std::vector<int64_t>  sorted_ints;
+    for (const SortEntry& entry : entries)
+    {
+        sorted_ints.push_back(ints[entry.row]);
+        sorted_values.push_back(values[entry.row]);
+    }
+    encode_ints(sorted_ints, sorted_keys);
+    {
+        file_id_t file  = disk.open_file("bulk_sorted", rc);
+        BPlusTree tree(pool, file, rc);
+        auto      begin = Clock::now();
+        bulk_load(tree, sorted_keys, sorted_values, 0.9, threads, rc);
+        pool.flush_all(rc);
+        report("bulk load, sorted", file, begin);
+    }
+
+    return 0;
+}
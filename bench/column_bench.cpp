@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "ret.h"
+#include "sql/column.h"
+
+/**
+ * @brief 列向量测试与基准
+ *
+ * 校验DataChunk与Value之间的往返转换、NULL与选择向量，
+ * 再比较按批对整数列求和与逐行从Value读取的耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "%s\n", msg);
+    return 1;
+}
+
+static int correctness_checks()
+{
+    DataChunk          chunk({INTS, CHARS, FLOATS, DATES, BOOLEANS}, 100);
+    std::vector<Value> row(5);
+    RC                 rc;
+    for (int i = 0; i < 100; ++i)
+    {
+        std::string str = "row-" + std::string(i % 20, 'x') + std::to_string(i);
+        row[0].set_int(i, rc);
+        row[1].set_str_ref(str, rc);
+        row[2].set_float(i * 0.5f, rc);
+        row[3].set_date(i - 50, rc);
+        row[4].set_bool(i % 2, rc);
+        if (i % 7 == 0) row[2] = Value();
+        chunk.append_row(row, rc);
+        if (rc != RC::SUCCESS) return fail("append failed");
+    }
+    chunk.append_row(row, rc);
+    if (rc != RC::INVALID_ARGUMENT) return fail("append to full chunk should fail");
+    if (chunk.column(2).validity().all_valid(100) || !chunk.column(0).validity().all_valid(100))
+        return fail("validity mismatch");
+
+    // 只保留偶数行
+    SelectionVector& sel = chunk.selection();
+    for (int i = 0; i < 50; ++i) sel.set(i, i * 2);
+    sel.set_size(50);
+    chunk.set_has_selection(true);
+
+    for (std::size_t i = 0; i < chunk.size(); ++i)
+    {
+        int n = static_cast<int>(i * 2);
+        chunk.get_row(i, row, rc);
+        std::string str = "row-" + std::string(n % 20, 'x') + std::to_string(n);
+        if (rc != RC::SUCCESS || row[0].get_int(rc) != n || row[1].get_str(rc) != str) return fail("row mismatch");
+        if ((n % 7 == 0) != (row[2].attr_type() == UNDEFINED)) return fail("null mismatch");
+        if (row[3].get_date(rc) != n - 50 || row[4].get_bool(rc)) return fail("row mismatch");
+    }
+
+    row[0].set_float(1.0f, rc);
+    chunk.reset();
+    chunk.append_row(row, rc);
+    if (rc != RC::INVALID_ARGUMENT) return fail("type mismatch should fail");
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int batches = argc > 1 ? atoi(argv[1]) : 500;
+
+    if (correctness_checks()) return 1;
+    printf("correctness checks passed\n");
+
+    RC                              rc;
+    DataChunk                       chunk({INTS});
+    std::vector<std::vector<Value>> rows(VectorCapacity, std::vector<Value>(1));
+    for (std::size_t i = 0; i < VectorCapacity; ++i)
+    {
+        rows[i][0].set_int(static_cast<int>(i * 2654435761u % 1000), rc);
+        chunk.append_row(rows[i], rc);
+    }
+
+    long sum   = 0;
+    auto begin = Clock::now();
+    for (int b = 0; b < batches; ++b)
+        for (auto& row : rows) sum += row[0].get_int(rc);
+    double row_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / batches / VectorCapacity;
+
+    long       batch_sum = 0;
+    const int* ints      = chunk.column<INTS>(0).data();
+    begin                = Clock::now();
+    for (int b = 0; b < batches; ++b)
+        for (std::size_t i = 0; i < chunk.row_count(); ++i) batch_sum += ints[i];
+    double batch_ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / batches / VectorCapacity;
+
+    if (sum != batch_sum) return fail("sum mismatch");
+    printf("row-at-a-time sum:   %.2f ns/row\n", row_ns);
+    printf("batch-at-a-time sum: %.2f ns/row\n", batch_ns);
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Trans/date.h"
+#include "ret.h"
+
+/**
+ * @brief 日期转换测试与基准
+ *
+ * 先用逐年累加的参考实现校验常数时间转换的正确性，再测量解析和格式化的吞吐量。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static bool leap(int y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+
+/**
+ * @brief 逐年逐月累加的参考实现
+ */
+static int reference_days(int y, int m, int d)
+{
+    static const int month_days[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int              days         = 0;
+    for (int i = 1970; i < y; ++i) days += leap(i) ? 366 : 365;
+    for (int i = y; i < 1970; ++i) days -= leap(i) ? 366 : 365;
+    for (int i = 1; i < m; ++i) days += month_days[i] + (i == 2 && leap(y));
+    return days + d - 1;
+}
+
+static int fail(const char* msg, const char* detail)
+{
+    fprintf(stderr, "%s: %s\n", msg, detail);
+    return 1;
+}
+
+static int correctness_checks()
+{
+    char buf[MaxDateStrLen + 1];
+    RC   rc;
+    int  date;
+
+    // 逐日校验1600~2400年与参考实现一致，且格式化后能解析回原值
+    int expected = reference_days(1600, 1, 1);
+    for (int y = 1600; y <= 2400; ++y)
+    {
+        for (int m = 1; m <= 12; ++m)
+        {
+            int days_in_month = m == 2 ? 28 + leap(y) : (m == 4 || m == 6 || m == 9 || m == 11) ? 30 : 31;
+            for (int d = 1; d <= days_in_month; ++d, ++expected)
+            {
+                snprintf(buf, sizeof(buf), "%04d-%02d-%02d", y, m, d);
+                StrDate2IntDate(buf, date, rc);
+                if (rc != RC::SUCCESS || date != expected) return fail("parse mismatch", buf);
+                if (IntDate2StrDate(date) != buf) return fail("format mismatch", buf);
+            }
+        }
+    }
+
+    // 边界与非法输入
+    const char* valid[]   = {"5000000-12-31", "-5000000-01-01", "0000-02-29", "1970-1-1", "2000-02-29"};
+    const char* invalid[] = {"1900-02-29", "2023-13-01", "2023-00-10", "2023-04-31", "5000001-01-01", "2023/01/01",
+        "2023-01-01x", "", "-", "2023-001-01", "abcd-ef-gh"};
+    for (const char* s : valid)
+    {
+        StrDate2IntDate(s, date, rc);
+        if (rc != RC::SUCCESS) return fail("should be valid", s);
+        int y, m, d;
+        CivilFromDays(date, y, m, d);
+        if (DaysFromCivil(y, m, d) != date) return fail("round trip failed", s);
+    }
+    for (const char* s : invalid)
+    {
+        StrDate2IntDate(s, date, rc);
+        if (rc != RC::INVALID_DATE) return fail("should be invalid", s);
+    }
+    StrDate2IntDate("5000000-12-31", date, rc);
+    if (IntDate2StrDate(date) != "5000000-12-31") return fail("format mismatch", "5000000-12-31");
+    if (IntDate2StrDate(-719528) != "0000-01-01") return fail("format mismatch", "0000-01-01");
+    return 0;
+}
+
+/**
+ * @brief 批量接口与逐行接口逐行比对，含混入的非法行与非定长行
+ */
+static int batch_checks()
+{
+    std::vector<std::string> strs;
+    for (int y = 0; y <= 9999; y += 7)
+        for (int m = 0; m <= 13; ++m)
+        {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%04d-%02d-%02d", y, m, (y + m) % 32);
+            strs.push_back(buf);
+            if (m == 2)
+            {
+                snprintf(buf, sizeof(buf), "%04d-02-29", y);
+                strs.push_back(buf);
+            }
+        }
+    const char* odd[] = {"-999-01-01", "2023-1-01", "2023x01-01", "20230-1-01", "1999-12-31", "12345-06-07",
+        "2023-01-0a", "2023-01-01x"};
+    for (int i = 0; i < 64; ++i) strs.insert(strs.begin() + i * 97, odd[i % 8]);
+
+    std::size_t              count = strs.size();
+    std::vector<const char*> ptrs(count);
+    std::vector<std::size_t> lens(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        ptrs[i] = strs[i].data();
+        lens[i] = strs[i].size();
+    }
+
+    std::vector<int>      dates(count);
+    std::vector<uint64_t> invalid((count + 63) / 64, ~uint64_t(0));
+    RC                    batch_rc = StrDates2IntDates(ptrs.data(), lens.data(), count, dates.data(), invalid.data());
+
+    bool any_invalid = false;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int date;
+        RC  rc;
+        StrDate2IntDate(ptrs[i], lens[i], date, rc);
+        bool bit = invalid[i / 64] >> (i % 64) & 1;
+        if (date != dates[i] || bit != (rc != RC::SUCCESS)) return fail("batch parse mismatch", ptrs[i]);
+        any_invalid |= bit;
+    }
+    if (batch_rc != (any_invalid ? RC::INVALID_DATE : RC::SUCCESS)) return fail("batch rc mismatch", "");
+
+    std::vector<char>        buf(count * MaxDateStrLen);
+    std::vector<std::size_t> offsets(count + 1);
+    IntDates2StrDates(dates.data(), count, buf.data(), offsets.data());
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::string s(buf.data() + offsets[i], offsets[i + 1] - offsets[i]);
+        if (s != IntDate2StrDate(dates[i])) return fail("batch format mismatch", s.c_str());
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int rows = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    if (correctness_checks() || batch_checks()) return 1;
+    printf("correctness checks passed\n");
+
+    std::vector<int>         dates(rows);
+    std::vector<std::string> strs(rows);
+    unsigned int             seed = 12345;
+    for (int i = 0; i < rows; ++i)
+    {
+        seed     = seed * 1103515245u + 12345u;
+        dates[i] = static_cast<int>(seed % 200000) - 100000;
+        strs[i]  = IntDate2StrDate(dates[i]);
+    }
+
+    long checksum = 0;
+    auto begin    = Clock::now();
+    for (int i = 0; i < rows; ++i)
+    {
+        int date;
+        RC  rc;
+        StrDate2IntDate(strs[i].data(), strs[i].size(), date, rc);
+        checksum += date;
+    }
+    double parse_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / rows;
+
+    char buf[MaxDateStrLen];
+    begin = Clock::now();
+    for (int i = 0; i < rows; ++i) checksum += IntDate2StrDate(dates[i], buf) + buf[0];
+    double format_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / rows;
+
+    std::vector<const char*> ptrs(rows);
+    std::vector<std::size_t> lens(rows);
+    std::vector<int>         parsed(rows);
+    std::vector<uint64_t>    invalid((rows + 63) / 64);
+    for (int i = 0; i < rows; ++i)
+    {
+        ptrs[i] = strs[i].data();
+        lens[i] = strs[i].size();
+    }
+    begin = Clock::now();
+    StrDates2IntDates(ptrs.data(), lens.data(), rows, parsed.data(), invalid.data());
+    double batch_parse_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / rows;
+    checksum += parsed[rows / 2];
+
+    std::vector<char>        out(static_cast<std::size_t>(rows) * MaxDateStrLen);
+    std::vector<std::size_t> offsets(rows + 1);
+    begin = Clock::now();
+    checksum += IntDates2StrDates(parsed.data(), rows, out.data(), offsets.data());
+    double batch_format_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / rows;
+
+    int far_date;
+    RC  rc;
+    begin = Clock::now();
+    for (int i = 0; i < rows; ++i)
+    {
+        StrDate2IntDate("4999999-12-31", far_date, rc);
+        checksum += far_date;
+    }
+    double far_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / rows;
+
+    printf("parse:  %.1f ns/row\n", parse_ns);
+    printf("format: %.1f ns/row\n", format_ns);
+    printf("batch parse:  %.1f ns/row\n", batch_parse_ns);
+    printf("batch format: %.1f ns/row\n", batch_format_ns);
+    printf("parse year 4999999: %.1f ns/row\n", far_ns);
+    printf("checksum %ld\n", checksum);
+    return 0;
+}
@@ -0,0 +1,337 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+#include <x86intrin.h>
+#include "ret.h"
+#include "sql/column.h"
+#include "sql/decimal.h"
+#include "sql/hash.h"
+#include "sql/kernels.h"
+#include "sql/value.h"
+
+/**
+ * @brief BIGINT与DECIMAL测试与基准
+ *
+ * 校验解析、格式化、舍入、溢出、跨类型比较，以及64位整数内核在各指令集上与标量实现逐位一致；
+ * 再测量64位整数内核、按列定点运算与128位求和的吞吐量（行/周期）。
+ */
+
+static const char* level_name(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+static uint64_t seed = 12345;
+
+static uint64_t next_random()
+{
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return seed >> 11;
+}
+
+static void fill(std::vector<int64_t>& values)
+{
+    static const int64_t edges[] = {std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), 0, -1,
+        1, 3037000500LL, -3037000500LL, 999999999999999999LL};
+    for (int64_t& v : values)
+    {
+        uint64_t r = next_random();
+        v          = r % 4 == 0 ? edges[r / 4 % 8] : static_cast<int64_t>(r % 2000001) - 1000000;
+    }
+}
+
+static bool check(bool ok, const char* what)
+{
+    if (!ok) fprintf(stderr, "check failed: %s\n", what);
+    return ok;
+}
+
+/**
+ * @brief 解析后再格式化，比较结果
+ */
+static bool round_trip(const char* str, int precision, int scale, const char* expected)
+{
+    int64_t value = 0;
+    RC      rc;
+    parse_decimal(str, strlen(str), precision, scale, value, rc);
+    if (!expected) return rc != RC::SUCCESS;
+    if (rc != RC::SUCCESS) return false;
+
+    char        buf[MaxNumberStrLen];
+    std::size_t len = format_decimal(value, scale, buf);
+    return std::string(buf, len) == expected;
+}
+
+static bool check_parse_format()
+{
+    bool ok = true;
+    ok &= check(round_trip("123.45", 5, 2, "123.45"), "plain");
+    ok &= check(round_trip("-0.5", 3, 1, "-0.5"), "negative fraction");
+    ok &= check(round_trip("1.005", 5, 2, "1.01"), "round half up");
+    ok &= check(round_trip("-1.005", 5, 2, "-1.01"), "round half away from zero");
+    ok &= check(round_trip("1.004", 5, 2, "1.00"), "round down");
+    ok &= check(round_trip("7", 5, 2, "7.00"), "pad scale");
+    ok &= check(round_trip(".5", 2, 1, "0.5"), "no integer digits");
+    ok &= check(round_trip("000123.4", 4, 1, "123.4"), "leading zeros");
+    ok &= check(round_trip("999.995", 5, 2, nullptr), "rounding overflows precision");
+    ok &= check(round_trip("1234.5", 5, 2, nullptr), "too many integer digits");
+    ok &= check(round_trip("1.2.3", 5, 2, nullptr), "garbage");
+    ok &= check(round_trip("", 5, 2, nullptr), "empty");
+    ok &= check(round_trip("-", 5, 2, nullptr), "sign only");
+    ok &= check(round_trip("999999999999999999", 18, 0, "999999999999999999"), "max precision");
+
+    RC      rc;
+    int64_t big = 0;
+    parse_bigint("-9223372036854775808", 20, big, rc);
+    ok &= check(rc == RC::SUCCESS && big == std::numeric_limits<int64_t>::min(), "bigint min");
+    parse_bigint("9223372036854775808", 19, big, rc);
+    ok &= check(rc != RC::SUCCESS, "bigint overflow");
+
+    char        buf[MaxNumberStrLen];
+    std::size_t len = format_bigint(std::numeric_limits<int64_t>::min(), buf);
+    ok &= check(std::string(buf, len) == "-9223372036854775808", "format bigint min");
+
+    int128_t total = int128_t(std::numeric_limits<int64_t>::max()) * 1000;
+    len            = format_decimal(total, 2, buf);
+    ok &= check(std::string(buf, len) == "92233720368547758070.00", "format 128-bit sum");
+    return ok;
+}
+
+static bool check_arith()
+{
+    bool    ok = true;
+    RC      rc;
+    int64_t out = 0;
+
+    decimal_arith(ArithOp::ADD, 150, 2, 25, 1, 10, 2, out, rc);  // 1.50 + 2.5
+    ok &= check(rc == RC::SUCCESS && out == 400, "add mixed scale");
+    decimal_arith(ArithOp::MUL, 150, 2, 25, 1, 10, 2, out, rc);  // 1.50 * 2.5
+    ok &= check(rc == RC::SUCCESS && out == 375, "mul");
+    decimal_arith(ArithOp::DIV, 100, 2, 3, 0, 10, 4, out, rc);  // 1.00 / 3
+    ok &= check(rc == RC::SUCCESS && out == 3333, "div");
+    decimal_arith(ArithOp::DIV, -200, 2, 3, 0, 10, 2, out, rc);  // -2.00 / 3
+    ok &= check(rc == RC::SUCCESS && out == -67, "div rounds away from zero");
+    decimal_arith(ArithOp::DIV, 1, 0, 0, 0, 10, 2, out, rc);
+    ok &= check(rc != RC::SUCCESS, "div by zero");
+    decimal_arith(ArithOp::MUL, 999999999999999999LL, 0, 999999999999999999LL, 0, 18, 0, out, rc);
+    ok &= check(rc != RC::SUCCESS, "mul overflow");
+    decimal_arith(ArithOp::ADD, 99999, 2, 1, 2, 5, 2, out, rc);
+    ok &= check(rc != RC::SUCCESS, "add exceeds precision");
+    decimal_rescale(12345, 3, 1, 5, out, rc);
+    ok &= check(rc == RC::SUCCESS && out == 123, "rescale down");
+    decimal_rescale(12345, 1, 3, 5, out, rc);
+    ok &= check(rc != RC::SUCCESS, "rescale up exceeds precision");
+    return ok;
+}
+
+static bool check_value_and_column()
+{
+    bool  ok = true;
+    RC    rc;
+    Value a, b, c, i, f, big;
+    a.set_decimal("1.50", 5, 2, rc);
+    b.set_decimal("1.5", 3, 1, rc);
+    c.set_decimal("1.51", 5, 2, rc);
+    i.set_int(2, rc);
+    f.set_float(1.25f, rc);
+    big.set_bigint(std::numeric_limits<int64_t>::max(), rc);
+
+    ok &= check(a.precision() == 5 && a.scale() == 2 && a.get_decimal(rc) == 150, "value fields");
+    ok &= check(a.equals(b) && a.compare(b, rc) == 0 && rc == RC::SUCCESS, "decimal equal across scales");
+    ok &= check(!a.equals(c) && a.compare(c, rc) < 0, "decimal order");
+    ok &= check(a.compare(i, rc) < 0 && rc == RC::SUCCESS, "decimal vs int");
+    ok &= check(a.compare(f, rc) > 0 && rc == RC::SUCCESS, "decimal vs float");
+    ok &= check(big.compare(a, rc) > 0 && rc == RC::SUCCESS, "bigint vs decimal");
+    ok &= check(hash_value(a) != hash_value(c), "decimal hash");
+
+    Value bad;
+    bad.set_decimal(int64_t(100000), 5, 2, rc);
+    ok &= check(rc != RC::SUCCESS, "set_decimal out of precision");
+
+    DataChunk chunk({BIGINTS, DECIMALS}, 16);
+    chunk.column(1).set_decimal_type(6, 3, rc);
+    chunk.append_row({big, a}, rc);
+    ok &= check(rc == RC::SUCCESS, "append row");
+    chunk.append_row({big, c}, rc);
+    ok &= check(chunk.column<DECIMALS>(1)[0] == 1500 && chunk.column<DECIMALS>(1)[1] == 1510, "column rescales");
+
+    std::vector<Value> row;
+    chunk.get_row(1, row, rc);
+    ok &= check(rc == RC::SUCCESS && row[0].equals(big) && row[1].equals(c) && row[1].scale() == 3, "get row");
+
+    Value wide;
+    wide.set_decimal("12345.6", 6, 1, rc);
+    chunk.append_row({big, wide}, rc);
+    ok &= check(rc != RC::SUCCESS, "append exceeds column precision");
+
+    uint64_t hashes[2];
+    hash_column(chunk.column(0), nullptr, 2, hashes);
+    ok &= check(hashes[0] == hash_value(big) && hashes[1] == hash_value(big), "bigint column hash");
+    return ok;
+}
+
+/**
+ * @brief 在level上运行所有64位整数内核
+ */
+static std::vector<uint64_t> run_all(SimdLevel level, const std::vector<int64_t>& a, const std::vector<int64_t>& b)
+{
+    set_simd_level(level);
+    std::size_t           n = a.size();
+    std::vector<uint64_t> out, bits((n + 63) / 64);
+    std::vector<int64_t>  values(n);
+
+    for (int op = 0; op < 6; ++op)
+    {
+        compare(static_cast<CompareOp>(op), a.data(), b.data(), n, bits.data());
+        out.insert(out.end(), bits.begin(), bits.end());
+        compare(static_cast<CompareOp>(op), a.data(), int64_t(-1), n, bits.data());
+        out.insert(out.end(), bits.begin(), bits.end());
+    }
+    for (int op = 0; op < 4; ++op)
+    {
+        out.push_back(arith(static_cast<ArithOp>(op), a.data(), b.data(), n, values.data(), bits.data()));
+        out.insert(out.end(), values.begin(), values.end());
+        out.insert(out.end(), bits.begin(), bits.end());
+        out.push_back(arith(static_cast<ArithOp>(op), a.data(), int64_t(-1), n, values.data(), bits.data()));
+        out.insert(out.end(), values.begin(), values.end());
+        out.insert(out.end(), bits.begin(), bits.end());
+    }
+    out.push_back(decimal_arith(ArithOp::ADD, a.data(), 2, b.data(), 2, n, 18, 2, values.data(), bits.data()));
+    out.insert(out.end(), values.begin(), values.end());
+    out.insert(out.end(), bits.begin(), bits.end());
+    return out;
+}
+
+/**
+ * @brief 按列运算与逐行运算的结果一致
+ */
+static bool check_batch_matches_rows(const std::vector<int64_t>& a, const std::vector<int64_t>& b)
+{
+    std::size_t           n = a.size();
+    std::vector<int64_t>  sa(n), sb(n), values(n);
+    std::vector<uint64_t> overflow((n + 63) / 64);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        sa[i] = a[i] % DecimalPow10[12];
+        sb[i] = b[i] % DecimalPow10[12];
+    }
+
+    const ArithOp ops[] = {ArithOp::ADD, ArithOp::SUB, ArithOp::MUL, ArithOp::DIV};
+    for (ArithOp op : ops)
+    {
+        for (int scale : {2, 3})
+        {
+            decimal_arith(op, sa.data(), 2, sb.data(), 2, n, 14, scale, values.data(), overflow.data());
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                int64_t expected = 0;
+                RC      rc;
+                decimal_arith(op, sa[i], 2, sb[i], 2, 14, scale, expected, rc);
+                bool flagged = overflow[i / 64] >> (i % 64) & 1;
+                if (flagged != (rc != RC::SUCCESS) || (!flagged && values[i] != expected))
+                {
+                    fprintf(stderr, "batch decimal op %d scale %d differs at row %zu\n", static_cast<int>(op), scale, i);
+                    return false;
+                }
+            }
+        }
+    }
+
+    std::vector<uint64_t> validity((n + 63) / 64, 0xF0F0F0F0F0F0F0F0ull);
+    validity[3]    = ~uint64_t(0);
+    int128_t naive = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        if (validity[i / 64] >> (i % 64) & 1) naive += a[i];
+    return check(sum(a.data(), validity.data(), n) == naive, "sum with nulls");
+}
+
+/**
+ * @brief 测量一个内核的吞吐量
+ */
+static double rows_per_cycle(std::size_t rows, int repeat, const std::function<void()>& kernel)
+{
+    kernel();
+    uint64_t begin = __rdtsc();
+    for (int r = 0; r < repeat; ++r) kernel();
+    return static_cast<double>(rows) * repeat / static_cast<double>(__rdtsc() - begin);
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t rows   = argc > 1 ? strtoul(argv[1], nullptr, 10) : 4096;
+    int         repeat = argc > 2 ? atoi(argv[2]) : 2000;
+
+    if (!check_parse_format() || !check_arith() || !check_value_and_column()) return 1;
+
+    SimdLevel best = detect_simd_level();
+
+    // 长度不是64的倍数，以覆盖尾部处理
+    std::size_t          n = 64 * 37 + 29;
+    std::vector<int64_t> a(n), b(n);
+    fill(a);
+    fill(b);
+
+    std::vector<uint64_t> expected = run_all(SimdLevel::SCALAR, a, b);
+    for (int level = 1; level <= static_cast<int>(best); ++level)
+    {
+        if (run_all(static_cast<SimdLevel>(level), a, b) != expected)
+        {
+            fprintf(stderr, "%s results differ from scalar\n", level_name(static_cast<SimdLevel>(level)));
+            return 1;
+        }
+    }
+    if (!check_batch_matches_rows(a, b)) return 1;
+    printf("correctness checks passed, best level %s\n", level_name(best));
+
+    // 基准数据在DECIMAL(15, 2)范围内，加法不会超出DECIMAL(18, 2)
+    a.resize(rows);
+    b.resize(rows);
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        a[i] = static_cast<int64_t>(next_random() % DecimalPow10[15]);
+        b[i] = static_cast<int64_t>(next_random() % DecimalPow10[15]);
+    }
+    std::vector<uint64_t> bits((rows + 63) / 64), validity((rows + 63) / 64, ~uint64_t(0));
+    std::vector<int64_t>  values(rows);
+    validity[0] = 0x00FF00FF00FF00FFull;
+
+    printf("%-24s", "rows/cycle");
+    for (int level = 0; level <= static_cast<int>(best); ++level)
+        printf("%10s", level_name(static_cast<SimdLevel>(level)));
+    printf("\n");
+
+    auto report = [&](const char* name, const std::function<void()>& kernel) {
+        printf("%-24s", name);
+        for (int level = 0; level <= static_cast<int>(best); ++level)
+        {
+            set_simd_level(static_cast<SimdLevel>(level));
+            printf("%10.2f", rows_per_cycle(rows, repeat, kernel));
+        }
+        printf("\n");
+    };
+
+    report("bigint lt const", [&] { compare(CompareOp::LT, a.data(), int64_t(500), rows, bits.data()); });
+    report("bigint eq vector", [&] { compare(CompareOp::EQ, a.data(), b.data(), rows, bits.data()); });
+    report("bigint add vector", [&] { arith(ArithOp::ADD, a.data(), b.data(), rows, values.data(), bits.data()); });
+    report("bigint mul vector", [&] { arith(ArithOp::MUL, a.data(), b.data(), rows, values.data(), bits.data()); });
+    report("decimal add same scale",
+        [&] { decimal_arith(ArithOp::ADD, a.data(), 2, b.data(), 2, rows, 18, 2, values.data(), bits.data()); });
+    report("decimal add mixed scale",
+        [&] { decimal_arith(ArithOp::ADD, a.data(), 2, b.data(), 1, rows, 18, 2, values.data(), bits.data()); });
+    report("decimal mul",
+        [&] { decimal_arith(ArithOp::MUL, a.data(), 2, b.data(), 2, rows, 18, 2, values.data(), bits.data()); });
+
+    volatile int64_t sink = 0;
+    report("sum", [&] { sink = static_cast<int64_t>(sum(a.data(), nullptr, rows)); });
+    report("sum with nulls", [&] { sink = static_cast<int64_t>(sum(a.data(), validity.data(), rows)); });
+    return 0;
+}
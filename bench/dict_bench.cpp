@@ -0,0 +1,236 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ret.h"
+#include "sql/column.h"
+#include "sql/dictionary.h"
+#include "sql/hash.h"
+
+/**
+ * @brief 字典编码测试与基准
+ *
+ * 在几百个不同值的低基数列上校验编码比较、哈希与解码的结果与未编码列一致，
+ * 再比较按编码与按字符串执行谓词、分组计数的耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static const int Distinct = 300;
+
+static unsigned int seed = 12345;
+
+static unsigned int next_random()
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static bool check(bool ok, const char* what)
+{
+    if (!ok) fprintf(stderr, "check failed: %s\n", what);
+    return ok;
+}
+
+static std::string category(int i)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "category_%04d", i * 7 % 1000);
+    return buf;
+}
+
+/**
+ * @brief 用同样的数据填充编码列与未编码列
+ */
+static void fill(DictVector& dict, ColumnVector<CHARS>& plain, std::size_t rows)
+{
+    RC rc;
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        if (next_random() % 10 == 0)
+        {
+            dict.validity().set_invalid(i);
+            plain.validity().set_invalid(i);
+            continue;
+        }
+        std::string str = category(next_random() % Distinct);
+        dict.set_str(i, str.data(), str.size(), rc);
+        plain.set_str(i, str.data(), str.size());
+    }
+}
+
+static bool expected_compare(CompareOp op, std::string_view a, std::string_view b)
+{
+    switch (op)
+    {
+        case CompareOp::EQ: return a == b;
+        case CompareOp::NE: return a != b;
+        case CompareOp::LT: return a < b;
+        case CompareOp::LE: return a <= b;
+        case CompareOp::GT: return a > b;
+        default: return a >= b;
+    }
+}
+
+static bool check_predicates(const DictVector& dict, const ColumnVector<CHARS>& plain, std::size_t rows)
+{
+    const char* constants[] = {"category_0007", "category_0500", "category_0501", "a", "zzz", "category_1", ""};
+    std::vector<uint64_t> bits((rows + 63) / 64);
+    for (const char* constant : constants)
+    {
+        for (int op = 0; op < 6; ++op)
+        {
+            RC rc;
+            compare(static_cast<CompareOp>(op), dict, constant, strlen(constant), rows, bits.data(), rc);
+            if (!check(rc == RC::SUCCESS, "compare on sorted dictionary")) return false;
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                if (!plain.validity().is_valid(i)) continue;
+                bool got = bits[i / 64] >> (i % 64) & 1;
+                if (got != expected_compare(static_cast<CompareOp>(op), plain[i], constant))
+                {
+                    fprintf(stderr, "op %d against '%s' differs at row %zu\n", op, constant, i);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool check_dictionary(std::size_t rows)
+{
+    bool                ok = true;
+    DictVector          dict(nullptr, rows);
+    ColumnVector<CHARS> plain(rows);
+    fill(dict, plain, rows);
+
+    // 随机顺序插入，字典无序，范围比较应当失败，等值比较仍然可用
+    RC                    rc;
+    std::vector<uint64_t> bits((rows + 63) / 64);
+    ok &= check(!dict.dictionary()->sorted(), "random inserts leave dictionary unsorted");
+    compare(CompareOp::LT, dict, "category_0100", 13, rows, bits.data(), rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "range compare needs sorted dictionary");
+    compare(CompareOp::EQ, dict, "category_0007", 13, rows, bits.data(), rc);
+    ok &= check(rc == RC::SUCCESS, "equality on unsorted dictionary");
+
+    std::vector<uint32_t> remap;
+    dict.shared_dictionary()->sort(remap);
+    dict.remap(remap, rows);
+    ok &= check(dict.dictionary()->sorted(), "sorted after sort");
+    for (uint32_t code = 1; code < dict.dictionary()->size(); ++code)
+        ok &= check(dict.dictionary()->decode(code - 1) < dict.dictionary()->decode(code), "codes preserve order");
+    ok &= check_predicates(dict, plain, rows);
+
+    std::vector<uint64_t> dict_hashes(rows), plain_hashes(rows);
+    hash_column(dict, nullptr, rows, dict_hashes.data());
+    hash_column(plain, nullptr, rows, plain_hashes.data());
+    ok &= check(dict_hashes == plain_hashes, "hashes match unencoded column");
+
+    for (std::size_t i = 0; i < rows; i += 97)
+    {
+        Value a, b;
+        dict.get_value(i, a, rc);
+        plain.get_value(i, b, rc);
+        ok &= check(a.attr_type() == b.attr_type() && (a.attr_type() == UNDEFINED || a.equals(b)), "decode");
+    }
+
+    // 两个字典之间的编码映射
+    StringDictionary other;
+    other.intern("category_0007", 13, rc);
+    other.intern("missing", 7, rc);
+    std::vector<uint32_t> mapping;
+    dict.dictionary()->translate(other, mapping);
+    ok &= check(mapping[0] == dict.dictionary()->find("category_0007", 13), "translate present");
+    ok &= check(mapping[1] == StringDictionary::NotFound, "translate missing");
+
+    DataChunk chunk({INTS, CHARS}, 8);
+    chunk.set_column(1, std::make_unique<DictVector>(dict.shared_dictionary(), 8), rc);
+    ok &= check(rc == RC::SUCCESS && chunk.column(1).dictionary() != nullptr, "set_column");
+    Value id, name;
+    id.set_int(1, rc);
+    name.set_str_ref("category_0014", rc);
+    chunk.append_row({id, name}, rc);
+    std::vector<Value> row;
+    chunk.get_row(0, row, rc);
+    ok &= check(rc == RC::SUCCESS && row[1].equals(name), "chunk round trip");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t rows    = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 20;
+    int         repeats = argc > 2 ? atoi(argv[2]) : 20;
+
+    if (!check_dictionary(64 * 41 + 17)) return 1;
+    printf("correctness checks passed\n");
+
+    DictVector          dict(nullptr, rows);
+    ColumnVector<CHARS> plain(rows);
+    fill(dict, plain, rows);
+    std::vector<uint32_t> remap;
+    dict.shared_dictionary()->sort(remap);
+    dict.remap(remap, rows);
+
+    std::vector<uint64_t> bits((rows + 63) / 64);
+    uint64_t              checksum = 0;
+
+    auto report = [&](const char* name, const std::function<void()>& body) {
+        body();
+        auto begin = Clock::now();
+        for (int r = 0; r < repeats; ++r) body();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / repeats / rows;
+        printf("%-26s %.2f ns/row\n", name, ns);
+    };
+
+    RC rc;
+    report("codes eq const", [&] {
+        compare(CompareOp::EQ, dict, "category_0007", 13, rows, bits.data(), rc);
+        checksum += bitmap_count(bits.data(), rows);
+    });
+    report("strings eq const", [&] {
+        std::string_view constant("category_0007");
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            if (i % 64 == 0) bits[i / 64] = 0;
+            bits[i / 64] |= uint64_t(plain[i] == constant) << (i % 64);
+        }
+        checksum += bitmap_count(bits.data(), rows);
+    });
+    report("codes lt const", [&] {
+        compare(CompareOp::LT, dict, "category_0500", 13, rows, bits.data(), rc);
+        checksum += bitmap_count(bits.data(), rows);
+    });
+    report("strings lt const", [&] {
+        std::string_view constant("category_0500");
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            if (i % 64 == 0) bits[i / 64] = 0;
+            bits[i / 64] |= uint64_t(plain[i] < constant) << (i % 64);
+        }
+        checksum += bitmap_count(bits.data(), rows);
+    });
+
+    // 分组计数：编码直接作下标，字符串走哈希表
+    std::vector<uint64_t> counts;
+    report("group by codes", [&] {
+        counts.assign(dict.dictionary()->size(), 0);
+        const uint32_t* codes = dict.codes();
+        for (std::size_t i = 0; i < rows; ++i) counts[codes[i]] += dict.validity().is_valid(i);
+        checksum += counts[0];
+    });
+    std::unordered_map<std::string_view, uint64_t> groups;
+    report("group by strings", [&] {
+        groups.clear();
+        for (std::size_t i = 0; i < rows; ++i)
+            if (plain.validity().is_valid(i)) ++groups[plain[i]];
+        checksum += groups.size();
+    });
+    if (rc != RC::SUCCESS) return 1;
+    printf("checksum %llu\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
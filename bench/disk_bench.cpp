@@ -0,0 +1,163 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "ret.h"
+#include "storage/disk_manager.h"
+
+/**
+ * @brief 页式磁盘管理测试与基准
+ *
+ * 校验页的分配、读写、越界检查、按区预留以及重新打开后数据与页数保持不变，
+ * 多线程分配的页号互不重复；再测量顺序写、随机读的耗时并打印I/O统计。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 用页号填充一页，便于校验
+ */
+static void fill_page(char* buf, std::size_t page_size, page_no_t page)
+{
+    for (std::size_t i = 0; i < page_size; i += sizeof(page)) memcpy(buf + i, &page, sizeof(page));
+}
+
+static bool check_pages(const std::string& dir)
+{
+    bool ok = true;
+    RC   rc;
+
+    DiskManager bad(dir, 1000, 8, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "page size must be a power of two");
+
+    std::vector<char> buf(4096), out(4096);
+    {
+        DiskManager disk(dir, 4096, 8, rc);
+        ok &= check(rc == RC::SUCCESS, "create manager");
+        file_id_t file = disk.open_file("orders", rc);
+        ok &= check(rc == RC::SUCCESS && disk.page_count(file) == 1, "new file has only the header page");
+        ok &= check(disk.open_file("orders", rc) == file, "open twice returns the same id");
+
+        for (page_no_t expect = 1; expect <= 20; ++expect)
+        {
+            page_no_t page = disk.allocate_page(file, rc);
+            ok &= check(rc == RC::SUCCESS && page == expect, "sequential page numbers");
+            fill_page(buf.data(), buf.size(), page);
+            disk.write_page({file, page}, buf.data(), rc);
+            ok &= check(rc == RC::SUCCESS, "write page");
+        }
+        ok &= check(disk.stats().extents == 3, "20 pages + header need 3 extents of 8 pages");
+
+        disk.read_page({file, 7}, out.data(), rc);
+        fill_page(buf.data(), buf.size(), 7);
+        ok &= check(rc == RC::SUCCESS && buf == out, "read back page");
+        disk.read_page({file, 0}, out.data(), rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT, "header page is not readable");
+        disk.read_page({file, 21}, out.data(), rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT, "page past the end");
+        disk.write_page({file + 1, 1}, buf.data(), rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT, "unknown file");
+
+        disk.sync(file, rc);
+        ok &= check(rc == RC::SUCCESS && disk.stats().syncs.count == 1, "sync");
+        ok &= check(std::filesystem::file_size(dir + "/orders.db") == 24 * 4096, "file grows by extents");
+    }
+
+    DiskManager disk(dir, 4096, 8, rc);
+    file_id_t   file = disk.open_file("orders", rc);
+    ok &= check(rc == RC::SUCCESS && disk.page_count(file) == 21, "page count survives reopen");
+    disk.read_page({file, 20}, out.data(), rc);
+    fill_page(buf.data(), buf.size(), 20);
+    ok &= check(rc == RC::SUCCESS && buf == out, "data survives reopen");
+    ok &= check(disk.allocate_page(file, rc) == 21 && disk.stats().extents == 0, "reuse reserved pages");
+
+    DiskManager other(dir, 8192, 8, rc);
+    other.open_file("orders", rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "page size mismatch");
+    other.open_file("a/b", rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "file name with slash");
+
+    file_id_t                           lineitem = disk.open_file("lineitem", rc);
+    std::vector<std::vector<page_no_t>> pages(4);
+    std::vector<std::thread>            threads;
+    for (std::size_t t = 0; t < pages.size(); ++t)
+        threads.emplace_back([&, t] {
+            RC trc;
+            for (int i = 0; i < 1000; ++i) pages[t].push_back(disk.allocate_page(lineitem, trc));
+        });
+    for (auto& thread : threads) thread.join();
+    std::set<page_no_t> unique;
+    for (const auto& list : pages) unique.insert(list.begin(), list.end());
+    ok &= check(unique.size() == 4000 && *unique.begin() == 1 && *unique.rbegin() == 4000, "concurrent allocation");
+    return ok;
+}
+
+static void print_stat(const char* name, const IoStat& stat)
+{
+    printf("  %-6s count %-8llu bytes %-12llu avg %8.0f ns  max %8llu ns\n", name,
+        static_cast<unsigned long long>(stat.count), static_cast<unsigned long long>(stat.bytes), stat.avg_ns(),
+        static_cast<unsigned long long>(stat.max_ns));
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t pages     = argc > 1 ? strtoul(argv[1], nullptr, 10) : 16384;
+    std::size_t page_size = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4096;
+
+    TempDir tmp("disk_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    bool ok = check_pages(dir + "/check");
+    if (ok) printf("correctness checks passed\n");
+
+    RC          rc;
+    DiskManager disk(dir + "/bench", page_size, 256, rc);
+    file_id_t   file = disk.open_file("bench", rc);
+    if (!ok || FAIL(rc)) return 1;
+
+    auto report = [&](const char* name, const std::function<void()>& body) {
+        auto begin = Clock::now();
+        body();
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / pages;
+        printf("%-24s %.2f us/page\n", name, us);
+    };
+
+    std::vector<char> buf(page_size);
+    report("allocate + write", [&] {
+        for (std::size_t i = 0; i < pages; ++i)
+        {
+            page_no_t page = disk.allocate_page(file, rc);
+            fill_page(buf.data(), page_size, page);
+            disk.write_page({file, page}, buf.data(), rc);
+        }
+    });
+    disk.sync(file, rc);
+    report("sequential read", [&] {
+        for (std::size_t i = 1; i <= pages; ++i) disk.read_page({file, static_cast<page_no_t>(i)}, buf.data(), rc);
+    });
+    std::size_t checksum = 0;
+    report("random read", [&] {
+        for (std::size_t i = 0; i < pages; ++i)
+        {
+            disk.read_page({file, static_cast<page_no_t>(next_random() % pages + 1)}, buf.data(), rc);
+            checksum += static_cast<unsigned char>(buf[0]);
+        }
+    });
+
+    DiskStats stats = disk.stats();
+    printf("io stats (extents %llu):\n", static_cast<unsigned long long>(stats.extents));
+    print_stat("read", stats.reads);
+    print_stat("write", stats.writes);
+    print_stat("sync", stats.syncs);
+    printf("checksum %zu\n", checksum);
+
+    return FAIL(rc);
+}
@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "ret.h"
+#include "sql/column.h"
+#include "sql/hash.h"
+
+/**
+ * @brief 哈希内核测试与基准
+ *
+ * 校验按列哈希与逐个Value哈希一致、FLOATS的±0.0与NaN规范化、DECIMALS与标度无关、NULL、多列合并与无键列，
+ * 检查连续整数与短字符串在低位桶上的分布，再测量按列哈希的吞吐量。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "%s\n", msg);
+    return 1;
+}
+
+static int correctness_checks()
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    if (hash_float(0.0f) != hash_float(-0.0f)) return fail("+0.0 and -0.0 hash differently");
+    if (hash_float(nan) != hash_float(-nan) || hash_float(nan) != hash_float(std::nanf("1")))
+        return fail("NaNs hash differently");
+    if (hash_float(1.0f) == hash_float(-1.0f)) return fail("1.0 and -1.0 collide");
+
+    DataChunk          chunk({INTS, CHARS, FLOATS, DATES, BOOLEANS}, 300);
+    std::vector<Value> row(5);
+    RC                 rc;
+    for (int i = 0; i < 300; ++i)
+    {
+        std::string str(i % 40, static_cast<char>('a' + i % 26));
+        row[0].set_int(i * 7919, rc);
+        row[1].set_str_ref(str, rc);
+        row[2].set_float(i % 3 == 0 ? -0.0f : i % 3 == 1 ? nan : i * 0.25f, rc);
+        row[3].set_date(i - 150, rc);
+        row[4].set_bool(i % 2, rc);
+        if (i % 11 == 0) row[i % 5] = Value();
+        chunk.append_row(row, rc);
+    }
+
+    // 选择向量取3的倍数行
+    for (int i = 0; i < 100; ++i) chunk.selection().set(i, i * 3);
+    chunk.selection().set_size(100);
+
+    for (bool selected : {false, true})
+    {
+        chunk.set_has_selection(selected);
+        std::vector<uint64_t> hashes(chunk.size());
+        hash_chunk(chunk, {0, 1, 2, 3, 4}, hashes.data());
+        for (std::size_t i = 0; i < chunk.size(); ++i)
+        {
+            chunk.get_row(i, row, rc);
+            uint64_t expect = hash_value(row[0]);
+            for (int c = 1; c < 5; ++c) expect = hash_combine(expect, hash_value(row[c]));
+            if (hashes[i] != expect) return fail("column hash differs from value hash");
+        }
+
+        hash_chunk(chunk, {2}, hashes.data());
+        for (std::size_t i = 0; i < chunk.size(); ++i)
+        {
+            chunk.get_row(i, row, rc);
+            if (row[2].attr_type() == UNDEFINED ? hashes[i] != NullHash : hashes[i] != hash_value(row[2]))
+                return fail("null hash mismatch");
+        }
+
+        // 没有键列时所有行归为一组，输出不能保留原来的内容
+        for (std::size_t i = 0; i < chunk.size(); ++i) hashes[i] = i;
+        hash_chunk(chunk, {}, hashes.data());
+        for (std::size_t i = 1; i < chunk.size(); ++i)
+            if (hashes[i] != hashes[0]) return fail("rows hash differently without key columns");
+    }
+
+    std::vector<uint64_t> ab(1), ba(1);
+    DataChunk             pair({INTS, INTS}, 1);
+    Value                 one(1, rc), two(2, rc);
+    pair.append_row({one, two}, rc);
+    hash_chunk(pair, {0, 1}, ab.data());
+    hash_chunk(pair, {1, 0}, ba.data());
+    if (ab[0] == ba[0]) return fail("column order ignored");
+
+    // Value::equals与标度无关，1.50与1.5相等就必须同哈希，按行与按列都一样
+    Value d150, d15, d15i;
+    d150.set_decimal(150, 6, 2, rc);
+    d15.set_decimal(15, 6, 1, rc);
+    d15i.set_decimal(15, 6, 0, rc);
+    if (!d150.equals(d15) || hash_value(d150) != hash_value(d15)) return fail("1.50 and 1.5 hash differently");
+    if (hash_value(d15) == hash_value(d15i)) return fail("1.5 and 15 collide");
+    DataChunk decimals({DECIMALS, DECIMALS}, 1);
+    decimals.column(0).set_decimal_type(6, 2, rc);
+    decimals.column(1).set_decimal_type(6, 1, rc);
+    decimals.append_row({d150, d15}, rc);
+    std::vector<uint64_t> scaled(1), canonical(1);
+    hash_chunk(decimals, {0}, scaled.data());
+    hash_chunk(decimals, {1}, canonical.data());
+    if (rc != RC::SUCCESS || scaled[0] != canonical[0] || scaled[0] != hash_value(d15))
+        return fail("decimal column hash depends on scale");
+    return 0;
+}
+
+/**
+ * @brief 统计n个哈希值落入2^bits个桶后的最大桶大小
+ */
+static std::size_t max_bucket(const std::vector<uint64_t>& hashes, int bits)
+{
+    std::vector<std::size_t> buckets(std::size_t(1) << bits);
+    std::size_t              worst = 0;
+    for (uint64_t h : hashes)
+    {
+        std::size_t& b = buckets[h & (buckets.size() - 1)];
+        if (++b > worst) worst = b;
+    }
+    return worst;
+}
+
+int main(int argc, char** argv)
+{
+    int batches = argc > 1 ? atoi(argv[1]) : 500;
+
+    if (correctness_checks()) return 1;
+
+    // 连续整数与短字符串都应均匀分布：2^16行放入2^12个桶，均值16
+    std::vector<uint64_t> ints(1 << 16), strs(1 << 16);
+    for (int i = 0; i < (1 << 16); ++i)
+    {
+        ints[i]         = hash_int(i);
+        std::string str = "k" + std::to_string(i);
+        strs[i]         = hash_bytes(str.data(), str.size());
+    }
+    std::unordered_set<uint64_t> distinct(strs.begin(), strs.end());
+    if (distinct.size() != strs.size()) return fail("string hash collision");
+    std::size_t int_worst = max_bucket(ints, 12), str_worst = max_bucket(strs, 12);
+    if (int_worst > 48 || str_worst > 48) return fail("poor distribution");
+    printf("correctness checks passed, max bucket int %zu, string %zu (mean 16)\n", int_worst, str_worst);
+
+    DataChunk          chunk({INTS, CHARS, FLOATS});
+    std::vector<Value> row(3);
+    RC                 rc;
+    for (std::size_t i = 0; i < VectorCapacity; ++i)
+    {
+        std::string str = "customer#" + std::to_string(i * 2654435761u % 100000);
+        row[0].set_int(static_cast<int>(i), rc);
+        row[1].set_str_ref(str, rc);
+        row[2].set_float(i * 0.5f, rc);
+        chunk.append_row(row, rc);
+    }
+
+    std::vector<uint64_t> hashes(VectorCapacity);
+    uint64_t              checksum = 0;
+    auto                  measure  = [&](const char* name, const std::vector<std::size_t>& keys) {
+        auto begin = Clock::now();
+        for (int b = 0; b < batches; ++b)
+        {
+            hash_chunk(chunk, keys, hashes.data());
+            checksum += hashes[b % VectorCapacity];
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / batches / VectorCapacity;
+        printf("%-22s %.2f ns/row\n", name, ns);
+    };
+    measure("INTS", {0});
+    measure("CHARS", {1});
+    measure("FLOATS", {2});
+    measure("INTS, CHARS, FLOATS", {0, 1, 2});
+    printf("checksum %llu\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
@@ -0,0 +1,282 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "ret.h"
+#include "storage/heap_file.h"
+
+/**
+ * @brief 堆文件测试与基准
+ *
+ * 以std::map为参照校验变长记录的插入、读取、顺序扫描、变长更新与转发、变短后搬回、删除与空间复用、
+ * 超长记录、从磁盘重新打开，再让多个线程并发插入更新删除后校验结果；
+ * 最后测量表增长过程中每批插入的耗时，以及删除一半后再插入时文件是否增长。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t key(RecordId rid) { return static_cast<uint64_t>(rid.page) << 16 | rid.slot; }
+
+/**
+ * @brief 长度为len、内容由tag决定的记录
+ */
+static std::string make_record(uint64_t tag, std::size_t len)
+{
+    std::string record(len, '\0');
+    for (std::size_t i = 0; i < len; ++i) record[i] = static_cast<char>('a' + (tag + i) % 26);
+    return record;
+}
+
+/**
+ * @brief 逐条读取与顺序扫描的结果都与expected一致
+ */
+static bool same_as(HeapFile& heap, const std::map<uint64_t, std::string>& expected)
+{
+    RC                rc;
+    std::vector<char> record;
+    for (auto& [k, want] : expected)
+    {
+        heap.get({static_cast<page_no_t>(k >> 16), static_cast<uint16_t>(k)}, record, rc);
+        if (rc != RC::SUCCESS || std::string(record.begin(), record.end()) != want) return false;
+    }
+    std::map<uint64_t, std::string> scanned;
+    for (HeapIterator it = heap.begin(rc); it.valid(); it.next(rc))
+        if (!scanned.emplace(key(it.rid()), std::string(it.data(), it.length())).second) return false;
+    return rc == RC::SUCCESS && scanned == expected;
+}
+
+static bool check_basic(BufferPool& pool)
+{
+    RC       rc;
+    HeapFile heap(pool, pool.disk().open_file("basic", rc), rc);
+    if (!check(rc == RC::SUCCESS, "create heap file")) return false;
+
+    std::map<uint64_t, std::string> expected;
+    for (uint64_t i = 0; i < 5000; ++i)
+    {
+        std::string record = make_record(i, next_random() % 200);
+        RecordId    rid    = heap.insert(record.data(), record.size(), rc);
+        if (!check(rc == RC::SUCCESS && expected.emplace(key(rid), record).second, "insert")) return false;
+    }
+    bool ok = check(same_as(heap, expected), "get and scan after inserts");
+
+    std::string too_long(heap.max_record_size() + 1, 'x');
+    heap.insert(too_long.data(), too_long.size(), rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "reject oversized record");
+    std::string longest(heap.max_record_size(), 'y');
+    RecordId    rid = heap.insert(longest.data(), longest.size(), rc);
+    ok &= check(rc == RC::SUCCESS, "insert longest record");
+    expected.emplace(key(rid), longest);
+
+    // 变长的记录搬到别的页，RecordId不变
+    for (auto& [k, record] : expected)
+    {
+        if (next_random() % 3) continue;
+        record = make_record(k, next_random() % heap.max_record_size());
+        heap.update({static_cast<page_no_t>(k >> 16), static_cast<uint16_t>(k)}, record.data(), record.size(), rc);
+        if (!check(rc == RC::SUCCESS, "update")) return false;
+    }
+    ok &= check(heap.stats().forwards > 0, "growing records are forwarded");
+    ok &= check(same_as(heap, expected), "get and scan after growing updates");
+
+    // 全部变短，被转发的记录搬回原位置，再变长时又被转发
+    for (int round = 0; round < 2; ++round)
+    {
+        for (auto& [k, record] : expected)
+        {
+            record = make_record(k + round, round ? next_random() % 300 : 1);
+            heap.update({static_cast<page_no_t>(k >> 16), static_cast<uint16_t>(k)}, record.data(), record.size(), rc);
+            if (!check(rc == RC::SUCCESS, "update again")) return false;
+        }
+        ok &= check(same_as(heap, expected), round ? "get and scan after regrowing" : "get and scan after shrinking");
+    }
+
+    // 删除一半后再插入同样多的记录，空间被复用
+    std::size_t      pages = heap.pages();
+    std::vector<int> lengths;
+    for (auto it = expected.begin(); it != expected.end();)
+    {
+        if (next_random() % 2)
+        {
+            ++it;
+            continue;
+        }
+        heap.remove({static_cast<page_no_t>(it->first >> 16), static_cast<uint16_t>(it->first)}, rc);
+        if (!check(rc == RC::SUCCESS, "remove")) return false;
+        lengths.push_back(static_cast<int>(it->second.size()));
+        it = expected.erase(it);
+    }
+    std::vector<char> record;
+    heap.get(rid, record, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT || expected.count(key(rid)), "get removed record");
+    heap.remove({1, 0}, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "reject map page");
+    for (std::size_t i = 0; i < lengths.size(); ++i)
+    {
+        std::string fresh = make_record(i * 7, lengths[i]);
+        RecordId    at    = heap.insert(fresh.data(), fresh.size(), rc);
+        expected[key(at)] = fresh;
+    }
+    ok &= check(heap.pages() <= pages + pages / 20, "free space is reused");
+    return ok && check(same_as(heap, expected), "get and scan after reuse");
+}
+
+static bool check_reopen(DiskManager& disk)
+{
+    RC                              rc;
+    std::map<uint64_t, std::string> expected;
+    file_id_t                       file = disk.open_file("reopen", rc);
+    std::size_t                     pages;
+    {
+        BufferPool pool(disk, 16, ReplacerKind::LRU_K, rc);
+        HeapFile   heap(pool, file, rc);
+        // 跨越多个映射页：512字节的页每个映射页覆盖496个数据页
+        std::vector<RecordId> rids;
+        for (uint64_t i = 0; i < 20000; ++i)
+        {
+            std::string record = make_record(i, 20 + i % 60);
+            rids.push_back(heap.insert(record.data(), record.size(), rc));
+            expected[key(rids.back())] = record;
+        }
+        for (std::size_t i = 0; i < rids.size(); i += 3)
+        {
+            heap.remove(rids[i], rc);
+            expected.erase(key(rids[i]));
+        }
+        pages = heap.pages();
+        pool.flush_all(rc);
+    }
+    BufferPool pool(disk, 16, ReplacerKind::LRU_K, rc);
+    HeapFile   heap(pool, file, rc);
+    bool       ok = check(rc == RC::SUCCESS && heap.pages() == pages && same_as(heap, expected), "reopen from disk");
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::string record = make_record(i, 40);
+        heap.insert(record.data(), record.size(), rc);
+    }
+    return ok && check(heap.pages() == pages, "free space map survives reopen");
+}
+
+static bool check_concurrent(BufferPool& pool)
+{
+    RC       rc;
+    HeapFile heap(pool, pool.disk().open_file("concurrent", rc), rc);
+
+    // 每个线程插入自己的记录，反复变长变短，再删除其中一半
+    const int                                    threads = 8, per_thread = 2000;
+    std::vector<std::map<uint64_t, std::string>> results(threads);
+    std::atomic<int>                             failures{0};
+    std::vector<std::thread>                     workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            RC                               trc;
+            std::map<uint64_t, std::string>& mine = results[t];
+            std::vector<RecordId>            rids;
+            for (int i = 0; i < per_thread; ++i)
+            {
+                std::string record = make_record(t * per_thread + i, 10 + i % 50);
+                rids.push_back(heap.insert(record.data(), record.size(), trc));
+                if (trc != RC::SUCCESS) ++failures;
+                mine[key(rids.back())] = record;
+            }
+            for (int round = 0; round < 3; ++round)
+                for (int i = 0; i < per_thread; ++i)
+                {
+                    std::string record = make_record(i + round, (i * 31 + round * 97) % 400);
+                    heap.update(rids[i], record.data(), record.size(), trc);
+                    if (trc != RC::SUCCESS) ++failures;
+                    mine[key(rids[i])] = record;
+                }
+            for (int i = 0; i < per_thread; i += 2)
+            {
+                heap.remove(rids[i], trc);
+                if (trc != RC::SUCCESS) ++failures;
+                mine.erase(key(rids[i]));
+                std::vector<char> record;
+                heap.get(rids[i + 1], record, trc);
+                if (trc != RC::SUCCESS || std::string(record.begin(), record.end()) != mine[key(rids[i + 1])])
+                    ++failures;
+            }
+        });
+    for (auto& worker : workers) worker.join();
+
+    std::map<uint64_t, std::string> expected;
+    for (auto& mine : results) expected.insert(mine.begin(), mine.end());
+    return check(failures == 0 && same_as(heap, expected), "concurrent inserts, updates and removes");
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t rows = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 21;
+
+    TempDir tmp("heap_file_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    RC          rc;
+    DiskManager small_pages(dir + "/small", 512, 64, rc);
+    bool        ok;
+    {
+        BufferPool pool(small_pages, 64, ReplacerKind::LRU_K, rc);
+        ok = check_basic(pool) && check_reopen(small_pages) && check_concurrent(pool);
+    }
+    if (!ok) return 1;
+    printf("correctness checks passed\n");
+
+    // 订单行：40~160字节的变长记录
+    DiskManager           disk(dir + "/bench", 8192, 1024, rc);
+    BufferPool            pool(disk, 65536, ReplacerKind::CLOCK, rc);
+    HeapFile              heap(pool, disk.open_file("orders", rc), rc);
+    std::vector<RecordId> rids;
+    rids.reserve(rows);
+    std::vector<std::string> records(64);
+    for (std::size_t i = 0; i < records.size(); ++i) records[i] = make_record(i, 40 + next_random() % 121);
+
+    const std::size_t batch = rows / 8;
+    for (std::size_t done = 0; done < rows; done += batch)
+    {
+        auto begin = Clock::now();
+        for (std::size_t i = done; i < done + batch; ++i)
+        {
+            const std::string& record = records[i % records.size()];
+            rids.push_back(heap.insert(record.data(), record.size(), rc));
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / batch;
+        printf("insert rows %8zu..%8zu  %.0f ns/row  %zu pages\n", done, done + batch, ns, heap.pages());
+    }
+
+    // 删除一半后再插入同样多的行，新行填进删除留下的空间
+    std::size_t pages = heap.pages();
+    auto        begin = Clock::now();
+    for (std::size_t i = 0; i < rows; i += 2) heap.remove(rids[i], rc);
+    double remove_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / (rows / 2);
+    begin            = Clock::now();
+    for (std::size_t i = 0; i < rows; i += 2)
+    {
+        const std::string& record = records[i % records.size()];
+        heap.insert(record.data(), record.size(), rc);
+    }
+    double insert_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / (rows / 2);
+    printf("remove half  %.0f ns/row, reinsert %.0f ns/row, pages %zu -> %zu\n", remove_ns, insert_ns, pages,
+        heap.pages());
+
+    // 一半的行变长一倍，放不下的被转发
+    begin = Clock::now();
+    for (std::size_t i = 1; i < rows; i += 2)
+    {
+        const std::string& record = records[i % records.size()];
+        std::string        longer = record + record;
+        heap.update(rids[i], longer.data(), longer.size(), rc);
+    }
+    double update_ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / (rows / 2);
+    printf("grow half    %.0f ns/row, %llu forwarded, %zu pages\n", update_ns,
+        static_cast<unsigned long long>(heap.stats().forwards), heap.pages());
+
+    return 0;
+}
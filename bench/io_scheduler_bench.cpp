@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "Thread/IoScheduler.h"
+#include "ret.h"
+
+/**
+ * @brief 协程I/O调度器测试与基准
+ *
+ * 数百对socketpair同时做乒乓往返，中间穿插定时等待：同一fd反复等待可读检验EPOLLONESHOT的重新注册，
+ * 恢复协程的线程必须是线程池的工作线程，进程的线程数不随进行中的协程数增长。
+ * 另外检查定时器按到期时间唤醒、Spawn的返回值与异常、协程帧在结束后被销毁，以及不可等待的fd报错。
+ * 最后测量乒乓往返的吞吐量。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static bool check(bool ok, const char* what)
+{
+    if (!ok) fprintf(stderr, "check failed: %s\n", what);
+    return ok;
+}
+
+/**
+ * @brief 进程当前的线程数
+ */
+static int thread_count()
+{
+    std::ifstream status("/proc/self/status");
+    std::string   line;
+    while (std::getline(status, line))
+        if (line.compare(0, 8, "Threads:") == 0) return atoi(line.c_str() + 8);
+    return -1;
+}
+
+/**
+ * @brief 记录恢复协程的线程
+ */
+struct ResumeLog
+{
+    std::mutex                mutex;  ///< 保护ids
+    std::set<std::thread::id> ids;    ///< 恢复过协程的线程
+
+    void record()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.insert(std::this_thread::get_id());
+    }
+};
+
+/**
+ * @brief 读满len字节，对端关闭或出错时返回false
+ */
+static Task<bool> read_full(IoScheduler& io, int fd, char* buf, size_t len)
+{
+    size_t got = 0;
+    while (got < len)
+    {
+        ssize_t n = co_await io.AsyncRead(fd, buf + got, len - got);
+        if (n <= 0) co_return false;
+        got += n;
+    }
+    co_return true;
+}
+
+/**
+ * @brief 把收到的每条消息原样写回，直到对端关闭
+ */
+static Task<int> echo(IoScheduler& io, int fd, ResumeLog& log)
+{
+    char buf[8];
+    int  served = 0;
+    while (co_await read_full(io, fd, buf, sizeof(buf)))
+    {
+        log.record();
+        if (co_await io.AsyncWrite(fd, buf, sizeof(buf)) != sizeof(buf)) break;
+        ++served;
+    }
+    close(fd);
+    co_return served;
+}
+
+/**
+ * @brief 发送rounds条消息并校验回声，每隔一段定时等待一次
+ *
+ * @return 正确往返的次数
+ */
+static Task<int> ping(IoScheduler& io, int fd, int id, int rounds, bool sleep, ResumeLog& log)
+{
+    int ok = 0;
+    for (int r = 0; r < rounds; ++r)
+    {
+        char    out[8], in[8];
+        int64_t message = static_cast<int64_t>(id) << 32 | r;
+        memcpy(out, &message, sizeof(out));
+        if (co_await io.AsyncWrite(fd, out, sizeof(out)) != sizeof(out)) break;
+        if (!co_await read_full(io, fd, in, sizeof(in))) break;
+        log.record();
+        if (memcmp(in, out, sizeof(in)) == 0) ++ok;
+        if (sleep && r % 8 == 7)
+        {
+            co_await io.Sleep(std::chrono::milliseconds(1 + id % 3));
+            log.record();
+        }
+    }
+    close(fd);
+    co_return ok;
+}
+
+/**
+ * @brief 启动pairs对乒乓协程，等待全部结束
+ *
+ * @param peak_threads 输出，等待期间观察到的最大线程数
+ * @return 正确往返的总次数，协程出错时为-1
+ */
+static long run_ping_pong(IoScheduler& io, int pairs, int rounds, bool sleep, ResumeLog& log, int& peak_threads)
+{
+    std::vector<std::future<int>> pings, echoes;
+    for (int p = 0; p < pairs; ++p)
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) return -1;
+        if (IoScheduler::SetNonBlocking(fds[0]) != RC::SUCCESS || IoScheduler::SetNonBlocking(fds[1]) != RC::SUCCESS)
+            return -1;
+        echoes.push_back(io.Spawn(echo(io, fds[1], log)));
+        pings.push_back(io.Spawn(ping(io, fds[0], p, rounds, sleep, log)));
+    }
+
+    peak_threads = thread_count();
+    long total   = 0;
+    for (auto& future : pings)
+    {
+        while (future.wait_for(std::chrono::milliseconds(5)) != std::future_status::ready)
+            peak_threads = std::max(peak_threads, thread_count());
+        total += future.get();
+    }
+    for (auto& future : echoes)
+        if (future.get() != rounds) return -1;
+    return total;
+}
+
+/**
+ * @brief 统计存活的对象数，用于检查协程帧的销毁
+ */
+struct Tracker
+{
+    static std::atomic<int> live;  ///< 存活的对象数
+
+    Tracker() { ++live; }
+    Tracker(const Tracker&) { ++live; }
+    ~Tracker() { --live; }
+};
+
+std::atomic<int> Tracker::live{0};
+
+/**
+ * @brief 协程帧持有tracker的副本，帧销毁时副本随之析构
+ */
+static Task<int> hold(IoScheduler& io, Tracker tracker, int value)
+{
+    (void)tracker;
+    co_await io.Sleep(std::chrono::milliseconds(2));
+    co_await io.Schedule();
+    co_return value;
+}
+
+static Task<void> fail_after_sleep(IoScheduler& io)
+{
+    co_await io.Sleep(std::chrono::milliseconds(1));
+    throw std::runtime_error("expected");
+}
+
+static Task<RC> wait_readable(IoScheduler& io, int fd) { co_return co_await io.Readable(fd); }
+
+/**
+ * @brief 定时等待到deadline，记录醒来的顺序，早于deadline醒来时计入early
+ */
+static Task<void> sleeper(IoScheduler& io, int index, Clock::time_point deadline, std::mutex& mutex,
+                          std::vector<int>& order, std::atomic<int>& early)
+{
+    co_await io.Sleep(deadline - Clock::now());
+    if (Clock::now() < deadline) ++early;
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(index);
+}
+
+static bool check_timers()
+{
+    // 单线程的池按提交顺序恢复协程，醒来的顺序就是反应器发现到期的顺序
+    ThreadPool  pool(1);
+    IoScheduler io(pool);
+
+    const int                      count = 40;
+    std::mutex                     mutex;
+    std::vector<int>               order;
+    std::atomic<int>               early{0};
+    std::vector<std::future<void>> done;
+    Clock::time_point              start = Clock::now() + std::chrono::milliseconds(5);
+    for (int i = count - 1; i >= 0; --i)
+        done.push_back(io.Spawn(sleeper(io, i, start + std::chrono::milliseconds(2 * i), mutex, order, early)));
+    for (auto& future : done) future.get();
+
+    bool ok = check(early == 0, "no timer fires before its deadline");
+    ok &= check(order.size() == static_cast<size_t>(count), "every timer fires");
+    return ok && check(std::is_sorted(order.begin(), order.end()), "timers fire in deadline order");
+}
+
+static bool check_lifetime(IoScheduler& io)
+{
+    std::vector<std::future<int>> values;
+    for (int i = 0; i < 100; ++i) values.push_back(io.Spawn(hold(io, Tracker(), i)));
+    bool ok = true;
+    for (int i = 0; i < 100; ++i) ok &= values[i].get() == i;
+    if (!check(ok, "spawned tasks return their values")) return false;
+
+    // 返回值写入promise之后协程帧才销毁，稍等片刻
+    for (int spin = 0; spin < 1000 && Tracker::live != 0; ++spin)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (!check(Tracker::live == 0, "finished coroutine frames are destroyed")) return false;
+
+    auto failed = io.Spawn(fail_after_sleep(io));
+    try
+    {
+        failed.get();
+        return check(false, "exceptions reach the future");
+    } catch (const std::runtime_error&)
+    {}
+
+    // 普通文件不能加入epoll，等待立即失败而不是永远挂起
+    char path[] = "/tmp/io_scheduler_bench_XXXXXX";
+    int  file   = mkstemp(path);
+    if (file < 0) return false;
+    unlink(path);
+    RC rc = io.Spawn(wait_readable(io, file)).get();
+    close(file);
+    return check(rc == RC::OTHER_RET, "waiting on a regular file fails");
+}
+
+int main(int argc, char** argv)
+{
+    int pairs  = argc > 1 ? atoi(argv[1]) : 256;
+    int rounds = argc > 2 ? atoi(argv[2]) : 200;
+
+    int         baseline = thread_count();
+    ThreadPool  pool(4);
+    IoScheduler io(pool);
+    ResumeLog   log;
+
+    int  peak;
+    long total = run_ping_pong(io, 256, 32, true, log, peak);
+    bool ok    = check(total == 256 * 32, "ping-pong over 256 socketpairs with timers");
+    ok &= check(peak <= baseline + 5, "thread count bounded by the pool and the reactor");
+    ok &= check(pool.Size() == 4, "pool does not grow");
+    ok &= check(!log.ids.count(std::this_thread::get_id()) && log.ids.size() <= 4, "coroutines resume on the pool");
+    ok = ok && check_timers() && check_lifetime(io);
+    if (!ok) return 1;
+    printf("correctness checks passed, peak %d threads with %d in flight\n", peak - baseline, 2 * 256);
+
+    for (int p : {1, 16, pairs})
+    {
+        auto begin   = Clock::now();
+        long trips   = run_ping_pong(io, p, rounds, false, log, peak);
+        auto elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+        if (trips != static_cast<long>(p) * rounds) return 1;
+        printf("%4d pairs  %8ld round trips  %.3f s  %.0f K/s\n", p, trips, elapsed, trips / elapsed / 1000);
+    }
+    return 0;
+}
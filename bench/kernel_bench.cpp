@@ -0,0 +1,218 @@
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <x86intrin.h>
+#include "sql/kernels.h"
+
+/**
+ * @brief 计算内核测试与基准
+ *
+ * 先在含边界值（INT_MIN、INT_MAX、0、NaN、±0.0）的随机数据上校验各指令集实现与标量实现的结果逐位一致，
+ * 再以TSC周期数为单位测量每个内核的吞吐量（行/周期）。
+ */
+
+static const char* level_name(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+static const char* compare_names[] = {"eq", "ne", "lt", "le", "gt", "ge"};
+static const char* arith_names[]   = {"add", "sub", "mul", "div"};
+
+static unsigned int seed = 12345;
+
+static unsigned int next_random()
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static void fill(std::vector<int>& ints, std::vector<float>& floats, std::vector<bool>& flags)
+{
+    static const int   int_edges[]   = {INT_MIN, INT_MAX, 0, -1, 1, 46341, -46341, 65536};
+    static const float float_edges[] = {
+        std::numeric_limits<float>::quiet_NaN(), 0.0f, -0.0f, std::numeric_limits<float>::infinity(), 1.0f};
+    for (std::size_t i = 0; i < ints.size(); ++i)
+    {
+        unsigned int r = next_random();
+        ints[i]        = r % 4 == 0 ? int_edges[r / 4 % 8] : static_cast<int>(r % 2001) - 1000;
+        floats[i]      = r % 5 == 0 ? float_edges[r / 5 % 5] : static_cast<float>(r % 2001) / 8 - 125;
+        flags[i]       = r % 3 == 0;
+    }
+}
+
+/**
+ * @brief 在level上运行所有内核，结果追加到out中
+ */
+static std::vector<uint64_t> run_all(SimdLevel level, const std::vector<int>& a, const std::vector<int>& b,
+    const std::vector<float>& fa, const std::vector<float>& fb, const bool* flags)
+{
+    set_simd_level(level);
+    std::size_t           n     = a.size();
+    std::size_t           words = (n + 63) / 64;
+    std::vector<uint64_t> out;
+    std::vector<uint64_t> bits(words);
+    std::vector<int>      ints(n);
+    std::vector<float>    floats(n);
+
+    auto append_bits = [&] { out.insert(out.end(), bits.begin(), bits.end()); };
+    auto append_ints = [&] { out.insert(out.end(), ints.begin(), ints.end()); };
+    auto append_floats = [&] {
+        for (float f : floats)
+        {
+            uint32_t raw;
+            memcpy(&raw, &f, sizeof(raw));
+            out.push_back(std::isnan(f) ? 0x7FC00000u : raw);
+        }
+    };
+
+    for (int op = 0; op < 6; ++op)
+    {
+        compare(static_cast<CompareOp>(op), a.data(), b.data(), n, bits.data());
+        append_bits();
+        compare(static_cast<CompareOp>(op), a.data(), 7, n, bits.data());
+        append_bits();
+        compare(static_cast<CompareOp>(op), fa.data(), fb.data(), n, bits.data());
+        append_bits();
+        compare(static_cast<CompareOp>(op), fa.data(), 0.0f, n, bits.data());
+        append_bits();
+    }
+    for (int op = 0; op < 4; ++op)
+    {
+        out.push_back(arith(static_cast<ArithOp>(op), a.data(), b.data(), n, ints.data(), bits.data()));
+        append_ints();
+        append_bits();
+        out.push_back(arith(static_cast<ArithOp>(op), a.data(), -1, n, ints.data(), bits.data()));
+        append_ints();
+        append_bits();
+        arith(static_cast<ArithOp>(op), fa.data(), fb.data(), n, floats.data());
+        append_floats();
+        arith(static_cast<ArithOp>(op), fa.data(), 3.0f, n, floats.data());
+        append_floats();
+    }
+
+    std::vector<uint64_t> x(words), y(words);
+    compare(CompareOp::LT, a.data(), 0, n, x.data());
+    bools_to_bitmap(flags, n, y.data());
+    out.insert(out.end(), y.begin(), y.end());
+    bitmap_and(x.data(), y.data(), n, bits.data());
+    append_bits();
+    bitmap_or(x.data(), y.data(), n, bits.data());
+    append_bits();
+    bitmap_not(x.data(), n, bits.data());
+    append_bits();
+    out.push_back(bitmap_count(bits.data(), n));
+
+    std::vector<uint32_t> sel(n);
+    std::size_t           selected = bitmap_to_selection(bits.data(), n, sel.data());
+    out.insert(out.end(), sel.begin(), sel.begin() + selected);
+    return out;
+}
+
+/**
+ * @brief 测量一个内核的吞吐量
+ */
+static double rows_per_cycle(std::size_t rows, int repeat, const std::function<void()>& kernel)
+{
+    kernel();
+    uint64_t begin = __rdtsc();
+    for (int r = 0; r < repeat; ++r) kernel();
+    return static_cast<double>(rows) * repeat / static_cast<double>(__rdtsc() - begin);
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t rows = argc > 1 ? strtoul(argv[1], nullptr, 10) : 4096;
+    int         repeat = argc > 2 ? atoi(argv[2]) : 2000;
+
+    SimdLevel best = detect_simd_level();
+
+    // 长度不是64的倍数，以覆盖尾部处理
+    std::size_t        n = 64 * 37 + 29;
+    std::vector<int>   a(n), b(n);
+    std::vector<float> fa(n), fb(n);
+    std::vector<bool>  flag_bits(n);
+    fill(a, fa, flag_bits);
+    fill(b, fb, flag_bits);
+    std::unique_ptr<bool[]> flags(new bool[n]);
+    for (std::size_t i = 0; i < n; ++i) flags[i] = flag_bits[i];
+
+    std::vector<uint64_t> expected = run_all(SimdLevel::SCALAR, a, b, fa, fb, flags.get());
+    for (int level = 1; level <= static_cast<int>(best); ++level)
+    {
+        if (run_all(static_cast<SimdLevel>(level), a, b, fa, fb, flags.get()) != expected)
+        {
+            fprintf(stderr, "%s results differ from scalar\n", level_name(static_cast<SimdLevel>(level)));
+            return 1;
+        }
+    }
+
+    // 抽查溢出判断
+    int edge_a[] = {INT_MAX, INT_MIN, 46341, -46341, 46340, 5, INT_MIN, 7};
+    int edge_b[] = {1, 1, 46341, 46341, 46340, 0, -1, 2};
+    int result[8];
+    uint64_t overflow;
+    arith(ArithOp::ADD, edge_a, edge_b, 8, result, &overflow);
+    if (overflow != 0x41) return 1;
+    arith(ArithOp::MUL, edge_a, edge_b, 8, result, &overflow);
+    if (overflow != 0x4C) return 1;
+    arith(ArithOp::DIV, edge_a, edge_b, 8, result, &overflow);
+    if (overflow != 0x60 || result[5] != 0 || result[6] != INT_MIN || result[7] != 3) return 1;
+    printf("correctness checks passed, best level %s\n", level_name(best));
+
+    a.resize(rows);
+    b.resize(rows);
+    fa.resize(rows);
+    fb.resize(rows);
+    flag_bits.resize(rows);
+    fill(a, fa, flag_bits);
+    fill(b, fb, flag_bits);
+    std::vector<uint64_t> bits((rows + 63) / 64), other((rows + 63) / 64, 0x5555555555555555ull);
+    std::vector<int>      ints(rows);
+    std::vector<float>    floats(rows);
+
+    printf("%-20s", "rows/cycle");
+    for (int level = 0; level <= static_cast<int>(best); ++level) printf("%10s", level_name(static_cast<SimdLevel>(level)));
+    printf("\n");
+
+    auto report = [&](const char* name, const std::function<void()>& kernel) {
+        printf("%-20s", name);
+        for (int level = 0; level <= static_cast<int>(best); ++level)
+        {
+            set_simd_level(static_cast<SimdLevel>(level));
+            printf("%10.2f", rows_per_cycle(rows, repeat, kernel));
+        }
+        printf("\n");
+    };
+
+    char name[32];
+    for (int op = 0; op < 6; ++op)
+    {
+        snprintf(name, sizeof(name), "int %s const", compare_names[op]);
+        report(name, [&] { compare(static_cast<CompareOp>(op), a.data(), 0, rows, bits.data()); });
+        snprintf(name, sizeof(name), "float %s vector", compare_names[op]);
+        report(name, [&] { compare(static_cast<CompareOp>(op), fa.data(), fb.data(), rows, bits.data()); });
+    }
+    for (int op = 0; op < 4; ++op)
+    {
+        snprintf(name, sizeof(name), "int %s vector", arith_names[op]);
+        report(name, [&] { arith(static_cast<ArithOp>(op), a.data(), b.data(), rows, ints.data(), bits.data()); });
+        snprintf(name, sizeof(name), "float %s const", arith_names[op]);
+        report(name, [&] { arith(static_cast<ArithOp>(op), fa.data(), 3.0f, rows, floats.data()); });
+    }
+    report("bitmap and", [&] { bitmap_and(bits.data(), other.data(), rows, bits.data()); });
+    report("bitmap not", [&] { bitmap_not(bits.data(), rows, bits.data()); });
+    report("bools to bitmap", [&] { bools_to_bitmap(flags.get(), rows < n ? rows : n, bits.data()); });
+    return 0;
+}
@@ -0,0 +1,250 @@
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Trans/number.h"
+#include "ret.h"
+#include "sql/column.h"
+#include "sql/format.h"
+
+/**
+ * @brief 数值格式化与解析测试与基准
+ *
+ * 校验整数、浮点数的格式化结果可以精确解析回原值，非法输入被拒绝，按列格式化与逐个格式化一致；
+ * 再与ostringstream、snprintf比较耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static unsigned int seed = 12345;
+
+static unsigned int next_random()
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static bool check(bool ok, const char* what)
+{
+    if (!ok) fprintf(stderr, "check failed: %s\n", what);
+    return ok;
+}
+
+static float random_float()
+{
+    uint32_t bits = next_random() << 8 ^ next_random();
+    float    value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool check_round_trip()
+{
+    bool ok = true;
+    char buf[MaxBigIntStrLen];
+    RC   rc;
+
+    const int ints[] = {0, -1, 1, 9, 10, INT_MAX, INT_MIN, 1000000000, -999999999};
+    for (int value : ints)
+    {
+        int parsed = 0;
+        Str2Int(buf, Int2Str(value, buf), parsed, rc);
+        ok &= check(rc == RC::SUCCESS && parsed == value, "int round trip");
+    }
+    int64_t big = 0;
+    Str2BigInt(buf, BigInt2Str(std::numeric_limits<int64_t>::min(), buf), big, rc);
+    ok &= check(rc == RC::SUCCESS && big == std::numeric_limits<int64_t>::min(), "bigint round trip");
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        float value = random_float();
+        if (std::isnan(value)) continue;
+        float       parsed = 0;
+        std::size_t len    = Float2Str(value, buf);
+        Str2Float(buf, len, parsed, rc);
+        if (rc != RC::SUCCESS || memcmp(&parsed, &value, sizeof(value)) != 0)
+        {
+            fprintf(stderr, "float %.9g formatted as %.*s\n", value, static_cast<int>(len), buf);
+            return false;
+        }
+        ok &= check(len <= MaxFloatStrLen, "float length");
+    }
+
+    ok &= check(std::string(buf, Float2Str(0.1f, buf)) == "0.1", "shortest 0.1");
+    ok &= check(std::string(buf, Float2Str(3.0f, buf)) == "3", "integral float");
+    ok &= check(std::string(buf, Float2Str(-std::numeric_limits<float>::infinity(), buf)) == "-inf", "-inf");
+    ok &= check(std::string(buf, Float2Str(-1.17549435e-38f, buf)) == "-1.1754944e-38", "denormal boundary");
+
+    const char* bad_ints[] = {"", "+", "-", "+-1", "--1", " 1", "1 ", "1a", "2147483648", "-2147483649", "0x10"};
+    for (const char* str : bad_ints)
+    {
+        int value = 7;
+        Str2Int(str, strlen(str), value, rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT && value == 7, str);
+    }
+    int value = 0;
+    Str2Int("+42", 3, value, rc);
+    ok &= check(rc == RC::SUCCESS && value == 42, "leading plus");
+
+    const char* bad_floats[] = {"", ".", "e5", "1e", "1.5x", "1e999", "+-1"};
+    for (const char* str : bad_floats)
+    {
+        float f = 7;
+        Str2Float(str, strlen(str), f, rc);
+        ok &= check(rc == RC::INVALID_ARGUMENT && f == 7, str);
+    }
+    float f = 0;
+    Str2Float("+2.5e-3", 7, f, rc);
+    ok &= check(rc == RC::SUCCESS && f == 2.5e-3f, "float with exponent");
+    return ok;
+}
+
+/**
+ * @brief 生成一批含NULL的数据
+ */
+static void fill(DataChunk& chunk, std::size_t rows)
+{
+    RC rc;
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        std::vector<Value> row(5);
+        unsigned int       r = next_random();
+        row[0].set_int(static_cast<int>(next_random()) - (1 << 23), rc);
+        row[1].set_float(static_cast<float>(r % 100000) / 7.0f, rc);
+        row[2].set_date(static_cast<int>(r % 30000), rc);
+        row[3].set_str_ref(r % 2 ? "shipped" : "pending", rc);
+        row[4].set_decimal(static_cast<int64_t>(r % 1000000) - 500000, 12, 2, rc);
+        if (r % 11 == 0) row[r % 5] = Value();
+        chunk.append_row(row, rc);
+    }
+}
+
+static bool check_chunk()
+{
+    RC        rc;
+    DataChunk chunk({INTS, FLOATS, DATES, CHARS, DECIMALS}, 500);
+    chunk.column(4).set_decimal_type(12, 2, rc);
+    fill(chunk, 500);
+    for (uint32_t i = 0; i < 200; ++i) chunk.selection().set(i, i * 2 + 1);
+    chunk.selection().set_size(200);
+    chunk.set_has_selection(true);
+
+    std::vector<std::vector<std::string>> rows;
+    format_chunk(chunk, rows);
+    if (!check(rows.size() == 200, "row count")) return false;
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+        std::vector<Value> values;
+        chunk.get_row(i, values, rc);
+        for (std::size_t c = 0; c < values.size(); ++c)
+        {
+            std::string expected;
+            format_value(values[c], expected);
+            if (rows[i][c] != expected) return check(false, "format_chunk matches format_value");
+        }
+    }
+
+    Value       decimal;
+    std::string text;
+    decimal.set_decimal("-0.05", 4, 2, rc);
+    format_value(decimal, text);
+    text += ',';
+    format_value(Value(), text);
+    Value flag(true, rc);
+    text += ',';
+    format_value(flag, text);
+    return check(text == "-0.05,NULL,true", "format_value");
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t rows = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    if (!check_round_trip() || !check_chunk()) return 1;
+    printf("correctness checks passed\n");
+
+    std::vector<int>   ints(rows);
+    std::vector<float> floats(rows);
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        ints[i]   = static_cast<int>(next_random()) - (1 << 23);
+        floats[i] = static_cast<float>(next_random() % 1000000) / 7.0f;
+    }
+
+    std::size_t checksum = 0;
+    auto        report   = [&](const char* name, const std::function<void()>& body) {
+        auto begin = Clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / rows;
+        printf("%-24s %.2f ns/value\n", name, ns);
+    };
+
+    std::vector<char>        buf(rows * MaxFloatStrLen);
+    std::vector<std::size_t> offsets(rows + 1);
+    report("Ints2Strs", [&] { checksum += Ints2Strs(ints.data(), rows, buf.data(), offsets.data()); });
+    report("int snprintf", [&] {
+        for (std::size_t i = 0; i < rows; ++i) checksum += snprintf(buf.data(), 16, "%d", ints[i]);
+    });
+    report("int ostringstream", [&] {
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            std::ostringstream os;
+            os << ints[i];
+            checksum += os.str().size();
+        }
+    });
+    report("Floats2Strs", [&] { checksum += Floats2Strs(floats.data(), rows, buf.data(), offsets.data()); });
+    report("float snprintf %.9g", [&] {
+        for (std::size_t i = 0; i < rows; ++i) checksum += snprintf(buf.data(), 32, "%.9g", floats[i]);
+    });
+    report("float ostringstream", [&] {
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            std::ostringstream os;
+            os.precision(9);
+            os << floats[i];
+            checksum += os.str().size();
+        }
+    });
+    report("Str2Int", [&] {
+        Ints2Strs(ints.data(), rows, buf.data(), offsets.data());
+        RC rc;
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            int value;
+            Str2Int(buf.data() + offsets[i], offsets[i + 1] - offsets[i], value, rc);
+            checksum += value;
+        }
+    });
+    report("Str2Float", [&] {
+        Floats2Strs(floats.data(), rows, buf.data(), offsets.data());
+        RC rc;
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            float value;
+            Str2Float(buf.data() + offsets[i], offsets[i + 1] - offsets[i], value, rc);
+            checksum += static_cast<std::size_t>(value);
+        }
+    });
+
+    RC        rc;
+    DataChunk chunk({INTS, FLOATS, DATES, CHARS, DECIMALS});
+    chunk.column(4).set_decimal_type(12, 2, rc);
+    fill(chunk, VectorCapacity);
+    std::vector<std::vector<std::string>> table;
+    rows = VectorCapacity * 5;
+    report("format_chunk per cell", [&] {
+        table.clear();
+        format_chunk(chunk, table);
+        checksum += table.size();
+    });
+    printf("checksum %zu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Thread/ThreadPool.h"
+#include "bench_util.h"
+#include "ret.h"
+#include "sql/sort_key.h"
+#include "storage/bplus_builder.h"
+
+/**
+ * @brief B+树乐观锁耦合测试与基准
+ *
+ * 在帧数很少的缓冲池上以std::set为参照校验乐观锁耦合模式的插入、重复键、跨叶子的查找与删除，
+ * 再让多个线程并发插入删除查找、与遍历和批量构建并发后校验结果；
+ * 最后对比锁耦合与乐观锁耦合在只读、读多写少与读写混合负载下1到64个线程的吞吐。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 缓冲池只有32帧，树远大于缓冲池，乐观读者经常遇到被淘汰复用的帧
+ */
+static bool check_basic(BufferPool& pool)
+{
+    RC        rc;
+    BPlusTree tree(pool, pool.disk().open_file("basic", rc), LatchMode::OPTIMISTIC, rc);
+    if (!check(rc == RC::SUCCESS && tree.latch_mode() == LatchMode::OPTIMISTIC, "create tree")) return false;
+
+    // 每个键最多40个值，同一个键的值跨越多个叶子
+    std::set<Entry> expected;
+    for (int i = 0; i < 30000; ++i)
+    {
+        int64_t  k     = next_random() % 2000;
+        uint64_t value = next_random() % 40;
+        bool     fresh = expected.emplace(int_key(k), value).second;
+        tree.insert(bytes(int_key(k)), 9, value, rc);
+        if (!check(fresh == (rc == RC::SUCCESS), "insert reports duplicates")) return false;
+    }
+    bool ok = check(tree.height() > 2 && tree.stats().splits > 0, "tree grows");
+    ok &= check(same_as(tree, expected), "full scan after inserts");
+
+    for (int64_t k = 0; k < 2000; ++k)
+    {
+        std::string           key = int_key(k);
+        std::vector<uint64_t> values{7};
+        tree.lookup(bytes(key), key.size(), values, rc);
+        std::vector<uint64_t> want{7};
+        for (auto it = expected.lower_bound({key, 0}); it != expected.end() && it->first == key; ++it)
+            want.push_back(it->second);
+        if (!check(rc == RC::SUCCESS && values == want, "lookup appends every value in order")) return false;
+    }
+
+    std::vector<Entry> all(expected.begin(), expected.end());
+    for (std::size_t i = all.size(); i > 1; --i) std::swap(all[i - 1], all[next_random() % i]);
+    for (std::size_t i = 0; i < all.size(); i += 2)
+    {
+        tree.remove(bytes(all[i].first), all[i].first.size(), all[i].second, rc);
+        if (!check(rc == RC::SUCCESS, "remove existing entry")) return false;
+        expected.erase(all[i]);
+    }
+    tree.remove(bytes(all[0].first), all[0].first.size(), all[0].second, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "remove missing entry");
+    ok &= check(tree.stats().merges == 0, "optimistic removes do not merge");
+    return ok && check(same_as(tree, expected), "full scan after removes");
+}
+
+static bool check_concurrent(BufferPool& pool)
+{
+    RC        rc;
+    file_id_t file = pool.disk().open_file("concurrent", rc);
+    BPlusTree tree(pool, file, LatchMode::OPTIMISTIC, rc);
+
+    // 每个线程插入自己的一组键，删除其中的奇数键并查找偶数键；另一个线程同时反复遍历
+    const int                threads = 8, per_thread = 4000;
+    std::vector<std::thread> workers;
+    std::atomic<int>         failures{0};
+    std::atomic<bool>        done{false};
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            RC trc;
+            for (int i = 0; i < per_thread; ++i)
+            {
+                tree.insert(bytes(int_key(i * threads + t)), 9, t, trc);
+                if (trc != RC::SUCCESS) ++failures;
+            }
+            for (int i = 1; i < per_thread; i += 2)
+            {
+                tree.remove(bytes(int_key(i * threads + t)), 9, t, trc);
+                if (trc != RC::SUCCESS) ++failures;
+                std::vector<uint64_t> values;
+                tree.lookup(bytes(int_key((i - 1) * threads + t)), 9, values, trc);
+                if (values.size() != 1 || values[0] != static_cast<uint64_t>(t)) ++failures;
+            }
+        });
+    std::thread scanner([&] {
+        while (!done.load())
+        {
+            RC          trc;
+            std::string last;
+            for (BPlusTreeIterator it = tree.begin(trc); it.valid(); it.next(trc))
+            {
+                std::string key(reinterpret_cast<const char*>(it.key()), it.key_len());
+                if (key <= last) ++failures;
+                last = std::move(key);
+            }
+        }
+    });
+    for (auto& worker : workers) worker.join();
+    done = true;
+    scanner.join();
+
+    std::set<Entry> expected;
+    for (int t = 0; t < threads; ++t)
+        for (int i = 0; i < per_thread; i += 2) expected.emplace(int_key(i * threads + t), t);
+    return check(failures == 0 && same_as(tree, expected), "concurrent inserts, removes, lookups and scans");
+}
+
+/**
+ * @brief 批量构建期间的乐观查找要么找不到，要么看到完整的结果
+ */
+static bool check_bulk_load(BufferPool& pool)
+{
+    RC         rc;
+    ThreadPool threads(2);
+    BPlusTree  tree(pool, pool.disk().open_file("bulk", rc), LatchMode::OPTIMISTIC, rc);
+
+    KeyEncoder            encoder({{0, BIGINTS, false, true, 0}});
+    SortKeyBuffer         keys;
+    std::vector<Value>    row(1);
+    std::vector<uint64_t> values;
+    for (int64_t k = 0; k < 20000; ++k)
+    {
+        row[0].set_bigint(k / 2, rc);
+        encoder.encode(row, keys, rc);
+        values.push_back(k % 2);
+    }
+    std::atomic<bool> done{false};
+    std::atomic<int>  failures{0};
+    std::thread       reader([&] {
+        std::string key = int_key(7777);
+        while (!done.load())
+        {
+            RC                    trc;
+            std::vector<uint64_t> found;
+            tree.lookup(bytes(key), key.size(), found, trc);
+            if (trc != RC::SUCCESS || (!found.empty() && found != std::vector<uint64_t>{0, 1})) ++failures;
+        }
+    });
+    bulk_load(tree, keys, values, 0.8, threads, rc);
+    done = true;
+    reader.join();
+
+    bool ok = rc == RC::SUCCESS && failures == 0;
+    for (int64_t k = 0; ok && k < 10000; k += 97)
+    {
+        std::vector<uint64_t> found;
+        tree.lookup(bytes(int_key(k)), 9, found, rc);
+        ok = found == std::vector<uint64_t>{0, 1};
+    }
+    return check(ok, "lookups during and after bulk load");
+}
+
+/**
+ * @brief 负载：lookups%的点查，其余一半插入新键、一半删除本线程插入过的键
+ */
+struct Workload
+{
+    const char* name;     ///< 名称
+    unsigned    lookups;  ///< 点查占比，百分数
+};
+
+static void run(BPlusTree& tree, const std::vector<std::string>& loaded, const Workload& workload, std::size_t ops)
+{
+    std::atomic<int64_t> next_key{static_cast<int64_t>(loaded.size())};
+    for (unsigned int threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u})
+    {
+        BPlusTreeStats           before = tree.stats();
+        std::vector<std::thread> workers;
+        auto                     begin = Clock::now();
+        for (unsigned int t = 0; t < threads; ++t)
+            workers.emplace_back([&, t] {
+                unsigned int          state = t * 7919 + 1;
+                RC                    trc;
+                std::vector<uint64_t> values;
+                std::vector<int64_t>  inserted;
+                for (std::size_t i = 0; i < ops / threads; ++i)
+                {
+                    state             = state * 1103515245u + 12345u;
+                    unsigned int pick = (state >> 8) % 100;
+                    if (pick >= workload.lookups)
+                    {
+                        if (pick % 2 == 0 || inserted.empty())
+                        {
+                            inserted.push_back(next_key.fetch_add(1) * 2 + 1);
+                            tree.insert(bytes(int_key(inserted.back())), 9, 0, trc);
+                        }
+                        else
+                        {
+                            tree.remove(bytes(int_key(inserted.back())), 9, 0, trc);
+                            inserted.pop_back();
+                        }
+                        continue;
+                    }
+                    values.clear();
+                    tree.lookup(bytes(loaded[(state >> 8) % loaded.size()]), 9, values, trc);
+                }
+            });
+        for (auto& worker : workers) worker.join();
+        double         seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        BPlusTreeStats after   = tree.stats();
+        printf("  %-10s %2u threads  %.2f Mops/s  (restarts %llu)\n", workload.name, threads, ops / seconds / 1e6,
+            static_cast<unsigned long long>(after.restarts - before.restarts));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t ops = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 19;
+
+    TempDir tmp("olc_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    RC          rc;
+    DiskManager small_pages(dir + "/small", 512, 64, rc);
+    bool        ok;
+    {
+        BufferPool pool(small_pages, 32, ReplacerKind::CLOCK, rc);
+        ok = check_basic(pool) && check_concurrent(pool) && check_bulk_load(pool);
+    }
+    if (!ok) return 1;
+    printf("correctness checks passed\n");
+
+    DiskManager disk(dir + "/bench", 4096, 64, rc);
+    BufferPool  pool(disk, 16384, ReplacerKind::CLOCK, rc);
+    const int                preload = 1 << 18;
+    std::vector<std::string> loaded(preload);
+    for (int64_t k = 0; k < preload; ++k) loaded[k] = int_key(k * 2);
+
+    const Workload workloads[] = {{"read-only", 100}, {"read-heavy", 95}, {"mixed", 50}};
+    for (LatchMode mode : {LatchMode::CRABBING, LatchMode::OPTIMISTIC})
+    {
+        BPlusTree tree(pool, disk.open_file(mode == LatchMode::CRABBING ? "crabbing" : "optimistic", rc), mode, rc);
+        for (int64_t k = 0; k < preload; ++k) tree.insert(bytes(loaded[k]), 9, k, rc);
+        printf("%s, preloaded %d keys, height %u\n", mode == LatchMode::CRABBING ? "latch crabbing" : "optimistic",
+            preload, tree.height());
+        for (const Workload& workload : workloads) run(tree, loaded, workload, ops);
+    }
+
+    return 0;
+}
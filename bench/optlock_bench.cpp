@@ -0,0 +1,192 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "Thread/OptLock.h"
+#include "Thread/ReWrLock.h"
+
+/**
+ * @brief 乐观版本锁测试与基准
+ *
+ * 先做功能检查，再以多线程读写一对必须保持相等的计数验证乐观读的一致性，
+ * 最后在不同读写比例下与ReWrLock对比读吞吐量并统计乐观读的重试率。
+ */
+
+/**
+ * @brief 受保护的数据：写者保证a == b
+ */
+struct Pair
+{
+    std::atomic<long> a{0};
+    std::atomic<long> b{0};
+};
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "%s\n", msg);
+    return 1;
+}
+
+static int functional_checks()
+{
+    OptLock  lock;
+    uint64_t v;
+    if (!lock.read_begin(v) || !lock.validate(v)) return fail("read on idle lock should validate");
+
+    uint64_t stale = v;
+    if (!lock.upgrade(v)) return fail("upgrade with current version should succeed");
+    if (!lock.is_locked()) return fail("lock should be exclusive after upgrade");
+    if (lock.try_lock()) return fail("try_lock should fail while exclusive");
+    lock.unlock();
+    if (lock.validate(stale)) return fail("validate should fail after a write");
+    if (lock.upgrade(stale)) return fail("upgrade with stale version should fail");
+
+    if (!lock.lock()) return fail("lock should succeed");
+    lock.unlock_obsolete();
+    if (!lock.is_obsolete() || lock.is_locked()) return fail("lock should be obsolete and unlocked");
+    if (lock.read_begin(v)) return fail("read_begin should report obsolete lock");
+    if (lock.lock()) return fail("lock should fail on obsolete lock");
+    return 0;
+}
+
+static int consistency_check(unsigned int threads)
+{
+    OptLock           lock;
+    Pair              data;
+    std::atomic<bool> stop{false};
+    std::atomic<long> torn{0};
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            for (long i = 0; !stop.load(std::memory_order_relaxed); ++i)
+            {
+                if (t == 0 && i % 8 == 0)
+                {
+                    lock.lock();
+                    data.a.store(data.a.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    data.b.store(data.b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    lock.unlock();
+                    continue;
+                }
+                while (true)
+                {
+                    uint64_t v;
+                    if (!lock.read_begin(v)) continue;
+                    long a = data.a.load(std::memory_order_relaxed);
+                    long b = data.b.load(std::memory_order_relaxed);
+                    if (!lock.validate(v)) continue;
+                    if (a != b) ++torn;
+                    break;
+                }
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stop = true;
+    for (auto& w : workers) w.join();
+    return torn.load() == 0 ? 0 : fail("optimistic read observed a torn write");
+}
+
+int main(int argc, char** argv)
+{
+    std::chrono::milliseconds duration(argc > 1 ? atoi(argv[1]) : 200);
+    unsigned int              max_threads = std::max(2u, std::thread::hardware_concurrency());
+
+    if (functional_checks() || consistency_check(max_threads)) return 1;
+    printf("functional checks passed\n");
+
+    printf("%-8s %-8s %-18s %-18s %-18s\n",
+        "threads",
+        "write%",
+        "OptLock reads/s",
+        "OptLock restart%",
+        "ReWrLock reads/s");
+    for (int write_percent : {0, 1, 10})
+    {
+        for (unsigned int threads = 1; threads <= max_threads; threads *= 2)
+        {
+            OptLock  opt;
+            ReWrLock rw;
+            Pair     data;
+            double   results[2];
+            long     restarts = 0, reads = 0;
+
+            for (int kind = 0; kind < 2; ++kind)
+            {
+                std::atomic<bool> stop{false};
+                std::atomic<long> total_reads{0}, total_restarts{0};
+
+                std::vector<std::thread> workers;
+                for (unsigned int t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&, t] {
+                        unsigned int seed        = 2654435761u * (t + 1);
+                        long         local_reads = 0, local_restarts = 0;
+                        while (!stop.load(std::memory_order_relaxed))
+                        {
+                            seed = seed * 1103515245u + 12345u;
+                            bool is_write = int((seed >> 16) % 100) < write_percent;
+                            if (kind == 0 && is_write)
+                            {
+                                opt.lock();
+                                data.a.fetch_add(1, std::memory_order_relaxed);
+                                data.b.fetch_add(1, std::memory_order_relaxed);
+                                opt.unlock();
+                            }
+                            else if (kind == 0)
+                            {
+                                while (true)
+                                {
+                                    uint64_t v;
+                                    opt.read_begin(v);
+                                    volatile long a = data.a.load(std::memory_order_relaxed);
+                                    (void)a;
+                                    if (opt.validate(v)) break;
+                                    ++local_restarts;
+                                }
+                                ++local_reads;
+                            }
+                            else if (is_write)
+                            {
+                                auto guard = rw.write();
+                                data.a.fetch_add(1, std::memory_order_relaxed);
+                                data.b.fetch_add(1, std::memory_order_relaxed);
+                            }
+                            else
+                            {
+                                auto          guard = rw.read();
+                                volatile long a     = data.a.load(std::memory_order_relaxed);
+                                (void)a;
+                                ++local_reads;
+                            }
+                        }
+                        total_reads += local_reads;
+                        total_restarts += local_restarts;
+                    });
+                }
+                std::this_thread::sleep_for(duration);
+                stop = true;
+                for (auto& w : workers) w.join();
+
+                results[kind] = total_reads.load() / (duration.count() / 1000.0);
+                if (kind == 0)
+                {
+                    reads    = total_reads.load();
+                    restarts = total_restarts.load();
+                }
+            }
+
+            printf("%-8u %-8d %-18.0f %-18.3f %-18.0f\n",
+                threads,
+                write_percent,
+                results[0],
+                reads ? 100.0 * restarts / reads : 0.0,
+                results[1]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Thread/ThreadPool.h"
+#include "bench_util.h"
+#include "ret.h"
+#include "sql/sort_key.h"
+#include "storage/bplus_tree.h"
+
+/**
+ * @brief B+树并行范围扫描测试与基准
+ *
+ * 按日期建索引（每天若干行），校验切分点有序且落在区间内、各分段有序且互不重叠、
+ * 并行扫描的有序结果与单线程遍历一致；再测量三个月的日期区间在不同线程数下的扫描耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 把2024年的日期编码为DATES排序键
+ */
+static std::vector<uint8_t> date_key(int month, int day)
+{
+    static const KeyEncoder encoder({{0, DATES, false, true, 0}});
+    char                    text[32];
+    snprintf(text, sizeof(text), "2024-%02d-%02d", month, day);
+    RC            rc;
+    SortKeyBuffer keys;
+    encoder.encode({Value(text, 1, rc)}, keys, rc);
+    return std::vector<uint8_t>(keys.key(0), keys.key(0) + keys.length(0));
+}
+
+static const int DaysInMonth[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+/**
+ * @brief 单线程遍历[lo, hi)
+ */
+static std::vector<uint64_t> serial_scan(
+    BPlusTree& tree, const std::vector<uint8_t>& lo, const std::vector<uint8_t>* hi)
+{
+    RC                    rc;
+    std::vector<uint64_t> values;
+    for (BPlusTreeIterator it = tree.lower_bound(lo.data(), lo.size(), rc); it.valid(); it.next(rc))
+    {
+        if (hi && compare_key(it.key(), it.key_len(), 0, hi->data(), hi->size(), 0) >= 0) break;
+        values.push_back(it.value());
+    }
+    return values;
+}
+
+static bool check_range(BPlusTree& tree, ThreadPool& threads, const std::vector<uint8_t>& lo,
+    const std::vector<uint8_t>* hi, const char* what)
+{
+    RC                                rc;
+    std::vector<std::vector<uint8_t>> bounds;
+    tree.split_range(lo.data(), lo.size(), hi ? hi->data() : nullptr, hi ? hi->size() : 0, threads.Size(), bounds, rc);
+    bool ok = rc == RC::SUCCESS && bounds.size() < threads.Size();
+    for (std::size_t i = 0; i < bounds.size(); ++i)
+    {
+        ok &= lo.empty() || compare_key(lo.data(), lo.size(), 0, bounds[i].data(), bounds[i].size(), 0) < 0;
+        ok &= !hi || compare_key(bounds[i].data(), bounds[i].size(), 0, hi->data(), hi->size(), 0) < 0;
+        ok &= i == 0 || bounds[i - 1] < bounds[i];
+    }
+    if (!check(ok, what)) return false;
+
+    // 每个分段内有序，且第i段的最大键小于第i + 1段的最小键
+    std::vector<std::vector<std::vector<uint8_t>>> parts(threads.Size());
+    std::mutex                                     mutex;
+    std::size_t                                    visited = 0;
+    tree.parallel_scan(lo.data(), lo.size(), hi ? hi->data() : nullptr, hi ? hi->size() : 0, threads,
+        [&](std::size_t part, const uint8_t* key, std::size_t len, uint64_t) {
+            if (parts[part].empty() || parts[part].back() != std::vector<uint8_t>(key, key + len))
+                parts[part].emplace_back(key, key + len);
+            std::lock_guard<std::mutex> lock(mutex);
+            ++visited;
+        },
+        rc);
+    std::vector<std::vector<uint8_t>> keys;
+    for (auto& part : parts) keys.insert(keys.end(), part.begin(), part.end());
+    for (std::size_t i = 1; i < keys.size(); ++i) ok &= keys[i - 1] < keys[i];
+
+    std::vector<uint64_t> expected = serial_scan(tree, lo, hi);
+    std::vector<uint64_t> values;
+    tree.scan_range(lo.data(), lo.size(), hi ? hi->data() : nullptr, hi ? hi->size() : 0, threads, values, rc);
+    return check(ok && rc == RC::SUCCESS && visited == expected.size() && values == expected, what);
+}
+
+int main(int argc, char** argv)
+{
+    int rows_per_day = argc > 1 ? atoi(argv[1]) : 2000;
+
+    TempDir tmp("range_scan_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    RC          rc;
+    DiskManager disk(dir, 4096, 256, rc);
+    BufferPool  pool(disk, 1024, ReplacerKind::LRU_K, rc);
+    BPlusTree   tree(pool, disk.open_file("orders_date", rc), rc);
+
+    // 按行号顺序插入，日期与行号无关，模拟按插入顺序追加的订单表
+    const int                         days = 366;
+    std::vector<std::vector<uint8_t>> dates;
+    for (int month = 1; month <= 12; ++month)
+        for (int day = 1; day <= DaysInMonth[month - 1]; ++day) dates.push_back(date_key(month, day));
+    for (uint64_t row = 0; row < static_cast<uint64_t>(days) * rows_per_day; ++row)
+    {
+        const std::vector<uint8_t>& key = dates[row * 7919 % days];
+        tree.insert(key.data(), key.size(), row, rc);
+    }
+    printf("indexed %d rows, height %u\n", days * rows_per_day, tree.height());
+
+    std::vector<uint8_t> empty;
+    std::vector<uint8_t> march    = date_key(3, 1);
+    std::vector<uint8_t> april    = date_key(4, 1);
+    std::vector<uint8_t> day      = date_key(6, 15);
+    std::vector<uint8_t> next_day = date_key(6, 16);
+    bool                 ok       = true;
+    for (unsigned int n : {1u, 3u, 8u})
+    {
+        ThreadPool threads(n);
+        ok &= check_range(tree, threads, march, &april, "one month");
+        ok &= check_range(tree, threads, empty, nullptr, "whole index");
+        ok &= check_range(tree, threads, day, &next_day, "one day");
+        ok &= check_range(tree, threads, april, &march, "empty range");
+        ok &= check_range(tree, threads, april, nullptr, "open upper bound");
+    }
+    if (!ok) return 1;
+    printf("correctness checks passed\n");
+
+    // 三个月的区间大于缓冲池，扫描过程中叶子不断被淘汰，预读让未命中的读取落在页缓存上
+    std::vector<uint8_t> july = date_key(7, 1);
+    auto                 begin = Clock::now();
+    std::size_t          count = serial_scan(tree, april, &july).size();
+    double               ms    = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    printf("serial scan           %zu rows  %.2f ms\n", count, ms);
+    for (unsigned int n : {1u, 2u, 4u, 8u, 16u})
+    {
+        ThreadPool            threads(n);
+        std::vector<uint64_t> values;
+        pool.reset_stats();
+        begin = Clock::now();
+        tree.scan_range(april.data(), april.size(), july.data(), july.size(), threads, values, rc);
+        ms                    = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+        BufferPoolStats stats = pool.stats();
+        printf("scan_range %2u threads %zu rows  %.2f ms  (misses %llu, prefetches %llu)\n", n, values.size(), ms,
+            static_cast<unsigned long long>(stats.misses), static_cast<unsigned long long>(stats.prefetches));
+    }
+
+    return 0;
+}
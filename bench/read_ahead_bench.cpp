@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "bench_util.h"
+#include "ret.h"
+#include "storage/async_io.h"
+#include "storage/buffer_pool.h"
+#include "storage/heap_file.h"
+
+/**
+ * @brief io_uring异步读与预读测试与基准
+ *
+ * 校验异步读引擎（超出队列深度的批量、读到文件末尾补0、不可用时的同步退化）读到的内容正确，
+ * 缓冲池的read_ahead把页读入帧、之后的取页全部命中，顺序访问被检测并按窗口预读而随机访问不触发预读，
+ * 多线程并发的顺序扫描与预读下页面内容正确，带预读的堆文件扫描与不带预读的结果一致，
+ * 以及预读进行中析构缓冲池是安全的；
+ * 最后在冷缓存下对比同步逐页读与异步预读的顺序扫描、逐页随机读与每次同时请求64页的随机读的耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 用页号填充一页（跳过页首8字节的页面LSN），便于校验
+ */
+static void fill_page(char* buf, std::size_t page_size, page_no_t page)
+{
+    memset(buf, 0, 8);
+    for (std::size_t i = 8; i < page_size; i += sizeof(page)) memcpy(buf + i, &page, sizeof(page));
+}
+
+static bool page_is(const char* buf, std::size_t page_size, page_no_t page)
+{
+    for (std::size_t i = 8; i < page_size; i += sizeof(page))
+        if (memcmp(buf + i, &page, sizeof(page)) != 0) return false;
+    return true;
+}
+
+/**
+ * @brief 在文件中写入pages个按页号填充的页
+ */
+static void create_pages(DiskManager& disk, file_id_t file, page_no_t pages)
+{
+    RC                rc;
+    std::vector<char> buf(disk.page_size());
+    for (page_no_t i = 0; i < pages; ++i)
+    {
+        page_no_t page = disk.allocate_page(file, rc);
+        fill_page(buf.data(), buf.size(), page);
+        disk.write_page({file, page}, buf.data(), rc);
+    }
+    disk.sync(file, rc);
+}
+
+/**
+ * @brief 把数据文件移出页缓存，之后的读都要访问磁盘
+ */
+static void drop_cache(const std::string& dir, const std::string& name)
+{
+    int fd = open((dir + "/" + name + ".db").c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static bool check_engine(const std::string& dir, unsigned int depth)
+{
+    const std::size_t len = 4096, blocks = 300;
+    std::string       path = dir + "/engine" + std::to_string(depth);
+    int               fd   = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    std::vector<char> block(len);
+    for (page_no_t i = 0; i < blocks; ++i)
+    {
+        fill_page(block.data(), len, i);
+        if (pwrite(fd, block.data(), len, static_cast<off_t>(i) * len) != static_cast<ssize_t>(len)) return false;
+    }
+    // 最后一块只写一半，之后的读越过文件末尾
+    if (ftruncate(fd, blocks * len - len / 2) != 0) return false;
+
+    std::vector<char>        out(2 * blocks * len);
+    std::vector<RC>          results(2 * blocks, RC::INVALID_ARGUMENT);
+    std::atomic<std::size_t> done{0};
+    std::vector<AsyncRead>   reads;
+    {
+        AsyncIo aio(depth);
+        if (depth) printf("io_uring %s\n", aio.uring() ? "available" : "unavailable, reads fall back to pread");
+        for (std::size_t i = 0; i < 2 * blocks; ++i)
+        {
+            std::size_t block = i % blocks;
+            reads.push_back({fd, out.data() + i * len, len, static_cast<off_t>(block * len), [&, i](RC rc) {
+                                 results[i] = rc;
+                                 ++done;
+                             }});
+        }
+        aio.submit(reads);
+        // 析构时等待全部请求完成
+    }
+    close(fd);
+
+    bool ok = check(done == 2 * blocks, "every callback runs once");
+    for (std::size_t i = 0; i < 2 * blocks && ok; ++i)
+    {
+        std::size_t block = i % blocks;
+        const char* buf   = out.data() + i * len;
+        ok &= check(results[i] == RC::SUCCESS, "read succeeds");
+        if (block + 1 < blocks)
+            ok &= check(page_is(buf, len, static_cast<page_no_t>(block)), "read the right block");
+        else
+        {
+            std::vector<char> expect(len);
+            fill_page(expect.data(), len, static_cast<page_no_t>(block));
+            memset(expect.data() + len / 2, 0, len / 2);
+            ok &= check(memcmp(buf + 8, expect.data() + 8, len - 8) == 0, "zero fill past the end of file");
+        }
+    }
+    return ok;
+}
+
+static bool check_read_ahead(DiskManager& disk)
+{
+    RC         rc;
+    file_id_t  file = disk.open_file("ahead", rc);
+    create_pages(disk, file, 2000);
+    BufferPool pool(disk, 256, ReplacerKind::CLOCK, rc);
+
+    // 显式预读：一次最多占四分之一的帧
+    pool.read_ahead({file, 1}, 100, rc);
+    bool ok = check(rc == RC::SUCCESS && pool.stats().prefetches == 64, "read ahead at most a quarter of the frames");
+    pool.read_ahead({file, 1990}, 100, rc);
+    ok &= check(pool.stats().prefetches == 64 + 11, "read ahead stops at the end of file");
+    for (page_no_t page = 1; page <= 64; ++page)
+    {
+        PageGuard guard = pool.fetch_page({file, page}, rc);
+        ok &= check(rc == RC::SUCCESS && page_is(guard.data(), disk.page_size(), page), "read ahead content");
+    }
+    ok &= check(pool.stats().misses == 0, "pages read ahead are hits");
+
+    // 顺序访问：预读窗口从4页加倍到32页，之后大部分取页命中
+    pool.set_read_ahead(32);
+    pool.reset_stats();
+    for (page_no_t page = 100; page < 2000; ++page)
+    {
+        PageGuard guard = pool.fetch_page({file, page}, rc);
+        ok &= check(rc == RC::SUCCESS && page_is(guard.data(), disk.page_size(), page), "sequential scan content");
+        if (!ok) return false;
+    }
+    BufferPoolStats stats = pool.stats();
+    printf("sequential scan of 1900 pages: %llu misses, %llu pages read ahead\n",
+        static_cast<unsigned long long>(stats.misses), static_cast<unsigned long long>(stats.prefetches));
+    ok &= check(stats.misses < 20, "sequential misses trigger read ahead");
+
+    // 随机访问不触发预读
+    pool.reset_stats();
+    for (int i = 0; i < 500; ++i)
+    {
+        page_no_t page  = next_random() % 1999 + 1;
+        PageGuard guard = pool.fetch_page({file, page}, rc);
+        ok &= check(rc == RC::SUCCESS && page_is(guard.data(), disk.page_size(), page), "random access content");
+    }
+    ok &= check(pool.stats().prefetches < 50, "random access does not read ahead");
+
+    // 并发的顺序扫描：同一页可能同时被预读、命中与淘汰
+    std::atomic<int>         failures{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t)
+        workers.emplace_back([&, t] {
+            RC trc;
+            for (int round = 0; round < 3; ++round)
+                for (page_no_t page = 1 + t * 300; page < 2000; ++page)
+                {
+                    PageGuard guard = pool.fetch_page({file, page}, trc);
+                    if (trc != RC::SUCCESS || !page_is(guard.data(), disk.page_size(), page)) ++failures;
+                    if (page % 97 == 0) pool.read_ahead({file, page + 50}, 16, trc);
+                }
+        });
+    for (auto& worker : workers) worker.join();
+    ok &= check(failures == 0, "concurrent scans with read ahead");
+
+    // 预读进行中析构缓冲池
+    {
+        BufferPool other(disk, 64, ReplacerKind::LRU_K, rc);
+        other.read_ahead({file, 1}, 16, rc);
+    }
+    return ok;
+}
+
+/**
+ * @brief 扫描堆文件，返回记录数与记录长度之和
+ */
+static std::pair<std::size_t, std::size_t> scan(HeapFile& heap)
+{
+    RC          rc;
+    std::size_t count = 0, bytes = 0;
+    for (HeapIterator it = heap.begin(rc); it.valid(); it.next(rc))
+    {
+        ++count;
+        bytes += it.length();
+    }
+    return {count, bytes};
+}
+
+static bool check_heap_scan(DiskManager& disk)
+{
+    RC        rc;
+    file_id_t file = disk.open_file("heap", rc);
+    {
+        BufferPool pool(disk, 256, ReplacerKind::CLOCK, rc);
+        HeapFile   heap(pool, file, rc);
+        for (int i = 0; i < 20000; ++i)
+        {
+            std::string record(next_random() % 200 + 20, static_cast<char>('a' + i % 26));
+            heap.insert(record.data(), record.size(), rc);
+        }
+    }
+    BufferPool plain_pool(disk, 128, ReplacerKind::CLOCK, rc);
+    HeapFile   plain(plain_pool, file, rc);
+    auto       expect = scan(plain);
+
+    BufferPool pool(disk, 128, ReplacerKind::CLOCK, rc);
+    pool.set_read_ahead(16);
+    HeapFile heap(pool, file, rc);
+    auto     got = scan(heap);
+    bool     ok  = check(expect.first == 20000 && got == expect, "heap scan with read ahead");
+    return ok && check(pool.stats().prefetches > 0 && pool.stats().misses < 10, "heap scan requests pages ahead");
+}
+
+/**
+ * @brief 冷缓存下用fetch逐页取pages中的页，返回耗时（毫秒）
+ */
+template <class Fetch>
+static double timed(const std::string& dir, const std::string& name, Fetch fetch)
+{
+    drop_cache(dir, name);
+    auto begin = Clock::now();
+    fetch();
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    page_no_t pages = argc > 1 ? strtoul(argv[1], nullptr, 10) : 16384;
+
+    TempDir tmp("read_ahead_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    RC          rc;
+    DiskManager disk(dir, 4096, 256, rc);
+    disk.start_async_io(128);
+    bool ok = check_engine(dir, 0) && check_engine(dir, 64) && check_read_ahead(disk) && check_heap_scan(disk);
+    if (!ok) return 1;
+    printf("correctness checks passed\n");
+
+    DiskManager sync_disk(dir, 4096, 256, rc);
+    file_id_t   file = disk.open_file("bench", rc);
+    create_pages(disk, file, pages);
+    disk.close_file(file, rc);
+    file = sync_disk.open_file("bench", rc);
+
+    // 顺序扫描：同步逐页读；异步顺序预读；扫描提前请求之后的页
+    double sync_ms = timed(dir, "bench", [&] {
+        BufferPool pool(sync_disk, 1024, ReplacerKind::CLOCK, rc);
+        for (page_no_t page = 1; page <= pages; ++page) pool.fetch_page({file, page}, rc);
+    });
+    sync_disk.close_file(file, rc);
+    file = disk.open_file("bench", rc);
+
+    for (std::size_t window : {16, 64, 256})
+    {
+        AsyncIoStats before = disk.async_stats();
+        double       ms     = timed(dir, "bench", [&] {
+            BufferPool pool(disk, 1024, ReplacerKind::CLOCK, rc);
+            pool.set_read_ahead(window);
+            for (page_no_t page = 1; page <= pages; ++page) pool.fetch_page({file, page}, rc);
+        });
+        AsyncIoStats after   = disk.async_stats();
+        double       per     = static_cast<double>(after.submitted - before.submitted) /
+                         std::max<uint64_t>(1, after.batches - before.batches);
+        printf("sequential scan %u pages  sync %.1f ms  read ahead %3zu pages %.1f ms (%.1fx, %.1f reads/submit)\n",
+            pages, sync_ms, window, ms, sync_ms / ms, per);
+    }
+
+    // 随机读：逐页同步读与每次同时请求64页，64个读同时在进行
+    std::vector<page_no_t> order(pages / 4);
+    for (page_no_t& page : order) page = next_random() % pages + 1;
+    disk.close_file(file, rc);
+    file          = sync_disk.open_file("bench", rc);
+    double one_ms = timed(dir, "bench", [&] {
+        BufferPool pool(sync_disk, 8192, ReplacerKind::CLOCK, rc);
+        for (page_no_t page : order) pool.fetch_page({file, page}, rc);
+    });
+    sync_disk.close_file(file, rc);
+    file            = disk.open_file("bench", rc);
+    double batch_ms = timed(dir, "bench", [&] {
+        BufferPool pool(disk, 8192, ReplacerKind::CLOCK, rc);
+        for (std::size_t i = 0; i < order.size(); i += 64)
+        {
+            std::size_t end = std::min(order.size(), i + 64);
+            for (std::size_t j = i; j < end; ++j) pool.read_ahead({file, order[j]}, 1, rc);
+            for (std::size_t j = i; j < end; ++j) pool.fetch_page({file, order[j]}, rc);
+        }
+    });
+    printf("random reads %zu pages  one at a time %.1f ms  batches of 64 %.1f ms (%.1fx)\n", order.size(), one_ms,
+        batch_ms, one_ms / batch_ms);
+
+    return 0;
+}
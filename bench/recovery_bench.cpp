@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "Thread/ThreadPool.h"
+#include "bench_util.h"
+#include "ret.h"
+#include "storage/bplus_tree.h"
+#include "storage/heap_file.h"
+#include "storage/recovery.h"
+
+/**
+ * @brief 崩溃恢复测试与基准
+ *
+ * 在子进程中执行事务后直接_exit模拟崩溃：缓冲池中的脏页与日志缓冲区中未落盘的记录全部丢失，
+ * 已写回的页面留在操作系统缓存中。父进程恢复后与只含已提交事务的参照结果比较。
+ * 依次校验：运行时回滚、检查点与淘汰写回交错时未提交事务被撤销、恢复后再次崩溃仍能恢复；
+ * 堆文件与B+树索引记日志的插入、改写与删除在运行时回滚与崩溃恢复后只留下已提交的行；
+ * 多个线程提交事务的同时反复做检查点，对比有无检查点时的事务吞吐，并校验日志被截断；
+ * 最后在一半页面已写回的大量修改上对比1到8个线程并行重做的耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static const std::size_t               PageSize = 4096;
+static const std::size_t               Slots    = 64;  ///< 每页的8字节槽数，从页内偏移8开始
+static const std::chrono::microseconds NoDelay{0};
+
+static unsigned int next_random(unsigned int& seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+/**
+ * @brief 一个数据文件、日志、缓冲池与恢复管理器
+ */
+struct Db
+{
+    RC              disk_rc, log_rc, pool_rc, file_rc;
+    DiskManager     disk;
+    LogManager      log;
+    BufferPool      pool;
+    RecoveryManager recovery;
+    file_id_t       file;
+
+    Db(const std::string& dir, std::size_t frames)
+        : disk(dir + "/data", PageSize, 256, disk_rc),
+          log(dir + "/wal", 1 << 20, 1 << 20, NoDelay, log_rc),
+          pool(disk, frames, ReplacerKind::CLOCK, pool_rc),
+          recovery(pool, log),
+          file(disk.open_file("t", file_rc))
+    {
+    }
+
+    bool ok() const
+    {
+        return disk_rc == RC::SUCCESS && log_rc == RC::SUCCESS && pool_rc == RC::SUCCESS && file_rc == RC::SUCCESS;
+    }
+};
+
+/**
+ * @brief 分配pages个数据页并落盘，之后的修改都记日志
+ */
+static bool create_pages(Db& db, std::size_t pages)
+{
+    RC rc;
+    for (std::size_t i = 0; i < pages; ++i)
+        if (db.pool.new_page(db.file, rc), FAIL(rc)) return false;
+    db.pool.flush_all(rc);
+    if (FAIL(rc)) return false;
+    db.disk.sync_all(rc);
+    return SUCC(rc);
+}
+
+static void write_slot(Db& db, Transaction& txn, std::size_t slot, uint64_t value, RC& rc)
+{
+    PageGuard page = db.pool.fetch_page({db.file, static_cast<page_no_t>(1 + slot / Slots)}, rc);
+    if (FAIL(rc)) return;
+    WriteGuard guard = page.latch().write();
+    db.recovery.update(txn, page, 8 + slot % Slots * 8, reinterpret_cast<const char*>(&value), sizeof(value), rc);
+}
+
+/**
+ * @brief 全部槽的内容与model一致
+ */
+static bool same_as(Db& db, const std::vector<uint64_t>& model)
+{
+    RC rc;
+    for (std::size_t slot = 0; slot < model.size(); ++slot)
+    {
+        PageGuard page = db.pool.fetch_page({db.file, static_cast<page_no_t>(1 + slot / Slots)}, rc);
+        if (FAIL(rc)) return false;
+        uint64_t value;
+        memcpy(&value, page.data() + 8 + slot % Slots * 8, sizeof(value));
+        if (value != model[slot]) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 在子进程中执行work，返回其是否以0退出
+ *
+ * work结束后子进程直接_exit，work中要“崩溃”的对象须用new创建、不释放，它们的析构函数不会执行。
+ */
+template <class Work>
+static bool in_child(Work work)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        int code = work() ? 0 : 1;
+        fflush(stdout);
+        fflush(stderr);
+        _exit(code);
+    }
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * @brief 单线程工作负载中的一个事务
+ */
+struct TxnPlan
+{
+    enum Outcome
+    {
+        COMMIT,
+        ABORT,
+        IN_FLIGHT
+    };
+    std::vector<std::pair<std::size_t, uint64_t>> writes;      ///< 槽与写入的值
+    Outcome                                       outcome;     ///< 结局
+    bool                                          checkpoint;  ///< 结束后做一次检查点
+};
+
+/**
+ * @brief 单线程工作负载：约15%的事务回滚，每500个事务做一次检查点，最后几个事务崩溃时仍未提交
+ */
+static std::vector<TxnPlan> make_plan(std::size_t slots, std::size_t txns, std::size_t in_flight)
+{
+    unsigned int          seed = 777;
+    std::vector<TxnPlan>  plan(txns + in_flight);
+    std::set<std::size_t> taken;
+    for (std::size_t i = 0; i < plan.size(); ++i)
+    {
+        TxnPlan& txn   = plan[i];
+        txn.outcome    = next_random(seed) % 100 < 15 ? TxnPlan::ABORT : TxnPlan::COMMIT;
+        txn.checkpoint = i % 500 == 499;
+        if (i >= txns) txn.outcome = TxnPlan::IN_FLIGHT;
+        for (unsigned int w = 0, n = 1 + next_random(seed) % 4; w < n; ++w)
+        {
+            // 未提交的事务之间不修改同一个槽
+            std::size_t slot = next_random(seed) % slots;
+            if (txn.outcome == TxnPlan::IN_FLIGHT && !taken.insert(slot).second) continue;
+            txn.writes.emplace_back(slot, static_cast<uint64_t>(i) << 8 | w);
+        }
+    }
+    return plan;
+}
+
+static std::vector<uint64_t> committed_state(const std::vector<TxnPlan>& plan, std::size_t slots)
+{
+    std::vector<uint64_t> model(slots, 0);
+    for (const TxnPlan& txn : plan)
+        if (txn.outcome == TxnPlan::COMMIT)
+            for (auto& [slot, value] : txn.writes) model[slot] = value;
+    return model;
+}
+
+static bool check_crash(const std::string& dir)
+{
+    // 64个页只有16帧，页面不断被淘汰写回，写回前须先落盘日志
+    const std::size_t    pages = 64, slots = pages * Slots, in_flight = 3;
+    std::vector<TxnPlan> plan  = make_plan(slots, 3000, in_flight);
+    bool                 ok    = in_child([&] {
+        Db& db = *new Db(dir, 16);
+        if (!db.ok() || !create_pages(db, pages)) return false;
+        RC rc;
+        for (const TxnPlan& txn_plan : plan)
+        {
+            Transaction* txn = db.recovery.begin();
+            for (auto& [slot, value] : txn_plan.writes)
+                if (write_slot(db, *txn, slot, value, rc), FAIL(rc)) return false;
+            if (txn_plan.outcome == TxnPlan::COMMIT) db.recovery.commit(txn, rc);
+            if (txn_plan.outcome == TxnPlan::ABORT) db.recovery.abort(txn, rc);
+            if (FAIL(rc)) return false;
+            if (txn_plan.checkpoint) db.recovery.checkpoint(rc);
+            if (FAIL(rc)) return false;
+        }
+        // 未提交事务的修改写回数据文件：写回前它们的记录先落盘，恢复时须撤销
+        db.pool.flush_all(rc);
+        return SUCC(rc) && db.recovery.active() == in_flight;
+    });
+    if (!check(ok, "run transactions and crash")) return false;
+
+    // 恢复后立刻再次崩溃：恢复写下的CLR与检查点足以让下一次恢复得到同样的结果
+    std::vector<uint64_t> model = committed_state(plan, slots);
+    ok                          = in_child([&] {
+        Db&        db = *new Db(dir, 16);
+        ThreadPool workers(4);
+        RC         rc;
+        db.recovery.recover(workers, rc);
+        RecoveryStats stats = db.recovery.stats();
+        return db.ok() && SUCC(rc) && stats.losers == in_flight && stats.undone > 0 && stats.checkpoints == 1 &&
+               same_as(db, model);
+    });
+    if (!check(ok, "recover, undo in-flight transactions, crash again")) return false;
+
+    Db         db(dir, 16);
+    ThreadPool workers(4);
+    RC         rc;
+    db.recovery.recover(workers, rc);
+    RecoveryStats stats = db.recovery.stats();
+    ok                  = check(db.ok() && SUCC(rc) && stats.losers == 0, "second recovery finds no losers");
+    ok &= check(same_as(db, model), "only committed transactions survive");
+
+    // 恢复后继续运行：事务编号不与崩溃前的重复，回滚照常
+    Transaction* txn = db.recovery.begin();
+    ok &= check(txn->id > plan.size(), "transaction ids continue after recovery");
+    write_slot(db, *txn, 0, 12345, rc);
+    db.recovery.abort(txn, rc);
+    return ok && check(SUCC(rc) && same_as(db, model), "abort after recovery");
+}
+
+/**
+ * @brief 表事务中的一个操作：插入、改写或删除第row行，行存于堆文件，索引键为行号
+ */
+struct RowOp
+{
+    enum Kind
+    {
+        INSERT,
+        UPDATE,
+        REMOVE
+    };
+    Kind        kind;  ///< 操作
+    uint64_t    row;   ///< 行号
+    std::string data;  ///< 插入与改写的内容
+};
+
+struct TableTxn
+{
+    std::vector<RowOp> ops;      ///< 依次执行的操作
+    TxnPlan::Outcome   outcome;  ///< 结局
+};
+
+/**
+ * @brief 表工作负载：约20%的事务回滚，最后一个事务崩溃时仍未提交
+ *
+ * 回滚与未提交的事务写得多，撤销覆盖堆文件的记录搬动与B+树的节点分裂；第一个事务在空树上插入足够多的行，
+ * 回滚时撤销根节点分裂。
+ */
+static std::vector<TableTxn> make_table_plan(std::size_t txns)
+{
+    unsigned int          seed = 31337;
+    std::vector<TableTxn> plan(txns + 1);
+    std::vector<uint64_t> rows;
+    uint64_t              next_row = 0;
+    for (std::size_t i = 0; i < plan.size(); ++i)
+    {
+        TableTxn& txn = plan[i];
+        txn.outcome   = next_random(seed) % 100 < 20 || i == 0 ? TxnPlan::ABORT : TxnPlan::COMMIT;
+        if (i == txns) txn.outcome = TxnPlan::IN_FLIGHT;
+        std::vector<uint64_t> live  = rows;
+        unsigned int          limit = txn.outcome == TxnPlan::COMMIT ? 16 : 160;
+        unsigned int          n     = i == 0 ? 600 : 1 + next_random(seed) % limit;
+        for (unsigned int op = 0; op < n; ++op)
+        {
+            unsigned int choice = next_random(seed) % 10;
+            std::string  data(20 + next_random(seed) % 600, '\0');
+            unsigned int tag = next_random(seed);
+            for (std::size_t c = 0; c < data.size(); ++c) data[c] = static_cast<char>('a' + (tag + c) % 26);
+            if (live.empty() || choice < 5)
+            {
+                txn.ops.push_back({RowOp::INSERT, next_row, data});
+                live.push_back(next_row++);
+                continue;
+            }
+            std::size_t index = next_random(seed) % live.size();
+            if (choice < 8)
+                txn.ops.push_back({RowOp::UPDATE, live[index], data});
+            else
+            {
+                txn.ops.push_back({RowOp::REMOVE, live[index], {}});
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+        if (txn.outcome == TxnPlan::COMMIT) rows = live;
+    }
+    return plan;
+}
+
+static std::map<uint64_t, std::string> committed_rows(const std::vector<TableTxn>& plan)
+{
+    std::map<uint64_t, std::string> model;
+    for (const TableTxn& txn : plan)
+    {
+        if (txn.outcome != TxnPlan::COMMIT) continue;
+        for (const RowOp& op : txn.ops)
+        {
+            if (op.kind == RowOp::REMOVE)
+                model.erase(op.row);
+            else
+                model[op.row] = op.data;
+        }
+    }
+    return model;
+}
+
+/**
+ * @brief 行号的大端编码，索引按行号排序
+ */
+static void row_key(uint64_t row, uint8_t* key)
+{
+    for (int i = 7; i >= 0; --i, row >>= 8) key[i] = static_cast<uint8_t>(row);
+}
+
+static uint64_t pack(RecordId rid) { return static_cast<uint64_t>(rid.page) << 16 | rid.slot; }
+
+/**
+ * @brief 在一个事务中执行txn_plan，提交时把行的RecordId写回rids，运行时回滚后重新载入B+树
+ */
+static bool run_table_txn(
+    Db& db, HeapFile& heap, BPlusTree& tree, const TableTxn& txn_plan, std::map<uint64_t, RecordId>& rids)
+{
+    RC                           rc;
+    Transaction*                 txn   = db.recovery.begin();
+    std::map<uint64_t, RecordId> local = rids;
+    for (const RowOp& op : txn_plan.ops)
+    {
+        uint8_t key[8];
+        row_key(op.row, key);
+        if (op.kind == RowOp::INSERT)
+        {
+            RecordId rid = heap.insert(txn, op.data.data(), op.data.size(), rc);
+            if (SUCC(rc)) tree.insert(txn, key, sizeof(key), pack(rid), rc);
+            local[op.row] = rid;
+        }
+        else if (op.kind == RowOp::UPDATE)
+            heap.update(txn, local[op.row], op.data.data(), op.data.size(), rc);
+        else
+        {
+            heap.remove(txn, local[op.row], rc);
+            if (SUCC(rc)) tree.remove(txn, key, sizeof(key), pack(local[op.row]), rc);
+            local.erase(op.row);
+        }
+        if (FAIL(rc)) return false;
+    }
+    if (txn_plan.outcome == TxnPlan::COMMIT)
+    {
+        db.recovery.commit(txn, rc);
+        rids.swap(local);
+    }
+    if (txn_plan.outcome == TxnPlan::ABORT)
+    {
+        db.recovery.abort(txn, rc);
+        if (SUCC(rc)) tree.reload(rc);
+    }
+    return SUCC(rc);
+}
+
+/**
+ * @brief 索引的条目与堆文件的记录都恰好是model中的行
+ */
+static bool same_table(HeapFile& heap, BPlusTree& tree, const std::map<uint64_t, std::string>& model)
+{
+    RC                rc;
+    std::vector<char> record;
+    std::size_t       entries = 0;
+    for (BPlusTreeIterator it = tree.begin(rc); it.valid(); it.next(rc), ++entries)
+    {
+        uint64_t row = 0;
+        for (std::size_t i = 0; i < it.key_len(); ++i) row = row << 8 | it.key()[i];
+        auto found = model.find(row);
+        if (it.key_len() != 8 || found == model.end()) return false;
+        heap.get({static_cast<page_no_t>(it.value() >> 16), static_cast<uint16_t>(it.value())}, record, rc);
+        if (FAIL(rc) || std::string(record.begin(), record.end()) != found->second) return false;
+    }
+    if (FAIL(rc) || entries != model.size()) return false;
+    std::size_t records = 0;
+    for (HeapIterator it = heap.begin(rc); it.valid(); it.next(rc)) ++records;
+    return SUCC(rc) && records == model.size();
+}
+
+static bool check_table_crash(const std::string& dir, LatchMode mode)
+{
+    // 16帧放不下堆文件与索引，页面不断被淘汰写回
+    std::vector<TableTxn>           plan  = make_table_plan(400);
+    std::map<uint64_t, std::string> model = committed_rows(plan);
+    bool                            ok    = in_child([&] {
+        Db&       db         = *new Db(dir, 16);
+        RC        rc         = RC::SUCCESS;
+        file_id_t heap_file  = db.disk.open_file("heap", rc);
+        file_id_t index_file = SUCC(rc) ? db.disk.open_file("index", rc) : 0;
+        if (!db.ok() || FAIL(rc)) return false;
+        HeapFile& heap = *new HeapFile(db.pool, heap_file, rc);
+        if (FAIL(rc)) return false;
+        BPlusTree& tree = *new BPlusTree(db.pool, index_file, mode, rc);
+        if (FAIL(rc)) return false;
+        // 新建的文件先写回，之后的修改都记日志
+        db.pool.flush_all(rc);
+        if (FAIL(rc)) return false;
+
+        std::map<uint64_t, RecordId> rids;
+        for (std::size_t i = 0; i + 1 < plan.size(); ++i)
+            if (!check(run_table_txn(db, heap, tree, plan[i], rids), "run table transactions")) return false;
+        if (!check(same_table(heap, tree, model), "runtime aborts restore the heap and the index")) return false;
+
+        // 未提交事务的修改全部写回数据文件，恢复时须撤销
+        if (!run_table_txn(db, heap, tree, plan.back(), rids)) return false;
+        db.pool.flush_all(rc);
+        return SUCC(rc);
+    });
+    if (!check(ok, "modify a heap file and an index, crash")) return false;
+
+    Db         db(dir, 16);
+    RC         heap_rc, index_rc, rc;
+    file_id_t  heap_file  = db.disk.open_file("heap", heap_rc);
+    file_id_t  index_file = db.disk.open_file("index", index_rc);
+    ThreadPool workers(4);
+    db.recovery.recover(workers, rc);
+    ok = check(db.ok() && SUCC(heap_rc) && SUCC(index_rc) && SUCC(rc) && db.recovery.stats().losers == 1,
+        "recover the heap file and the index");
+    HeapFile heap(db.pool, heap_file, rc);
+    if (!check(ok && SUCC(rc), "reopen the heap file")) return false;
+    BPlusTree tree(db.pool, index_file, mode, rc);
+    if (!check(SUCC(rc), "reopen the index")) return false;
+    ok = check(same_table(heap, tree, model), "heap file and index hold only committed rows");
+
+    // 恢复后继续记日志地修改
+    TableTxn more{{}, TxnPlan::COMMIT};
+    for (uint64_t row = 1000000; row < 1000200; ++row)
+    {
+        more.ops.push_back({RowOp::INSERT, row, std::string(100, 'x')});
+        model[row] = std::string(100, 'x');
+    }
+    std::map<uint64_t, RecordId> rids;
+    ok &= check(run_table_txn(db, heap, tree, more, rids), "insert after recovery");
+    return ok && check(same_table(heap, tree, model), "heap file and index after recovery");
+}
+
+/**
+ * @brief 第thread个线程的第seq个事务写入的槽与值，线程只写slot % threads == thread的槽
+ */
+static std::vector<std::pair<std::size_t, uint64_t>> thread_writes(
+    unsigned int thread, unsigned int threads, std::size_t seq, std::size_t slots)
+{
+    unsigned int seed = static_cast<unsigned int>(thread * 1000003u + seq * 7919u + 1);
+    std::vector<std::pair<std::size_t, uint64_t>> writes;
+    for (unsigned int w = 0; w < 4; ++w)
+    {
+        std::size_t slot = next_random(seed) % (slots / threads) * threads + thread;
+        writes.emplace_back(slot, static_cast<uint64_t>(thread) << 48 | seq << 8 | w);
+    }
+    return writes;
+}
+
+static bool check_fuzzy_checkpoint(const std::string& dir, std::size_t txns)
+{
+    const unsigned int threads = 8;
+    const std::size_t  pages = 256, slots = pages * Slots;
+    bool               ok = in_child([&] {
+        Db&         db      = *new Db(dir, 128);
+        ThreadPool& flusher = *new ThreadPool(1);
+        if (!db.ok() || !create_pages(db, pages)) return false;
+        db.log.start_flusher(flusher);
+
+        std::atomic<int> failures{0};
+        auto             phase = [&](std::size_t from, bool checkpoints) {
+            std::atomic<bool>        done{false};
+            std::atomic<int>         taken{0};
+            std::vector<std::thread> workers;
+            auto                     begin = Clock::now();
+            for (unsigned int t = 0; t < threads; ++t)
+                workers.emplace_back([&, t] {
+                    RC rc;
+                    for (std::size_t seq = from; seq < from + txns; ++seq)
+                    {
+                        Transaction* txn = db.recovery.begin();
+                        for (auto& [slot, value] : thread_writes(t, threads, seq, slots))
+                            write_slot(db, *txn, slot, value, rc);
+                        db.recovery.commit(txn, rc);
+                        if (FAIL(rc)) ++failures;
+                    }
+                });
+            std::thread checkpointer([&] {
+                RC rc;
+                while (checkpoints && !done)
+                {
+                    db.recovery.checkpoint(rc);
+                    if (FAIL(rc)) ++failures;
+                    ++taken;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+            });
+            for (auto& worker : workers) worker.join();
+            double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+            done           = true;
+            checkpointer.join();
+            printf("%-26s %8.0f txn/s  %3d checkpoints\n", checkpoints ? "commits with checkpoints" : "commits alone",
+                threads * txns / seconds, taken.load());
+        };
+        lsn_t begin = db.log.begin_lsn();
+        phase(0, false);
+        phase(txns, true);
+
+        // 每个线程最后一个事务崩溃时未提交，它们的记录随别的提交落盘
+        RC rc;
+        for (unsigned int t = 0; t < threads; ++t)
+        {
+            Transaction* txn = db.recovery.begin();
+            for (auto& [slot, value] : thread_writes(t, threads, 2 * txns, slots))
+                write_slot(db, *txn, slot, value, rc);
+        }
+        db.log.flush(db.log.end_lsn(), rc);
+        return failures == 0 && SUCC(rc) && db.log.begin_lsn() > begin;
+    });
+    if (!check(ok, "commit while checkpointing, truncate the log, crash")) return false;
+
+    std::vector<uint64_t> model(slots, 0);
+    for (unsigned int t = 0; t < threads; ++t)
+        for (std::size_t seq = 0; seq < 2 * txns; ++seq)
+            for (auto& [slot, value] : thread_writes(t, threads, seq, slots)) model[slot] = value;
+    Db         db(dir, 128);
+    ThreadPool workers(4);
+    RC         rc;
+    db.recovery.recover(workers, rc);
+    return check(db.ok() && SUCC(rc) && db.recovery.stats().losers == threads && same_as(db, model),
+        "recover from a fuzzy checkpoint");
+}
+
+static bool bench_redo(const std::string& dir, std::size_t updates)
+{
+    // 16384页（64MB），缓冲池放得下全部页面，崩溃前写回偶数页：这些页的修改在重做时按页面LSN跳过
+    const std::size_t pages = 16384, slots = pages * Slots, per_txn = 100;
+    unsigned int      seed  = 4242;
+    std::vector<std::pair<std::size_t, uint64_t>> writes(updates);
+    std::vector<uint64_t>                         model(slots, 0);
+    for (std::size_t i = 0; i < updates; ++i)
+    {
+        writes[i] = {next_random(seed) % slots, i + 1};
+        model[writes[i].first] = i + 1;
+    }
+    bool ok = in_child([&] {
+        Db& db = *new Db(dir + "/base", pages * 2);
+        if (!db.ok() || !create_pages(db, pages)) return false;
+        RC rc;
+        for (std::size_t i = 0; i < updates; i += per_txn)
+        {
+            Transaction* txn = db.recovery.begin();
+            for (std::size_t j = i; j < std::min(updates, i + per_txn); ++j)
+                write_slot(db, *txn, writes[j].first, writes[j].second, rc);
+            db.recovery.commit(txn, rc);
+            if (FAIL(rc)) return false;
+        }
+        for (page_no_t page = 2; page <= pages; page += 2) db.pool.flush_page({db.file, page}, rc);
+        return SUCC(rc);
+    });
+    if (!check(ok, "write updates and crash")) return false;
+
+    for (unsigned int threads : {1u, 2u, 4u, 8u})
+    {
+        std::string copy = dir + "/redo" + std::to_string(threads);
+        std::filesystem::copy(dir + "/base", copy, std::filesystem::copy_options::recursive);
+        Db         db(copy, pages * 2);
+        ThreadPool workers(threads);
+        RC         rc;
+        auto       begin = Clock::now();
+        db.recovery.recover(workers, rc);
+        double        total = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+        RecoveryStats stats = db.recovery.stats();
+        if (!check(SUCC(rc) && stats.redo_applied < stats.redo_checked && same_as(db, model), "parallel redo"))
+            return false;
+        printf("redo %u threads  analysis %6.1f ms  redo %7.1f ms  total %7.1f ms  %llu/%llu records applied\n",
+            threads, stats.analysis_ms, stats.redo_ms, total, static_cast<unsigned long long>(stats.redo_applied),
+            static_cast<unsigned long long>(stats.redo_checked));
+        std::filesystem::remove_all(copy);
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t updates = argc > 1 ? strtoul(argv[1], nullptr, 10) : 400000;
+
+    TempDir tmp("recovery_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    bool ok = check_crash(dir + "/crash") && check_table_crash(dir + "/crabbing", LatchMode::CRABBING) &&
+              check_table_crash(dir + "/optimistic", LatchMode::OPTIMISTIC);
+    if (ok) printf("correctness checks passed\n");
+    ok = ok && check_fuzzy_checkpoint(dir + "/fuzzy", 500) && bench_redo(dir + "/redo", updates);
+    return ok ? 0 : 1;
+}
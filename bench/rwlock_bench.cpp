@@ -0,0 +1,182 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "Thread/ReWrLock.h"
+#include "Thread/BRLock.h"
+#include "ret.h"
+
+/**
+ * @brief 读写锁争用基准测试
+ *
+ * 每个线程按给定比例执行读/写临界区，统计总吞吐量与写者获取锁的最大等待时间，
+ * 与std::shared_mutex和BRLock对比。写者最大等待时间反映读者持续涌入时写者是否被饿死。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult
+{
+    double ops_per_sec;     ///< 每秒完成的临界区数
+    double max_write_wait;  ///< 写者获取锁的最大等待时间（微秒）
+};
+
+/**
+ * @brief 对一种锁运行一轮测试
+ *
+ * @tparam Read 获取读锁并执行临界区的函数
+ * @tparam Write 获取写锁并执行临界区的函数
+ */
+template <class Read, class Write>
+BenchResult run(int threads, int write_percent, std::chrono::milliseconds duration, Read read, Write write)
+{
+    std::atomic<bool>        stop{false};
+    std::atomic<long>        ops{0};
+    std::atomic<long>        max_wait{0};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            unsigned int seed  = 2654435761u * (t + 1);
+            long         local = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                seed = seed * 1103515245u + 12345u;
+                if (int((seed >> 16) % 100) < write_percent)
+                {
+                    auto begin = Clock::now();
+                    write([&] {
+                        long wait = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count();
+                        long prev = max_wait.load(std::memory_order_relaxed);
+                        while (wait > prev && !max_wait.compare_exchange_weak(prev, wait)) {}
+                    });
+                }
+                else
+                    read();
+                ++local;
+            }
+            ops += local;
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& w : workers) w.join();
+
+    return {ops.load() / (duration.count() / 1000.0), double(max_wait.load())};
+}
+
+int main(int argc, char** argv)
+{
+    std::chrono::milliseconds duration(argc > 1 ? atoi(argv[1]) : 200);
+    unsigned int              max_threads = std::max(2u, std::thread::hardware_concurrency());
+
+    long shared_data = 0;
+
+    printf("%-8s %-8s %-18s %-18s %-18s %-18s %-18s %-18s\n",
+        "threads",
+        "write%",
+        "ReWrLock ops/s",
+        "ReWrLock maxwait",
+        "shared_mutex ops/s",
+        "shared_mutex maxwait",
+        "BRLock ops/s",
+        "BRLock maxwait");
+
+    for (int write_percent : {0, 1, 10, 50})
+    {
+        for (unsigned int threads = 1; threads <= max_threads; threads *= 2)
+        {
+            ReWrLock rw;
+            auto     rw_result = run(
+                threads,
+                write_percent,
+                duration,
+                [&] {
+                    auto guard = rw.read();
+                    volatile long v = shared_data;
+                    (void)v;
+                },
+                [&](auto&& on_acquired) {
+                    auto guard = rw.write();
+                    on_acquired();
+                    ++shared_data;
+                });
+
+            std::shared_mutex sm;
+            auto              sm_result = run(
+                threads,
+                write_percent,
+                duration,
+                [&] {
+                    std::shared_lock<std::shared_mutex> guard(sm);
+                    volatile long v = shared_data;
+                    (void)v;
+                },
+                [&](auto&& on_acquired) {
+                    std::unique_lock<std::shared_mutex> guard(sm);
+                    on_acquired();
+                    ++shared_data;
+                });
+
+            BRLock br;
+            auto   br_result = run(
+                threads,
+                write_percent,
+                duration,
+                [&] {
+                    auto guard = br.read();
+                    volatile long v = shared_data;
+                    (void)v;
+                },
+                [&](auto&& on_acquired) {
+                    auto guard = br.write();
+                    on_acquired();
+                    ++shared_data;
+                });
+
+            printf("%-8u %-8d %-18.0f %-18.0f %-18.0f %-18.0f %-18.0f %-18.0f\n",
+                threads,
+                write_percent,
+                rw_result.ops_per_sec,
+                rw_result.max_write_wait,
+                sm_result.ops_per_sec,
+                sm_result.max_write_wait,
+                br_result.ops_per_sec,
+                br_result.max_write_wait);
+        }
+    }
+
+    // 功能检查：try/限时获取与升级
+    ReWrLock lock;
+    RC       rc;
+    {
+        auto reader = lock.read();
+        auto writer = lock.try_write(rc);
+        if (rc != RC::LOCKED || writer.owns()) return fprintf(stderr, "try_write should fail under reader\n"), 1;
+        auto timed = lock.write_for(std::chrono::microseconds(1000), rc);
+        if (rc != RC::LOCKED || timed.owns()) return fprintf(stderr, "write_for should time out\n"), 1;
+        auto again = lock.try_read(rc);
+        if (rc != RC::SUCCESS || !again.owns()) return fprintf(stderr, "try_read should succeed after timeout\n"), 1;
+    }
+    {
+        auto upgradable = lock.upgradable_read();
+        auto reader     = lock.try_read(rc);
+        if (rc != RC::SUCCESS) return fprintf(stderr, "readers should coexist with upgrader\n"), 1;
+        std::thread release([r = std::move(reader)]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            ReadGuard done(std::move(r));
+        });
+        auto writer = upgradable.upgrade();
+        release.join();
+        if (!writer.owns() || upgradable.owns()) return fprintf(stderr, "upgrade failed\n"), 1;
+        lock.try_read(rc);
+        if (rc != RC::LOCKED) return fprintf(stderr, "try_read should fail under upgraded writer\n"), 1;
+    }
+    printf("functional checks passed\n");
+    return 0;
+}
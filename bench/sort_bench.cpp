@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+#include "ret.h"
+#include "sql/column.h"
+#include "sql/dictionary.h"
+#include "sql/sort_key.h"
+
+/**
+ * @brief 规范化排序键测试与基准
+ *
+ * 在含NULL、负数、±0.0、空串与内嵌'\0'的多类型数据上，校验基数排序与前缀排序的结果
+ * 与按Value逐列比较的稳定排序完全一致，再比较三者的耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static const std::vector<AttrType> Types = {INTS, FLOATS, CHARS, DATES, BOOLEANS, BIGINTS, DECIMALS};
+
+static unsigned int seed = 12345;
+
+static unsigned int next_random()
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static bool check(bool ok, const char* what)
+{
+    if (!ok) fprintf(stderr, "check failed: %s\n", what);
+    return ok;
+}
+
+/**
+ * @brief 生成一批数据，取值范围很小以制造大量相等的键
+ */
+static void fill(DataChunk& chunk, std::size_t rows)
+{
+    static const char* strings[] = {"", "a", "ab", "abc", "b", "ba", "abcdefghij", "abcdefghik", "zz"};
+    static const float floats[]  = {-1.5f, -0.0f, 0.0f, 0.25f, 3.0f, -1e30f, std::numeric_limits<float>::infinity()};
+
+    RC rc;
+    chunk.column(6).set_decimal_type(10, 2, rc);
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        std::vector<Value> row(Types.size());
+        unsigned int       r = next_random();
+        row[0].set_int(static_cast<int>(r % 7) - 3 + (r % 50 == 0 ? INT32_MIN / 2 : 0), rc);
+        row[1].set_float(floats[r / 7 % 7], rc);
+        if (r / 49 % 5 == 0)
+        {
+            // 内嵌'\0'的字符串
+            char buf[4] = {'a', '\0', static_cast<char>('a' + r % 3), 0};
+            row[2].set_str(buf, 2 + r / 3 % 2, chunk.column<CHARS>(2).heap(), rc);
+        }
+        else
+            row[2].set_str_ref(strings[r / 49 % 9], rc);
+        row[3].set_date(20240101 + static_cast<int>(r % 3), rc);
+        row[4].set_bool(r % 2, rc);
+        row[5].set_bigint(static_cast<int64_t>(r % 5) * 3000000000LL - 6000000000LL, rc);
+        row[6].set_decimal(static_cast<int64_t>(r % 9) - 4, 10, 2, rc);
+        for (std::size_t c = 0; c < row.size(); ++c)
+            if (next_random() % 6 == 0) row[c] = Value();
+        chunk.append_row(row, rc);
+        if (rc != RC::SUCCESS) return;
+    }
+}
+
+/**
+ * @brief 按Value逐列比较，作为参照
+ */
+static int compare_rows(const std::vector<Value>& a, const std::vector<Value>& b, const std::vector<SortColumn>& spec)
+{
+    for (const SortColumn& column : spec)
+    {
+        const Value& x      = a[column.column];
+        const Value& y      = b[column.column];
+        bool         x_null = x.attr_type() == UNDEFINED;
+        bool         y_null = y.attr_type() == UNDEFINED;
+        if (x_null || y_null)
+        {
+            if (x_null == y_null) continue;
+            return (x_null == column.nulls_first) ? -1 : 1;
+        }
+        RC  rc;
+        int cmp = x.compare(y, rc);
+        if (cmp) return column.descending ? -cmp : cmp;
+    }
+    return 0;
+}
+
+static bool check_sort(const DataChunk& chunk, const std::vector<SortColumn>& spec)
+{
+    RC                              rc;
+    std::vector<std::vector<Value>> rows(chunk.size());
+    for (std::size_t i = 0; i < chunk.size(); ++i) chunk.get_row(i, rows[i], rc);
+
+    std::vector<uint32_t> expected(rows.size());
+    for (uint32_t i = 0; i < expected.size(); ++i) expected[i] = i;
+    std::stable_sort(expected.begin(), expected.end(),
+        [&](uint32_t a, uint32_t b) { return compare_rows(rows[a], rows[b], spec) < 0; });
+
+    KeyEncoder    encoder(spec);
+    SortKeyBuffer keys, row_keys;
+    encoder.encode(chunk, keys, rc);
+    if (!check(rc == RC::SUCCESS && keys.size() == rows.size(), "encode chunk")) return false;
+
+    // 按元组编码的结果与按列编码逐字节相同
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+        encoder.encode(rows[i], row_keys, rc);
+        if (rc != RC::SUCCESS || row_keys.length(i) != keys.length(i) ||
+            memcmp(row_keys.key(i), keys.key(i), keys.length(i)) != 0)
+            return check(false, "row encoding matches column encoding");
+    }
+
+    std::vector<SortEntry> radix, prefix;
+    make_entries(keys, radix);
+    make_entries(keys, prefix);
+    radix_sort(radix);
+    prefix_sort(prefix);
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+        if (radix[i].row != expected[i] || prefix[i].row != expected[i])
+        {
+            fprintf(stderr, "order differs at %zu: expected %u, radix %u, prefix %u\n", i, expected[i], radix[i].row,
+                prefix[i].row);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool check_special_values()
+{
+    bool          ok = true;
+    RC            rc;
+    KeyEncoder    floats({{0, FLOATS, false, true, 0}});
+    SortKeyBuffer keys;
+    const float   values[] = {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), 0.0f,
+        -0.0f, -std::numeric_limits<float>::infinity()};
+    for (float f : values) floats.encode({Value(f, rc)}, keys, rc);
+    auto cmp = [&](std::size_t a, std::size_t b) { return memcmp(keys.key(a), keys.key(b), keys.length(a)); };
+    ok &= check(cmp(0, 1) > 0, "NaN sorts after infinity");
+    ok &= check(cmp(2, 3) == 0, "-0.0 equals 0.0");
+    ok &= check(cmp(3, 4) > 0, "-infinity is smallest");
+
+    // 不同标度的DECIMALS缩放到同一标度
+    KeyEncoder decimals({{0, DECIMALS, true, true, 3}});
+    Value      a, b;
+    a.set_decimal(int64_t(150), 5, 2, rc);
+    b.set_decimal(int64_t(15), 3, 1, rc);
+    keys.clear();
+    decimals.encode({a}, keys, rc);
+    decimals.encode({b}, keys, rc);
+    ok &= check(keys.size() == 2 && cmp(0, 1) == 0, "decimal scales normalized");
+
+    // 字典编码列与普通列编码相同
+    DataChunk plain({CHARS}, 4), encoded({CHARS}, 4);
+    encoded.set_column(0, std::make_unique<DictVector>(nullptr, 4), rc);
+    for (const char* str : {"pear", "apple", "fig"})
+    {
+        Value v(str, rc);
+        plain.append_row({v}, rc);
+        encoded.append_row({v}, rc);
+    }
+    KeyEncoder    strings({{0, CHARS, true, true, 0}});
+    SortKeyBuffer plain_keys, encoded_keys;
+    strings.encode(plain, plain_keys, rc);
+    strings.encode(encoded, encoded_keys, rc);
+    for (std::size_t i = 0; i < 3; ++i)
+        ok &= check(plain_keys.length(i) == encoded_keys.length(i) &&
+                        memcmp(plain_keys.key(i), encoded_keys.key(i), plain_keys.length(i)) == 0,
+            "dictionary column encoding");
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t rows = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+    if (!check_special_values()) return 1;
+
+    DataChunk chunk(Types, 3000);
+    fill(chunk, 3000);
+    std::vector<std::vector<SortColumn>> specs = {
+        {{0, INTS, false, true, 0}},
+        {{2, CHARS, false, true, 0}, {0, INTS, true, false, 0}},
+        {{1, FLOATS, true, true, 0}, {2, CHARS, true, false, 0}, {6, DECIMALS, false, true, 2}},
+        {{4, BOOLEANS, false, false, 0}, {3, DATES, true, true, 0}, {5, BIGINTS, false, true, 0},
+            {2, CHARS, false, true, 0}, {1, FLOATS, false, false, 0}},
+    };
+    for (const auto& spec : specs)
+        if (!check_sort(chunk, spec)) return 1;
+
+    // 选择向量只编码被选中的行
+    for (std::size_t i = 0; i < 1000; ++i) chunk.selection().set(i, static_cast<uint32_t>(i * 3));
+    chunk.selection().set_size(1000);
+    chunk.set_has_selection(true);
+    if (!check_sort(chunk, specs[1])) return 1;
+    printf("correctness checks passed\n");
+
+    // 基准：一个整数列与一个字符串列
+    std::vector<SortColumn>         spec = {{2, CHARS, false, true, 0}, {0, INTS, true, true, 0}};
+    KeyEncoder                      encoder(spec);
+    SortKeyBuffer                   keys;
+    std::vector<std::vector<Value>> values;
+    RC                              rc;
+    DataChunk                       batch(Types, VectorCapacity);
+    double                          encode_ns = 0;
+    for (std::size_t done = 0; done < rows; done += VectorCapacity)
+    {
+        batch.reset();
+        fill(batch, std::min(VectorCapacity, rows - done));
+        auto begin = Clock::now();
+        encoder.encode(batch, keys, rc);
+        encode_ns += std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            values.emplace_back();
+            batch.get_row(i, values.back(), rc);
+        }
+    }
+    printf("%-24s %.2f ns/row\n", "encode", encode_ns / rows);
+
+    // fill生成的字符串都不超过12字节，Value内联保存，batch重置后仍然有效
+    auto report = [&](const char* name, const std::function<void()>& body) {
+        auto begin = Clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / rows;
+        printf("%-24s %.2f ns/row\n", name, ns);
+    };
+
+    std::vector<SortEntry> entries;
+    make_entries(keys, entries);
+    report("radix sort", [&] { radix_sort(entries); });
+    make_entries(keys, entries);
+    report("prefix sort", [&] { prefix_sort(entries); });
+
+    std::vector<uint32_t> order(values.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    report("value compare sort", [&] {
+        std::sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) { return compare_rows(values[a], values[b], spec) < 0; });
+    });
+    return rc == RC::SUCCESS ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Thread/ThreadPool.h"
+
+/**
+ * @brief 线程池测试与基准
+ *
+ * 校验有任务在执行时调整线程数：增大后新线程立即参与执行，减小后多余的线程做完当前任务退出并被回收；
+ * 自适应模式在任务排队时增加线程，负载消失后空闲超时的线程退出，线程数回到下限；
+ * 工作线程在ManagedBlock中阻塞时线程池补充线程执行排队的任务，阻塞结束后补充的线程退出。
+ * 最后测量不同线程数下提交空任务的吞吐量。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static bool check(bool ok, const char* what)
+{
+    if (!ok) fprintf(stderr, "check failed: %s\n", what);
+    return ok;
+}
+
+/**
+ * @brief 进程当前的线程数
+ */
+static int thread_count()
+{
+    std::ifstream status("/proc/self/status");
+    std::string   line;
+    while (std::getline(status, line))
+        if (line.compare(0, 8, "Threads:") == 0) return atoi(line.c_str() + 8);
+    return -1;
+}
+
+/**
+ * @brief 轮询直到条件成立，超时返回false
+ */
+template <class Pred>
+static bool wait_until(Pred pred, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000))
+{
+    auto deadline = Clock::now() + timeout;
+    while (!pred())
+    {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief 同时在执行的任务数与其峰值
+ */
+struct Concurrency
+{
+    std::atomic<int> running{0};  ///< 正在执行的任务数
+    std::atomic<int> peak{0};     ///< running的峰值
+
+    void enter()
+    {
+        int now  = ++running;
+        int prev = peak.load();
+        while (now > prev && !peak.compare_exchange_weak(prev, now)) {}
+    }
+    void leave() { --running; }
+};
+
+static bool check_resize()
+{
+    int        baseline = thread_count();
+    ThreadPool pool(2);
+
+    // 8个任务都等待放行，只有2个线程时最多2个在执行
+    std::promise<void>       release;
+    std::shared_future<void> gate = release.get_future().share();
+    Concurrency              tasks;
+    std::atomic<int>         finished{0};
+    for (int i = 0; i < 8; ++i)
+        pool.Post([&, gate] {
+            tasks.enter();
+            gate.wait();
+            tasks.leave();
+            ++finished;
+        });
+    bool ok = check(wait_until([&] { return tasks.running == 2; }), "two workers pick up tasks");
+
+    pool.Resize(8);
+    ok &= check(pool.Size() == 8, "grow creates workers at once");
+    ok &= check(wait_until([&] { return tasks.running == 8; }), "new workers run queued tasks");
+
+    // 任务仍在执行时缩小，多余的线程做完手上的任务才退出
+    pool.Resize(3);
+    ok &= check(tasks.running == 8, "shrink does not interrupt running tasks");
+    release.set_value();
+    pool.Sync();
+    ok &= check(finished == 8, "all tasks finish after shrink");
+    ok &= check(wait_until([&] { return pool.Size() == 3; }), "surplus workers retire after shrink");
+
+    // 退出的线程在下一次Resize时被回收
+    pool.Resize(3);
+    ok &= check(thread_count() == baseline + 3, "retired workers are reaped");
+
+    std::atomic<int> count{0};
+    for (int i = 0; i < 1000; ++i) pool.Post([&] { ++count; });
+    pool.Sync();
+    return ok && check(count == 1000, "pool works after shrink");
+}
+
+static bool check_adaptive()
+{
+    int        baseline = thread_count();
+    ThreadPool pool(2);
+
+    ThreadPool::AdaptiveOptions options;
+    options.MinThreads     = 2;
+    options.MaxThreads     = 8;
+    options.WaitThreshold  = std::chrono::microseconds(200);
+    options.KeepAlive      = std::chrono::milliseconds(50);
+    options.SampleInterval = std::chrono::milliseconds(5);
+    pool.EnableAdaptive(options);
+
+    // 每个任务占用2ms，2个线程处理不完，排队时间超过阈值
+    Concurrency tasks;
+    for (int i = 0; i < 400; ++i)
+        pool.Post([&] {
+            tasks.enter();
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            tasks.leave();
+        });
+    pool.Sync();
+    bool ok = check(tasks.peak > 2, "adaptive mode adds workers under load");
+    ok &= check(tasks.peak <= 8, "adaptive mode respects MaxThreads");
+
+    // 空闲超过KeepAlive的线程退出，监控线程回收它们，线程数回到下限
+    ok &= check(wait_until([&] { return pool.Size() == 2; }), "idle workers retire in adaptive mode");
+    ok &= check(wait_until([&] { return thread_count() == baseline + 3; }), "monitor reaps retired workers");
+
+    pool.DisableAdaptive();
+    ok &= check(thread_count() == baseline + 2, "monitor stops");
+    std::atomic<int> count{0};
+    for (int i = 0; i < 1000; ++i) pool.Post([&] { ++count; });
+    pool.Sync();
+    return ok && check(count == 1000, "pool works after retiring workers");
+}
+
+static bool check_managed_block()
+{
+    ThreadPool pool(2);
+
+    // 两个线程都在ManagedBlock中等待放行，排队的任务只能由补充的线程执行
+    std::promise<void>       release;
+    std::shared_future<void> gate = release.get_future().share();
+    std::atomic<int>         blocked{0};
+    for (int i = 0; i < 2; ++i)
+        pool.Post([&, gate] {
+            auto guard = ThreadPool::ManagedBlock();
+            ++blocked;
+            gate.wait();
+        });
+    bool ok = check(wait_until([&] { return blocked == 2; }), "both workers block");
+
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 4; ++i) pool.Post([&] { ++ran; });
+    ok &= check(wait_until([&] { return ran == 4; }), "blocked workers are compensated");
+    ok &= check(pool.Size() > 2 && pool.Size() <= 4, "compensation stays within the blocked count");
+
+    release.set_value();
+    pool.Sync();
+    ok &= check(wait_until([&] { return pool.Size() == 2; }), "compensating workers retire after unblocking");
+
+    // 非工作线程登记阻塞不影响线程池
+    {
+        auto guard = ThreadPool::ManagedBlock();
+    }
+    return ok && check(pool.Size() == 2, "ManagedBlock outside the pool is a no-op");
+}
+
+int main(int argc, char** argv)
+{
+    long tasks = argc > 1 ? atol(argv[1]) : 1 << 20;
+
+    if (!check_resize() || !check_adaptive() || !check_managed_block()) return 1;
+    printf("correctness checks passed\n");
+
+    for (unsigned int threads : {1u, 2u, 4u, 8u})
+    {
+        ThreadPool        pool(threads);
+        std::atomic<long> count{0};
+        auto              begin = Clock::now();
+        for (long i = 0; i < tasks; ++i) pool.Post([&] { count.fetch_add(1, std::memory_order_relaxed); });
+        pool.Sync();
+        auto elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+        if (count != tasks) return 1;
+        printf("%u threads  %.2f M tasks/s\n", threads, tasks / elapsed / 1e6);
+    }
+    return 0;
+}
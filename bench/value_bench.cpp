@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "ret.h"
+#include "sql/arena.h"
+#include "sql/value.h"
+
+/**
+ * @brief 紧凑Value测试与基准
+ *
+ * 校验Value与std::string的比较结果一致，再比较两者排序的耗时。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    int rows = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    // 一半为短字符串，一半为共享前缀的长字符串，逼近前缀比较的最坏情况
+    std::vector<std::string> strs(rows);
+    unsigned int             seed = 12345;
+    for (int i = 0; i < rows; ++i)
+    {
+        seed        = seed * 1103515245u + 12345u;
+        int len     = (seed >> 16) % 2 ? 4 + (seed >> 8) % 9 : 13 + (seed >> 8) % 20;
+        strs[i]     = len > 12 ? "user" : "";
+        while (static_cast<int>(strs[i].size()) < len)
+        {
+            seed = seed * 1103515245u + 12345u;
+            strs[i].push_back(static_cast<char>('a' + (seed >> 16) % 26));
+        }
+    }
+
+    StringArena        arena;
+    std::vector<Value> values(rows);
+    RC                 rc;
+    for (int i = 0; i < rows; ++i) values[i].set_str(strs[i].data(), strs[i].size(), arena, rc);
+
+    for (int i = 1; i < rows; ++i)
+    {
+        int  expect = strs[i - 1].compare(strs[i]);
+        int  got    = values[i - 1].compare(values[i], rc);
+        bool equal  = values[i - 1].equals(values[i]);
+        if ((expect < 0) != (got < 0) || (expect > 0) != (got > 0) || equal != (expect == 0))
+        {
+            fprintf(stderr, "compare mismatch: %s %s\n", strs[i - 1].c_str(), strs[i].c_str());
+            return 1;
+        }
+    }
+    Value int_value(7, rc), float_value(7.5f, rc);
+    if (int_value.compare(float_value, rc) >= 0 || rc != RC::SUCCESS) return 1;
+    int_value.compare(values[0], rc);
+    if (rc != RC::INVALID_ARGUMENT) return 1;
+    printf("correctness checks passed, sizeof(Value) = %zu\n", sizeof(Value));
+
+    auto begin = Clock::now();
+    std::sort(strs.begin(), strs.end());
+    double string_ms = elapsed_ms(begin);
+
+    begin = Clock::now();
+    std::sort(values.begin(), values.end(), [&rc](const Value& a, const Value& b) { return a.compare(b, rc) < 0; });
+    double value_ms = elapsed_ms(begin);
+
+    for (int i = 0; i < rows; ++i)
+    {
+        if (values[i].get_str(rc) != strs[i])
+        {
+            fprintf(stderr, "sort mismatch at %d\n", i);
+            return 1;
+        }
+    }
+
+    printf("sort std::string: %.1f ms\n", string_ms);
+    printf("sort Value:       %.1f ms\n", value_ms);
+    return 0;
+}
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "Thread/ThreadPool.h"
+#include "bench_util.h"
+#include "ret.h"
+#include "storage/log_manager.h"
+
+/**
+ * @brief 预写日志测试与基准
+ *
+ * 校验多线程追加的记录（含跨越段文件与缓冲区末尾的记录）落盘后按日志序号完整读回、超长记录被拒绝、
+ * 刷写任务把并发的提交合并到一次fdatasync、重新打开后从末尾继续追加，以及记录损坏时日志在损坏处结束、
+ * 其后的残留记录不会在之后的追加后重新出现；
+ * 最后对比每次提交一次fdatasync与组提交在1到64个并发提交线程下的每秒事务数。
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static const std::chrono::microseconds NoDelay{0};
+
+/**
+ * @brief 第thread个线程的第seq条记录：线程号、序号，再按二者填充到len字节
+ */
+static std::string make_record(uint32_t thread, uint32_t seq, std::size_t len)
+{
+    std::string record(std::max<std::size_t>(len, 8), '\0');
+    memcpy(record.data(), &thread, 4);
+    memcpy(record.data() + 4, &seq, 4);
+    for (std::size_t i = 8; i < record.size(); ++i) record[i] = static_cast<char>(thread * 31 + seq + i);
+    return record;
+}
+
+static bool parse_record(const char* data, std::size_t len, uint32_t& thread, uint32_t& seq)
+{
+    if (len < 8) return false;
+    memcpy(&thread, data, 4);
+    memcpy(&seq, data + 4, 4);
+    return std::string(data, len) == make_record(thread, seq, len);
+}
+
+/**
+ * @brief 读回全部记录，校验内容、日志序号与每个线程内的顺序
+ */
+static bool read_back(LogManager& log, const std::vector<std::vector<lsn_t>>& lsns)
+{
+    RC                    rc;
+    std::vector<uint32_t> next(lsns.size(), 0);
+    std::size_t           count = 0;
+    lsn_t                 last  = log.begin_lsn();
+    for (LogReader reader = log.read(log.begin_lsn(), rc); reader.valid(); reader.next(rc), ++count)
+    {
+        uint32_t thread, seq;
+        if (!parse_record(reader.data(), reader.length(), thread, seq) || thread >= lsns.size()) return false;
+        if (seq != next[thread]++ || lsns[thread][seq] != reader.lsn() || reader.begin() != last) return false;
+        last = reader.lsn();
+    }
+    std::size_t total = 0;
+    for (auto& mine : lsns) total += mine.size();
+    return rc == RC::SUCCESS && count == total && last == log.end_lsn();
+}
+
+static bool check_append(const std::string& dir)
+{
+    // 64KB的段文件与16KB的缓冲区，记录经常跨越段边界与缓冲区末尾，追加经常等待缓冲区空间
+    RC         rc;
+    LogManager log(dir, 64 * 1024, 16 * 1024, NoDelay, rc);
+    if (!check(rc == RC::SUCCESS && log.end_lsn() == log.begin_lsn(), "create log")) return false;
+
+    const int                       threads = 8, per_thread = 2000;
+    std::vector<std::vector<lsn_t>> lsns(threads);
+    std::atomic<int>                failures{0};
+    std::vector<std::thread>        workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            RC           trc;
+            unsigned int state = t * 7919 + 1;
+            for (int i = 0; i < per_thread; ++i)
+            {
+                state              = state * 1103515245u + 12345u;
+                std::string record = make_record(t, i, (state >> 8) % 3000);
+                lsns[t].push_back(log.append(record.data(), record.size(), trc));
+                if (trc != RC::SUCCESS) ++failures;
+                // 每隔一段等待落盘，不启动刷写任务时由等待的线程自己写出
+                if (i % 100 == 99) log.flush(lsns[t].back(), trc);
+                if (trc != RC::SUCCESS) ++failures;
+            }
+        });
+    for (auto& worker : workers) worker.join();
+    bool ok = check(failures == 0, "concurrent appends");
+
+    std::string huge(log.buffer_size(), 'x');
+    log.append(huge.data(), huge.size(), rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "reject record larger than the buffer");
+    log.flush(log.end_lsn() + 8, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "reject flushing past the end");
+
+    std::string record = make_record(0, per_thread, 100);
+    lsns[0].push_back(log.append(record.data(), record.size(), rc));
+    ok &= check(log.durable_lsn() < lsns[0].back(), "appends are not durable before flush");
+    log.flush(log.end_lsn(), rc);
+    ok &= check(rc == RC::SUCCESS && log.durable_lsn() == log.end_lsn(), "flush makes everything durable");
+    ok &= check(log.stats().buffer_full > 0, "appends wait for buffer space");
+    return ok && check(read_back(log, lsns), "read back every record in order");
+}
+
+static bool check_group_commit(const std::string& dir)
+{
+    RC         rc;
+    ThreadPool pool(1);
+    LogManager log(dir, 1 << 20, 1 << 16, std::chrono::microseconds(200), rc);
+    log.start_flusher(pool);
+
+    // 每条记录都等待落盘，刷写任务把同时等待的提交合并到一轮
+    const int                       threads = 16, per_thread = 100;
+    std::vector<std::vector<lsn_t>> lsns(threads);
+    std::atomic<int>                failures{0};
+    std::vector<std::thread>        workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            RC trc;
+            for (int i = 0; i < per_thread; ++i)
+            {
+                std::string record = make_record(t, i, 100);
+                lsns[t].push_back(log.append(record.data(), record.size(), trc));
+                log.flush(lsns[t].back(), trc);
+                if (trc != RC::SUCCESS || log.durable_lsn() < lsns[t].back()) ++failures;
+            }
+        });
+    for (auto& worker : workers) worker.join();
+    LogStats stats = log.stats();
+    bool     ok    = check(failures == 0, "every commit is durable when flush returns");
+    ok &= check(stats.syncs * 2 < stats.commits, "concurrent commits share an fdatasync");
+    log.stop_flusher();
+    return ok && check(read_back(log, lsns), "read back committed records");
+}
+
+static bool check_recovery(const std::string& dir)
+{
+    const std::size_t               segment = 64 * 1024;
+    std::vector<std::vector<lsn_t>> lsns(1);
+    std::vector<lsn_t>              begins;
+    RC                              rc;
+    {
+        LogManager log(dir, segment, 16 * 1024, NoDelay, rc);
+        for (uint32_t i = 0; i < 300; ++i)
+        {
+            std::string record = make_record(0, i, 500);
+            begins.push_back(log.end_lsn());
+            lsns[0].push_back(log.append(record.data(), record.size(), rc));
+        }
+    }
+
+    // 析构时落盘，重新打开后从末尾继续追加
+    bool ok;
+    {
+        LogManager log(dir, segment, 16 * 1024, NoDelay, rc);
+        ok = check(rc == RC::SUCCESS && log.end_lsn() == lsns[0].back() && read_back(log, lsns), "reopen");
+        for (uint32_t i = 300; i < 400; ++i)
+        {
+            std::string record = make_record(0, i, 500);
+            begins.push_back(log.end_lsn());
+            lsns[0].push_back(log.append(record.data(), record.size(), rc));
+        }
+        log.flush(log.end_lsn(), rc);
+    }
+    LogManager(dir, 2 * segment, 16 * 1024, NoDelay, rc);
+    ok &= check(rc == RC::INVALID_ARGUMENT, "reject a different segment size");
+
+    // 损坏第350条记录：日志在它之前结束
+    lsn_t broken = begins[350] + sizeof(LogRecordHeader) + 10;
+    char  path[64];
+    snprintf(path, sizeof(path), "/%016llx.log", static_cast<unsigned long long>(broken / segment));
+    int fd = open((dir + path).c_str(), O_WRONLY);
+    ok &= check(fd >= 0 && pwrite(fd, "!", 1, broken % segment) == 1, "corrupt a record");
+    close(fd);
+    lsns[0].resize(350);
+    {
+        LogManager log(dir, segment, 16 * 1024, NoDelay, rc);
+        ok &= check(log.end_lsn() == begins[350] && read_back(log, lsns), "log ends before the corrupt record");
+
+        // 用更长的一条记录覆盖损坏处，原来排在后面的记录不会接在它后面重新出现
+        std::string record = make_record(0, 350, 700);
+        lsns[0].push_back(log.append(record.data(), record.size(), rc));
+    }
+    LogManager log(dir, segment, 16 * 1024, NoDelay, rc);
+    return ok && check(log.end_lsn() == lsns[0].back() && read_back(log, lsns), "stale records stay cleared");
+}
+
+/**
+ * @brief 每个线程提交txns个事务，每个事务追加一条记录并等待落盘，返回每秒事务数
+ */
+template <class Commit>
+static double run(unsigned int threads, std::size_t txns, Commit commit)
+{
+    std::vector<std::thread> workers;
+    auto                     begin = Clock::now();
+    for (unsigned int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            std::string record = make_record(t, 0, 120);
+            for (std::size_t i = 0; i < txns; ++i) commit(record);
+        });
+    for (auto& worker : workers) worker.join();
+    return threads * txns / std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t txns = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200;
+
+    TempDir tmp("wal_bench");
+    if (!tmp.valid()) return 1;
+    const std::string& dir = tmp.path();
+
+    bool ok = check_append(dir + "/append") && check_group_commit(dir + "/group") && check_recovery(dir + "/recover");
+    if (!ok) return 1;
+    printf("correctness checks passed\n");
+
+    // 对照：每个事务写入后各自fdatasync
+    int        fd = open((dir + "/single.log").c_str(), O_RDWR | O_CREAT, 0644);
+    std::mutex mutex;
+    off_t      offset = 0;
+    for (unsigned int threads : {1u, 8u, 64u})
+    {
+        double tps = run(threads, txns, [&](const std::string& record) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pwrite(fd, record.data(), record.size(), offset) > 0) offset += record.size();
+            fdatasync(fd);
+        });
+        printf("fsync per commit  %2u threads  %8.0f txn/s\n", threads, tps);
+    }
+    close(fd);
+
+    ThreadPool pool(1);
+    for (int delay : {0, 100})
+    {
+        RC         rc;
+        LogManager log(dir + "/bench" + std::to_string(delay), 16 << 20, 4 << 20, std::chrono::microseconds(delay), rc);
+        log.start_flusher(pool);
+        for (unsigned int threads : {1u, 8u, 16u, 32u, 64u})
+        {
+            LogStats before = log.stats();
+            double   tps    = run(threads, txns, [&](const std::string& record) {
+                RC trc;
+                log.flush(log.append(record.data(), record.size(), trc), trc);
+            });
+            LogStats after   = log.stats();
+            double   batched = static_cast<double>(after.commits - before.commits) /
+                             std::max<uint64_t>(1, after.syncs - before.syncs);
+            printf("group commit %3dus %2u threads  %8.0f txn/s  %.1f commits per fdatasync\n", delay, threads, tps,
+                batched);
+        }
+        log.stop_flusher();
+    }
+
+    return 0;
+}
@@ -13,6 +13,7 @@
     RET_CODE(TABLE_NOT_EXIST)  \
     RET_CODE(COLUMN_NOT_EXIST) \
     RET_CODE(LOCKED)           \
+    RET_CODE(IO_ERROR)         \
     RET_CODE(OTHER_RET)        \
     RET_CODE(UNKNOW_RET)
 
@@ -0,0 +1,63 @@
+#include "arena.h"
+#include <cstring>
+
+/**
+ * @brief 字符串内存池构造函数
+ *
+ * @param block_size 每块的默认大小
+ */
+StringArena::StringArena(std::size_t block_size)
+    : block_size_(block_size), cur_(nullptr), remaining_(0), used_(0)
+{}
+
+/**
+ * @brief 分配一段未初始化的内存
+ *
+ * 当前块不足时申请新块；超过半块的请求单独申请，不浪费当前块的剩余空间。
+ */
+char* StringArena::allocate(std::size_t size)
+{
+    used_ += size;
+    if (size <= remaining_)
+    {
+        char* ptr = cur_;
+        cur_ += size;
+        remaining_ -= size;
+        return ptr;
+    }
+
+    if (size > block_size_ / 2)
+    {
+        large_.emplace_back(new char[size]);
+        return large_.back().get();
+    }
+
+    blocks_.emplace_back(new char[block_size_]);
+    cur_       = blocks_.back().get() + size;
+    remaining_ = block_size_ - size;
+    return blocks_.back().get();
+}
+
+/**
+ * @brief 复制一段字符串到内存池
+ */
+const char* StringArena::copy(const char* str, std::size_t len)
+{
+    char* dst = allocate(len);
+    if (len) memcpy(dst, str, len);
+    return dst;
+}
+
+/**
+ * @brief 释放全部内存，保留第一块以供复用
+ */
+void StringArena::clear()
+{
+    used_ = 0;
+    large_.clear();
+    if (blocks_.empty()) return;
+
+    blocks_.resize(1);
+    cur_       = blocks_.front().get();
+    remaining_ = block_size_;
+}
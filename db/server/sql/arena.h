@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 字符串内存池
+ *
+ * 按块追加分配、整体释放，用于存放长字符串Value及列向量的字符串数据。
+ * 分配出的内存在clear()或析构前一直有效，单个对象不能单独释放。非线程安全。
+ */
+class StringArena
+{
+  public:
+    /**
+     * @brief 构造函数
+     *
+     * @param block_size 每块的默认大小，超过该大小的分配单独占用一块
+     */
+    explicit StringArena(std::size_t block_size = 64 * 1024);
+
+    StringArena(StringArena&&) noexcept            = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
+    StringArena(const StringArena&)                = delete;
+    StringArena& operator=(const StringArena&)     = delete;
+
+    /**
+     * @brief 分配一段未初始化的内存
+     *
+     * @param size 字节数
+     * @return 指向分配内存的指针
+     */
+    char* allocate(std::size_t size);
+
+    /**
+     * @brief 复制一段字符串到内存池
+     *
+     * 不追加结尾的'\0'。
+     *
+     * @param str 源字符串
+     * @param len 字符串长度
+     * @return 复制后的地址
+     */
+    const char* copy(const char* str, std::size_t len);
+
+    /**
+     * @brief 释放全部内存，保留第一块以供复用
+     */
+    void clear();
+
+    /**
+     * @brief 已分配出去的字节数
+     */
+    std::size_t bytes_used() const { return used_; }
+
+  private:
+    std::vector<std::unique_ptr<char[]>> blocks_;      ///< 按默认大小申请的内存块
+    std::vector<std::unique_ptr<char[]>> large_;       ///< 单独申请的大块
+    std::size_t                          block_size_;  ///< 默认块大小
+    char*                                cur_;         ///< 当前块中下一个可用位置
+    std::size_t                          remaining_;   ///< 当前块剩余字节数
+    std::size_t                          used_;        ///< 已分配出去的字节数
+};
@@ -0,0 +1,151 @@
+#include "column.h"
+#include "decimal.h"
+#include "ret.h"
+
+/**
+ * @brief 有效性位图构造函数，全部行初始为有效
+ *
+ * @param capacity 最大行数
+ */
+ValidityMask::ValidityMask(std::size_t capacity) : words_((capacity + 63) / 64, ~uint64_t(0)) {}
+
+/**
+ * @brief 将全部行置为有效
+ */
+void ValidityMask::set_all_valid()
+{
+    for (uint64_t& word : words_) word = ~uint64_t(0);
+}
+
+/**
+ * @brief 前count行是否全部有效
+ */
+bool ValidityMask::all_valid(std::size_t count) const
+{
+    std::size_t full = count / 64;
+    for (std::size_t i = 0; i < full; ++i)
+        if (~words_[i]) return false;
+
+    std::size_t rest = count % 64;
+    if (!rest) return true;
+    uint64_t mask = (uint64_t(1) << rest) - 1;
+    return (words_[full] & mask) == mask;
+}
+
+/**
+ * @brief 清空有效性位图
+ */
+void ColumnBase::reset() { validity_.set_all_valid(); }
+
+/**
+ * @brief 设置DECIMALS列的精度与标度
+ */
+void ColumnBase::set_decimal_type(int precision, int scale, RC& rc)
+{
+    if (!decimal_type_valid(precision, scale))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    precision_ = precision;
+    scale_     = scale;
+    rc         = RC::SUCCESS;
+}
+
+/**
+ * @brief 按类型创建列向量
+ */
+static std::unique_ptr<ColumnBase> make_column(AttrType type, std::size_t capacity)
+{
+    switch (type)
+    {
+        case CHARS: return std::make_unique<ColumnVector<CHARS>>(capacity);
+        case INTS: return std::make_unique<ColumnVector<INTS>>(capacity);
+        case FLOATS: return std::make_unique<ColumnVector<FLOATS>>(capacity);
+        case DATES: return std::make_unique<ColumnVector<DATES>>(capacity);
+        case BOOLEANS: return std::make_unique<ColumnVector<BOOLEANS>>(capacity);
+        case BIGINTS: return std::make_unique<ColumnVector<BIGINTS>>(capacity);
+        case DECIMALS: return std::make_unique<ColumnVector<DECIMALS>>(capacity);
+        default: return nullptr;
+    }
+}
+
+/**
+ * @brief 批数据构造函数
+ *
+ * @param types 各列类型
+ * @param capacity 最大行数
+ */
+DataChunk::DataChunk(const std::vector<AttrType>& types, std::size_t capacity)
+    : selection_(capacity), has_selection_(false), capacity_(capacity), count_(0)
+{
+    columns_.reserve(types.size());
+    for (AttrType type : types) columns_.push_back(make_column(type, capacity));
+}
+
+/**
+ * @brief 替换一列
+ */
+void DataChunk::set_column(std::size_t i, std::unique_ptr<ColumnBase> column, RC& rc)
+{
+    if (i >= columns_.size() || !column || column->capacity() < capacity_)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    columns_[i] = std::move(column);
+    rc          = RC::SUCCESS;
+}
+
+/**
+ * @brief 追加一行
+ *
+ * 某列写入失败时不增加行数，已写入的列会在下一次追加时被覆盖。
+ */
+void DataChunk::append_row(const std::vector<Value>& row, RC& rc)
+{
+    if (count_ == capacity_ || row.size() != columns_.size())
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    for (std::size_t i = 0; i < columns_.size(); ++i)
+    {
+        columns_[i]->set_value(count_, row[i], rc);
+        if (rc != RC::SUCCESS) return;
+    }
+    ++count_;
+    rc = RC::SUCCESS;
+}
+
+/**
+ * @brief 读取一个逻辑行
+ */
+void DataChunk::get_row(std::size_t i, std::vector<Value>& row, RC& rc) const
+{
+    if (i >= size())
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    std::size_t index = row_index(i);
+    row.resize(columns_.size());
+    for (std::size_t c = 0; c < columns_.size(); ++c)
+    {
+        columns_[c]->get_value(index, row[c], rc);
+        if (rc != RC::SUCCESS) return;
+    }
+}
+
+/**
+ * @brief 清空数据与选择向量
+ */
+void DataChunk::reset()
+{
+    for (auto& column : columns_) column->reset();
+    selection_.set_size(0);
+    has_selection_ = false;
+    count_         = 0;
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "value.h"
+
+enum class RC;
+class StringDictionary;
+
+/**
+ * @brief 一批数据的默认行数
+ */
+constexpr std::size_t VectorCapacity = 2048;
+
+/**
+ * @brief 各AttrType在列向量中的存储类型
+ */
+template <AttrType Type>
+struct AttrTraits;
+
+template <>
+struct AttrTraits<CHARS>
+{
+    using type = std::string_view;  ///< 指向列的字符串堆
+};
+
+template <>
+struct AttrTraits<INTS>
+{
+    using type = int;
+};
+
+template <>
+struct AttrTraits<FLOATS>
+{
+    using type = float;
+};
+
+template <>
+struct AttrTraits<DATES>
+{
+    using type = int;
+};
+
+template <>
+struct AttrTraits<BOOLEANS>
+{
+    using type = bool;
+};
+
+template <>
+struct AttrTraits<BIGINTS>
+{
+    using type = int64_t;
+};
+
+template <>
+struct AttrTraits<DECIMALS>
+{
+    using type = int64_t;  ///< 放大10^scale倍后的整数
+};
+
+/**
+ * @brief 有效性位图
+ *
+ * 第i位为1表示第i行非NULL。新建时全部有效。
+ */
+class ValidityMask
+{
+  public:
+    explicit ValidityMask(std::size_t capacity);
+
+    bool is_valid(std::size_t row) const { return words_[row / 64] >> (row % 64) & 1; }
+    void set_valid(std::size_t row) { words_[row / 64] |= uint64_t(1) << (row % 64); }
+    void set_invalid(std::size_t row) { words_[row / 64] &= ~(uint64_t(1) << (row % 64)); }
+
+    /**
+     * @brief 将全部行置为有效
+     */
+    void set_all_valid();
+
+    /**
+     * @brief 前count行是否全部有效，可据此跳过逐行检查
+     */
+    bool all_valid(std::size_t count) const;
+
+    uint64_t*       data() { return words_.data(); }
+    const uint64_t* data() const { return words_.data(); }
+
+  private:
+    std::vector<uint64_t> words_;  ///< 位图
+};
+
+/**
+ * @brief 选择向量
+ *
+ * 保存过滤后仍然存活的行号，使过滤不必移动列数据。
+ */
+class SelectionVector
+{
+  public:
+    explicit SelectionVector(std::size_t capacity) : indices_(capacity), size_(0) {}
+
+    uint32_t operator[](std::size_t i) const { return indices_[i]; }
+
+    void        set(std::size_t i, uint32_t row) { indices_[i] = row; }
+    void        set_size(std::size_t size) { size_ = size; }
+    std::size_t size() const { return size_; }
+
+    uint32_t*       data() { return indices_.data(); }
+    const uint32_t* data() const { return indices_.data(); }
+
+  private:
+    std::vector<uint32_t> indices_;  ///< 行号
+    std::size_t           size_;     ///< 有效行号个数
+};
+
+/**
+ * @brief 列向量基类
+ *
+ * 保存类型、容量与有效性位图，并提供与Value之间的逐行转换。
+ * 批量计算应通过ColumnVector<Type>::data()直接访问定长数组。
+ */
+class ColumnBase
+{
+  public:
+    ColumnBase(AttrType type, std::size_t capacity) : validity_(capacity), type_(type), capacity_(capacity) {}
+    virtual ~ColumnBase() = default;
+
+    AttrType    type() const { return type_; }
+    std::size_t capacity() const { return capacity_; }
+    int         precision() const { return precision_; }
+    int         scale() const { return scale_; }
+
+    /**
+     * @brief 设置DECIMALS列的精度与标度，默认为DECIMAL(18, 0)
+     *
+     * 已写入的数据不会被缩放。
+     */
+    void set_decimal_type(int precision, int scale, RC& rc);
+
+    /**
+     * @brief 字典编码的CHARS列返回其字典，其余列返回nullptr，见dictionary.h
+     */
+    virtual const StringDictionary* dictionary() const { return nullptr; }
+
+    ValidityMask&       validity() { return validity_; }
+    const ValidityMask& validity() const { return validity_; }
+
+    /**
+     * @brief 读取一行为Value
+     *
+     * NULL行得到UNDEFINED类型的Value；字符串不复制，指向列的字符串堆。
+     */
+    virtual void get_value(std::size_t row, Value& value, RC& rc) const = 0;
+
+    /**
+     * @brief 用Value写入一行
+     *
+     * UNDEFINED类型的Value写为NULL，其余类型必须与列类型一致，否则rc为RC::INVALID_ARGUMENT。
+     * DECIMALS按列的标度缩放，超出列的精度时rc为RC::INVALID_ARGUMENT。
+     */
+    virtual void set_value(std::size_t row, const Value& value, RC& rc) = 0;
+
+    /**
+     * @brief 清空有效性位图与字符串堆，准备装入下一批数据
+     */
+    virtual void reset();
+
+  protected:
+    ValidityMask validity_;  ///< 有效性位图
+
+  private:
+    AttrType    type_;           ///< 列类型
+    std::size_t capacity_;       ///< 最大行数
+    int         precision_ = 18;  ///< DECIMALS的精度
+    int         scale_     = 0;   ///< DECIMALS的标度
+};
+
+/**
+ * @brief 定长类型列向量
+ *
+ * @tparam Type 列类型
+ */
+template <AttrType Type>
+class ColumnVector : public ColumnBase
+{
+  public:
+    using T = typename AttrTraits<Type>::type;
+
+    explicit ColumnVector(std::size_t capacity = VectorCapacity)
+        : ColumnBase(Type, capacity), data_(new T[capacity]())
+    {}
+
+    T*       data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+
+    T&       operator[](std::size_t row) { return data_[row]; }
+    const T& operator[](std::size_t row) const { return data_[row]; }
+
+    /**
+     * @brief 写入一个字符串，数据复制到列的字符串堆中
+     */
+    void set_str(std::size_t row, const char* str, std::size_t len)
+        requires(Type == CHARS);
+
+    StringArena& heap() requires(Type == CHARS) { return heap_; }
+
+    void get_value(std::size_t row, Value& value, RC& rc) const override;
+    void set_value(std::size_t row, const Value& value, RC& rc) override;
+    void reset() override;
+
+  private:
+    std::unique_ptr<T[]> data_;  ///< 定长数据
+    StringArena          heap_;  ///< 字符串堆，仅CHARS列使用
+};
+
+/**
+ * @brief 一批数据
+ *
+ * 由若干等容量的列向量与一个可选的选择向量组成，是按批执行时算子之间传递数据的单位。
+ */
+class DataChunk
+{
+  public:
+    /**
+     * @brief 构造函数
+     *
+     * @param types 各列类型，不能为UNDEFINED
+     * @param capacity 最大行数
+     */
+    explicit DataChunk(const std::vector<AttrType>& types, std::size_t capacity = VectorCapacity);
+
+    std::size_t column_count() const { return columns_.size(); }
+    std::size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief 列数据中已写入的行数
+     */
+    std::size_t row_count() const { return count_; }
+    void        set_row_count(std::size_t count) { count_ = count; }
+
+    /**
+     * @brief 逻辑行数，有选择向量时为被选中的行数
+     */
+    std::size_t size() const { return has_selection_ ? selection_.size() : count_; }
+
+    /**
+     * @brief 逻辑行号对应的物理行号
+     */
+    std::size_t row_index(std::size_t i) const { return has_selection_ ? selection_[i] : i; }
+
+    ColumnBase&       column(std::size_t i) { return *columns_[i]; }
+    const ColumnBase& column(std::size_t i) const { return *columns_[i]; }
+
+    /**
+     * @brief 替换一列，新列的容量不能小于批的容量
+     *
+     * 用于把CHARS列换成字典编码的DictVector。
+     */
+    void set_column(std::size_t i, std::unique_ptr<ColumnBase> column, RC& rc);
+
+    /**
+     * @brief 以具体类型访问列，调用者需保证类型一致
+     *
+     * 字典编码的CHARS列不是ColumnVector<CHARS>。
+     */
+    template <AttrType Type>
+    ColumnVector<Type>& column(std::size_t i)
+    {
+        return static_cast<ColumnVector<Type>&>(*columns_[i]);
+    }
+
+    SelectionVector&       selection() { return selection_; }
+    const SelectionVector& selection() const { return selection_; }
+    bool             has_selection() const { return has_selection_; }
+
+    /**
+     * @brief 启用或取消选择向量
+     */
+    void set_has_selection(bool has_selection) { has_selection_ = has_selection; }
+
+    /**
+     * @brief 追加一行
+     *
+     * @param row 各列的值，个数必须等于列数
+     * @param rc 批已满或类型不符时失败
+     */
+    void append_row(const std::vector<Value>& row, RC& rc);
+
+    /**
+     * @brief 读取一个逻辑行
+     *
+     * @param i 逻辑行号
+     * @param row 输出的各列值
+     */
+    void get_row(std::size_t i, std::vector<Value>& row, RC& rc) const;
+
+    /**
+     * @brief 清空数据与选择向量，保留已分配的内存
+     */
+    void reset();
+
+  private:
+    std::vector<std::unique_ptr<ColumnBase>> columns_;        ///< 列向量
+    SelectionVector                          selection_;      ///< 选择向量
+    bool                                     has_selection_;  ///< 是否启用选择向量
+    std::size_t                              capacity_;       ///< 最大行数
+    std::size_t                              count_;          ///< 已写入的行数
+};
+
+#include "column.tpp"
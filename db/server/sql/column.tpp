@@ -0,0 +1,101 @@
+#include <cstring>
+#include "decimal.h"
+#include "ret.h"
+
+/**
+ * @brief 写入一个字符串，数据复制到列的字符串堆中
+ *
+ * @param row 行号
+ * @param str 字符串
+ * @param len 字符串长度
+ */
+template <AttrType Type>
+void ColumnVector<Type>::set_str(std::size_t row, const char* str, std::size_t len)
+    requires(Type == CHARS)
+{
+    data_[row] = std::string_view(heap_.copy(str, len), len);
+    validity_.set_valid(row);
+}
+
+/**
+ * @brief 读取一行为Value
+ */
+template <AttrType Type>
+void ColumnVector<Type>::get_value(std::size_t row, Value& value, RC& rc) const
+{
+    if (!validity_.is_valid(row))
+    {
+        value = Value();
+        rc    = RC::SUCCESS;
+        return;
+    }
+
+    if constexpr (Type == CHARS)
+        value.set_str_ref(data_[row], rc);
+    else if constexpr (Type == INTS)
+        value.set_int(data_[row], rc);
+    else if constexpr (Type == FLOATS)
+        value.set_float(data_[row], rc);
+    else if constexpr (Type == DATES)
+        value.set_date(data_[row], rc);
+    else if constexpr (Type == BIGINTS)
+        value.set_bigint(data_[row], rc);
+    else if constexpr (Type == DECIMALS)
+        value.set_decimal(data_[row], precision(), scale(), rc);
+    else
+        value.set_bool(data_[row], rc);
+}
+
+/**
+ * @brief 用Value写入一行
+ */
+template <AttrType Type>
+void ColumnVector<Type>::set_value(std::size_t row, const Value& value, RC& rc)
+{
+    if (value.attr_type() == UNDEFINED)
+    {
+        validity_.set_invalid(row);
+        rc = RC::SUCCESS;
+        return;
+    }
+    if (value.attr_type() != Type)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    if constexpr (Type == CHARS)
+    {
+        std::string_view str = value.get_str(rc);
+        set_str(row, str.data(), str.size());
+        return;
+    }
+    else if constexpr (Type == INTS)
+        data_[row] = value.get_int(rc);
+    else if constexpr (Type == FLOATS)
+        data_[row] = value.get_float(rc);
+    else if constexpr (Type == DATES)
+        data_[row] = value.get_date(rc);
+    else if constexpr (Type == BIGINTS)
+        data_[row] = value.get_bigint(rc);
+    else if constexpr (Type == DECIMALS)
+    {
+        int64_t unscaled = value.get_decimal(rc);
+        decimal_rescale(unscaled, value.scale(), scale(), precision(), unscaled, rc);
+        if (rc != RC::SUCCESS) return;
+        data_[row] = unscaled;
+    }
+    else
+        data_[row] = value.get_bool(rc);
+    validity_.set_valid(row);
+}
+
+/**
+ * @brief 清空有效性位图与字符串堆
+ */
+template <AttrType Type>
+void ColumnVector<Type>::reset()
+{
+    ColumnBase::reset();
+    if constexpr (Type == CHARS) heap_.clear();
+}
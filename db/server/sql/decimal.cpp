@@ -0,0 +1,293 @@
+#include "decimal.h"
+#include <vector>
+#include "Trans/number.h"
+#include "ret.h"
+
+const int64_t DecimalPow10[MaxDecimalPrecision + 1] = {
+    1LL,
+    10LL,
+    100LL,
+    1000LL,
+    10000LL,
+    100000LL,
+    1000000LL,
+    10000000LL,
+    100000000LL,
+    1000000000LL,
+    10000000000LL,
+    100000000000LL,
+    1000000000000LL,
+    10000000000000LL,
+    100000000000000LL,
+    1000000000000000LL,
+    10000000000000000LL,
+    100000000000000000LL,
+    1000000000000000000LL,
+};
+
+/**
+ * @brief 128位的10的幂
+ */
+static int128_t pow10_128(int n)
+{
+    int128_t result = 1;
+    while (n >= MaxDecimalPrecision)
+    {
+        result *= DecimalPow10[MaxDecimalPrecision];
+        n -= MaxDecimalPrecision;
+    }
+    return result * DecimalPow10[n];
+}
+
+bool decimal_type_valid(int precision, int scale)
+{
+    return precision >= 1 && precision <= MaxDecimalPrecision && scale >= 0 && scale <= precision;
+}
+
+void parse_bigint(const char* str, std::size_t len, int64_t& out, RC& rc) { Str2BigInt(str, len, out, rc); }
+
+/**
+ * @brief 解析定点小数
+ *
+ * 先跳过整数部分的前导0，整数部分位数不能超过precision - scale。
+ */
+void parse_decimal(const char* str, std::size_t len, int precision, int scale, int64_t& out, RC& rc)
+{
+    rc = RC::INVALID_ARGUMENT;
+    if (!decimal_type_valid(precision, scale)) return;
+
+    const char* cur = str;
+    const char* end = str + len;
+
+    bool negative = cur < end && *cur == '-';
+    if (cur < end && (*cur == '-' || *cur == '+')) ++cur;
+
+    int     digits     = 0;
+    int     int_digits = 0;
+    int64_t value      = 0;
+    for (; cur < end && static_cast<unsigned>(*cur - '0') < 10; ++cur, ++digits)
+    {
+        if (value == 0 && *cur == '0') continue;
+        if (++int_digits > precision - scale) return;
+        value = value * 10 + (*cur - '0');
+    }
+
+    int frac_digits = 0;
+    if (cur < end && *cur == '.')
+    {
+        for (++cur; cur < end && static_cast<unsigned>(*cur - '0') < 10; ++cur, ++digits)
+        {
+            if (frac_digits < scale)
+                value = value * 10 + (*cur - '0');
+            else if (frac_digits == scale)
+                value += *cur >= '5';  // 只看被舍去的第一位即可四舍五入
+            ++frac_digits;
+        }
+    }
+    if (cur != end || digits == 0) return;
+
+    if (frac_digits < scale) value *= DecimalPow10[scale - frac_digits];
+    if (!decimal_fits(value, precision)) return;
+
+    out = negative ? -value : value;
+    rc  = RC::SUCCESS;
+}
+
+/**
+ * @brief 把无符号整数的十进制表示写到end之前
+ *
+ * @param min_digits 最少输出的位数，不足时补0
+ * @return 第一个字符的位置
+ */
+template <class U>
+static char* write_digits(U value, int min_digits, char* end)
+{
+    int written = 0;
+    do
+    {
+        *--end = static_cast<char>('0' + value % 10);
+        value /= 10;
+        ++written;
+    } while (value || written < min_digits);
+    return end;
+}
+
+/**
+ * @brief 格式化定点小数
+ *
+ * 小数部分补足scale位，整数部分至少输出一位。
+ */
+template <class S, class U>
+static std::size_t format_scaled(S value, int scale, char* buf)
+{
+    char  tmp[MaxNumberStrLen];
+    char* end   = tmp + sizeof(tmp);
+    U     mag   = value < 0 ? U(0) - static_cast<U>(value) : static_cast<U>(value);
+    char* begin = end;
+    if (scale > 0)
+    {
+        U frac = mag % static_cast<U>(pow10_128(scale));
+        mag /= static_cast<U>(pow10_128(scale));
+        begin    = write_digits(frac, scale, end);
+        *--begin = '.';
+    }
+    begin = write_digits(mag, 1, begin);
+    if (value < 0) *--begin = '-';
+
+    std::size_t len = end - begin;
+    for (std::size_t i = 0; i < len; ++i) buf[i] = begin[i];
+    return len;
+}
+
+std::size_t format_bigint(int64_t value, char* buf) { return BigInt2Str(value, buf); }
+
+std::size_t format_decimal(int64_t value, int scale, char* buf)
+{
+    return format_scaled<int64_t, uint64_t>(value, scale, buf);
+}
+
+std::size_t format_decimal(int128_t value, int scale, char* buf)
+{
+    return format_scaled<int128_t, uint128_t>(value, scale, buf);
+}
+
+/**
+ * @brief 128位缩放，缩小时四舍五入（远离零）
+ *
+ * @return 放大时溢出返回false
+ */
+static bool rescale128(int128_t value, int from_scale, int to_scale, int128_t& out)
+{
+    if (to_scale >= from_scale) return !__builtin_mul_overflow(value, pow10_128(to_scale - from_scale), &out);
+
+    int128_t divisor = pow10_128(from_scale - to_scale);
+    int128_t rem     = value % divisor;
+    out              = value / divisor;
+    if (rem * 2 >= divisor)
+        ++out;
+    else if (rem * 2 <= -divisor)
+        --out;
+    return true;
+}
+
+/**
+ * @brief 把128位结果写回64位并检查精度
+ */
+static void narrow(int128_t value, int precision, int64_t& out, RC& rc)
+{
+    if (value >= DecimalPow10[precision] || value <= -DecimalPow10[precision])
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    out = static_cast<int64_t>(value);
+    rc  = RC::SUCCESS;
+}
+
+void decimal_rescale(int64_t value, int from_scale, int to_scale, int precision, int64_t& out, RC& rc)
+{
+    int128_t result;
+    if (!rescale128(value, from_scale, to_scale, result))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    narrow(result, precision, out, rc);
+}
+
+int decimal_compare(int64_t a, int a_scale, int64_t b, int b_scale)
+{
+    // 两者都小于10^18，放大不超过10^18倍，128位足够
+    int128_t lhs = a, rhs = b;
+    if (a_scale < b_scale) lhs *= pow10_128(b_scale - a_scale);
+    if (b_scale < a_scale) rhs *= pow10_128(a_scale - b_scale);
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/**
+ * @brief 单行定点小数运算
+ *
+ * 加减法对齐到较大的标度；乘法结果的标度为两者之和；
+ * 除法把被除数放大到结果标度加一位再除，最后一位用于四舍五入。
+ */
+void decimal_arith(ArithOp op, int64_t a, int a_scale, int64_t b, int b_scale, int precision, int scale,
+    int64_t& out, RC& rc)
+{
+    rc = RC::INVALID_ARGUMENT;
+    if (!decimal_type_valid(precision, scale)) return;
+
+    int128_t result;
+    int      result_scale;
+    switch (op)
+    {
+        case ArithOp::ADD:
+        case ArithOp::SUB:
+        {
+            result_scale = a_scale > b_scale ? a_scale : b_scale;
+            int128_t lhs = a * pow10_128(result_scale - a_scale);
+            int128_t rhs = b * pow10_128(result_scale - b_scale);
+            result       = op == ArithOp::ADD ? lhs + rhs : lhs - rhs;
+            break;
+        }
+        case ArithOp::MUL:
+            result       = static_cast<int128_t>(a) * b;
+            result_scale = a_scale + b_scale;
+            break;
+        default:
+        {
+            if (b == 0) return;
+            int128_t dividend;
+            if (!rescale128(a, a_scale - b_scale, scale + 1, dividend)) return;
+            result       = dividend / b;
+            result_scale = scale + 1;
+            break;
+        }
+    }
+
+    if (!rescale128(result, result_scale, scale, result)) return;
+    narrow(result, precision, out, rc);
+}
+
+bool decimal_check_precision(const int64_t* values, std::size_t count, int precision, uint64_t* overflow)
+{
+    std::size_t           words = (count + 63) / 64;
+    std::vector<uint64_t> high(words), low(words);
+    compare(CompareOp::GE, values, DecimalPow10[precision], count, high.data());
+    compare(CompareOp::LE, values, -DecimalPow10[precision], count, low.data());
+    bitmap_or(high.data(), low.data(), count, high.data());
+
+    bool any = bitmap_count(high.data(), count) != 0;
+    if (overflow) bitmap_or(overflow, high.data(), count, overflow);
+    return any;
+}
+
+bool decimal_arith(ArithOp op, const int64_t* a, int a_scale, const int64_t* b, int b_scale, std::size_t count,
+    int precision, int scale, int64_t* out, uint64_t* overflow)
+{
+    if ((op == ArithOp::ADD || op == ArithOp::SUB) && a_scale == scale && b_scale == scale &&
+        decimal_type_valid(precision, scale))
+    {
+        bool any = arith(op, a, b, count, out, overflow);
+        return decimal_check_precision(out, count, precision, overflow) || any;
+    }
+
+    uint64_t any = 0;
+    for (std::size_t w = 0; w * 64 < count; ++w)
+    {
+        std::size_t end  = w * 64 + 64 < count ? w * 64 + 64 : count;
+        uint64_t    word = 0;
+        for (std::size_t i = w * 64; i < end; ++i)
+        {
+            RC rc;
+            decimal_arith(op, a[i], a_scale, b[i], b_scale, precision, scale, out[i], rc);
+            if (rc != RC::SUCCESS)
+            {
+                out[i] = 0;
+                word |= uint64_t(1) << (i % 64);
+            }
+        }
+        if (overflow) overflow[w] = word;
+        any |= word;
+    }
+    return any != 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "kernels.h"
+
+enum class RC;
+
+/*
+ * BIGINTS与DECIMALS的解析、格式化与算术。
+ *
+ * DECIMAL(p, s)以放大10^s倍的int64_t保存，1 <= p <= 18，0 <= s <= p，|值| < 10^p。
+ * 乘除与不同标度之间的运算在128位整数中完成，结果按四舍五入（远离零）缩放到目标标度后再检查精度。
+ * 求和使用128位整数累加，不会溢出，也不需要任意精度运算。
+ * 溢出或超出精度时rc为RC::INVALID_ARGUMENT。
+ */
+
+/**
+ * @brief DECIMAL的最大精度
+ */
+constexpr int MaxDecimalPrecision = 18;
+
+/**
+ * @brief 格式化缓冲区大小：符号、38位数字、小数点与前导0
+ */
+constexpr std::size_t MaxNumberStrLen = 42;
+
+/**
+ * @brief 10的幂，下标为0~18
+ */
+extern const int64_t DecimalPow10[MaxDecimalPrecision + 1];
+
+/**
+ * @brief 检查精度与标度是否合法
+ */
+bool decimal_type_valid(int precision, int scale);
+
+/**
+ * @brief 值是否在精度范围内，即|value| < 10^precision
+ */
+inline bool decimal_fits(int64_t value, int precision)
+{
+    return value < DecimalPow10[precision] && value > -DecimalPow10[precision];
+}
+
+/**
+ * @brief 解析64位整数
+ *
+ * 接受可选的正负号与十进制数字，不接受空白。
+ */
+void parse_bigint(const char* str, std::size_t len, int64_t& out, RC& rc);
+
+/**
+ * @brief 解析定点小数
+ *
+ * 接受"[+-]digits[.digits]"，小数位多于scale时四舍五入。
+ *
+ * @param out 输出放大10^scale倍后的整数
+ */
+void parse_decimal(const char* str, std::size_t len, int precision, int scale, int64_t& out, RC& rc);
+
+/**
+ * @brief 格式化64位整数
+ *
+ * @param buf 至少MaxNumberStrLen字节，不写结尾的'\0'
+ * @return 写入的字节数
+ */
+std::size_t format_bigint(int64_t value, char* buf);
+
+/**
+ * @brief 格式化定点小数，总是输出scale位小数
+ */
+std::size_t format_decimal(int64_t value, int scale, char* buf);
+
+/**
+ * @brief 格式化128位定点小数，用于求和结果
+ */
+std::size_t format_decimal(int128_t value, int scale, char* buf);
+
+/**
+ * @brief 缩放到新的标度
+ */
+void decimal_rescale(int64_t value, int from_scale, int to_scale, int precision, int64_t& out, RC& rc);
+
+/**
+ * @brief 比较两个标度可以不同的定点小数
+ *
+ * @return 小于、等于、大于时分别返回负数、0、正数
+ */
+int decimal_compare(int64_t a, int a_scale, int64_t b, int b_scale);
+
+/**
+ * @brief 单行定点小数运算
+ *
+ * @param precision 结果精度
+ * @param scale 结果标度
+ */
+void decimal_arith(ArithOp op, int64_t a, int a_scale, int64_t b, int b_scale, int precision, int scale,
+    int64_t& out, RC& rc);
+
+/**
+ * @brief 按列定点小数运算
+ *
+ * 加减法且三个标度相同时直接使用64位整数内核再批量检查精度；其余情况逐行计算。
+ *
+ * @param overflow 输出位图，第i位为1表示第i行溢出或超出精度，可为nullptr
+ * @return 是否有任意一行溢出
+ */
+bool decimal_arith(ArithOp op, const int64_t* a, int a_scale, const int64_t* b, int b_scale, std::size_t count,
+    int precision, int scale, int64_t* out, uint64_t* overflow);
+
+/**
+ * @brief 把超出精度的行合并到溢出位图中
+ *
+ * @return 是否有任意一行超出精度
+ */
+bool decimal_check_precision(const int64_t* values, std::size_t count, int precision, uint64_t* overflow);
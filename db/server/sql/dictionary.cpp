@@ -0,0 +1,186 @@
+#include "dictionary.h"
+#include <algorithm>
+#include <numeric>
+#include "hash.h"
+#include "ret.h"
+
+uint32_t StringDictionary::intern(const char* str, std::size_t len, RC& rc)
+{
+    rc      = RC::SUCCESS;
+    auto it = index_.find(std::string_view(str, len));
+    if (it != index_.end()) return it->second;
+
+    if (strings_.size() >= MaxSize)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return NotFound;
+    }
+
+    std::string_view stored(arena_.copy(str, len), len);
+    if (!strings_.empty() && !(strings_.back() < stored)) sorted_ = false;
+
+    uint32_t code = static_cast<uint32_t>(strings_.size());
+    strings_.push_back(stored);
+    hashes_.push_back(hash_bytes(str, len));
+    index_.emplace(stored, code);
+    return code;
+}
+
+uint32_t StringDictionary::find(const char* str, std::size_t len) const
+{
+    auto it = index_.find(std::string_view(str, len));
+    return it == index_.end() ? NotFound : it->second;
+}
+
+/**
+ * @brief 按字符串排序并重新编号
+ *
+ * 只交换视图与哈希值，字符串数据不移动。
+ */
+void StringDictionary::sort(std::vector<uint32_t>& remap)
+{
+    std::vector<uint32_t> order(strings_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return strings_[a] < strings_[b]; });
+
+    std::vector<std::string_view> strings(strings_.size());
+    std::vector<uint64_t>         hashes(hashes_.size());
+    remap.resize(strings_.size());
+    for (uint32_t code = 0; code < order.size(); ++code)
+    {
+        strings[code]      = strings_[order[code]];
+        hashes[code]       = hashes_[order[code]];
+        remap[order[code]] = code;
+    }
+    strings_.swap(strings);
+    hashes_.swap(hashes);
+    for (auto& entry : index_) entry.second = remap[entry.second];
+    sorted_ = true;
+}
+
+uint32_t StringDictionary::lower_bound(std::string_view str) const
+{
+    return static_cast<uint32_t>(std::lower_bound(strings_.begin(), strings_.end(), str) - strings_.begin());
+}
+
+uint32_t StringDictionary::upper_bound(std::string_view str) const
+{
+    return static_cast<uint32_t>(std::upper_bound(strings_.begin(), strings_.end(), str) - strings_.begin());
+}
+
+/**
+ * @brief 把"列 op 常量"转换为"编码 code_op code"
+ *
+ * 编码总是非负的，"< 0"恒假、">= 0"恒真。
+ * 有序字典中，LT与GE以lower_bound为界，LE与GT以upper_bound为界。
+ */
+void StringDictionary::translate_predicate(
+    CompareOp op, const char* str, std::size_t len, CompareOp& code_op, int& code, RC& rc) const
+{
+    rc = RC::SUCCESS;
+    std::string_view value(str, len);
+    switch (op)
+    {
+        case CompareOp::EQ:
+        case CompareOp::NE:
+        {
+            uint32_t found = find(str, len);
+            if (found == NotFound)
+            {
+                code_op = op == CompareOp::EQ ? CompareOp::LT : CompareOp::GE;
+                code    = 0;
+                return;
+            }
+            code_op = op;
+            code    = static_cast<int>(found);
+            return;
+        }
+        default: break;
+    }
+
+    if (!sorted_)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    switch (op)
+    {
+        case CompareOp::LT: code_op = CompareOp::LT, code = static_cast<int>(lower_bound(value)); return;
+        case CompareOp::LE: code_op = CompareOp::LT, code = static_cast<int>(upper_bound(value)); return;
+        case CompareOp::GT: code_op = CompareOp::GE, code = static_cast<int>(upper_bound(value)); return;
+        default: code_op = CompareOp::GE, code = static_cast<int>(lower_bound(value)); return;
+    }
+}
+
+void StringDictionary::translate(const StringDictionary& other, std::vector<uint32_t>& mapping) const
+{
+    mapping.resize(other.size());
+    for (uint32_t code = 0; code < other.size(); ++code)
+    {
+        std::string_view str = other.decode(code);
+        mapping[code]        = find(str.data(), str.size());
+    }
+}
+
+/**
+ * @brief 构造函数
+ *
+ * @param dictionary 共享的字典，为nullptr时新建一个
+ * @param capacity 最大行数
+ */
+DictVector::DictVector(std::shared_ptr<StringDictionary> dictionary, std::size_t capacity)
+    : ColumnBase(CHARS, capacity),
+      dictionary_(dictionary ? std::move(dictionary) : std::make_shared<StringDictionary>()),
+      codes_(new uint32_t[capacity]())
+{}
+
+void DictVector::set_str(std::size_t row, const char* str, std::size_t len, RC& rc)
+{
+    uint32_t code = dictionary_->intern(str, len, rc);
+    if (rc != RC::SUCCESS) return;
+    codes_[row] = code;
+    validity_.set_valid(row);
+}
+
+void DictVector::remap(const std::vector<uint32_t>& remap, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i) codes_[i] = remap[codes_[i]];
+}
+
+void DictVector::get_value(std::size_t row, Value& value, RC& rc) const
+{
+    if (!validity_.is_valid(row))
+    {
+        value = Value();
+        rc    = RC::SUCCESS;
+        return;
+    }
+    std::string_view str = dictionary_->decode(codes_[row]);
+    value.set_str_ref(str, rc);
+}
+
+void DictVector::set_value(std::size_t row, const Value& value, RC& rc)
+{
+    if (value.attr_type() == UNDEFINED)
+    {
+        validity_.set_invalid(row);
+        rc = RC::SUCCESS;
+        return;
+    }
+
+    std::string_view str = value.get_str(rc);
+    if (rc != RC::SUCCESS) return;
+    set_str(row, str.data(), str.size(), rc);
+}
+
+void compare(CompareOp op, const DictVector& column, const char* str, std::size_t len, std::size_t count,
+    uint64_t* out, RC& rc)
+{
+    CompareOp code_op;
+    int       code;
+    column.dictionary()->translate_predicate(op, str, len, code_op, code, rc);
+    if (rc != RC::SUCCESS) return;
+
+    // 编码不超过INT32_MAX，按int解释不改变大小关系
+    compare(code_op, reinterpret_cast<const int*>(column.codes()), code, count, out);
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "arena.h"
+#include "column.h"
+#include "kernels.h"
+
+enum class RC;
+
+/*
+ * CHARS列的字典编码。
+ *
+ * 每个不同的字符串只在字典中保存一份，列中保存32位编码。编码从0开始连续分配，
+ * GROUP BY可以直接用编码作数组下标；字典有序时编码的大小关系与字符串一致，
+ * 等值与范围谓词都转换为一次整数比较，由kernels.h中的内核按列完成。
+ * 只在输出时才把编码解码为字符串。
+ */
+
+/**
+ * @brief 字符串字典
+ *
+ * 字符串保存在内部的StringArena中，decode返回的视图在字典析构前一直有效。
+ * 同时缓存每个字符串的hash_bytes，使编码列的哈希值与未编码列一致。非线程安全。
+ */
+class StringDictionary
+{
+  public:
+    static constexpr uint32_t NotFound = UINT32_MAX;  ///< find找不到时的返回值
+    static constexpr uint32_t MaxSize  = INT32_MAX;   ///< 编码作为int参与比较，不能超过INT32_MAX
+
+    StringDictionary() = default;
+
+    StringDictionary(const StringDictionary&)            = delete;
+    StringDictionary& operator=(const StringDictionary&) = delete;
+
+    /**
+     * @brief 取得字符串的编码，不存在时追加
+     *
+     * 追加的字符串大于已有的全部字符串时字典保持有序，否则变为无序。
+     *
+     * @param rc 字典已满时为RC::INVALID_ARGUMENT
+     */
+    uint32_t intern(const char* str, std::size_t len, RC& rc);
+
+    /**
+     * @brief 查找字符串的编码
+     *
+     * @return 不存在时返回NotFound
+     */
+    uint32_t find(const char* str, std::size_t len) const;
+
+    std::string_view decode(uint32_t code) const { return strings_[code]; }
+    uint64_t         hash(uint32_t code) const { return hashes_[code]; }
+    const uint64_t*  hashes() const { return hashes_.data(); }
+    std::size_t      size() const { return strings_.size(); }
+
+    /**
+     * @brief 编码顺序是否与字符串的字节序一致
+     */
+    bool sorted() const { return sorted_; }
+
+    /**
+     * @brief 按字符串排序并重新编号
+     *
+     * 已编码的列需要用remap更新，见DictVector::remap。
+     *
+     * @param remap 输出，remap[旧编码] = 新编码
+     */
+    void sort(std::vector<uint32_t>& remap);
+
+    /**
+     * @brief 把"列 op 常量"转换为"编码 code_op code"
+     *
+     * EQ与NE总能转换，常量不在字典中时转换为恒假或恒真的比较；
+     * 范围比较要求字典有序，否则rc为RC::INVALID_ARGUMENT，调用者应解码后比较。
+     */
+    void translate_predicate(
+        CompareOp op, const char* str, std::size_t len, CompareOp& code_op, int& code, RC& rc) const;
+
+    /**
+     * @brief 建立另一个字典到本字典的编码映射，用于两列字典不同时按编码连接
+     *
+     * @param mapping 输出，mapping[other的编码] = 本字典的编码，不存在时为NotFound
+     */
+    void translate(const StringDictionary& other, std::vector<uint32_t>& mapping) const;
+
+  private:
+    /**
+     * @brief 第一个不小于str的编码，要求字典有序
+     */
+    uint32_t lower_bound(std::string_view str) const;
+
+    /**
+     * @brief 第一个大于str的编码，要求字典有序
+     */
+    uint32_t upper_bound(std::string_view str) const;
+
+    StringArena                                    arena_;          ///< 字符串数据
+    std::vector<std::string_view>                  strings_;        ///< 编码到字符串
+    std::vector<uint64_t>                          hashes_;         ///< 编码到字符串哈希值
+    std::unordered_map<std::string_view, uint32_t> index_;          ///< 字符串到编码
+    bool                                           sorted_ = true;  ///< 编码是否保序
+};
+
+/**
+ * @brief 字典编码的CHARS列
+ *
+ * type()为CHARS，dictionary()不为空；数据是编码数组而不是字符串，
+ * 不能当作ColumnVector<CHARS>访问。多个列可以共享同一个字典。
+ */
+class DictVector : public ColumnBase
+{
+  public:
+    explicit DictVector(
+        std::shared_ptr<StringDictionary> dictionary = nullptr, std::size_t capacity = VectorCapacity);
+
+    uint32_t*       codes() { return codes_.get(); }
+    const uint32_t* codes() const { return codes_.get(); }
+
+    const StringDictionary*           dictionary() const override { return dictionary_.get(); }
+    std::shared_ptr<StringDictionary> shared_dictionary() const { return dictionary_; }
+
+    /**
+     * @brief 写入一个字符串，不在字典中时追加到字典
+     */
+    void set_str(std::size_t row, const char* str, std::size_t len, RC& rc);
+
+    /**
+     * @brief 字典重新编号后更新前count行的编码
+     */
+    void remap(const std::vector<uint32_t>& remap, std::size_t count);
+
+    /**
+     * @brief 读取一行，字符串指向字典，不复制
+     */
+    void get_value(std::size_t row, Value& value, RC& rc) const override;
+    void set_value(std::size_t row, const Value& value, RC& rc) override;
+
+  private:
+    std::shared_ptr<StringDictionary> dictionary_;  ///< 字典
+    std::unique_ptr<uint32_t[]>       codes_;       ///< 编码
+};
+
+/**
+ * @brief 字典编码列与字符串常量比较
+ *
+ * 先用translate_predicate把谓词转换为编码比较，再调用整数比较内核。
+ *
+ * @param out 输出位图，第i位为第i行的比较结果，不考虑NULL
+ * @param rc 字典无序且op为范围比较时为RC::INVALID_ARGUMENT
+ */
+void compare(CompareOp op, const DictVector& column, const char* str, std::size_t len, std::size_t count,
+    uint64_t* out, RC& rc);
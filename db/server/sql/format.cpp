@@ -0,0 +1,152 @@
+#include "format.h"
+#include <cstring>
+#include <string_view>
+#include "Trans/date.h"
+#include "Trans/number.h"
+#include "column.h"
+#include "decimal.h"
+#include "dictionary.h"
+#include "ret.h"
+
+static constexpr std::string_view NullText = "NULL";
+
+/**
+ * @brief 定长类型格式化后的最大长度
+ */
+template <AttrType Type>
+static constexpr std::size_t max_width()
+{
+    if constexpr (Type == INTS) return MaxIntStrLen;
+    if constexpr (Type == FLOATS) return MaxFloatStrLen;
+    if constexpr (Type == DATES) return MaxDateStrLen;
+    if constexpr (Type == BOOLEANS) return 5;
+    if constexpr (Type == BIGINTS) return MaxBigIntStrLen;
+    return MaxNumberStrLen;
+}
+
+/**
+ * @brief 格式化一个定长类型的值
+ *
+ * @param scale DECIMALS的标度
+ * @return 写入的字节数
+ */
+template <AttrType Type, class T>
+static std::size_t format_one(T value, int scale, char* out)
+{
+    if constexpr (Type == INTS) return Int2Str(value, out);
+    if constexpr (Type == FLOATS) return Float2Str(value, out);
+    if constexpr (Type == DATES) return IntDate2StrDate(value, out);
+    if constexpr (Type == BIGINTS) return BigInt2Str(value, out);
+    if constexpr (Type == DECIMALS) return format_decimal(static_cast<int64_t>(value), scale, out);
+    if constexpr (Type == BOOLEANS)
+    {
+        std::string_view text = value ? "true" : "false";
+        memcpy(out, text.data(), text.size());
+        return text.size();
+    }
+}
+
+/**
+ * @brief 定长类型列：先按最大长度预留空间，写完再截断
+ */
+template <AttrType Type>
+static void format_fixed(const ColumnBase& base, const uint32_t* sel, std::size_t count, std::string& buf,
+    std::vector<std::size_t>& offsets)
+{
+    constexpr std::size_t width = max_width<Type>() > NullText.size() ? max_width<Type>() : NullText.size();
+
+    const auto&         column   = static_cast<const ColumnVector<Type>&>(base);
+    const ValidityMask& validity = column.validity();
+    std::size_t         pos      = buf.size();
+    buf.resize(pos + count * width);
+    char* out = buf.data();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t row = sel ? sel[i] : i;
+        offsets[i]      = pos;
+        if (validity.is_valid(row))
+            pos += format_one<Type>(column[row], column.scale(), out + pos);
+        else
+        {
+            memcpy(out + pos, NullText.data(), NullText.size());
+            pos += NullText.size();
+        }
+    }
+    offsets[count] = pos;
+    buf.resize(pos);
+}
+
+/**
+ * @brief CHARS列：直接复制，字典编码列从字典中取
+ */
+static void format_chars(const ColumnBase& column, const uint32_t* sel, std::size_t count, std::string& buf,
+    std::vector<std::size_t>& offsets)
+{
+    const StringDictionary* dictionary = column.dictionary();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t row = sel ? sel[i] : i;
+        offsets[i]      = buf.size();
+        if (!column.validity().is_valid(row))
+            buf.append(NullText);
+        else if (dictionary)
+            buf.append(dictionary->decode(static_cast<const DictVector&>(column).codes()[row]));
+        else
+            buf.append(static_cast<const ColumnVector<CHARS>&>(column)[row]);
+    }
+    offsets[count] = buf.size();
+}
+
+void format_column(
+    const ColumnBase& column, const uint32_t* sel, std::size_t count, std::string& buf, std::vector<std::size_t>& offsets)
+{
+    offsets.resize(count + 1);
+    switch (column.type())
+    {
+        case CHARS: return format_chars(column, sel, count, buf, offsets);
+        case INTS: return format_fixed<INTS>(column, sel, count, buf, offsets);
+        case FLOATS: return format_fixed<FLOATS>(column, sel, count, buf, offsets);
+        case DATES: return format_fixed<DATES>(column, sel, count, buf, offsets);
+        case BOOLEANS: return format_fixed<BOOLEANS>(column, sel, count, buf, offsets);
+        case BIGINTS: return format_fixed<BIGINTS>(column, sel, count, buf, offsets);
+        case DECIMALS: return format_fixed<DECIMALS>(column, sel, count, buf, offsets);
+        default:
+            for (std::size_t i = 0; i <= count; ++i) offsets[i] = buf.size();
+            return;
+    }
+}
+
+void format_chunk(const DataChunk& chunk, std::vector<std::vector<std::string>>& rows)
+{
+    std::size_t     count = chunk.size();
+    std::size_t     first = rows.size();
+    const uint32_t* sel   = chunk.has_selection() ? chunk.selection().data() : nullptr;
+    rows.resize(first + count, std::vector<std::string>(chunk.column_count()));
+
+    std::string              buf;
+    std::vector<std::size_t> offsets;
+    for (std::size_t c = 0; c < chunk.column_count(); ++c)
+    {
+        buf.clear();
+        format_column(chunk.column(c), sel, count, buf, offsets);
+        for (std::size_t i = 0; i < count; ++i)
+            rows[first + i][c].assign(buf.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+}
+
+void format_value(const Value& value, std::string& out)
+{
+    char buf[MaxNumberStrLen];
+    RC   rc;
+    switch (value.attr_type())
+    {
+        case CHARS: out.append(value.get_str(rc)); return;
+        case INTS: out.append(buf, format_one<INTS>(value.get_int(rc), 0, buf)); return;
+        case FLOATS: out.append(buf, format_one<FLOATS>(value.get_float(rc), 0, buf)); return;
+        case DATES: out.append(buf, format_one<DATES>(value.get_date(rc), 0, buf)); return;
+        case BOOLEANS: out.append(buf, format_one<BOOLEANS>(value.get_bool(rc), 0, buf)); return;
+        case BIGINTS: out.append(buf, format_one<BIGINTS>(value.get_bigint(rc), 0, buf)); return;
+        case DECIMALS: out.append(buf, format_one<DECIMALS>(value.get_decimal(rc), value.scale(), buf)); return;
+        default: out.append(NullText); return;
+    }
+}
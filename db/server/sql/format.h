@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class RC;
+class ColumnBase;
+class DataChunk;
+class Value;
+
+/*
+ * 查询结果的文本格式化。
+ *
+ * 按列一次分派类型，整数、浮点数、日期与定点小数直接写入输出缓冲区，不经过iostream。
+ * NULL输出为"NULL"，BOOLEANS输出为"true"与"false"，FLOATS为最短往返表示。
+ */
+
+/**
+ * @brief 按列格式化，追加到buf
+ *
+ * @param column 列向量
+ * @param sel 选择向量，为nullptr时依次处理第0~count-1行
+ * @param count 行数
+ * @param buf 输出缓冲区，文本追加在已有内容之后
+ * @param offsets 输出count + 1项，第i行为buf[offsets[i], offsets[i + 1])
+ */
+void format_column(
+    const ColumnBase& column, const uint32_t* sel, std::size_t count, std::string& buf, std::vector<std::size_t>& offsets);
+
+/**
+ * @brief 把一批数据的全部逻辑行格式化为字符串表格，追加到rows
+ *
+ * 每列格式化到同一个缓冲区后再切分，用于填充SqlQueryResult::results。
+ */
+void format_chunk(const DataChunk& chunk, std::vector<std::vector<std::string>>& rows);
+
+/**
+ * @brief 格式化单个值，追加到out
+ */
+void format_value(const Value& value, std::string& out);
@@ -0,0 +1,265 @@
+#include "hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "column.h"
+#include "dictionary.h"
+#include "ret.h"
+
+/**
+ * @brief wyhash使用的常数
+ */
+static const uint64_t P0 = 0xa0761d6478bd642full;
+static const uint64_t P1 = 0xe7037ed1a0b428dbull;
+static const uint64_t P2 = 0x8ebc6af09c88c6e3ull;
+static const uint64_t P3 = 0x589965cc75374cc3ull;
+
+/**
+ * @brief 64x64->128位乘法后高低两半异或
+ */
+static inline uint64_t mum(uint64_t a, uint64_t b)
+{
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+static inline uint64_t read8(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t read4(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief 整数哈希
+ *
+ * 一次mum对连续整数的低位分布不够均匀，再混合一次。
+ */
+uint64_t hash_int(int value) { return mum(mum(static_cast<uint32_t>(value) ^ P0, P1) ^ P2, P1); }
+
+uint64_t hash_int64(int64_t value) { return mum(mum(static_cast<uint64_t>(value) ^ P0, P1) ^ P2, P1); }
+
+/**
+ * @brief 浮点数哈希
+ *
+ * 0.0 == -0.0，所以两者按0.0处理；NaN与任何值都不相等，但分组时应归为一组，统一为同一个位模式。
+ */
+uint64_t hash_float(float value)
+{
+    uint32_t bits;
+    if (value == 0.0f)
+        bits = 0;
+    else if (std::isnan(value))
+        bits = 0x7fc00000u;
+    else
+        memcpy(&bits, &value, sizeof(bits));
+    return mum(mum(bits ^ P2, P1) ^ P0, P1);
+}
+
+/**
+ * @brief 定点小数哈希
+ *
+ * 去掉末尾的0得到规范形式，Value::equals认为相等的值规范形式相同。
+ */
+uint64_t hash_decimal(int64_t unscaled, int scale)
+{
+    while (scale > 0 && unscaled % 10 == 0)
+    {
+        unscaled /= 10;
+        --scale;
+    }
+    return hash_combine(hash_int64(unscaled), static_cast<uint64_t>(scale));
+}
+
+/**
+ * @brief 字符串哈希
+ *
+ * 不超过16字节时用至多4次非对齐读取覆盖全部字节，更长时每次吸收16字节，最后16字节总是参与混合。
+ */
+uint64_t hash_bytes(const char* data, std::size_t len)
+{
+    uint64_t seed = P0;
+    uint64_t a, b;
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            std::size_t shift = (len >> 3) << 2;
+            a                 = read4(data) << 32 | read4(data + shift);
+            b                 = read4(data + len - 4) << 32 | read4(data + len - 4 - shift);
+        }
+        else if (len > 0)
+        {
+            a = static_cast<uint64_t>(static_cast<uint8_t>(data[0])) << 16 |
+                static_cast<uint64_t>(static_cast<uint8_t>(data[len >> 1])) << 8 | static_cast<uint8_t>(data[len - 1]);
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        const char* p    = data;
+        std::size_t left = len;
+        while (left > 16)
+        {
+            seed = mum(read8(p) ^ P1, read8(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+        a = read8(data + len - 16);
+        b = read8(data + len - 8);
+    }
+    return mum(P1 ^ len, mum(a ^ P1, b ^ seed));
+}
+
+uint64_t hash_combine(uint64_t hash, uint64_t value) { return mum(hash ^ P3, value ^ P0); }
+
+uint64_t hash_value(const Value& value)
+{
+    RC rc;
+    switch (value.attr_type())
+    {
+        case CHARS:
+        {
+            std::string_view str = value.get_str(rc);
+            return hash_bytes(str.data(), str.size());
+        }
+        case INTS: return hash_int(value.get_int(rc));
+        case DATES: return hash_int(value.get_date(rc));
+        case FLOATS: return hash_float(value.get_float(rc));
+        case BOOLEANS: return hash_int(value.get_bool(rc));
+        case BIGINTS: return hash_int64(value.get_bigint(rc));
+        case DECIMALS: return hash_decimal(value.get_decimal(rc), value.scale());
+        default: return NullHash;
+    }
+}
+
+/**
+ * @brief 单值哈希
+ */
+static inline uint64_t hash_one(int value) { return hash_int(value); }
+static inline uint64_t hash_one(int64_t value) { return hash_int64(value); }
+static inline uint64_t hash_one(float value) { return hash_float(value); }
+static inline uint64_t hash_one(bool value) { return hash_int(value); }
+static inline uint64_t hash_one(std::string_view value) { return hash_bytes(value.data(), value.size()); }
+
+/**
+ * @brief 按列计算哈希值
+ *
+ * 全部行有效且没有选择向量时走无分支的紧凑循环；否则逐行检查有效性。
+ *
+ * @tparam Combine 为true时合并到已有的哈希值中
+ */
+template <bool Combine, AttrType Type>
+static void hash_typed(const ColumnVector<Type>& column, const uint32_t* sel, std::size_t count, uint64_t* hashes)
+{
+    const auto*         data     = column.data();
+    const ValidityMask& validity = column.validity();
+
+    if (!sel && validity.all_valid(count))
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint64_t h = hash_one(data[i]);
+            hashes[i]  = Combine ? hash_combine(hashes[i], h) : h;
+        }
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t row = sel ? sel[i] : i;
+        uint64_t    h   = validity.is_valid(row) ? hash_one(data[row]) : NullHash;
+        hashes[i]       = Combine ? hash_combine(hashes[i], h) : h;
+    }
+}
+
+/**
+ * @brief DECIMALS列按规范形式哈希，标度取自列
+ */
+template <bool Combine>
+static void hash_decimals(const ColumnVector<DECIMALS>& column, const uint32_t* sel, std::size_t count,
+                          uint64_t* hashes)
+{
+    const int64_t*      data     = column.data();
+    const ValidityMask& validity = column.validity();
+    int                 scale    = column.scale();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t row = sel ? sel[i] : i;
+        uint64_t    h   = validity.is_valid(row) ? hash_decimal(data[row], scale) : NullHash;
+        hashes[i]       = Combine ? hash_combine(hashes[i], h) : h;
+    }
+}
+
+/**
+ * @brief 字典编码列的哈希值直接取自字典缓存，不访问字符串
+ */
+template <bool Combine>
+static void hash_codes(const DictVector& column, const uint32_t* sel, std::size_t count, uint64_t* hashes)
+{
+    const uint32_t*     codes    = column.codes();
+    const uint64_t*     cached   = column.dictionary()->hashes();
+    const ValidityMask& validity = column.validity();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t row = sel ? sel[i] : i;
+        uint64_t    h   = validity.is_valid(row) ? cached[codes[row]] : NullHash;
+        hashes[i]       = Combine ? hash_combine(hashes[i], h) : h;
+    }
+}
+
+template <bool Combine>
+static void hash_dispatch(const ColumnBase& column, const uint32_t* sel, std::size_t count, uint64_t* hashes)
+{
+    if (column.dictionary())
+        return hash_codes<Combine>(static_cast<const DictVector&>(column), sel, count, hashes);
+
+    switch (column.type())
+    {
+        case CHARS:
+            return hash_typed<Combine>(static_cast<const ColumnVector<CHARS>&>(column), sel, count, hashes);
+        case INTS: return hash_typed<Combine>(static_cast<const ColumnVector<INTS>&>(column), sel, count, hashes);
+        case FLOATS:
+            return hash_typed<Combine>(static_cast<const ColumnVector<FLOATS>&>(column), sel, count, hashes);
+        case DATES: return hash_typed<Combine>(static_cast<const ColumnVector<DATES>&>(column), sel, count, hashes);
+        case BOOLEANS:
+            return hash_typed<Combine>(static_cast<const ColumnVector<BOOLEANS>&>(column), sel, count, hashes);
+        case BIGINTS:
+            return hash_typed<Combine>(static_cast<const ColumnVector<BIGINTS>&>(column), sel, count, hashes);
+        case DECIMALS:
+            return hash_decimals<Combine>(static_cast<const ColumnVector<DECIMALS>&>(column), sel, count, hashes);
+        default: break;
+    }
+}
+
+void hash_column(const ColumnBase& column, const uint32_t* sel, std::size_t count, uint64_t* hashes)
+{
+    hash_dispatch<false>(column, sel, count, hashes);
+}
+
+void combine_hash_column(const ColumnBase& column, const uint32_t* sel, std::size_t count, uint64_t* hashes)
+{
+    hash_dispatch<true>(column, sel, count, hashes);
+}
+
+void hash_chunk(const DataChunk& chunk, const std::vector<std::size_t>& keys, uint64_t* hashes)
+{
+    const uint32_t* sel   = chunk.has_selection() ? chunk.selection().data() : nullptr;
+    std::size_t     count = chunk.size();
+    if (keys.empty())
+    {
+        std::fill_n(hashes, count, P0);
+        return;
+    }
+    hash_column(chunk.column(keys[0]), sel, count, hashes);
+    for (std::size_t k = 1; k < keys.size(); ++k) combine_hash_column(chunk.column(keys[k]), sel, count, hashes);
+}
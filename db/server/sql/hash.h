@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Value;
+class ColumnBase;
+class DataChunk;
+
+/*
+ * 哈希连接、GROUP BY与DISTINCT使用的键哈希。
+ *
+ * 数值使用wyhash式的128位乘法混合，字符串按wyhash的方式每次吸收16字节。
+ * FLOATS在哈希前规范化：-0.0与0.0、所有NaN分别得到相同的哈希值。
+ * NULL得到固定的NullHash。字典编码列使用字典缓存的字符串哈希值，与未编码的CHARS列一致，两者可以直接连接。
+ * BIGINTS按64位整数哈希。DECIMALS的相等与标度无关，先去掉放大后整数末尾的0再与剩余的标度一起哈希，
+ * 1.50与1.5得到相同的哈希值。
+ * 按列计算的结果与对同一行的Value调用hash_value完全一致。
+ */
+
+/**
+ * @brief NULL的哈希值
+ */
+constexpr uint64_t NullHash = 0x6a09e667f3bcc908ull;
+
+uint64_t hash_int(int value);
+uint64_t hash_int64(int64_t value);
+uint64_t hash_float(float value);
+
+/**
+ * @brief 定点小数哈希，按规范形式计算，与标度无关
+ *
+ * @param unscaled 放大10^scale倍后的整数
+ */
+uint64_t hash_decimal(int64_t unscaled, int scale);
+uint64_t hash_bytes(const char* data, std::size_t len);
+
+/**
+ * @brief 把一列的哈希值合并到已有的哈希值中，不满足交换律，列的顺序有意义
+ */
+uint64_t hash_combine(uint64_t hash, uint64_t value);
+
+/**
+ * @brief 单个Value的哈希值
+ *
+ * UNDEFINED视为NULL。
+ */
+uint64_t hash_value(const Value& value);
+
+/**
+ * @brief 计算一列前count行的哈希值
+ *
+ * @param column 列向量
+ * @param sel 选择向量，为nullptr时依次处理第0~count-1行，否则处理sel[0]~sel[count-1]行
+ * @param count 行数
+ * @param hashes 输出，第i个为第i个逻辑行的哈希值
+ */
+void hash_column(const ColumnBase& column, const uint32_t* sel, std::size_t count, uint64_t* hashes);
+
+/**
+ * @brief 计算一列的哈希值并合并到hashes中
+ */
+void combine_hash_column(const ColumnBase& column, const uint32_t* sel, std::size_t count, uint64_t* hashes);
+
+/**
+ * @brief 计算多列键的哈希值，不物化元组
+ *
+ * 没有键列时每行的哈希值相同，所有行归为一组。
+ *
+ * @param chunk 批数据，启用选择向量时只处理被选中的行
+ * @param keys 作为键的列号
+ * @param hashes 输出，共chunk.size()个
+ */
+void hash_chunk(const DataChunk& chunk, const std::vector<std::size_t>& keys, uint64_t* hashes);
@@ -0,0 +1,268 @@
+#include "kernels.h"
+#include "kernels_impl.h"
+
+using namespace KernelDetail;
+
+template <CompareOp Op, class T>
+static void compare_scalar(const T* a, const T* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    compare_range<Op>(a, b, const_b, 0, count, out);
+}
+
+static void compare_int_scalar(CompareOp op, const int* a, const int* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_scalar, a, b, const_b, count, out);
+}
+
+static void compare_float_scalar(
+    CompareOp op, const float* a, const float* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_scalar, a, b, const_b, count, out);
+}
+
+static void compare_int64_scalar(
+    CompareOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_scalar, a, b, const_b, count, out);
+}
+
+template <ArithOp Op, class T>
+static bool arith_int_scalar(const T* a, const T* b, bool const_b, std::size_t count, T* out, uint64_t* overflow)
+{
+    return arith_range<Op>(a, b, const_b, 0, count, out, overflow);
+}
+
+static bool arith_int_scalar(
+    ArithOp op, const int* a, const int* b, bool const_b, std::size_t count, int* out, uint64_t* overflow)
+{
+    DISPATCH_ARITH(op, arith_int_scalar, a, b, const_b, count, out, overflow);
+}
+
+static bool arith_int64_scalar(
+    ArithOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, int64_t* out, uint64_t* overflow)
+{
+    DISPATCH_ARITH(op, arith_int_scalar, a, b, const_b, count, out, overflow);
+}
+
+template <ArithOp Op>
+static void arith_float_scalar(const float* a, const float* b, bool const_b, std::size_t count, float* out)
+{
+    arith_range<Op>(a, b, const_b, 0, count, out);
+}
+
+static void arith_float_scalar(ArithOp op, const float* a, const float* b, bool const_b, std::size_t count, float* out)
+{
+    DISPATCH_ARITH(op, arith_float_scalar, a, b, const_b, count, out);
+}
+
+static void bitmap_and_scalar(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out)
+{
+    for (std::size_t i = 0; i < words; ++i) out[i] = a[i] & b[i];
+}
+
+static void bitmap_or_scalar(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out)
+{
+    for (std::size_t i = 0; i < words; ++i) out[i] = a[i] | b[i];
+}
+
+static void bitmap_not_scalar(const uint64_t* a, std::size_t words, uint64_t* out)
+{
+    for (std::size_t i = 0; i < words; ++i) out[i] = ~a[i];
+}
+
+static void bools_to_bitmap_scalar(const bool* a, std::size_t count, uint64_t* out) { bools_range(a, 0, count, out); }
+
+const KernelTable ScalarKernels = {
+    compare_int_scalar,
+    compare_float_scalar,
+    compare_int64_scalar,
+    arith_int_scalar,
+    arith_int64_scalar,
+    arith_float_scalar,
+    bitmap_and_scalar,
+    bitmap_or_scalar,
+    bitmap_not_scalar,
+    bools_to_bitmap_scalar,
+};
+
+/**
+ * @brief CPU支持的最高指令集级别
+ *
+ * AVX-512实现只使用AVX512F与AVX512BW指令。
+ */
+SimdLevel detect_simd_level()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    return SimdLevel::SCALAR;
+}
+
+/**
+ * @brief 各级别对应的函数表
+ */
+static const KernelTable* table_of(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::AVX512: return &Avx512Kernels;
+        case SimdLevel::AVX2: return &Avx2Kernels;
+        default: return &ScalarKernels;
+    }
+}
+
+static SimdLevel          current_level = detect_simd_level();
+static const KernelTable* kernels       = table_of(current_level);
+
+SimdLevel simd_level() { return current_level; }
+
+void set_simd_level(SimdLevel level)
+{
+    SimdLevel supported = detect_simd_level();
+    current_level       = level > supported ? supported : level;
+    kernels             = table_of(current_level);
+}
+
+/**
+ * @brief 清零最后一个字中超出count的位
+ */
+static void clear_tail(std::size_t count, uint64_t* out)
+{
+    if (count % 64) out[count / 64] &= (uint64_t(1) << (count % 64)) - 1;
+}
+
+void compare(CompareOp op, const int* a, const int* b, std::size_t count, uint64_t* out)
+{
+    kernels->compare_int(op, a, b, false, count, out);
+}
+
+void compare(CompareOp op, const float* a, const float* b, std::size_t count, uint64_t* out)
+{
+    kernels->compare_float(op, a, b, false, count, out);
+}
+
+void compare(CompareOp op, const int64_t* a, const int64_t* b, std::size_t count, uint64_t* out)
+{
+    kernels->compare_int64(op, a, b, false, count, out);
+}
+
+void compare(CompareOp op, const int* a, int b, std::size_t count, uint64_t* out)
+{
+    kernels->compare_int(op, a, &b, true, count, out);
+}
+
+void compare(CompareOp op, const float* a, float b, std::size_t count, uint64_t* out)
+{
+    kernels->compare_float(op, a, &b, true, count, out);
+}
+
+void compare(CompareOp op, const int64_t* a, int64_t b, std::size_t count, uint64_t* out)
+{
+    kernels->compare_int64(op, a, &b, true, count, out);
+}
+
+bool arith(ArithOp op, const int* a, const int* b, std::size_t count, int* out, uint64_t* overflow)
+{
+    return kernels->arith_int(op, a, b, false, count, out, overflow);
+}
+
+bool arith(ArithOp op, const int* a, int b, std::size_t count, int* out, uint64_t* overflow)
+{
+    return kernels->arith_int(op, a, &b, true, count, out, overflow);
+}
+
+bool arith(ArithOp op, const int64_t* a, const int64_t* b, std::size_t count, int64_t* out, uint64_t* overflow)
+{
+    return kernels->arith_int64(op, a, b, false, count, out, overflow);
+}
+
+bool arith(ArithOp op, const int64_t* a, int64_t b, std::size_t count, int64_t* out, uint64_t* overflow)
+{
+    return kernels->arith_int64(op, a, &b, true, count, out, overflow);
+}
+
+/**
+ * @brief 64位整数列求和
+ *
+ * 128位加法只是一对add/adc，不需要分块检测溢出；有NULL时按位图逐字处理，全有效的字走无分支循环。
+ */
+int128_t sum(const int64_t* values, const uint64_t* validity, std::size_t count)
+{
+    int128_t total = 0;
+    if (!validity)
+    {
+        for (std::size_t i = 0; i < count; ++i) total += values[i];
+        return total;
+    }
+
+    for (std::size_t w = 0; w * 64 < count; ++w)
+    {
+        std::size_t end  = w * 64 + 64 < count ? w * 64 + 64 : count;
+        uint64_t    word = validity[w];
+        if (end - w * 64 == 64 && word == ~uint64_t(0))
+        {
+            for (std::size_t i = w * 64; i < end; ++i) total += values[i];
+            continue;
+        }
+        for (std::size_t i = w * 64; i < end; ++i)
+            if (word >> (i % 64) & 1) total += values[i];
+    }
+    return total;
+}
+
+void arith(ArithOp op, const float* a, const float* b, std::size_t count, float* out)
+{
+    kernels->arith_float(op, a, b, false, count, out);
+}
+
+void arith(ArithOp op, const float* a, float b, std::size_t count, float* out)
+{
+    kernels->arith_float(op, a, &b, true, count, out);
+}
+
+void bitmap_and(const uint64_t* a, const uint64_t* b, std::size_t count, uint64_t* out)
+{
+    kernels->bitmap_and(a, b, (count + 63) / 64, out);
+}
+
+void bitmap_or(const uint64_t* a, const uint64_t* b, std::size_t count, uint64_t* out)
+{
+    kernels->bitmap_or(a, b, (count + 63) / 64, out);
+}
+
+void bitmap_not(const uint64_t* a, std::size_t count, uint64_t* out)
+{
+    kernels->bitmap_not(a, (count + 63) / 64, out);
+    clear_tail(count, out);
+}
+
+std::size_t bitmap_count(const uint64_t* bitmap, std::size_t count)
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count / 64; ++i) total += __builtin_popcountll(bitmap[i]);
+    if (count % 64) total += __builtin_popcountll(bitmap[count / 64] & ((uint64_t(1) << (count % 64)) - 1));
+    return total;
+}
+
+/**
+ * @brief 位图转选择向量
+ *
+ * 逐个取出最低位的1，耗时与选中的行数成正比。
+ */
+std::size_t bitmap_to_selection(const uint64_t* bitmap, std::size_t count, uint32_t* sel)
+{
+    std::size_t n = 0;
+    for (std::size_t w = 0; w * 64 < count; ++w)
+    {
+        uint64_t word = bitmap[w];
+        if (w * 64 + 64 > count) word &= (uint64_t(1) << (count % 64)) - 1;
+        while (word)
+        {
+            sel[n++] = static_cast<uint32_t>(w * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+    return n;
+}
+
+void bools_to_bitmap(const bool* a, std::size_t count, uint64_t* out) { kernels->bools_to_bitmap(a, count, out); }
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 128位整数，用于64位整数的中间结果与求和
+ */
+__extension__ typedef __int128          int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+/**
+ * @brief 比较运算
+ */
+enum class CompareOp
+{
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+};
+
+/**
+ * @brief 算术运算
+ */
+enum class ArithOp
+{
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+};
+
+/**
+ * @brief 向量化指令集级别
+ */
+enum class SimdLevel
+{
+    SCALAR,
+    AVX2,
+    AVX512,
+};
+
+/*
+ * 数值列的批量计算内核。INTS与DATES使用int版本，BIGINTS与同标度的DECIMALS使用int64_t版本，
+ * FLOATS使用float版本，BOOLEANS先用bools_to_bitmap转为位图再做位运算。
+ *
+ * 位图共(count + 63) / 64个字，第i位对应第i行，最后一个字中超出count的位总是被清零。
+ * 首次调用时按CPU支持的指令集选择AVX-512、AVX2或标量实现，三者结果完全一致。
+ * 内核不处理NULL，调用者应把结果位图与有效性位图做bitmap_and。
+ */
+
+/**
+ * @brief CPU支持的最高指令集级别
+ */
+SimdLevel detect_simd_level();
+
+/**
+ * @brief 当前使用的指令集级别
+ */
+SimdLevel simd_level();
+
+/**
+ * @brief 指定使用的指令集级别，超过CPU支持的级别时降为CPU支持的最高级别
+ *
+ * 用于测试与基准，非线程安全。
+ */
+void set_simd_level(SimdLevel level);
+
+/**
+ * @brief 向量与向量比较
+ *
+ * @param op 比较运算
+ * @param a 左操作数
+ * @param b 右操作数
+ * @param count 行数
+ * @param out 输出位图，第i位为a[i] op b[i]
+ */
+void compare(CompareOp op, const int* a, const int* b, std::size_t count, uint64_t* out);
+void compare(CompareOp op, const float* a, const float* b, std::size_t count, uint64_t* out);
+void compare(CompareOp op, const int64_t* a, const int64_t* b, std::size_t count, uint64_t* out);
+
+/**
+ * @brief 向量与常量比较
+ *
+ * 浮点数比较遵循IEEE 754：NaN参与的比较只有NE为真。
+ *
+ * @param out 输出位图，第i位为a[i] op b
+ */
+void compare(CompareOp op, const int* a, int b, std::size_t count, uint64_t* out);
+void compare(CompareOp op, const float* a, float b, std::size_t count, uint64_t* out);
+void compare(CompareOp op, const int64_t* a, int64_t b, std::size_t count, uint64_t* out);
+
+/**
+ * @brief 整数向量与向量的算术运算
+ *
+ * 溢出行的结果为按补码截断后的值；除数为0的行结果为0，最小值 / -1的结果为最小值，两者都计为溢出。
+ *
+ * @param overflow 输出位图，第i位为1表示第i行溢出，可为nullptr
+ * @return 是否有任意一行溢出
+ */
+bool arith(ArithOp op, const int* a, const int* b, std::size_t count, int* out, uint64_t* overflow);
+bool arith(ArithOp op, const int64_t* a, const int64_t* b, std::size_t count, int64_t* out, uint64_t* overflow);
+
+/**
+ * @brief 整数向量与常量的算术运算
+ */
+bool arith(ArithOp op, const int* a, int b, std::size_t count, int* out, uint64_t* overflow);
+bool arith(ArithOp op, const int64_t* a, int64_t b, std::size_t count, int64_t* out, uint64_t* overflow);
+
+/**
+ * @brief 64位整数列求和
+ *
+ * 以128位累加，2^64行以内不会溢出。
+ *
+ * @param validity 有效性位图，为nullptr时全部行有效
+ */
+int128_t sum(const int64_t* values, const uint64_t* validity, std::size_t count);
+
+/**
+ * @brief 浮点向量的算术运算，遵循IEEE 754，溢出得到无穷大
+ */
+void arith(ArithOp op, const float* a, const float* b, std::size_t count, float* out);
+void arith(ArithOp op, const float* a, float b, std::size_t count, float* out);
+
+/**
+ * @brief 位图按位与、或、非
+ *
+ * @param count 行数
+ */
+void bitmap_and(const uint64_t* a, const uint64_t* b, std::size_t count, uint64_t* out);
+void bitmap_or(const uint64_t* a, const uint64_t* b, std::size_t count, uint64_t* out);
+void bitmap_not(const uint64_t* a, std::size_t count, uint64_t* out);
+
+/**
+ * @brief 位图中为1的位数
+ */
+std::size_t bitmap_count(const uint64_t* bitmap, std::size_t count);
+
+/**
+ * @brief 位图转选择向量
+ *
+ * @param sel 输出为1的行号，至少bitmap_count个
+ * @return 选中的行数
+ */
+std::size_t bitmap_to_selection(const uint64_t* bitmap, std::size_t count, uint32_t* sel);
+
+/**
+ * @brief 布尔数组转位图
+ */
+void bools_to_bitmap(const bool* a, std::size_t count, uint64_t* out);
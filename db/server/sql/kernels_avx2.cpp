@@ -0,0 +1,325 @@
+#include <immintrin.h>
+#include "kernels_impl.h"
+
+/*
+ * AVX2实现：每次处理8行，8次比较的movemask拼成一个64位的位图字。
+ * 整数除法没有向量指令，直接使用标量实现。
+ */
+
+using namespace KernelDetail;
+
+#define AVX2 __attribute__((target("avx2")))
+
+/**
+ * @brief 8行整数比较，返回8位掩码
+ */
+template <CompareOp Op>
+AVX2 static inline unsigned compare8(__m256i a, __m256i b)
+{
+    __m256i mask;
+    bool    negate = Op == CompareOp::NE || Op == CompareOp::LE || Op == CompareOp::GE;
+    if constexpr (Op == CompareOp::EQ || Op == CompareOp::NE) mask = _mm256_cmpeq_epi32(a, b);
+    if constexpr (Op == CompareOp::GT || Op == CompareOp::LE) mask = _mm256_cmpgt_epi32(a, b);
+    if constexpr (Op == CompareOp::LT || Op == CompareOp::GE) mask = _mm256_cmpgt_epi32(b, a);
+    unsigned bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+    return negate ? bits ^ 0xFF : bits;
+}
+
+/**
+ * @brief 8行浮点比较，返回8位掩码
+ */
+template <CompareOp Op>
+AVX2 static inline unsigned compare8(__m256 a, __m256 b)
+{
+    __m256 mask;
+    if constexpr (Op == CompareOp::EQ) mask = _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+    if constexpr (Op == CompareOp::NE) mask = _mm256_cmp_ps(a, b, _CMP_NEQ_UQ);
+    if constexpr (Op == CompareOp::LT) mask = _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    if constexpr (Op == CompareOp::LE) mask = _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+    if constexpr (Op == CompareOp::GT) mask = _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+    if constexpr (Op == CompareOp::GE) mask = _mm256_cmp_ps(a, b, _CMP_GE_OQ);
+    return static_cast<unsigned>(_mm256_movemask_ps(mask));
+}
+
+/**
+ * @brief 4行64位整数比较，返回4位掩码
+ */
+template <CompareOp Op>
+AVX2 static inline unsigned compare4(__m256i a, __m256i b)
+{
+    __m256i mask;
+    bool    negate = Op == CompareOp::NE || Op == CompareOp::LE || Op == CompareOp::GE;
+    if constexpr (Op == CompareOp::EQ || Op == CompareOp::NE) mask = _mm256_cmpeq_epi64(a, b);
+    if constexpr (Op == CompareOp::GT || Op == CompareOp::LE) mask = _mm256_cmpgt_epi64(a, b);
+    if constexpr (Op == CompareOp::LT || Op == CompareOp::GE) mask = _mm256_cmpgt_epi64(b, a);
+    unsigned bits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    return negate ? bits ^ 0xF : bits;
+}
+
+AVX2 static inline __m256i load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+AVX2 static inline __m256i load(const int64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+AVX2 static inline __m256  load(const float* p) { return _mm256_loadu_ps(p); }
+AVX2 static inline __m256i broadcast(const int* p) { return _mm256_set1_epi32(*p); }
+AVX2 static inline __m256i broadcast(const int64_t* p) { return _mm256_set1_epi64x(*p); }
+AVX2 static inline __m256  broadcast(const float* p) { return _mm256_set1_ps(*p); }
+
+template <CompareOp Op, class T>
+AVX2 static void compare_avx2(const T* a, const T* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    std::size_t full = count / 64;
+    auto        vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 8; ++k)
+        {
+            std::size_t i = w * 64 + k * 8;
+            word |= uint64_t(compare8<Op>(load(a + i), const_b ? vb : load(b + i))) << (k * 8);
+        }
+        out[w] = word;
+    }
+    compare_range<Op>(a, b, const_b, full * 64, count, out);
+}
+
+static void compare_int_avx2(CompareOp op, const int* a, const int* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_avx2, a, b, const_b, count, out);
+}
+
+static void compare_float_avx2(
+    CompareOp op, const float* a, const float* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_avx2, a, b, const_b, count, out);
+}
+
+template <CompareOp Op>
+AVX2 static void compare_int64_avx2(const int64_t* a, const int64_t* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    std::size_t full = count / 64;
+    __m256i     vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 16; ++k)
+        {
+            std::size_t i = w * 64 + k * 4;
+            word |= uint64_t(compare4<Op>(load(a + i), const_b ? vb : load(b + i))) << (k * 4);
+        }
+        out[w] = word;
+    }
+    compare_range<Op>(a, b, const_b, full * 64, count, out);
+}
+
+static void compare_int64_avx2(
+    CompareOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_int64_avx2, a, b, const_b, count, out);
+}
+
+/**
+ * @brief 8行整数运算，返回8位溢出掩码
+ *
+ * 加减法的溢出由符号位判断；乘法用两次32x32->64位乘法分别得到偶数行与奇数行的完整乘积，
+ * 高32位不等于低32位的符号扩展即为溢出。
+ */
+template <ArithOp Op>
+AVX2 static inline unsigned arith8(__m256i a, __m256i b, __m256i& out)
+{
+    if constexpr (Op == ArithOp::ADD)
+    {
+        out = _mm256_add_epi32(a, b);
+        __m256i ov = _mm256_and_si256(_mm256_xor_si256(a, out), _mm256_xor_si256(b, out));
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(ov)));
+    }
+    if constexpr (Op == ArithOp::SUB)
+    {
+        out = _mm256_sub_epi32(a, b);
+        __m256i ov = _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(a, out));
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(ov)));
+    }
+    if constexpr (Op == ArithOp::MUL)
+    {
+        out = _mm256_mullo_epi32(a, b);
+        __m256i even    = _mm256_mul_epi32(a, b);
+        __m256i odd     = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        __m256i even_lo = _mm256_shuffle_epi32(_mm256_srai_epi32(even, 31), _MM_SHUFFLE(2, 2, 0, 0));
+        __m256i odd_lo  = _mm256_shuffle_epi32(_mm256_srai_epi32(odd, 31), _MM_SHUFFLE(2, 2, 0, 0));
+        unsigned even_ov =
+            ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(even, even_lo))));
+        unsigned odd_ov =
+            ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(odd, odd_lo))));
+        return ((even_ov >> 1) & 0x55) | (odd_ov & 0xAA);
+    }
+    return 0;
+}
+
+template <ArithOp Op>
+AVX2 static bool arith_int_avx2(
+    const int* a, const int* b, bool const_b, std::size_t count, int* out, uint64_t* overflow)
+{
+    if constexpr (Op == ArithOp::DIV) return arith_range<Op>(a, b, const_b, 0, count, out, overflow);
+
+    std::size_t full = count / 64;
+    uint64_t    any  = 0;
+    __m256i     vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 8; ++k)
+        {
+            std::size_t i = w * 64 + k * 8;
+            __m256i     r;
+            word |= uint64_t(arith8<Op>(load(a + i), const_b ? vb : load(b + i), r)) << (k * 8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+        }
+        if (overflow) overflow[w] = word;
+        any |= word;
+    }
+    return arith_range<Op>(a, b, const_b, full * 64, count, out, overflow) || any;
+}
+
+static bool arith_int_avx2(
+    ArithOp op, const int* a, const int* b, bool const_b, std::size_t count, int* out, uint64_t* overflow)
+{
+    DISPATCH_ARITH(op, arith_int_avx2, a, b, const_b, count, out, overflow);
+}
+
+/**
+ * @brief 64位整数加减法，每次4行
+ *
+ * AVX2没有64x64位乘法，乘除法使用标量实现。
+ */
+template <ArithOp Op>
+AVX2 static bool arith_int64_avx2(
+    const int64_t* a, const int64_t* b, bool const_b, std::size_t count, int64_t* out, uint64_t* overflow)
+{
+    if constexpr (Op == ArithOp::MUL || Op == ArithOp::DIV)
+        return arith_range<Op>(a, b, const_b, 0, count, out, overflow);
+
+    std::size_t full = count / 64;
+    uint64_t    any  = 0;
+    __m256i     vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 16; ++k)
+        {
+            std::size_t i  = w * 64 + k * 4;
+            __m256i     va = load(a + i);
+            __m256i     vi = const_b ? vb : load(b + i);
+            __m256i     r, ov;
+            if constexpr (Op == ArithOp::ADD)
+            {
+                r  = _mm256_add_epi64(va, vi);
+                ov = _mm256_and_si256(_mm256_xor_si256(va, r), _mm256_xor_si256(vi, r));
+            }
+            else
+            {
+                r  = _mm256_sub_epi64(va, vi);
+                ov = _mm256_and_si256(_mm256_xor_si256(va, vi), _mm256_xor_si256(va, r));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+            word |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(ov))) << (k * 4);
+        }
+        if (overflow) overflow[w] = word;
+        any |= word;
+    }
+    return arith_range<Op>(a, b, const_b, full * 64, count, out, overflow) || any;
+}
+
+static bool arith_int64_avx2(
+    ArithOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, int64_t* out, uint64_t* overflow)
+{
+    DISPATCH_ARITH(op, arith_int64_avx2, a, b, const_b, count, out, overflow);
+}
+
+template <ArithOp Op>
+AVX2 static inline __m256 arith8(__m256 a, __m256 b)
+{
+    if constexpr (Op == ArithOp::ADD) return _mm256_add_ps(a, b);
+    if constexpr (Op == ArithOp::SUB) return _mm256_sub_ps(a, b);
+    if constexpr (Op == ArithOp::MUL) return _mm256_mul_ps(a, b);
+    return _mm256_div_ps(a, b);
+}
+
+template <ArithOp Op>
+AVX2 static void arith_float_avx2(const float* a, const float* b, bool const_b, std::size_t count, float* out)
+{
+    std::size_t full = count / 8 * 8;
+    __m256      vb   = broadcast(b);
+    for (std::size_t i = 0; i < full; i += 8)
+        _mm256_storeu_ps(out + i, arith8<Op>(load(a + i), const_b ? vb : load(b + i)));
+    arith_range<Op>(a, b, const_b, full, count, out);
+}
+
+static void arith_float_avx2(ArithOp op, const float* a, const float* b, bool const_b, std::size_t count, float* out)
+{
+    DISPATCH_ARITH(op, arith_float_avx2, a, b, const_b, count, out);
+}
+
+AVX2 static void bitmap_and_avx2(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(va, vb));
+    }
+    for (; i < words; ++i) out[i] = a[i] & b[i];
+}
+
+AVX2 static void bitmap_or_avx2(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(va, vb));
+    }
+    for (; i < words; ++i) out[i] = a[i] | b[i];
+}
+
+AVX2 static void bitmap_not_avx2(const uint64_t* a, std::size_t words, uint64_t* out)
+{
+    std::size_t i    = 0;
+    __m256i     ones = _mm256_set1_epi32(-1);
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(va, ones));
+    }
+    for (; i < words; ++i) out[i] = ~a[i];
+}
+
+/**
+ * @brief 布尔数组转位图，每次处理32个字节
+ */
+AVX2 static void bools_to_bitmap_avx2(const bool* a, std::size_t count, uint64_t* out)
+{
+    std::size_t full = count / 64;
+    __m256i     zero = _mm256_setzero_si256();
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        __m256i  lo   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + w * 64));
+        __m256i  hi   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + w * 64 + 32));
+        uint32_t zlo  = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, zero)));
+        uint32_t zhi  = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, zero)));
+        out[w]        = ~(uint64_t(zhi) << 32 | zlo);
+    }
+    bools_range(a, full * 64, count, out);
+}
+
+const KernelTable Avx2Kernels = {
+    compare_int_avx2,
+    compare_float_avx2,
+    compare_int64_avx2,
+    arith_int_avx2,
+    arith_int64_avx2,
+    arith_float_avx2,
+    bitmap_and_avx2,
+    bitmap_or_avx2,
+    bitmap_not_avx2,
+    bools_to_bitmap_avx2,
+};
@@ -0,0 +1,315 @@
+#include <immintrin.h>
+#include "kernels_impl.h"
+
+/*
+ * AVX-512实现：每次处理16行，比较指令直接产生16位掩码，4个掩码拼成一个64位的位图字。
+ * 只使用AVX512F与AVX512BW指令。整数除法没有向量指令，直接使用标量实现。
+ */
+
+using namespace KernelDetail;
+
+// GCC的AVX-512头文件用自赋值表示未定义的寄存器值，内联后会误报未初始化
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#define AVX512 __attribute__((target("avx512f,avx512bw")))
+
+/**
+ * @brief 比较运算对应的谓词
+ */
+template <CompareOp Op>
+constexpr int int_predicate()
+{
+    if constexpr (Op == CompareOp::EQ) return _MM_CMPINT_EQ;
+    if constexpr (Op == CompareOp::NE) return _MM_CMPINT_NE;
+    if constexpr (Op == CompareOp::LT) return _MM_CMPINT_LT;
+    if constexpr (Op == CompareOp::LE) return _MM_CMPINT_LE;
+    if constexpr (Op == CompareOp::GT) return _MM_CMPINT_NLE;
+    return _MM_CMPINT_NLT;
+}
+
+template <CompareOp Op>
+constexpr int float_predicate()
+{
+    if constexpr (Op == CompareOp::EQ) return _CMP_EQ_OQ;
+    if constexpr (Op == CompareOp::NE) return _CMP_NEQ_UQ;
+    if constexpr (Op == CompareOp::LT) return _CMP_LT_OQ;
+    if constexpr (Op == CompareOp::LE) return _CMP_LE_OQ;
+    if constexpr (Op == CompareOp::GT) return _CMP_GT_OQ;
+    return _CMP_GE_OQ;
+}
+
+template <CompareOp Op>
+AVX512 static inline __mmask16 compare16(__m512i a, __m512i b)
+{
+    constexpr int predicate = int_predicate<Op>();
+    return _mm512_cmp_epi32_mask(a, b, predicate);
+}
+
+template <CompareOp Op>
+AVX512 static inline __mmask16 compare16(__m512 a, __m512 b)
+{
+    constexpr int predicate = float_predicate<Op>();
+    return _mm512_cmp_ps_mask(a, b, predicate);
+}
+
+template <CompareOp Op>
+AVX512 static inline __mmask8 compare8(__m512i a, __m512i b)
+{
+    constexpr int predicate = int_predicate<Op>();
+    return _mm512_cmp_epi64_mask(a, b, predicate);
+}
+
+AVX512 static inline __m512i load(const int* p) { return _mm512_loadu_si512(p); }
+AVX512 static inline __m512i load(const int64_t* p) { return _mm512_loadu_si512(p); }
+AVX512 static inline __m512  load(const float* p) { return _mm512_loadu_ps(p); }
+AVX512 static inline __m512i broadcast(const int* p) { return _mm512_set1_epi32(*p); }
+AVX512 static inline __m512i broadcast(const int64_t* p) { return _mm512_set1_epi64(*p); }
+AVX512 static inline __m512  broadcast(const float* p) { return _mm512_set1_ps(*p); }
+
+template <CompareOp Op, class T>
+AVX512 static void compare_avx512(const T* a, const T* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    std::size_t full = count / 64;
+    auto        vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+            std::size_t i = w * 64 + k * 16;
+            word |= uint64_t(compare16<Op>(load(a + i), const_b ? vb : load(b + i))) << (k * 16);
+        }
+        out[w] = word;
+    }
+    compare_range<Op>(a, b, const_b, full * 64, count, out);
+}
+
+static void compare_int_avx512(
+    CompareOp op, const int* a, const int* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_avx512, a, b, const_b, count, out);
+}
+
+static void compare_float_avx512(
+    CompareOp op, const float* a, const float* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_avx512, a, b, const_b, count, out);
+}
+
+template <CompareOp Op>
+AVX512 static void compare_int64_avx512(
+    const int64_t* a, const int64_t* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    std::size_t full = count / 64;
+    __m512i     vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 8; ++k)
+        {
+            std::size_t i = w * 64 + k * 8;
+            word |= uint64_t(compare8<Op>(load(a + i), const_b ? vb : load(b + i))) << (k * 8);
+        }
+        out[w] = word;
+    }
+    compare_range<Op>(a, b, const_b, full * 64, count, out);
+}
+
+static void compare_int64_avx512(
+    CompareOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, uint64_t* out)
+{
+    DISPATCH_COMPARE(op, compare_int64_avx512, a, b, const_b, count, out);
+}
+
+/**
+ * @brief 16行整数运算，返回16位溢出掩码
+ *
+ * 判断方法与AVX2实现相同。
+ */
+template <ArithOp Op>
+AVX512 static inline __mmask16 arith16(__m512i a, __m512i b, __m512i& out)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    if constexpr (Op == ArithOp::ADD)
+    {
+        out = _mm512_add_epi32(a, b);
+        return _mm512_cmplt_epi32_mask(_mm512_and_si512(_mm512_xor_si512(a, out), _mm512_xor_si512(b, out)), zero);
+    }
+    if constexpr (Op == ArithOp::SUB)
+    {
+        out = _mm512_sub_epi32(a, b);
+        return _mm512_cmplt_epi32_mask(_mm512_and_si512(_mm512_xor_si512(a, b), _mm512_xor_si512(a, out)), zero);
+    }
+    if constexpr (Op == ArithOp::MUL)
+    {
+        out = _mm512_mullo_epi32(a, b);
+        __m512i   even    = _mm512_mul_epi32(a, b);
+        __m512i   odd     = _mm512_mul_epi32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+        __m512i   even_lo = _mm512_shuffle_epi32(_mm512_srai_epi32(even, 31), _MM_PERM_CCAA);
+        __m512i   odd_lo  = _mm512_shuffle_epi32(_mm512_srai_epi32(odd, 31), _MM_PERM_CCAA);
+        __mmask16 even_ov = _mm512_cmpneq_epi32_mask(even, even_lo);
+        __mmask16 odd_ov  = _mm512_cmpneq_epi32_mask(odd, odd_lo);
+        return ((even_ov >> 1) & 0x5555) | (odd_ov & 0xAAAA);
+    }
+    return 0;
+}
+
+template <ArithOp Op>
+AVX512 static bool arith_int_avx512(
+    const int* a, const int* b, bool const_b, std::size_t count, int* out, uint64_t* overflow)
+{
+    if constexpr (Op == ArithOp::DIV) return arith_range<Op>(a, b, const_b, 0, count, out, overflow);
+
+    std::size_t full = count / 64;
+    uint64_t    any  = 0;
+    __m512i     vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+            std::size_t i = w * 64 + k * 16;
+            __m512i     r;
+            word |= uint64_t(arith16<Op>(load(a + i), const_b ? vb : load(b + i), r)) << (k * 16);
+            _mm512_storeu_si512(out + i, r);
+        }
+        if (overflow) overflow[w] = word;
+        any |= word;
+    }
+    return arith_range<Op>(a, b, const_b, full * 64, count, out, overflow) || any;
+}
+
+static bool arith_int_avx512(
+    ArithOp op, const int* a, const int* b, bool const_b, std::size_t count, int* out, uint64_t* overflow)
+{
+    DISPATCH_ARITH(op, arith_int_avx512, a, b, const_b, count, out, overflow);
+}
+
+/**
+ * @brief 64位整数加减法，每次8行
+ *
+ * 64x64位乘法需要AVX512DQ且得不到高位，乘除法使用标量实现。
+ */
+template <ArithOp Op>
+AVX512 static bool arith_int64_avx512(
+    const int64_t* a, const int64_t* b, bool const_b, std::size_t count, int64_t* out, uint64_t* overflow)
+{
+    if constexpr (Op == ArithOp::MUL || Op == ArithOp::DIV)
+        return arith_range<Op>(a, b, const_b, 0, count, out, overflow);
+
+    std::size_t   full = count / 64;
+    uint64_t      any  = 0;
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i       vb   = broadcast(b);
+    for (std::size_t w = 0; w < full; ++w)
+    {
+        uint64_t word = 0;
+        for (std::size_t k = 0; k < 8; ++k)
+        {
+            std::size_t i  = w * 64 + k * 8;
+            __m512i     va = load(a + i);
+            __m512i     vi = const_b ? vb : load(b + i);
+            __m512i     r, ov;
+            if constexpr (Op == ArithOp::ADD)
+            {
+                r  = _mm512_add_epi64(va, vi);
+                ov = _mm512_and_si512(_mm512_xor_si512(va, r), _mm512_xor_si512(vi, r));
+            }
+            else
+            {
+                r  = _mm512_sub_epi64(va, vi);
+                ov = _mm512_and_si512(_mm512_xor_si512(va, vi), _mm512_xor_si512(va, r));
+            }
+            _mm512_storeu_si512(out + i, r);
+            word |= uint64_t(_mm512_cmplt_epi64_mask(ov, zero)) << (k * 8);
+        }
+        if (overflow) overflow[w] = word;
+        any |= word;
+    }
+    return arith_range<Op>(a, b, const_b, full * 64, count, out, overflow) || any;
+}
+
+static bool arith_int64_avx512(
+    ArithOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, int64_t* out, uint64_t* overflow)
+{
+    DISPATCH_ARITH(op, arith_int64_avx512, a, b, const_b, count, out, overflow);
+}
+
+template <ArithOp Op>
+AVX512 static inline __m512 arith16(__m512 a, __m512 b)
+{
+    if constexpr (Op == ArithOp::ADD) return _mm512_add_ps(a, b);
+    if constexpr (Op == ArithOp::SUB) return _mm512_sub_ps(a, b);
+    if constexpr (Op == ArithOp::MUL) return _mm512_mul_ps(a, b);
+    return _mm512_div_ps(a, b);
+}
+
+/**
+ * @brief 浮点运算，尾部用掩码加载与存储，不回退到标量
+ */
+template <ArithOp Op>
+AVX512 static void arith_float_avx512(const float* a, const float* b, bool const_b, std::size_t count, float* out)
+{
+    __m512 vb = broadcast(b);
+    for (std::size_t i = 0; i < count; i += 16)
+    {
+        __mmask16 mask = count - i >= 16 ? 0xFFFF : static_cast<__mmask16>((1u << (count - i)) - 1);
+        __m512    va   = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512    vbi  = const_b ? vb : _mm512_maskz_loadu_ps(mask, b + i);
+        _mm512_mask_storeu_ps(out + i, mask, arith16<Op>(va, vbi));
+    }
+}
+
+static void arith_float_avx512(
+    ArithOp op, const float* a, const float* b, bool const_b, std::size_t count, float* out)
+{
+    DISPATCH_ARITH(op, arith_float_avx512, a, b, const_b, count, out);
+}
+
+AVX512 static void bitmap_and_avx512(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= words; i += 8)
+        _mm512_storeu_si512(out + i, _mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+    for (; i < words; ++i) out[i] = a[i] & b[i];
+}
+
+AVX512 static void bitmap_or_avx512(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= words; i += 8)
+        _mm512_storeu_si512(out + i, _mm512_or_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+    for (; i < words; ++i) out[i] = a[i] | b[i];
+}
+
+AVX512 static void bitmap_not_avx512(const uint64_t* a, std::size_t words, uint64_t* out)
+{
+    std::size_t i    = 0;
+    __m512i     ones = _mm512_set1_epi32(-1);
+    for (; i + 8 <= words; i += 8) _mm512_storeu_si512(out + i, _mm512_xor_si512(_mm512_loadu_si512(a + i), ones));
+    for (; i < words; ++i) out[i] = ~a[i];
+}
+
+/**
+ * @brief 布尔数组转位图，64个字节一次比较得到一个位图字
+ */
+AVX512 static void bools_to_bitmap_avx512(const bool* a, std::size_t count, uint64_t* out)
+{
+    std::size_t full = count / 64;
+    for (std::size_t w = 0; w < full; ++w)
+        out[w] = _mm512_test_epi8_mask(_mm512_loadu_si512(a + w * 64), _mm512_set1_epi8(-1));
+    bools_range(a, full * 64, count, out);
+}
+
+const KernelTable Avx512Kernels = {
+    compare_int_avx512,
+    compare_float_avx512,
+    compare_int64_avx512,
+    arith_int_avx512,
+    arith_int64_avx512,
+    arith_float_avx512,
+    bitmap_and_avx512,
+    bitmap_or_avx512,
+    bitmap_not_avx512,
+    bools_to_bitmap_avx512,
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "kernels.h"
+
+/*
+ * 计算内核的内部接口：各指令集实现填写一张函数表，由kernels.cpp按CPU选择。
+ * 这里的标量模板同时用作标量实现与SIMD实现的尾部处理。
+ */
+
+/**
+ * @brief 一种指令集的内核函数表
+ *
+ * const_b为true时b只有一个元素，与a的每一行运算。
+ */
+struct KernelTable
+{
+    void (*compare_int)(CompareOp op, const int* a, const int* b, bool const_b, std::size_t count, uint64_t* out);
+    void (*compare_float)(
+        CompareOp op, const float* a, const float* b, bool const_b, std::size_t count, uint64_t* out);
+    void (*compare_int64)(
+        CompareOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, uint64_t* out);
+    bool (*arith_int)(
+        ArithOp op, const int* a, const int* b, bool const_b, std::size_t count, int* out, uint64_t* overflow);
+    bool (*arith_int64)(ArithOp op, const int64_t* a, const int64_t* b, bool const_b, std::size_t count, int64_t* out,
+        uint64_t* overflow);
+    void (*arith_float)(ArithOp op, const float* a, const float* b, bool const_b, std::size_t count, float* out);
+    void (*bitmap_and)(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out);
+    void (*bitmap_or)(const uint64_t* a, const uint64_t* b, std::size_t words, uint64_t* out);
+    void (*bitmap_not)(const uint64_t* a, std::size_t words, uint64_t* out);
+    void (*bools_to_bitmap)(const bool* a, std::size_t count, uint64_t* out);
+};
+
+extern const KernelTable ScalarKernels;
+extern const KernelTable Avx2Kernels;
+extern const KernelTable Avx512Kernels;
+
+/**
+ * @brief 按运算类型展开模板实例
+ */
+#define DISPATCH_COMPARE(op, fn, ...)                                  \
+    switch (op)                                                        \
+    {                                                                  \
+        case CompareOp::EQ: return fn<CompareOp::EQ>(__VA_ARGS__);     \
+        case CompareOp::NE: return fn<CompareOp::NE>(__VA_ARGS__);     \
+        case CompareOp::LT: return fn<CompareOp::LT>(__VA_ARGS__);     \
+        case CompareOp::LE: return fn<CompareOp::LE>(__VA_ARGS__);     \
+        case CompareOp::GT: return fn<CompareOp::GT>(__VA_ARGS__);     \
+        default: return fn<CompareOp::GE>(__VA_ARGS__);                \
+    }
+
+#define DISPATCH_ARITH(op, fn, ...)                                    \
+    switch (op)                                                        \
+    {                                                                  \
+        case ArithOp::ADD: return fn<ArithOp::ADD>(__VA_ARGS__);       \
+        case ArithOp::SUB: return fn<ArithOp::SUB>(__VA_ARGS__);       \
+        case ArithOp::MUL: return fn<ArithOp::MUL>(__VA_ARGS__);       \
+        default: return fn<ArithOp::DIV>(__VA_ARGS__);                 \
+    }
+
+namespace KernelDetail
+{
+    template <CompareOp Op, class T>
+    inline bool compare_one(T a, T b)
+    {
+        if constexpr (Op == CompareOp::EQ) return a == b;
+        if constexpr (Op == CompareOp::NE) return a != b;
+        if constexpr (Op == CompareOp::LT) return a < b;
+        if constexpr (Op == CompareOp::LE) return a <= b;
+        if constexpr (Op == CompareOp::GT) return a > b;
+        if constexpr (Op == CompareOp::GE) return a >= b;
+    }
+
+    /**
+     * @brief 标量比较[begin, count)，begin必须是64的倍数
+     */
+    template <CompareOp Op, class T>
+    void compare_range(const T* a, const T* b, bool const_b, std::size_t begin, std::size_t count, uint64_t* out)
+    {
+        for (std::size_t w = begin / 64; w * 64 < count; ++w)
+        {
+            std::size_t end  = w * 64 + 64 < count ? w * 64 + 64 : count;
+            uint64_t    word = 0;
+            for (std::size_t i = w * 64; i < end; ++i)
+                word |= uint64_t(compare_one<Op>(a[i], const_b ? b[0] : b[i])) << (i % 64);
+            out[w] = word;
+        }
+    }
+
+    /**
+     * @brief 单行整数运算
+     *
+     * @return 是否溢出
+     */
+    template <ArithOp Op, class T>
+    inline bool arith_one(T a, T b, T& out)
+    {
+        if constexpr (Op == ArithOp::ADD) return __builtin_add_overflow(a, b, &out);
+        if constexpr (Op == ArithOp::SUB) return __builtin_sub_overflow(a, b, &out);
+        if constexpr (Op == ArithOp::MUL) return __builtin_mul_overflow(a, b, &out);
+        if constexpr (Op == ArithOp::DIV)
+        {
+            if (b == 0)
+            {
+                out = 0;
+                return true;
+            }
+            if (a == std::numeric_limits<T>::min() && b == -1)
+            {
+                out = a;
+                return true;
+            }
+            out = a / b;
+            return false;
+        }
+    }
+
+    /**
+     * @brief 标量整数运算[begin, count)，begin必须是64的倍数
+     *
+     * @return 是否有任意一行溢出
+     */
+    template <ArithOp Op, class T>
+    bool arith_range(
+        const T* a, const T* b, bool const_b, std::size_t begin, std::size_t count, T* out, uint64_t* overflow)
+    {
+        uint64_t any = 0;
+        for (std::size_t w = begin / 64; w * 64 < count; ++w)
+        {
+            std::size_t end  = w * 64 + 64 < count ? w * 64 + 64 : count;
+            uint64_t    word = 0;
+            for (std::size_t i = w * 64; i < end; ++i)
+                word |= uint64_t(arith_one<Op>(a[i], const_b ? b[0] : b[i], out[i])) << (i % 64);
+            if (overflow) overflow[w] = word;
+            any |= word;
+        }
+        return any != 0;
+    }
+
+    template <ArithOp Op>
+    inline float arith_one(float a, float b)
+    {
+        if constexpr (Op == ArithOp::ADD) return a + b;
+        if constexpr (Op == ArithOp::SUB) return a - b;
+        if constexpr (Op == ArithOp::MUL) return a * b;
+        if constexpr (Op == ArithOp::DIV) return a / b;
+    }
+
+    /**
+     * @brief 标量浮点运算[begin, count)
+     */
+    template <ArithOp Op>
+    void arith_range(const float* a, const float* b, bool const_b, std::size_t begin, std::size_t count, float* out)
+    {
+        for (std::size_t i = begin; i < count; ++i) out[i] = arith_one<Op>(a[i], const_b ? b[0] : b[i]);
+    }
+
+    /**
+     * @brief 标量布尔数组转位图[begin, count)，begin必须是64的倍数
+     */
+    inline void bools_range(const bool* a, std::size_t begin, std::size_t count, uint64_t* out)
+    {
+        for (std::size_t w = begin / 64; w * 64 < count; ++w)
+        {
+            std::size_t end  = w * 64 + 64 < count ? w * 64 + 64 : count;
+            uint64_t    word = 0;
+            for (std::size_t i = w * 64; i < end; ++i) word |= uint64_t(a[i]) << (i % 64);
+            out[w] = word;
+        }
+    }
+}  // namespace KernelDetail
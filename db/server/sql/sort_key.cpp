@@ -0,0 +1,369 @@
+#include "sort_key.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "column.h"
+#include "decimal.h"
+#include "dictionary.h"
+#include "ret.h"
+
+static constexpr uint8_t NullFirstMarker = 0x00;  ///< NULL排在最前时的标记
+static constexpr uint8_t ValidMarker     = 0x01;  ///< 非NULL的标记
+static constexpr uint8_t NullLastMarker  = 0x02;  ///< NULL排在最后时的标记
+
+void SortKeyBuffer::clear()
+{
+    data_.clear();
+    offsets_.assign(1, 0);
+}
+
+/**
+ * @brief 定长类型数据部分的字节数，CHARS返回0
+ */
+static std::size_t fixed_width(AttrType type)
+{
+    switch (type)
+    {
+        case INTS:
+        case DATES:
+        case FLOATS: return 4;
+        case BIGINTS:
+        case DECIMALS: return 8;
+        case BOOLEANS: return 1;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief 字符串转义并加上结尾后的字节数
+ */
+static std::size_t string_width(std::string_view str)
+{
+    return str.size() + std::count(str.begin(), str.end(), '\0') + 2;
+}
+
+static uint32_t encode_int(int value) { return static_cast<uint32_t>(value) ^ 0x80000000u; }
+static uint64_t encode_int64(int64_t value) { return static_cast<uint64_t>(value) ^ 0x8000000000000000ull; }
+
+/**
+ * @brief 浮点数的保序编码
+ *
+ * 负数取反后绝对值越大编码越小；非负数翻转符号位后排在所有负数之后。
+ */
+static uint32_t encode_float(float value)
+{
+    if (value == 0.0f) value = 0.0f;
+    if (std::isnan(value)) value = std::numeric_limits<float>::quiet_NaN();
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits & 0x80000000u ? ~bits : bits ^ 0x80000000u;
+}
+
+/**
+ * @brief 以大端序写入，降序时取反
+ */
+template <class U>
+static void write_fixed(uint8_t*& out, U value, bool descending)
+{
+    if (descending) value = ~value;
+    for (std::size_t i = 0; i < sizeof(U); ++i) out[i] = static_cast<uint8_t>(value >> (8 * (sizeof(U) - 1 - i)));
+    out += sizeof(U);
+}
+
+static void write_string(uint8_t*& out, std::string_view str, bool descending)
+{
+    uint8_t mask = descending ? 0xFF : 0x00;
+    for (char c : str)
+    {
+        *out++ = static_cast<uint8_t>(c) ^ mask;
+        if (c == '\0') *out++ = 0xFF ^ mask;
+    }
+    *out++ = mask;
+    *out++ = mask;
+}
+
+static void write_null(uint8_t*& out, const SortColumn& spec)
+{
+    *out++          = spec.nulls_first ? NullFirstMarker : NullLastMarker;
+    std::size_t len = fixed_width(spec.type);
+    memset(out, 0, len);
+    out += len;
+}
+
+/**
+ * @brief 写入一个非NULL值
+ *
+ * @param scale DECIMALS值的标度
+ */
+template <AttrType Type, class T>
+static void write_value(uint8_t*& out, T value, const SortColumn& spec, int scale, RC& rc)
+{
+    *out++ = ValidMarker;
+    if constexpr (Type == INTS || Type == DATES)
+        write_fixed(out, encode_int(value), spec.descending);
+    else if constexpr (Type == FLOATS)
+        write_fixed(out, encode_float(value), spec.descending);
+    else if constexpr (Type == BOOLEANS)
+        write_fixed(out, static_cast<uint8_t>(value), spec.descending);
+    else if constexpr (Type == BIGINTS)
+        write_fixed(out, encode_int64(value), spec.descending);
+    else if constexpr (Type == DECIMALS)
+    {
+        int64_t scaled = value;
+        if (scale != spec.scale) decimal_rescale(value, scale, spec.scale, MaxDecimalPrecision, scaled, rc);
+        write_fixed(out, encode_int64(scaled), spec.descending);
+    }
+    else
+        write_string(out, value, spec.descending);
+}
+
+/**
+ * @brief 取CHARS列的一行，兼容字典编码列
+ */
+static std::string_view string_at(const ColumnBase& column, std::size_t row)
+{
+    if (column.dictionary())
+        return column.dictionary()->decode(static_cast<const DictVector&>(column).codes()[row]);
+    return static_cast<const ColumnVector<CHARS>&>(column)[row];
+}
+
+/**
+ * @brief 把一列写入每行的键中
+ *
+ * @param cursors 每行键中下一个写入位置，写入后前移
+ */
+template <AttrType Type>
+static void encode_column(
+    const DataChunk& chunk, const SortColumn& spec, uint8_t* data, std::vector<uint32_t>& cursors, RC& rc)
+{
+    const ColumnBase&   column   = chunk.column(spec.column);
+    const ValidityMask& validity = column.validity();
+    for (std::size_t i = 0; i < cursors.size(); ++i)
+    {
+        std::size_t row = chunk.row_index(i);
+        uint8_t*    out = data + cursors[i];
+        if (!validity.is_valid(row))
+            write_null(out, spec);
+        else if constexpr (Type == CHARS)
+            write_value<Type>(out, string_at(column, row), spec, 0, rc);
+        else
+            write_value<Type>(out, static_cast<const ColumnVector<Type>&>(column)[row], spec, column.scale(), rc);
+        cursors[i] = static_cast<uint32_t>(out - data);
+    }
+}
+
+void KeyEncoder::encode(const DataChunk& chunk, SortKeyBuffer& keys, RC& rc) const
+{
+    rc = RC::SUCCESS;
+    for (const SortColumn& spec : columns_)
+    {
+        if (spec.column >= chunk.column_count() || chunk.column(spec.column).type() != spec.type)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+    }
+
+    // 第一遍：计算每行的键长
+    std::size_t           count = chunk.size();
+    std::vector<uint32_t> lengths(count, 0);
+    for (const SortColumn& spec : columns_)
+    {
+        if (spec.type != CHARS)
+        {
+            for (uint32_t& length : lengths) length += 1 + fixed_width(spec.type);
+            continue;
+        }
+        const ColumnBase& column = chunk.column(spec.column);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::size_t row = chunk.row_index(i);
+            lengths[i] += 1 + (column.validity().is_valid(row) ? string_width(string_at(column, row)) : 0);
+        }
+    }
+
+    std::size_t           old_keys = keys.size();
+    std::vector<uint32_t> cursors(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        cursors[i] = keys.offsets_.back();
+        keys.offsets_.push_back(keys.offsets_.back() + lengths[i]);
+    }
+    keys.data_.resize(keys.offsets_.back());
+
+    // 第二遍：逐列写入
+    uint8_t* data = keys.data_.data();
+    for (const SortColumn& spec : columns_)
+    {
+        switch (spec.type)
+        {
+            case CHARS: encode_column<CHARS>(chunk, spec, data, cursors, rc); break;
+            case INTS: encode_column<INTS>(chunk, spec, data, cursors, rc); break;
+            case FLOATS: encode_column<FLOATS>(chunk, spec, data, cursors, rc); break;
+            case DATES: encode_column<DATES>(chunk, spec, data, cursors, rc); break;
+            case BOOLEANS: encode_column<BOOLEANS>(chunk, spec, data, cursors, rc); break;
+            case BIGINTS: encode_column<BIGINTS>(chunk, spec, data, cursors, rc); break;
+            case DECIMALS: encode_column<DECIMALS>(chunk, spec, data, cursors, rc); break;
+            default: rc = RC::INVALID_ARGUMENT; break;
+        }
+        if (rc != RC::SUCCESS)
+        {
+            keys.offsets_.resize(old_keys + 1);
+            keys.data_.resize(keys.offsets_.back());
+            return;
+        }
+    }
+}
+
+void KeyEncoder::encode(const std::vector<Value>& row, SortKeyBuffer& keys, RC& rc) const
+{
+    rc = RC::SUCCESS;
+    std::size_t length = 0;
+    for (const SortColumn& spec : columns_)
+    {
+        if (spec.column >= row.size() ||
+            (row[spec.column].attr_type() != UNDEFINED && row[spec.column].attr_type() != spec.type))
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        const Value& value = row[spec.column];
+        length += 1 + fixed_width(spec.type);
+        if (spec.type == CHARS && value.attr_type() == CHARS) length += string_width(value.get_str(rc));
+    }
+
+    std::size_t begin = keys.data_.size();
+    keys.data_.resize(begin + length);
+    uint8_t* out = keys.data_.data() + begin;
+    for (const SortColumn& spec : columns_)
+    {
+        const Value& value = row[spec.column];
+        switch (value.attr_type())
+        {
+            case CHARS: write_value<CHARS>(out, value.get_str(rc), spec, 0, rc); break;
+            case INTS: write_value<INTS>(out, value.get_int(rc), spec, 0, rc); break;
+            case FLOATS: write_value<FLOATS>(out, value.get_float(rc), spec, 0, rc); break;
+            case DATES: write_value<DATES>(out, value.get_date(rc), spec, 0, rc); break;
+            case BOOLEANS: write_value<BOOLEANS>(out, value.get_bool(rc), spec, 0, rc); break;
+            case BIGINTS: write_value<BIGINTS>(out, value.get_bigint(rc), spec, 0, rc); break;
+            case DECIMALS: write_value<DECIMALS>(out, value.get_decimal(rc), spec, value.scale(), rc); break;
+            default: write_null(out, spec); break;
+        }
+        if (rc != RC::SUCCESS)
+        {
+            keys.data_.resize(begin);
+            return;
+        }
+    }
+    keys.offsets_.push_back(static_cast<uint32_t>(keys.data_.size()));
+}
+
+void make_entries(const SortKeyBuffer& keys, std::vector<SortEntry>& entries)
+{
+    entries.resize(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        const uint8_t* key    = keys.key(i);
+        std::size_t    length = keys.length(i);
+        uint64_t       prefix = 0;
+        for (std::size_t b = 0; b < 8; ++b) prefix = prefix << 8 | (b < length ? key[b] : 0);
+        entries[i] = {prefix, key, static_cast<uint32_t>(length), static_cast<uint32_t>(i)};
+    }
+}
+
+/**
+ * @brief 比较两个排序项
+ *
+ * 前缀补0后相等的两个键，前8字节之后的部分按memcmp比较，仍相等时短者在前。
+ */
+int compare_entries(const SortEntry& a, const SortEntry& b)
+{
+    if (a.prefix != b.prefix) return a.prefix < b.prefix ? -1 : 1;
+    uint32_t length = a.length < b.length ? a.length : b.length;
+    if (length > 8)
+    {
+        int cmp = memcmp(a.key + 8, b.key + 8, length - 8);
+        if (cmp) return cmp;
+    }
+    if (a.length != b.length) return a.length < b.length ? -1 : 1;
+    return (a.row > b.row) - (a.row < b.row);
+}
+
+static bool entry_less(const SortEntry& a, const SortEntry& b) { return compare_entries(a, b) < 0; }
+
+/**
+ * @brief 第depth个字节所在的桶，键已结束时为0，否则为字节值加1
+ *
+ * 前8字节从prefix中取，不访问键数据。
+ */
+static inline unsigned bucket_of(const SortEntry& entry, std::size_t depth)
+{
+    if (entry.length <= depth) return 0;
+    return 1 + (depth < 8 ? static_cast<unsigned>(entry.prefix >> (56 - 8 * depth) & 0xFF) : entry.key[depth]);
+}
+
+/**
+ * @brief 对前depth个字节都相同的一段排序
+ */
+static void radix_sort(SortEntry* entries, SortEntry* temp, std::size_t count, std::size_t depth)
+{
+    static constexpr std::size_t InsertionThreshold = 32;  ///< 小于该行数时改用插入排序
+
+    while (true)
+    {
+        if (count <= InsertionThreshold)
+        {
+            for (std::size_t i = 1; i < count; ++i)
+            {
+                SortEntry   entry = entries[i];
+                std::size_t j     = i;
+                for (; j > 0 && entry_less(entry, entries[j - 1]); --j) entries[j] = entries[j - 1];
+                entries[j] = entry;
+            }
+            return;
+        }
+
+        std::size_t counts[257] = {};
+        for (std::size_t i = 0; i < count; ++i) ++counts[bucket_of(entries[i], depth)];
+
+        // 所有键在这一字节相同时直接进入下一字节，避免无谓的分发
+        unsigned first = bucket_of(entries[0], depth);
+        if (counts[first] == count)
+        {
+            if (first == 0) break;
+            ++depth;
+            continue;
+        }
+
+        std::size_t starts[257];
+        std::size_t offset = 0;
+        for (unsigned b = 0; b < 257; ++b)
+        {
+            starts[b] = offset;
+            offset += counts[b];
+        }
+        for (std::size_t i = 0; i < count; ++i) temp[starts[bucket_of(entries[i], depth)]++] = entries[i];
+        std::copy(temp, temp + count, entries);
+
+        // 桶0中的键完全相同，只需按行号排序；分发是稳定的，输入按行号有序时这里已经有序
+        if (!std::is_sorted(entries, entries + counts[0], entry_less))
+            std::sort(entries, entries + counts[0], entry_less);
+        offset = counts[0];
+        for (unsigned b = 1; b < 257; ++b)
+        {
+            if (counts[b] > 1) radix_sort(entries + offset, temp + offset, counts[b], depth + 1);
+            offset += counts[b];
+        }
+        return;
+    }
+    if (!std::is_sorted(entries, entries + count, entry_less)) std::sort(entries, entries + count, entry_less);
+}
+
+void radix_sort(std::vector<SortEntry>& entries)
+{
+    std::vector<SortEntry> temp(entries.size());
+    radix_sort(entries.data(), temp.data(), entries.size(), 0);
+}
+
+void prefix_sort(std::vector<SortEntry>& entries) { std::sort(entries.begin(), entries.end(), entry_less); }
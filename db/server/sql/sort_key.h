@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "value.h"
+
+enum class RC;
+class DataChunk;
+
+/*
+ * 可按memcmp比较的规范化排序键。
+ *
+ * 多列元组被编码为一个字节串，两个字节串按memcmp比较（相同前缀时短者在前）的结果与按列依次做
+ * SQL比较的结果一致，排序、索引键与归并时不再需要逐列的类型分派。每列的编码为：
+ *
+ *   [NULL标记1字节][数据]
+ *
+ * NULL标记不受升降序影响；NULL的数据部分与非NULL等宽（CHARS没有数据部分）。数据部分：
+ *   - INTS、DATES：翻转符号位后的4字节大端序；BIGINTS、DECIMALS同理为8字节，DECIMALS先缩放到SortColumn::scale
+ *   - FLOATS：非负数翻转符号位，负数按位取反，4字节大端序；-0.0按0.0编码，所有NaN编码为同一个最大值
+ *   - BOOLEANS：1字节
+ *   - CHARS：0x00转义为0x00 0xFF，以0x00 0x00结尾，保证前缀关系与字节序一致
+ * 降序列的数据部分按位取反。
+ */
+
+/**
+ * @brief 一个排序列
+ */
+struct SortColumn
+{
+    std::size_t column      = 0;      ///< 在DataChunk中的列号；编码Value元组时为元组下标
+    AttrType    type        = INTS;   ///< 列类型
+    bool        descending  = false;  ///< 是否降序
+    bool        nulls_first = true;   ///< NULL是否排在最前，与升降序无关
+    int         scale       = 0;      ///< DECIMALS统一缩放到的标度
+};
+
+/**
+ * @brief 一批排序键
+ *
+ * 所有键连续存放在一块内存中。追加会使之前由key()取得的指针失效。
+ */
+class SortKeyBuffer
+{
+  public:
+    SortKeyBuffer() : offsets_(1, 0) {}
+
+    std::size_t    size() const { return offsets_.size() - 1; }
+    const uint8_t* key(std::size_t i) const { return data_.data() + offsets_[i]; }
+    std::size_t    length(std::size_t i) const { return offsets_[i + 1] - offsets_[i]; }
+
+    /**
+     * @brief 清空全部键，保留已分配的内存
+     */
+    void clear();
+
+  private:
+    friend class KeyEncoder;
+
+    std::vector<uint8_t>  data_;     ///< 键数据
+    std::vector<uint32_t> offsets_;  ///< 第i个键的起始位置，共size() + 1个
+};
+
+/**
+ * @brief 排序键编码器
+ */
+class KeyEncoder
+{
+  public:
+    explicit KeyEncoder(std::vector<SortColumn> columns) : columns_(std::move(columns)) {}
+
+    const std::vector<SortColumn>& columns() const { return columns_; }
+
+    /**
+     * @brief 按列编码一批数据的全部逻辑行，追加到keys
+     *
+     * 先计算每行的键长，再逐列写入，每列只做一次类型分派。
+     *
+     * @param rc 列类型与SortColumn不一致或DECIMALS缩放溢出时为RC::INVALID_ARGUMENT，keys不变
+     */
+    void encode(const DataChunk& chunk, SortKeyBuffer& keys, RC& rc) const;
+
+    /**
+     * @brief 编码一个元组，追加到keys
+     *
+     * UNDEFINED类型的Value视为NULL。
+     */
+    void encode(const std::vector<Value>& row, SortKeyBuffer& keys, RC& rc) const;
+
+  private:
+    std::vector<SortColumn> columns_;  ///< 排序列
+};
+
+/**
+ * @brief 排序项
+ *
+ * prefix为键的前8字节按大端序读成的整数，不足8字节补0，比较时先比较prefix。
+ */
+struct SortEntry
+{
+    uint64_t       prefix;  ///< 键前缀
+    const uint8_t* key;     ///< 完整的键
+    uint32_t       length;  ///< 键长
+    uint32_t       row;     ///< 行号，键相等时按行号排序
+};
+
+/**
+ * @brief 为每个键生成排序项，row为键在keys中的下标
+ */
+void make_entries(const SortKeyBuffer& keys, std::vector<SortEntry>& entries);
+
+/**
+ * @brief 比较两个排序项的键，相等时比较行号
+ *
+ * @return 小于、等于、大于时分别返回负数、0、正数
+ */
+int compare_entries(const SortEntry& a, const SortEntry& b);
+
+/**
+ * @brief MSD基数排序
+ *
+ * 每层按一个字节计数分桶，小桶改用插入排序；结果与prefix_sort一致。
+ */
+void radix_sort(std::vector<SortEntry>& entries);
+
+/**
+ * @brief 基于前缀的比较排序
+ *
+ * 前缀不同时只比较一个整数，相同时才比较剩余字节。
+ */
+void prefix_sort(std::vector<SortEntry>& entries);
@@ -1,6 +1,10 @@
 #include "value.h"
 #include "Trans/date.h"
+#include <cstddef>
 #include <cstring>
+#include <type_traits>
+#include "arena.h"
+#include "decimal.h"
 #include "ret.h"
 
 const char* AttrTypeStr[] = {
@@ -10,11 +14,13 @@ const char* AttrTypeStr[] = {
     "FLOATS",
     "DATES",
     "BOOLEANS",
+    "BIGINTS",
+    "DECIMALS",
 };
 
 const char* strat(AttrType type)
 {
-    if (type < AttrType::UNDEFINED || type > AttrType::BOOLEANS) return "UNDEFINED";
+    if (type < AttrType::UNDEFINED || type > AttrType::DECIMALS) return "UNDEFINED";
     return AttrTypeStr[type];
 }
 
@@ -25,41 +31,93 @@ AttrType atstr(const char* str)
     return AttrType::UNDEFINED;
 }
 
+static_assert(sizeof(Value) == 16, "Value must stay 16 bytes");
+static_assert(std::is_trivially_copyable_v<Value>, "Value must be trivially copyable");
+
 Value::Value(int val, RC& rc) { set_int(val, rc); }
+Value::Value(int64_t val, RC& rc) { set_bigint(val, rc); }
 Value::Value(float val, RC& rc) { set_float(val, rc); }
 Value::Value(bool val, RC& rc) { set_bool(val, rc); }
-Value::Value(const char* str, RC& rc) { set_str(str, rc); }
-Value::Value(const char* date, int this_is_date, RC& rc) { set_date(date, rc); }
+Value::Value(const char* str, StringArena& arena, RC& rc) { set_str(str, strlen(str), arena, rc); }
+Value::Value(const char* date, int /* this_is_date */, RC& rc) { set_date(date, rc); }
 
 void Value::set_int(int val, RC& rc)
 {
-    attr_type_            = AttrType::INTS;
-    num_value_.int_value_ = val;
-    length_               = sizeof(val);
+    attr_type_ = AttrType::INTS;
+    length_    = sizeof(val);
+    memset(prefix_, 0, sizeof(prefix_));
+    value_.bits_      = 0;
+    value_.int_value_ = val;
+    rc                = RC::SUCCESS;
+}
+void Value::set_bigint(int64_t val, RC& rc)
+{
+    attr_type_ = AttrType::BIGINTS;
+    length_    = sizeof(val);
+    memset(prefix_, 0, sizeof(prefix_));
+    value_.bigint_value_ = val;
+    rc                   = RC::SUCCESS;
 }
 void Value::set_float(float val, RC& rc)
 {
-    attr_type_              = AttrType::FLOATS;
-    num_value_.float_value_ = val;
-    length_                 = sizeof(val);
+    attr_type_ = AttrType::FLOATS;
+    length_    = sizeof(val);
+    memset(prefix_, 0, sizeof(prefix_));
+    value_.bits_        = 0;
+    value_.float_value_ = val;
+    rc                  = RC::SUCCESS;
 }
 void Value::set_bool(bool val, RC& rc)
 {
-    attr_type_             = AttrType::BOOLEANS;
-    num_value_.bool_value_ = val;
-    length_                = sizeof(val);
+    attr_type_ = AttrType::BOOLEANS;
+    length_    = sizeof(val);
+    memset(prefix_, 0, sizeof(prefix_));
+    value_.bits_       = 0;
+    value_.bool_value_ = val;
+    rc                 = RC::SUCCESS;
 }
-void Value::set_str(const char* str, RC& rc)
+
+/**
+ * @brief 设置字符串
+ *
+ * 短字符串内联存放，未使用的字节补零，使前缀比较与按字节比较的结果一致；
+ * 长字符串只复制前缀并保存指针。
+ */
+void Value::set_str_ref(std::string_view str, RC& rc)
 {
+    std::size_t len = str.size();
+    if (len > MaxLength)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
     attr_type_ = AttrType::CHARS;
-    str_value_ = str;
-    length_    = str_value_.length();
+    length_    = len;
+    memset(prefix_, 0, sizeof(prefix_));
+    value_.bits_ = 0;
+    if (len <= InlineLength)
+        memcpy(reinterpret_cast<char*>(this) + PrefixOffset, str.data(), len);
+    else
+    {
+        memcpy(prefix_, str.data(), PrefixLength);
+        value_.ptr_ = str.data();
+    }
+    rc = RC::SUCCESS;
+}
+void Value::set_str(const char* str, std::size_t len, StringArena& arena, RC& rc)
+{
+    if (len > InlineLength && len <= MaxLength) str = arena.copy(str, len);
+    set_str_ref(std::string_view(str, len), rc);
 }
 void Value::set_date(int date, RC& rc)
 {
-    attr_type_            = AttrType::DATES;
-    num_value_.int_value_ = date;
-    length_               = sizeof(date);
+    attr_type_ = AttrType::DATES;
+    length_    = sizeof(date);
+    memset(prefix_, 0, sizeof(prefix_));
+    value_.bits_      = 0;
+    value_.int_value_ = date;
+    rc                = RC::SUCCESS;
 }
 void Value::set_date(const char* date, RC& rc)
 {
@@ -69,7 +127,201 @@ void Value::set_date(const char* date, RC& rc)
     set_date(date_int, rc);
 }
 
+void Value::set_decimal(int64_t unscaled, int precision, int scale, RC& rc)
+{
+    if (!decimal_type_valid(precision, scale) || !decimal_fits(unscaled, precision))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    attr_type_ = AttrType::DECIMALS;
+    length_    = sizeof(unscaled);
+    memset(prefix_, 0, sizeof(prefix_));
+    prefix_[0]           = static_cast<char>(precision);
+    prefix_[1]           = static_cast<char>(scale);
+    value_.bigint_value_ = unscaled;
+    rc                   = RC::SUCCESS;
+}
+void Value::set_decimal(const char* str, int precision, int scale, RC& rc)
+{
+    int64_t unscaled = 0;
+    parse_decimal(str, strlen(str), precision, scale, unscaled, rc);
+    if (rc != RC::SUCCESS) return;
+    set_decimal(unscaled, precision, scale, rc);
+}
+
 int Value::get_int(RC& rc) const
 {
-    if (attr_type_ == AttrType::INTS) return num_value_.int_value_;
-}
\ No newline at end of file
+    if (attr_type_ != AttrType::INTS)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return 0;
+    }
+    rc = RC::SUCCESS;
+    return value_.int_value_;
+}
+int64_t Value::get_bigint(RC& rc) const
+{
+    if (attr_type_ != AttrType::BIGINTS)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return 0;
+    }
+    rc = RC::SUCCESS;
+    return value_.bigint_value_;
+}
+float Value::get_float(RC& rc) const
+{
+    if (attr_type_ != AttrType::FLOATS)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return 0;
+    }
+    rc = RC::SUCCESS;
+    return value_.float_value_;
+}
+bool Value::get_bool(RC& rc) const
+{
+    if (attr_type_ != AttrType::BOOLEANS)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return false;
+    }
+    rc = RC::SUCCESS;
+    return value_.bool_value_;
+}
+std::string_view Value::get_str(RC& rc) const
+{
+    if (attr_type_ != AttrType::CHARS)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return {};
+    }
+    rc = RC::SUCCESS;
+    return std::string_view(str_data(), length_);
+}
+int Value::get_date(RC& rc) const
+{
+    if (attr_type_ != AttrType::DATES)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return 0;
+    }
+    rc = RC::SUCCESS;
+    return value_.int_value_;
+}
+
+int64_t Value::get_decimal(RC& rc) const
+{
+    if (attr_type_ != AttrType::DECIMALS)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return 0;
+    }
+    rc = RC::SUCCESS;
+    return value_.bigint_value_;
+}
+
+/**
+ * @brief 三路比较
+ */
+template <class T>
+static int three_way(T a, T b)
+{
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief 精确数值类型转为定点数，整数的标度为0
+ *
+ * @return 不是INTS、BIGINTS或DECIMALS时返回false
+ */
+static bool as_exact(AttrType type, int64_t bits, int int_value, int scale, int64_t& unscaled, int& out_scale)
+{
+    switch (type)
+    {
+        case AttrType::INTS: unscaled = int_value, out_scale = 0; return true;
+        case AttrType::BIGINTS: unscaled = bits, out_scale = 0; return true;
+        case AttrType::DECIMALS: unscaled = bits, out_scale = scale; return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief 比较两个值
+ *
+ * 前缀按大端序读成整数比较，等价于前4字节的memcmp。
+ */
+int Value::compare(const Value& other, RC& rc) const
+{
+    rc = RC::SUCCESS;
+    if (attr_type_ == AttrType::CHARS && other.attr_type_ == AttrType::CHARS)
+    {
+        uint32_t lhs, rhs;
+        memcpy(&lhs, prefix_, sizeof(lhs));
+        memcpy(&rhs, other.prefix_, sizeof(rhs));
+        if (lhs != rhs) return three_way(__builtin_bswap32(lhs), __builtin_bswap32(rhs));
+
+        std::size_t len = length_ < other.length_ ? length_ : other.length_;
+        if (len > PrefixLength)
+        {
+            int cmp = memcmp(str_data() + PrefixLength, other.str_data() + PrefixLength, len - PrefixLength);
+            if (cmp) return cmp;
+        }
+        return three_way<uint32_t>(length_, other.length_);
+    }
+
+    if (attr_type_ == other.attr_type_)
+    {
+        switch (attr_type_)
+        {
+            case AttrType::INTS:
+            case AttrType::DATES: return three_way(value_.int_value_, other.value_.int_value_);
+            case AttrType::BIGINTS: return three_way(value_.bigint_value_, other.value_.bigint_value_);
+            case AttrType::FLOATS: return three_way(value_.float_value_, other.value_.float_value_);
+            case AttrType::BOOLEANS: return three_way(value_.bool_value_, other.value_.bool_value_);
+            default: break;
+        }
+    }
+
+    int64_t lhs = 0, rhs = 0;
+    int     lhs_scale = 0, rhs_scale = 0;
+    bool    lhs_exact = as_exact(attr_type(), value_.bigint_value_, value_.int_value_, scale(), lhs, lhs_scale);
+    bool    rhs_exact = as_exact(
+        other.attr_type(), other.value_.bigint_value_, other.value_.int_value_, other.scale(), rhs, rhs_scale);
+    if (lhs_exact && rhs_exact) return decimal_compare(lhs, lhs_scale, rhs, rhs_scale);
+
+    if (attr_type_ == AttrType::INTS && other.attr_type_ == AttrType::FLOATS)
+        return three_way(static_cast<float>(value_.int_value_), other.value_.float_value_);
+    if (attr_type_ == AttrType::FLOATS && other.attr_type_ == AttrType::INTS)
+        return three_way(value_.float_value_, static_cast<float>(other.value_.int_value_));
+    if (lhs_exact && other.attr_type_ == AttrType::FLOATS)
+        return three_way(static_cast<double>(lhs) / DecimalPow10[lhs_scale], double(other.value_.float_value_));
+    if (attr_type_ == AttrType::FLOATS && rhs_exact)
+        return three_way(double(value_.float_value_), static_cast<double>(rhs) / DecimalPow10[rhs_scale]);
+
+    rc = RC::INVALID_ARGUMENT;
+    return 0;
+}
+
+/**
+ * @brief 判断两个值是否相等
+ */
+bool Value::equals(const Value& other) const
+{
+    // 精度不参与相等判断，不能只比较头部
+    if (attr_type_ == AttrType::DECIMALS && other.attr_type_ == AttrType::DECIMALS)
+        return decimal_compare(value_.bigint_value_, scale(), other.value_.bigint_value_, other.scale()) == 0;
+
+    uint64_t lhs, rhs;
+    memcpy(&lhs, this, sizeof(lhs));
+    memcpy(&rhs, &other, sizeof(rhs));
+    if (lhs != rhs) return false;
+
+    if (attr_type_ == AttrType::FLOATS) return value_.float_value_ == other.value_.float_value_;
+    if (attr_type_ == AttrType::CHARS && length_ > InlineLength)
+        return value_.ptr_ == other.value_.ptr_ ||
+               memcmp(value_.ptr_ + PrefixLength, other.value_.ptr_ + PrefixLength, length_ - PrefixLength) == 0;
+    return value_.bits_ == other.value_.bits_;
+}
@@ -1,8 +1,11 @@
 #pragma once
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 enum class RC;
+class StringArena;
 
 enum AttrType
 {
@@ -12,44 +15,124 @@ enum AttrType
     FLOATS,
     DATES,
     BOOLEANS,
+    BIGINTS,   ///< 64位整数
+    DECIMALS,  ///< 定点小数，见decimal.h
 };
 
 const char* strat(AttrType type);
 AttrType    atstr(const char* str);
 
+/**
+ * @brief 16字节的紧凑值
+ *
+ * 布局为[类型8位|长度24位][前缀4字节][8字节负载]：
+ * 数值类型存放在负载中，DECIMALS的精度与标度存放在前缀的前两个字节；不超过12字节的字符串连同前缀内联存放；
+ * 更长的字符串在前缀中保存前4字节，负载为指向外部数据的指针。
+ * 对象可平凡复制，复制时不分配内存，也不拥有长字符串的数据，
+ * 长字符串的生命周期由调用者或StringArena保证。
+ */
 class Value
 {
   public:
+    static constexpr std::size_t InlineLength = 12;          ///< 内联存放的最大字符串长度
+    static constexpr std::size_t PrefixLength = 4;           ///< 字符串前缀长度
+    static constexpr std::size_t MaxLength    = (1 << 24) - 1;  ///< 字符串最大长度
+
     Value() = default;
 
     Value(int val, RC& rc);
+    Value(int64_t val, RC& rc);
     Value(float val, RC& rc);
     Value(bool val, RC& rc);
-    Value(const char* str, RC& rc);
+    Value(const char* str, StringArena& arena, RC& rc);
     Value(const char* date, int this_is_date, RC& rc);
 
     void set_int(int val, RC& rc);
+    void set_bigint(int64_t val, RC& rc);
     void set_float(float val, RC& rc);
     void set_bool(bool val, RC& rc);
-    void set_str(const char* str, RC& rc);
+
+    /**
+     * @brief 设置字符串，长字符串借用str的数据，只保存指针
+     *
+     * 调用者保证长字符串的数据在值及其副本的使用期间有效且不变，需要复制时使用带arena的set_str。
+     */
+    void set_str_ref(std::string_view str, RC& rc);
+
+    /**
+     * @brief 设置字符串，长字符串复制到arena中
+     */
+    void set_str(const char* str, std::size_t len, StringArena& arena, RC& rc);
     void set_date(int date, RC& rc);
     void set_date(const char* date, RC& rc);
 
-    int  get_int(RC& rc) const;
-    float get_float(RC& rc) const;
-    bool get_bool(RC& rc) const;
-    const char* get_str(RC& rc) const;
-    int get_date(RC& rc) const;
+    /**
+     * @brief 设置定点小数
+     *
+     * @param unscaled 放大10^scale倍后的整数，绝对值必须小于10^precision
+     */
+    void set_decimal(int64_t unscaled, int precision, int scale, RC& rc);
+    void set_decimal(const char* str, int precision, int scale, RC& rc);
+
+    int              get_int(RC& rc) const;
+    int64_t          get_bigint(RC& rc) const;
+    float            get_float(RC& rc) const;
+    bool             get_bool(RC& rc) const;
+    std::string_view get_str(RC& rc) const;
+    int              get_date(RC& rc) const;
+
+    /**
+     * @brief 取放大10^scale()倍后的整数
+     */
+    int64_t get_decimal(RC& rc) const;
+
+    AttrType    attr_type() const { return static_cast<AttrType>(attr_type_); }
+    std::size_t length() const { return length_; }
+    int         precision() const { return prefix_[0]; }  ///< DECIMALS的精度
+    int         scale() const { return prefix_[1]; }      ///< DECIMALS的标度
+
+    /**
+     * @brief 比较两个值
+     *
+     * 字符串先按前缀比较，前缀不同时无需访问外部数据；INTS、BIGINTS与DECIMALS之间按定点数精确比较，
+     * INTS与FLOATS之间按float比较，BIGINTS、DECIMALS与FLOATS之间按double比较。
+     * 类型不可比较时rc为RC::INVALID_ARGUMENT。
+     *
+     * @return 小于、等于、大于时分别返回负数、0、正数
+     */
+    int compare(const Value& other, RC& rc) const;
+
+    /**
+     * @brief 判断两个值是否相等
+     *
+     * 先比较头部与前缀共8字节，不同类型或不同长度的值直接判为不等；
+     * 两个DECIMALS按数值判断，与精度、标度无关。
+     */
+    bool equals(const Value& other) const;
 
   private:
-    AttrType attr_type_ = UNDEFINED;
-    int      length_    = 0;
+    /**
+     * @brief 字符串数据的起始地址
+     */
+    const char* str_data() const
+    {
+        return length_ <= InlineLength ? reinterpret_cast<const char*>(this) + PrefixOffset : value_.ptr_;
+    }
+
+    static constexpr std::size_t PrefixOffset = 4;  ///< 前缀在对象中的偏移
+
+    uint32_t attr_type_ : 8  = UNDEFINED;  ///< 值类型
+    uint32_t length_ : 24    = 0;          ///< 值长度
+    char     prefix_[PrefixLength] = {};   ///< 字符串前缀，短字符串的前4字节
 
     union
     {
-        int   int_value_;
-        float float_value_;
-        bool  bool_value_;
-    } num_value_;
-    std::string str_value_;
-};
\ No newline at end of file
+        char        suffix_[8];  ///< 短字符串的第5~12字节
+        const char* ptr_;        ///< 长字符串数据
+        int         int_value_;
+        int64_t     bigint_value_;  ///< BIGINTS与DECIMALS
+        float       float_value_;
+        bool        bool_value_;
+        uint64_t    bits_ = 0;   ///< 负载的原始位
+    } value_;
+};
@@ -0,0 +1,271 @@
+#include "async_io.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "ret.h"
+
+static constexpr uint64_t StopTag = ~0ull;  ///< 通知完成线程退出的空操作的user_data
+
+static int io_uring_setup(unsigned int entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/*
+ * 队列的头尾下标与内核共享：读对方推进的下标用acquire，推进自己的下标用release。
+ */
+static unsigned int load_acquire(unsigned int* index)
+{
+    return std::atomic_ref<unsigned int>(*index).load(std::memory_order_acquire);
+}
+
+static void store_release(unsigned int* index, unsigned int value)
+{
+    std::atomic_ref<unsigned int>(*index).store(value, std::memory_order_release);
+}
+
+AsyncIo::AsyncIo(unsigned int depth)
+{
+    if (depth == 0) return;
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = io_uring_setup(depth, &params);
+    if (fd < 0) return;
+    ring_fd_ = fd;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single   = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+    int prot  = PROT_READ | PROT_WRITE;
+    int flags = MAP_SHARED | MAP_POPULATE;
+    sq_ring_  = mmap(nullptr, sq_ring_size_, prot, flags, fd, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) sq_ring_ = nullptr;
+    cq_ring_ = single ? sq_ring_ : mmap(nullptr, cq_ring_size_, prot, flags, fd, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) cq_ring_ = nullptr;
+    sqes_ = mmap(nullptr, sqes_size_, prot, flags, fd, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) sqes_ = nullptr;
+    if (!sq_ring_ || !cq_ring_ || !sqes_)
+    {
+        close_ring();
+        return;
+    }
+
+    char* sq  = static_cast<char*>(sq_ring_);
+    char* cq  = static_cast<char*>(cq_ring_);
+    sq_head_  = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+    sq_tail_  = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+    sq_mask_  = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+    cq_head_  = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+    cq_tail_  = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+    cq_mask_  = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+    cqes_     = cq + params.cq_off.cqes;
+
+    // 进行中的请求不超过提交队列的长度，完成队列（默认两倍长）不会溢出
+    depth_ = params.sq_entries;
+    slots_.resize(depth_);
+    for (uint32_t i = depth_; i > 0; --i) free_slots_.push_back(i - 1);
+    completer_ = std::thread(&AsyncIo::complete_loop, this);
+}
+
+AsyncIo::~AsyncIo()
+{
+    if (!uring()) return;
+    {
+        std::unique_lock<std::mutex> lock(submit_mutex_);
+        slot_cv_.wait(lock, [this] { return free_slots_.size() == depth_; });
+        push(StopTag, IORING_OP_NOP);
+        if (enter(1) == 0)
+        {
+            // 无法通知完成线程时放弃它，保留队列的映射：它只访问映射与自己的局部变量，没有请求会再完成
+            completer_.detach();
+            return;
+        }
+    }
+    completer_.join();
+    close_ring();
+}
+
+void AsyncIo::close_ring()
+{
+    if (sqes_) munmap(sqes_, sqes_size_);
+    if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_) munmap(sq_ring_, sq_ring_size_);
+    sqes_ = cq_ring_ = sq_ring_ = nullptr;
+    close(ring_fd_);
+    ring_fd_ = -1;
+}
+
+void AsyncIo::push(uint64_t tag, uint8_t opcode)
+{
+    unsigned int  tail  = *sq_tail_;
+    unsigned int  index = tail & sq_mask_;
+    io_uring_sqe& sqe   = reinterpret_cast<io_uring_sqe*>(sqes_)[index];
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode    = opcode;
+    sqe.user_data = tag;
+    if (opcode == IORING_OP_READ)
+    {
+        const AsyncRead& read = slots_[tag];
+        sqe.fd                = read.fd;
+        sqe.addr              = reinterpret_cast<uint64_t>(read.buf);
+        sqe.len               = static_cast<uint32_t>(read.len);
+        sqe.off               = static_cast<uint64_t>(read.offset);
+    }
+    sq_array_[index] = index;
+    store_release(sq_tail_, tail + 1);
+}
+
+unsigned int AsyncIo::enter(unsigned int count)
+{
+    unsigned int done = 0;
+    while (done < count)
+    {
+        int ret = io_uring_enter(ring_fd_, count - done, 0, 0);
+        if (ret > 0)
+        {
+            done += ret;
+            continue;
+        }
+        if (ret < 0 && errno == EINTR) continue;
+        // 内核没有取走的队列项还在head与tail之间，没有SQPOLL时只在io_uring_enter中读取，可以撤回
+        store_release(sq_tail_, load_acquire(sq_head_));
+        break;
+    }
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    return done;
+}
+
+void AsyncIo::submit(std::vector<AsyncRead>& reads)
+{
+    submitted_.fetch_add(reads.size(), std::memory_order_relaxed);
+    if (!uring())
+    {
+        for (AsyncRead& read : reads) finish_sync(read, 0);
+        return;
+    }
+
+    std::vector<uint32_t> batch;
+    std::size_t           next = 0;
+    while (next < reads.size())
+    {
+        std::vector<AsyncRead> failed;
+        {
+            std::unique_lock<std::mutex> lock(submit_mutex_);
+            slot_cv_.wait(lock, [this] { return !free_slots_.empty(); });
+            batch.clear();
+            while (next < reads.size() && !free_slots_.empty())
+            {
+                uint32_t slot = free_slots_.back();
+                free_slots_.pop_back();
+                slots_[slot] = std::move(reads[next++]);
+                push(slot, IORING_OP_READ);
+                batch.push_back(slot);
+            }
+            for (std::size_t i = enter(batch.size()); i < batch.size(); ++i)
+            {
+                failed.push_back(std::move(slots_[batch[i]]));
+                free_slots_.push_back(batch[i]);
+            }
+        }
+        // 提交失败的请求改为同步读，回调不在提交锁下调用
+        for (AsyncRead& read : failed) finish_sync(read, 0);
+    }
+}
+
+void AsyncIo::finish_sync(AsyncRead& read, std::size_t got)
+{
+    fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    while (got < read.len)
+    {
+        ssize_t n = pread(read.fd, read.buf + got, read.len - got, read.offset + static_cast<off_t>(got));
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            read.done(RC::IO_ERROR);
+            return;
+        }
+        if (n == 0)
+        {
+            memset(read.buf + got, 0, read.len - got);
+            break;
+        }
+        got += n;
+    }
+    read.done(RC::SUCCESS);
+}
+
+void AsyncIo::complete_loop()
+{
+    int           fd      = ring_fd_;
+    unsigned int* cq_head = cq_head_;
+    unsigned int* cq_tail = cq_tail_;
+    unsigned int  cq_mask = cq_mask_;
+    io_uring_cqe* cqes    = static_cast<io_uring_cqe*>(cqes_);
+    while (true)
+    {
+        unsigned int head = *cq_head;
+        if (head == load_acquire(cq_tail))
+        {
+            io_uring_enter(fd, 0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+        uint64_t tag = cqes[head & cq_mask].user_data;
+        int      res = cqes[head & cq_mask].res;
+        store_release(cq_head, head + 1);
+        if (tag == StopTag) return;
+
+        AsyncRead& read = slots_[tag];
+        if (res >= 0 && static_cast<std::size_t>(res) == read.len)
+        {
+            completed_.fetch_add(1, std::memory_order_relaxed);
+            read.done(RC::SUCCESS);
+        }
+        else if (res == 0)
+        {
+            completed_.fetch_add(1, std::memory_order_relaxed);
+            memset(read.buf, 0, read.len);
+            read.done(RC::SUCCESS);
+        }
+        else if (res > 0 || res == -EINTR || res == -EAGAIN || res == -EINVAL || res == -EOPNOTSUPP)
+            // 短读读完剩余部分；内核不支持IORING_OP_READ等情况整页同步重读
+            finish_sync(read, res > 0 ? res : 0);
+        else
+        {
+            completed_.fetch_add(1, std::memory_order_relaxed);
+            read.done(RC::IO_ERROR);
+        }
+
+        // 回调返回后才归还槽，析构时等到全部槽空闲即全部回调都已返回
+        read.done = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(submit_mutex_);
+            free_slots_.push_back(static_cast<uint32_t>(tag));
+        }
+        slot_cv_.notify_all();
+    }
+}
+
+AsyncIoStats AsyncIo::stats() const
+{
+    AsyncIoStats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.batches   = batches_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.fallbacks = fallbacks_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+enum class RC;
+
+/*
+ * 基于io_uring的异步读。
+ *
+ * 直接使用io_uring_setup/io_uring_enter系统调用与映射的提交、完成队列，不依赖liburing。
+ * 一批读请求在提交锁下依次填入提交队列，再用一次io_uring_enter提交；完成线程阻塞在io_uring_enter上
+ * 等待完成事件，逐个调用请求的回调。进行中的请求数不超过队列深度，满时提交者等待。
+ *
+ * 内核不支持io_uring或被禁止使用时（如容器的seccomp策略）退化为在提交者线程中同步pread，
+ * 回调在submit返回前调用。读到文件末尾时其余部分补0，短读的剩余部分在完成线程中同步读完。
+ */
+
+/**
+ * @brief 异步读请求
+ */
+struct AsyncRead
+{
+    int                     fd;      ///< 文件描述符
+    char*                   buf;     ///< 输出缓冲区
+    std::size_t             len;     ///< 读取的字节数
+    off_t                   offset;  ///< 文件偏移
+    std::function<void(RC)> done;    ///< 完成回调，在完成线程中调用，不能阻塞在其他异步读上
+};
+
+/**
+ * @brief 异步读统计快照
+ */
+struct AsyncIoStats
+{
+    uint64_t submitted;  ///< 提交的请求数
+    uint64_t batches;    ///< 提交时调用io_uring_enter的次数
+    uint64_t completed;  ///< 完成的请求数
+    uint64_t fallbacks;  ///< 同步pread完成或补读的请求数
+};
+
+/**
+ * @brief 异步读引擎
+ *
+ * 线程安全。
+ */
+class AsyncIo
+{
+  public:
+    /**
+     * @brief 构造函数
+     *
+     * @param depth 队列深度，即同时进行的最大请求数；为0或io_uring不可用时同步读
+     */
+    explicit AsyncIo(unsigned int depth);
+
+    /**
+     * @brief 析构函数
+     *
+     * 等待全部请求完成后停止完成线程。
+     */
+    ~AsyncIo();
+
+    AsyncIo(const AsyncIo&)            = delete;
+    AsyncIo& operator=(const AsyncIo&) = delete;
+
+    /**
+     * @brief 是否在使用io_uring
+     */
+    bool uring() const { return ring_fd_ >= 0; }
+
+    /**
+     * @brief 批量提交读请求，不等待完成
+     *
+     * 请求多于空闲的队列项时分几次提交，期间等待先前的请求完成。reads中的回调被移走。
+     */
+    void submit(std::vector<AsyncRead>& reads);
+
+    AsyncIoStats stats() const;
+
+  private:
+    /**
+     * @brief 填入一个提交队列项，调用者持有submit_mutex_
+     *
+     * @param tag 完成事件的user_data，读请求为请求槽的下标
+     */
+    void push(uint64_t tag, uint8_t opcode);
+
+    /**
+     * @brief 提交已填入的队列项，调用者持有submit_mutex_
+     *
+     * @return 提交的项数，出错时其余的队列项已被撤回
+     */
+    unsigned int enter(unsigned int count);
+
+    /**
+     * @brief 同步读完请求剩余的部分并调用回调
+     */
+    void finish_sync(AsyncRead& read, std::size_t got);
+
+    /**
+     * @brief 解除队列的映射并关闭io_uring
+     */
+    void close_ring();
+
+    void complete_loop();
+
+    int                     ring_fd_{-1};    ///< io_uring的文件描述符，-1为同步读
+    unsigned int            depth_{0};       ///< 队列深度
+    void*                   sq_ring_{};      ///< 映射的提交队列
+    void*                   cq_ring_{};      ///< 映射的完成队列，与提交队列共用映射时等于sq_ring_
+    std::size_t             sq_ring_size_{}; ///< 提交队列映射的大小
+    std::size_t             cq_ring_size_{}; ///< 完成队列映射的大小
+    void*                   sqes_{};         ///< 映射的提交队列项数组
+    std::size_t             sqes_size_{};    ///< 提交队列项数组的大小
+    unsigned int*           sq_tail_{};      ///< 提交队列尾
+    unsigned int*           sq_head_{};      ///< 提交队列头，由内核推进
+    unsigned int            sq_mask_{};      ///< 提交队列下标掩码
+    unsigned int*           sq_array_{};     ///< 提交队列中的队列项下标
+    unsigned int*           cq_head_{};      ///< 完成队列头，由完成线程推进
+    unsigned int*           cq_tail_{};      ///< 完成队列尾，由内核推进
+    unsigned int            cq_mask_{};      ///< 完成队列下标掩码
+    void*                   cqes_{};         ///< 完成事件数组
+    std::vector<AsyncRead>  slots_;          ///< 按user_data索引的进行中请求
+    std::vector<uint32_t>   free_slots_;     ///< 空闲的请求槽
+    std::mutex              submit_mutex_;   ///< 保护提交队列、slots_的分配与free_slots_
+    std::condition_variable slot_cv_;        ///< 有请求完成时唤醒等待空闲槽的提交者
+    std::thread             completer_;      ///< 完成线程
+    std::atomic<uint64_t>   submitted_{0};   ///< 提交的请求数
+    std::atomic<uint64_t>   batches_{0};     ///< io_uring_enter次数
+    std::atomic<uint64_t>   completed_{0};   ///< 完成的请求数
+    std::atomic<uint64_t>   fallbacks_{0};   ///< 同步完成的请求数
+};
@@ -0,0 +1,280 @@
+#include "bplus_builder.h"
+#include <algorithm>
+#include <future>
+#include "Thread/ThreadPool.h"
+#include "ret.h"
+#include "sql/sort_key.h"
+
+static constexpr std::size_t MinSortRun = 1 << 14;  ///< 并行排序时每段的最少条目数
+
+BPlusTreeBuilder::BPlusTreeBuilder(BPlusTree& tree, double fill_factor, RC& rc)
+    : tree_(tree),
+      limit_(sizeof(NodeHeader) + static_cast<std::size_t>((tree.page_size_ - sizeof(NodeHeader)) * fill_factor)),
+      last_value_(0),
+      count_(0),
+      finished_(true)
+{
+    if (!(fill_factor > 0 && fill_factor <= 1))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    // 空树只有一个空的根叶子，它成为第一个叶子
+    tree_latch_.emplace(tree_.root_latch_.write());
+    Level& leaf = levels_.emplace_back();
+    leaf.page   = tree_.fetch(tree_.root_.load(std::memory_order_relaxed), rc);
+    if (SUCC(rc))
+    {
+        leaf.latch.emplace(leaf.page.latch().write());
+        BTreeNode root = tree_.node(leaf.page);
+        if (root.is_leaf() && root.count() == 0)
+        {
+            // 乐观读者不获取树级写锁，锁住原根叶子的版本号让它们等到新的根节点生效
+            first_leaf_ = tree_.fetch(leaf.page.id().page, rc);
+            if (SUCC(rc))
+            {
+                first_leaf_.version().lock();
+                finished_ = false;
+                return;
+            }
+        }
+        else
+            rc = RC::INVALID_ARGUMENT;
+        leaf.latch.reset();
+    }
+    levels_.clear();
+    tree_latch_.reset();
+}
+
+BPlusTreeBuilder::~BPlusTreeBuilder()
+{
+    RC rc;
+    finish(rc);
+}
+
+bool BPlusTreeBuilder::room(const BTreeNode& node, std::size_t len) const
+{
+    if (node.count() == 0) return true;
+    std::size_t size = BTreeNode::entry_size(len, node.is_leaf()) + BTreeNode::SlotSize;
+    return node.fits(len) && node.used_bytes() + size <= limit_;
+}
+
+void BPlusTreeBuilder::seal(Level& level, RC& rc)
+{
+    PageId id = level.page.id();
+    level.page.mark_dirty();
+    level.latch.reset();
+    tree_.pool_.flush_page(id, rc);
+    level.page.release();
+}
+
+void BPlusTreeBuilder::add(const uint8_t* key, std::size_t len, uint64_t value, RC& rc)
+{
+    if (finished_ || len > tree_.max_key_size_ ||
+        (count_ && compare_key(last_key_.data(), last_key_.size(), last_value_, key, len, value) >= 0))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    rc             = RC::SUCCESS;
+    BTreeNode leaf = tree_.node(levels_[0].page);
+    if (!room(leaf, len))
+    {
+        PageGuard page = tree_.allocate_node(nullptr, 0, rc);
+        if (FAIL(rc)) return;
+        page_no_t left  = levels_[0].page.id().page;
+        page_no_t right = page.id().page;
+        leaf.set_next(right);
+        seal(levels_[0], rc);
+        if (FAIL(rc)) return;
+        levels_[0].page = std::move(page);
+        levels_[0].latch.emplace(levels_[0].page.latch().write());
+        push(1, key, len, value, left, right, rc);
+        if (FAIL(rc)) return;
+        leaf = tree_.node(levels_[0].page);
+    }
+
+    leaf.insert(leaf.count(), key, len, value);
+    last_key_.assign(key, key + len);
+    last_value_ = value;
+    ++count_;
+}
+
+void BPlusTreeBuilder::push(
+    std::size_t level, const uint8_t* key, std::size_t len, uint64_t value, page_no_t left, page_no_t child, RC& rc)
+{
+    if (level == levels_.size())
+    {
+        PageGuard page = tree_.allocate_node(nullptr, static_cast<uint16_t>(level), rc);
+        if (FAIL(rc)) return;
+        Level& top = levels_.emplace_back();
+        top.page   = std::move(page);
+        top.latch.emplace(top.page.latch().write());
+        tree_.node(top.page).set_leftmost(left);
+    }
+
+    BTreeNode node = tree_.node(levels_[level].page);
+    if (room(node, len))
+    {
+        node.insert(node.count(), key, len, value, child);
+        return;
+    }
+
+    // 节点已满：分隔条目继续上推，child成为新节点的最左孩子
+    PageGuard page = tree_.allocate_node(nullptr, static_cast<uint16_t>(level), rc);
+    if (FAIL(rc)) return;
+    page_no_t full  = levels_[level].page.id().page;
+    page_no_t fresh = page.id().page;
+    seal(levels_[level], rc);
+    if (FAIL(rc)) return;
+    levels_[level].page = std::move(page);
+    levels_[level].latch.emplace(levels_[level].page.latch().write());
+    tree_.node(levels_[level].page).set_leftmost(child);
+    push(level + 1, key, len, value, full, fresh, rc);
+}
+
+void BPlusTreeBuilder::finish(RC& rc)
+{
+    rc = RC::SUCCESS;
+    if (finished_) return;
+    finished_ = true;
+
+    page_no_t root   = levels_.back().page.id().page;
+    uint32_t  height = static_cast<uint32_t>(levels_.size());
+    for (auto& level : levels_)
+    {
+        RC seal_rc;
+        seal(level, seal_rc);
+        if (FAIL(seal_rc)) rc = seal_rc;
+    }
+    levels_.clear();
+    {
+        std::lock_guard<std::mutex> lock(tree_.meta_mutex_);
+        tree_.root_.store(root, std::memory_order_relaxed);
+        tree_.height_.store(height, std::memory_order_release);
+        RC meta_rc;
+        tree_.write_meta(nullptr, meta_rc);
+        if (FAIL(meta_rc)) rc = meta_rc;
+    }
+    first_leaf_.version().unlock();
+    first_leaf_.release();
+    tree_latch_.reset();
+}
+
+static bool entry_less(const SortEntry& a, const SortEntry& b) { return compare_entries(a, b) < 0; }
+
+/**
+ * @brief 在pool中并行排序
+ *
+ * 分成pool中线程数个段各自基数排序，再逐轮两两归并，每轮的归并并行执行。
+ */
+static void parallel_sort(std::vector<SortEntry>& entries, ThreadPool& pool)
+{
+    std::size_t parts = std::min<std::size_t>(pool.Size(), entries.size() / MinSortRun);
+    if (parts <= 1)
+    {
+        radix_sort(entries);
+        return;
+    }
+
+    std::vector<std::vector<SortEntry>> runs(parts);
+    std::vector<std::future<void>>      tasks;
+    for (std::size_t part = 0; part < parts; ++part)
+        tasks.push_back(pool.EnQueue([&, part] {
+            runs[part].assign(entries.begin() + entries.size() * part / parts,
+                entries.begin() + entries.size() * (part + 1) / parts);
+            radix_sort(runs[part]);
+        }));
+    auto blocking = ThreadPool::ManagedBlock();
+    for (auto& task : tasks) task.get();
+
+    while (runs.size() > 1)
+    {
+        std::vector<std::vector<SortEntry>> merged((runs.size() + 1) / 2);
+        tasks.clear();
+        for (std::size_t i = 0; i < merged.size(); ++i)
+            tasks.push_back(pool.EnQueue([&, i] {
+                if (2 * i + 1 == runs.size())
+                {
+                    merged[i] = std::move(runs[2 * i]);
+                    return;
+                }
+                std::vector<SortEntry>& a = runs[2 * i];
+                std::vector<SortEntry>& b = runs[2 * i + 1];
+                merged[i].resize(a.size() + b.size());
+                std::merge(a.begin(), a.end(), b.begin(), b.end(), merged[i].begin(), entry_less);
+                std::vector<SortEntry>().swap(a);
+                std::vector<SortEntry>().swap(b);
+            }));
+        for (auto& task : tasks) task.get();
+        runs = std::move(merged);
+    }
+    entries = std::move(runs[0]);
+}
+
+static bool same_key(const SortEntry& a, const SortEntry& b)
+{
+    return a.prefix == b.prefix && a.length == b.length && memcmp(a.key, b.key, a.length) == 0;
+}
+
+void bulk_load(BPlusTree& tree, const SortKeyBuffer& keys, const std::vector<uint64_t>& values, double fill_factor,
+    ThreadPool& pool, RC& rc)
+{
+    std::size_t n = keys.size();
+    if (n != values.size() || n > UINT32_MAX)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (keys.length(i) > tree.max_key_size())
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+    }
+
+    bool sorted = true;
+    for (std::size_t i = 1; sorted && i < n; ++i)
+    {
+        int cmp = compare_key(keys.key(i - 1), keys.length(i - 1), values[i - 1], keys.key(i), keys.length(i), values[i]);
+        sorted  = cmp < 0;
+    }
+    if (sorted)
+    {
+        BPlusTreeBuilder builder(tree, fill_factor, rc);
+        for (std::size_t i = 0; i < n && SUCC(rc); ++i) builder.add(keys.key(i), keys.length(i), values[i], rc);
+        if (SUCC(rc)) builder.finish(rc);
+        return;
+    }
+
+    // 排序项在键相同时按下标排序，再把键相同的每一段按值排序，构建前先查出重复的(键, 值)
+    std::vector<SortEntry> entries;
+    make_entries(keys, entries);
+    parallel_sort(entries, pool);
+    for (std::size_t begin = 0, end; begin < n; begin = end)
+    {
+        for (end = begin + 1; end < n && same_key(entries[begin], entries[end]); ++end)
+        {
+        }
+        if (end - begin == 1) continue;
+        std::sort(entries.begin() + begin, entries.begin() + end,
+            [&](const SortEntry& a, const SortEntry& b) { return values[a.row] < values[b.row]; });
+        for (std::size_t i = begin + 1; i < end; ++i)
+        {
+            if (values[entries[i - 1].row] == values[entries[i].row])
+            {
+                rc = RC::INVALID_ARGUMENT;
+                return;
+            }
+        }
+    }
+
+    BPlusTreeBuilder builder(tree, fill_factor, rc);
+    for (std::size_t i = 0; i < n && SUCC(rc); ++i)
+        builder.add(entries[i].key, entries[i].length, values[entries[i].row], rc);
+    if (SUCC(rc)) builder.finish(rc);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "bplus_tree.h"
+
+enum class RC;
+class SortKeyBuffer;
+class ThreadPool;
+
+/*
+ * B+树的自底向上批量构建。
+ *
+ * 按(键, 值)升序逐条追加：叶子按填充率装满后分配下一个叶子并串进叶子链，新叶子的第一个条目
+ * 作为分隔条目追加到上一层最右的内部节点，内部节点装满时同样向上一层推出分隔条目，需要时新建一层。
+ * 每层只有最右节点在构建中，装满的节点立即按分配顺序写回，页面从文件末尾连续分配，写入基本是顺序的。
+ * 构建期间持有树级写锁并锁住原根叶子的版本号，其他线程对这棵树的操作等待构建结束。
+ */
+
+/**
+ * @brief 批量构建器
+ *
+ * 只能用于空树。析构时若尚未调用finish则自动完成构建。
+ */
+class BPlusTreeBuilder
+{
+  public:
+    /**
+     * @brief 构造函数
+     *
+     * @param fill_factor 节点的填充率，(0, 1]
+     * @param rc 树不为空或填充率不合法时为RC::INVALID_ARGUMENT
+     */
+    BPlusTreeBuilder(BPlusTree& tree, double fill_factor, RC& rc);
+    ~BPlusTreeBuilder();
+
+    BPlusTreeBuilder(const BPlusTreeBuilder&)            = delete;
+    BPlusTreeBuilder& operator=(const BPlusTreeBuilder&) = delete;
+
+    /**
+     * @brief 追加(key, value)
+     *
+     * @param rc 键超过BPlusTree::max_key_size()或不大于上一个(键, 值)时为RC::INVALID_ARGUMENT
+     */
+    void add(const uint8_t* key, std::size_t len, uint64_t value, RC& rc);
+
+    /**
+     * @brief 写回各层最右节点，设置根节点与树高
+     */
+    void finish(RC& rc);
+
+    uint64_t count() const { return count_; }
+
+  private:
+    /**
+     * @brief 某一层正在构建的最右节点
+     */
+    struct Level
+    {
+        PageGuard                 page;   ///< 节点页
+        std::optional<WriteGuard> latch;  ///< 写锁，先于page释放
+    };
+
+    /**
+     * @brief 节点装入一个键长为len的条目后是否仍不超过填充率，空节点总能装入
+     */
+    bool room(const BTreeNode& node, std::size_t len) const;
+
+    /**
+     * @brief 把指向child的分隔条目追加到第level层，left为child的左邻节点
+     */
+    void push(std::size_t level, const uint8_t* key, std::size_t len, uint64_t value, page_no_t left, page_no_t child,
+        RC& rc);
+
+    /**
+     * @brief 结束一个节点：标记脏页、释放写锁并写回
+     */
+    void seal(Level& level, RC& rc);
+
+    BPlusTree&                tree_;        ///< 构建的树
+    std::size_t               limit_;       ///< 节点装入条目后允许占用的最大字节数
+    std::optional<WriteGuard> tree_latch_;  ///< 树级写锁
+    PageGuard                 first_leaf_;  ///< 原根叶子，构建期间钉住并锁住版本号
+    std::vector<Level>        levels_;      ///< 自底向上每层的最右节点
+    std::vector<uint8_t>      last_key_;    ///< 上一个键
+    uint64_t                  last_value_;  ///< 上一个值
+    uint64_t                  count_;       ///< 已追加的条目数
+    bool                      finished_;    ///< 是否已完成构建
+};
+
+/**
+ * @brief 用一批(键, 值)批量构建空树
+ *
+ * 输入已按(键, 值)升序时直接流式构建；否则先在pool中并行排序：分段基数排序后两两归并，
+ * 再把键相同的条目按值排序。
+ *
+ * @param values values[i]为keys中第i个键的值
+ * @param rc 键与值的个数不一致、(键, 值)重复或树不为空时为RC::INVALID_ARGUMENT
+ */
+void bulk_load(BPlusTree& tree, const SortKeyBuffer& keys, const std::vector<uint64_t>& values, double fill_factor,
+    ThreadPool& pool, RC& rc);
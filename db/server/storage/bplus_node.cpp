@@ -0,0 +1,126 @@
+#include "bplus_node.h"
+#include <vector>
+
+void BTreeNode::init(uint16_t level)
+{
+    NodeHeader& h = header();
+    h.lsn         = 0;
+    h.level       = level;
+    h.count       = 0;
+    h.heap_begin  = static_cast<uint32_t>(page_size_);
+    h.garbage     = 0;
+    h.next        = InvalidPageNo;
+    h.leftmost    = InvalidPageNo;
+}
+
+std::size_t BTreeNode::lower_bound(const uint8_t* key, std::size_t len, uint64_t value) const
+{
+    std::size_t lo = 0, hi = count();
+    while (lo < hi)
+    {
+        std::size_t mid = (lo + hi) / 2;
+        if (compare(mid, key, len, value) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int BTreeNode::child_index(const uint8_t* key, std::size_t len, uint64_t value) const
+{
+    // 最后一个不大于(key, value)的分隔条目
+    std::size_t lo = 0, hi = count();
+    while (lo < hi)
+    {
+        std::size_t mid = (lo + hi) / 2;
+        if (compare(mid, key, len, value) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return static_cast<int>(lo) - 1;
+}
+
+void BTreeNode::insert(std::size_t i, const uint8_t* key, std::size_t len, uint64_t value, page_no_t child)
+{
+    std::size_t size = entry_size(len, is_leaf());
+    if (header().heap_begin - slots_end() < size + SlotSize) compact();
+
+    NodeHeader& h = header();
+    h.heap_begin -= static_cast<uint32_t>(size);
+    char* p = page_ + h.heap_begin;
+    store<uint16_t>(p, static_cast<uint16_t>(len));
+    memcpy(p + 2, key, len);
+    store<uint64_t>(p + 2 + len, value);
+    if (!is_leaf()) store<page_no_t>(p + 2 + len + 8, child);
+
+    char* slots = page_ + sizeof(NodeHeader);
+    memmove(slots + (i + 1) * SlotSize, slots + i * SlotSize, (h.count - i) * SlotSize);
+    store<uint16_t>(slots + i * SlotSize, static_cast<uint16_t>(h.heap_begin));
+    ++h.count;
+}
+
+void BTreeNode::remove(std::size_t i)
+{
+    NodeHeader& h = header();
+    h.garbage += static_cast<uint32_t>(entry_bytes(i));
+    char* slots = page_ + sizeof(NodeHeader);
+    memmove(slots + i * SlotSize, slots + (i + 1) * SlotSize, (h.count - i - 1) * SlotSize);
+    if (--h.count == 0)
+    {
+        h.heap_begin = static_cast<uint32_t>(page_size_);
+        h.garbage    = 0;
+    }
+}
+
+void BTreeNode::move_to(BTreeNode& other, std::size_t from)
+{
+    std::size_t n = count();
+    for (std::size_t i = from; i < n; ++i)
+        other.insert(other.count(), key(i), key_len(i), value(i), is_leaf() ? InvalidPageNo : child(i));
+
+    NodeHeader& h = header();
+    for (std::size_t i = from; i < n; ++i) h.garbage += static_cast<uint32_t>(entry_bytes(i));
+    h.count = static_cast<uint16_t>(from);
+    if (from == 0)
+    {
+        h.heap_begin = static_cast<uint32_t>(page_size_);
+        h.garbage    = 0;
+    }
+}
+
+std::size_t BTreeNode::split_point() const
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count(); ++i) total += entry_bytes(i) + SlotSize;
+
+    std::size_t left = 0, i = 0;
+    while (i + 1 < count() && left + (entry_bytes(i) + SlotSize) / 2 < total / 2)
+    {
+        left += entry_bytes(i) + SlotSize;
+        ++i;
+    }
+    return i ? i : 1;
+}
+
+void BTreeNode::compact()
+{
+    NodeHeader& h = header();
+    if (h.garbage == 0) return;
+
+    // 按槽的顺序把条目复制到临时缓冲区末尾，再整体拷回
+    std::vector<char> buf(page_size_);
+    std::size_t       end   = page_size_;
+    char*             slots = page_ + sizeof(NodeHeader);
+    for (std::size_t i = 0; i < h.count; ++i)
+    {
+        std::size_t size = entry_bytes(i);
+        end -= size;
+        memcpy(buf.data() + end, entry(i), size);
+        store<uint16_t>(slots + i * SlotSize, static_cast<uint16_t>(end));
+    }
+    memcpy(page_ + end, buf.data() + end, page_size_ - end);
+    h.heap_begin = static_cast<uint32_t>(end);
+    h.garbage    = 0;
+}
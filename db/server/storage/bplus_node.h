@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "disk_manager.h"
+
+/*
+ * B+树节点的页面布局。
+ *
+ *   [NodeHeader][槽数组，uint16_t × count，向高地址增长] ... 空闲 ... [条目区，向低地址增长]
+ *
+ * 叶子条目为[键长 uint16_t][键][值 uint64_t]，内部节点的条目再跟一个[孩子页号 uint32_t]。
+ * 条目按(键, 值)排序：键是规范化排序键，按memcmp比较、相同前缀时短者在前，键相同时按值比较。
+ * 同一个键可以对应多个值（如多个行号），(键, 值)整体唯一。
+ * 内部节点第i个条目的(键, 值)是第i个孩子中的最小条目的下界，小于第0个条目的都在leftmost中。
+ * 删除条目只回收槽，条目区的空洞在空间不足时由compact整理。
+ */
+
+/**
+ * @brief 节点页头
+ */
+struct NodeHeader
+{
+    uint64_t  lsn;         ///< 最后修改该页的日志序号
+    uint16_t  level;       ///< 层号，叶子为0
+    uint16_t  count;       ///< 条目数
+    uint32_t  heap_begin;  ///< 条目区起始偏移
+    uint32_t  garbage;     ///< 条目区中已删除条目占用的字节数
+    page_no_t next;        ///< 同层右兄弟，最右节点为InvalidPageNo
+    page_no_t leftmost;    ///< 内部节点的最左孩子
+};
+
+/**
+ * @brief 比较两个(键, 值)
+ *
+ * @return 小于、等于、大于时分别返回负数、0、正数
+ */
+inline int compare_key(
+    const uint8_t* a, std::size_t a_len, uint64_t a_value, const uint8_t* b, std::size_t b_len, uint64_t b_value)
+{
+    int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (cmp != 0) return cmp;
+    if (a_len != b_len) return a_len < b_len ? -1 : 1;
+    return a_value < b_value ? -1 : a_value > b_value;
+}
+
+/**
+ * @brief 页面上的B+树节点视图
+ *
+ * 不拥有页面内存，调用者负责钉住页面并持有相应的页锁。
+ */
+class BTreeNode
+{
+  public:
+    static constexpr std::size_t SlotSize = sizeof(uint16_t);  ///< 每个槽的字节数
+
+    BTreeNode(char* page, std::size_t page_size) : page_(page), page_size_(page_size) {}
+
+    /**
+     * @brief 初始化为空节点
+     */
+    void init(uint16_t level);
+
+    /**
+     * @brief 一个条目在条目区中占用的字节数，不含槽
+     */
+    static std::size_t entry_size(std::size_t key_len, bool leaf) { return 2 + key_len + 8 + (leaf ? 0 : 4); }
+
+    uint16_t  level() const { return header().level; }
+    bool      is_leaf() const { return header().level == 0; }
+    uint16_t  count() const { return header().count; }
+    page_no_t next() const { return header().next; }
+    page_no_t leftmost() const { return header().leftmost; }
+    void      set_next(page_no_t next) { header().next = next; }
+    void      set_leftmost(page_no_t child) { header().leftmost = child; }
+
+    const uint8_t* key(std::size_t i) const { return reinterpret_cast<const uint8_t*>(entry(i) + 2); }
+    std::size_t    key_len(std::size_t i) const { return load<uint16_t>(entry(i)); }
+    uint64_t       value(std::size_t i) const { return load<uint64_t>(entry(i) + 2 + key_len(i)); }
+    page_no_t      child(std::size_t i) const { return load<page_no_t>(entry(i) + 2 + key_len(i) + 8); }
+
+    /**
+     * @brief 孩子下标对应的页号，-1为leftmost
+     */
+    page_no_t child_at(int index) const { return index < 0 ? leftmost() : child(index); }
+
+    /**
+     * @brief 第i个条目与(key, value)比较
+     */
+    int compare(std::size_t i, const uint8_t* key, std::size_t len, uint64_t value) const
+    {
+        return compare_key(this->key(i), key_len(i), this->value(i), key, len, value);
+    }
+
+    /**
+     * @brief 第一个不小于(key, value)的条目下标
+     */
+    std::size_t lower_bound(const uint8_t* key, std::size_t len, uint64_t value) const;
+
+    /**
+     * @brief 内部节点中可能包含(key, value)的孩子下标，-1为leftmost
+     */
+    int child_index(const uint8_t* key, std::size_t len, uint64_t value) const;
+
+    /**
+     * @brief 整理后可用的字节数
+     */
+    std::size_t free_space() const { return header().heap_begin - slots_end() + header().garbage; }
+
+    /**
+     * @brief 有效数据占用的字节数：页头、槽与未删除的条目
+     */
+    std::size_t used_bytes() const { return page_size_ - free_space(); }
+
+    /**
+     * @brief 节点能否再放下一个键长为len的条目
+     */
+    bool fits(std::size_t len) const { return free_space() >= entry_size(len, is_leaf()) + SlotSize; }
+
+    /**
+     * @brief 在下标i处插入条目，调用者须先用fits确认空间足够
+     */
+    void insert(std::size_t i, const uint8_t* key, std::size_t len, uint64_t value, page_no_t child = InvalidPageNo);
+
+    /**
+     * @brief 删除下标i处的条目
+     */
+    void remove(std::size_t i);
+
+    /**
+     * @brief 把[from, count)的条目按顺序追加到other末尾，并从本节点删除
+     *
+     * 调用者须保证other放得下，且这些条目都大于other中已有的条目。
+     */
+    void move_to(BTreeNode& other, std::size_t from);
+
+    /**
+     * @brief 按字节数对半分裂时右半部分的起始下标，至少为1且小于count
+     */
+    std::size_t split_point() const;
+
+    /**
+     * @brief 整理条目区，消除删除留下的空洞
+     */
+    void compact();
+
+  private:
+    template <class T>
+    static T load(const char* p)
+    {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    template <class T>
+    static void store(char* p, T value)
+    {
+        memcpy(p, &value, sizeof(T));
+    }
+
+    NodeHeader&       header() { return *reinterpret_cast<NodeHeader*>(page_); }
+    const NodeHeader& header() const { return *reinterpret_cast<const NodeHeader*>(page_); }
+    std::size_t       slots_end() const { return sizeof(NodeHeader) + header().count * SlotSize; }
+    uint16_t          slot(std::size_t i) const { return load<uint16_t>(page_ + sizeof(NodeHeader) + i * SlotSize); }
+    const char*       entry(std::size_t i) const { return page_ + slot(i); }
+    std::size_t       entry_bytes(std::size_t i) const { return entry_size(key_len(i), is_leaf()); }
+
+    char*       page_;       ///< 页面内存
+    std::size_t page_size_;  ///< 页大小
+};
@@ -0,0 +1,1057 @@
+#include "bplus_tree.h"
+#include <algorithm>
+#include <future>
+#include <thread>
+#include "Thread/ThreadPool.h"
+#include "recovery.h"
+#include "ret.h"
+#include "sql/sort_key.h"
+
+static constexpr char    TreeMagic[8] = {'M', 'I', 'N', 'I', 'B', 'P', 'T', 'R'};
+static constexpr uint8_t EmptyKey[1]  = {0};  ///< 长度为0的键，代替空指针传给memcmp
+
+/**
+ * @brief 元数据页布局
+ */
+struct TreeMeta
+{
+    uint64_t  lsn;        ///< 最后修改该页的日志序号
+    char      magic[8];   ///< 魔数
+    page_no_t root;       ///< 根节点页号
+    uint32_t  height;     ///< 树高
+    page_no_t free_head;  ///< 空闲页链表头
+};
+
+void BPlusTreeIterator::skip_empty(RC& rc)
+{
+    rc = RC::SUCCESS;
+    while (page_.valid() && index_ >= node().count())
+    {
+        page_no_t next = node().next();
+        if (next == InvalidPageNo)
+        {
+            latch_.reset();
+            page_.release();
+            return;
+        }
+        PageGuard page = pool_->fetch_page({file_, next}, rc);
+        if (!page.valid())
+        {
+            latch_.reset();
+            page_.release();
+            return;
+        }
+        // 先取得右兄弟的读锁再释放当前叶子
+        ReadGuard latch = page.latch().read();
+        latch_.reset();
+        latch_.emplace(std::move(latch));
+        page_  = std::move(page);
+        index_ = 0;
+        read_ahead();
+    }
+}
+
+void BPlusTreeIterator::read_ahead()
+{
+    if (!read_ahead_ || !page_.valid()) return;
+    page_no_t next = node().next();
+    if (next == InvalidPageNo) return;
+    RC rc;
+    pool_->prefetch({file_, next}, rc);
+}
+
+void BPlusTreeIterator::next(RC& rc)
+{
+    ++index_;
+    skip_empty(rc);
+}
+
+void BPlusTree::Path::release_ancestors()
+{
+    root_latch.reset();
+    for (std::size_t i = first; i + 1 < nodes.size(); ++i)
+    {
+        nodes[i].latch.reset();
+        nodes[i].page.release();
+    }
+    first = nodes.size() - 1;
+}
+
+BPlusTree::BPlusTree(BufferPool& pool, file_id_t file, RC& rc) : BPlusTree(pool, file, LatchMode::CRABBING, rc) {}
+
+BPlusTree::BPlusTree(BufferPool& pool, file_id_t file, LatchMode mode, RC& rc)
+    : pool_(pool),
+      file_(file),
+      page_size_(pool.page_size()),
+      max_key_size_((page_size_ - sizeof(NodeHeader)) / 4 - BTreeNode::entry_size(0, false) - BTreeNode::SlotSize),
+      min_fill_(sizeof(NodeHeader) + (page_size_ - sizeof(NodeHeader)) / 4),
+      root_(InvalidPageNo),
+      height_(0),
+      mode_(mode)
+{
+    if (mode_ == LatchMode::OPTIMISTIC) hints_.reset(new std::atomic<Frame*>[HintSlots]());
+    if (pool.disk().page_count(file) > MetaPageNo)
+    {
+        reload(rc);
+        return;
+    }
+
+    PageGuard meta = pool_.new_page(file_, rc);
+    if (FAIL(rc)) return;
+    if (meta.id().page != MetaPageNo)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    PageGuard root = allocate_node(nullptr, 0, rc);
+    if (FAIL(rc)) return;
+    root_   = root.id().page;
+    height_ = 1;
+    std::lock_guard<std::mutex> lock(meta_mutex_);
+    write_meta(nullptr, rc);
+}
+
+void BPlusTree::reload(RC& rc)
+{
+    WriteGuard                  tree_latch = root_latch_.write();
+    std::lock_guard<std::mutex> lock(meta_mutex_);
+    TreeMeta                    header;
+    {
+        PageGuard meta = fetch(MetaPageNo, rc);
+        if (FAIL(rc)) return;
+        ReadGuard latch = meta.latch().read();
+        memcpy(&header, meta.data(), sizeof(header));
+    }
+    if (memcmp(header.magic, TreeMagic, sizeof(TreeMagic)) != 0 || header.height == 0)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    root_.store(header.root, std::memory_order_release);
+    height_.store(header.height, std::memory_order_release);
+    load_free_pages(header.free_head, rc);
+}
+
+/**
+ * @brief 沿空闲页链表读出各页，建立内存副本
+ */
+void BPlusTree::load_free_pages(page_no_t head, RC& rc)
+{
+    std::vector<page_no_t> chain;
+    page_no_t              limit = pool_.disk().page_count(file_);
+    page_no_t              page  = head;
+    while (page != InvalidPageNo)
+    {
+        if (page >= limit || chain.size() >= limit)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        PageGuard guard = fetch(page, rc);
+        if (FAIL(rc)) return;
+        ReadGuard latch = guard.latch().read();
+        chain.push_back(page);
+        page = node(guard).next();
+    }
+    free_pages_.assign(chain.rbegin(), chain.rend());
+}
+
+/**
+ * @brief 写入元数据页，保留页面LSN，调用者持有meta_mutex_
+ */
+void BPlusTree::write_meta(Transaction* txn, RC& rc)
+{
+    PageGuard meta = fetch(MetaPageNo, rc);
+    if (FAIL(rc)) return;
+    WriteGuard latch = meta.latch().write();
+    PageChange change(txn, meta);
+    TreeMeta   header;
+    memcpy(&header, meta.data(), sizeof(header));
+    memcpy(header.magic, TreeMagic, sizeof(TreeMagic));
+    header.root      = root_.load(std::memory_order_relaxed);
+    header.height    = height_.load(std::memory_order_relaxed);
+    header.free_head = free_pages_.empty() ? InvalidPageNo : free_pages_.back();
+    memcpy(meta.data(), &header, sizeof(header));
+    change.done(rc);
+}
+
+PageGuard BPlusTree::allocate_node(Transaction* txn, uint16_t level, RC& rc)
+{
+    page_no_t reuse = InvalidPageNo;
+    {
+        std::lock_guard<std::mutex> lock(meta_mutex_);
+        if (!free_pages_.empty())
+        {
+            reuse = free_pages_.back();
+            free_pages_.pop_back();
+            write_meta(txn, rc);
+            if (FAIL(rc))
+            {
+                free_pages_.push_back(reuse);
+                return {};
+            }
+        }
+    }
+    PageGuard page = reuse != InvalidPageNo ? fetch(reuse, rc) : pool_.new_page(file_, rc);
+    if (FAIL(rc)) return {};
+
+    // 释放这一页的线程可能还持有它的写锁，在这里等它放开
+    {
+        WriteGuard latch = page.latch().write();
+        PageChange change(txn, page);
+        node(page).init(level);
+        change.done(rc);
+    }
+    if (FAIL(rc)) return {};
+    return page;
+}
+
+void BPlusTree::free_node(Transaction* txn, PageGuard& page, RC& rc)
+{
+    std::lock_guard<std::mutex> lock(meta_mutex_);
+    PageChange                  change(txn, page);
+    BTreeNode                   freed = node(page);
+    freed.init(0);
+    freed.set_next(free_pages_.empty() ? InvalidPageNo : free_pages_.back());
+    change.done(rc);
+    if (FAIL(rc)) return;
+    free_pages_.push_back(page.id().page);
+    write_meta(txn, rc);
+}
+
+void BPlusTree::descend_for_read(const uint8_t* key, std::size_t len, uint64_t value, PageGuard& page,
+    std::optional<ReadGuard>& latch, RC& rc)
+{
+    std::optional<ReadGuard> tree_latch;
+    tree_latch.emplace(root_latch_.read());
+    page = fetch(root_.load(std::memory_order_relaxed), rc);
+    if (FAIL(rc)) return;
+    latch.emplace(page.latch().read());
+    tree_latch.reset();
+
+    while (!node(page).is_leaf())
+    {
+        BTreeNode parent = node(page);
+        PageGuard child  = fetch(parent.child_at(parent.child_index(key, len, value)), rc);
+        if (FAIL(rc))
+        {
+            latch.reset();
+            page.release();
+            return;
+        }
+        ReadGuard child_latch = child.latch().read();
+        latch.reset();
+        latch.emplace(std::move(child_latch));
+        page = std::move(child);
+    }
+}
+
+void BPlusTree::descend_for_write(const uint8_t* key, std::size_t len, uint64_t value, PageGuard& page,
+    std::optional<WriteGuard>& latch, RC& rc)
+{
+    std::optional<ReadGuard> tree_latch;
+    tree_latch.emplace(root_latch_.read());
+    page = fetch(root_.load(std::memory_order_relaxed), rc);
+    if (FAIL(rc)) return;
+    if (height_.load(std::memory_order_relaxed) == 1)
+    {
+        latch.emplace(page.latch().write());
+        return;
+    }
+
+    std::optional<ReadGuard> parent_latch;
+    parent_latch.emplace(page.latch().read());
+    tree_latch.reset();
+    while (true)
+    {
+        BTreeNode parent        = node(page);
+        bool      child_is_leaf = parent.level() == 1;
+        PageGuard child         = fetch(parent.child_at(parent.child_index(key, len, value)), rc);
+        if (FAIL(rc))
+        {
+            parent_latch.reset();
+            page.release();
+            return;
+        }
+        if (child_is_leaf)
+        {
+            latch.emplace(child.latch().write());
+            parent_latch.reset();
+            page = std::move(child);
+            return;
+        }
+        ReadGuard child_latch = child.latch().read();
+        parent_latch.reset();
+        parent_latch.emplace(std::move(child_latch));
+        page = std::move(child);
+    }
+}
+
+bool BPlusTree::insert_safe(const BTreeNode& node) const { return node.fits(max_key_size_); }
+
+bool BPlusTree::remove_safe(const BTreeNode& node, bool is_root) const
+{
+    if (is_root) return node.is_leaf() || node.count() > 1;
+    std::size_t largest = BTreeNode::entry_size(max_key_size_, node.is_leaf()) + BTreeNode::SlotSize;
+    return node.used_bytes() >= min_fill_ + largest;
+}
+
+void BPlusTree::descend_pessimistic(
+    const uint8_t* key, std::size_t len, uint64_t value, bool for_insert, Path& path, RC& rc)
+{
+    path.root_latch.emplace(root_latch_.write());
+    page_no_t page  = root_.load(std::memory_order_relaxed);
+    int       index = -1;
+    while (true)
+    {
+        LatchedNode& current = path.nodes.emplace_back();
+        current.page         = fetch(page, rc);
+        if (FAIL(rc)) return;
+        current.latch.emplace(current.page.latch().write());
+        current.index = index;
+
+        BTreeNode n    = node(current.page);
+        bool      safe = for_insert ? insert_safe(n) : remove_safe(n, path.nodes.size() == 1);
+        if (safe) path.release_ancestors();
+        if (n.is_leaf()) return;
+        index = n.child_index(key, len, value);
+        page  = n.child_at(index);
+    }
+}
+
+void BPlusTree::insert(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc)
+{
+    if (len > max_key_size_)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    if (mode_ == LatchMode::OPTIMISTIC)
+    {
+        insert_optimistic(txn, key, len, value, rc);
+        return;
+    }
+
+    {
+        PageGuard                 page;
+        std::optional<WriteGuard> latch;
+        descend_for_write(key, len, value, page, latch, rc);
+        if (FAIL(rc)) return;
+        BTreeNode   leaf  = node(page);
+        std::size_t index = leaf.lower_bound(key, len, value);
+        if (index < leaf.count() && leaf.compare(index, key, len, value) == 0)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        if (leaf.fits(len))
+        {
+            PageChange change(txn, page);
+            leaf.insert(index, key, len, value);
+            change.done(rc);
+            return;
+        }
+    }
+
+    restarts_.fetch_add(1, std::memory_order_relaxed);
+    Path path;
+    path.txn = txn;
+    path.nodes.reserve(height() + 1);
+    descend_pessimistic(key, len, value, true, path, rc);
+    if (FAIL(rc)) return;
+
+    BTreeNode   leaf  = node(path.nodes.back().page);
+    std::size_t index = leaf.lower_bound(key, len, value);
+    if (index < leaf.count() && leaf.compare(index, key, len, value) == 0)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    insert_into_path(path, key, len, value, rc);
+}
+
+void BPlusTree::insert_into_path(Path& path, const uint8_t* key, std::size_t len, uint64_t value, RC& rc)
+{
+    // 先分配好可能用到的全部节点，分配失败时树还没有被修改
+    std::vector<PageGuard> spare;
+    std::size_t            needed = path.nodes.size() - path.first + (path.root_latch ? 1 : 0);
+    for (std::size_t i = 0; i < needed; ++i)
+    {
+        spare.push_back(allocate_node(path.txn, 0, rc));
+        if (FAIL(rc)) break;
+    }
+    auto release_spare = [&] {
+        for (auto& page : spare)
+        {
+            if (!page.valid()) continue;
+            WriteGuard latch = page.latch().write();
+            RC         freed;
+            free_node(path.txn, page, freed);
+            if (FAIL(freed) && SUCC(rc)) rc = freed;
+        }
+    };
+    if (FAIL(rc))
+    {
+        release_spare();
+        return;
+    }
+
+    std::vector<uint8_t> sep(key, key + len);
+    uint64_t             sep_value = value;
+    page_no_t            sep_child = InvalidPageNo;
+    std::vector<uint8_t> up_key;
+    uint64_t             up_value = 0;
+    std::size_t          used     = 0;
+    for (std::size_t depth = path.nodes.size(); depth-- > path.first;)
+    {
+        LatchedNode& current = path.nodes[depth];
+        BTreeNode    left    = node(current.page);
+        if (left.fits(sep.size()))
+        {
+            PageChange  change(path.txn, current.page);
+            std::size_t index = left.lower_bound(sep.data(), sep.size(), sep_value);
+            left.insert(index, sep.data(), sep.size(), sep_value, sep_child);
+            change.done(rc);
+            if (FAIL(rc)) return;
+            spare.erase(spare.begin(), spare.begin() + used);
+            release_spare();
+            return;
+        }
+
+        PageGuard& right_page  = spare[used++];
+        WriteGuard right_latch = right_page.latch().write();
+        BTreeNode  right       = node(right_page);
+        PageChange left_change(path.txn, current.page);
+        PageChange right_change(path.txn, right_page);
+        split_node(left, right_page, up_key, up_value);
+        BTreeNode& target =
+            compare_key(sep.data(), sep.size(), sep_value, up_key.data(), up_key.size(), up_value) < 0 ? left : right;
+        std::size_t index = target.lower_bound(sep.data(), sep.size(), sep_value);
+        target.insert(index, sep.data(), sep.size(), sep_value, sep_child);
+        left_change.done(rc);
+        if (FAIL(rc)) return;
+        right_change.done(rc);
+        if (FAIL(rc)) return;
+
+        sep.swap(up_key);
+        sep_value = up_value;
+        sep_child = right_page.id().page;
+    }
+
+    // 根节点分裂：新根的最左孩子为旧根，唯一的分隔条目指向新分裂出的节点
+    PageGuard& root_page = spare[used++];
+    {
+        WriteGuard root_latch = root_page.latch().write();
+        PageChange change(path.txn, root_page);
+        BTreeNode  root = node(root_page);
+        root.init(static_cast<uint16_t>(node(path.nodes[0].page).level() + 1));
+        root.set_leftmost(path.nodes[0].page.id().page);
+        root.insert(0, sep.data(), sep.size(), sep_value, sep_child);
+        change.done(rc);
+        if (FAIL(rc)) return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(meta_mutex_);
+        root_.store(root_page.id().page, std::memory_order_relaxed);
+        height_.fetch_add(1, std::memory_order_release);
+        write_meta(path.txn, rc);
+        if (FAIL(rc)) return;
+    }
+    spare.erase(spare.begin(), spare.begin() + used);
+    release_spare();
+}
+
+void BPlusTree::split_node(BTreeNode& left, PageGuard& right_page, std::vector<uint8_t>& up_key, uint64_t& up_value)
+{
+    BTreeNode right = node(right_page);
+    right.init(left.level());
+    std::size_t middle = left.split_point();
+    if (left.is_leaf())
+    {
+        left.move_to(right, middle);
+        right.set_next(left.next());
+        left.set_next(right_page.id().page);
+        up_key.assign(right.key(0), right.key(0) + right.key_len(0));
+        up_value = right.value(0);
+    }
+    else
+    {
+        // 中间的分隔条目上移，它的孩子成为右节点的最左孩子
+        up_key.assign(left.key(middle), left.key(middle) + left.key_len(middle));
+        up_value = left.value(middle);
+        right.set_leftmost(left.child(middle));
+        left.move_to(right, middle + 1);
+        left.remove(middle);
+    }
+    splits_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BPlusTree::remove(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc)
+{
+    if (mode_ == LatchMode::OPTIMISTIC)
+    {
+        remove_optimistic(txn, key, len, value, rc);
+        return;
+    }
+
+    {
+        PageGuard                 page;
+        std::optional<WriteGuard> latch;
+        descend_for_write(key, len, value, page, latch, rc);
+        if (FAIL(rc)) return;
+        BTreeNode   leaf  = node(page);
+        std::size_t index = leaf.lower_bound(key, len, value);
+        if (index == leaf.count() || leaf.compare(index, key, len, value) != 0)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        std::size_t removed = BTreeNode::entry_size(len, true) + BTreeNode::SlotSize;
+        if (page.id().page == root_.load(std::memory_order_relaxed) || leaf.used_bytes() >= min_fill_ + removed)
+        {
+            PageChange change(txn, page);
+            leaf.remove(index);
+            change.done(rc);
+            return;
+        }
+    }
+
+    restarts_.fetch_add(1, std::memory_order_relaxed);
+    Path path;
+    path.txn = txn;
+    path.nodes.reserve(height() + 1);
+    descend_pessimistic(key, len, value, false, path, rc);
+    if (FAIL(rc)) return;
+
+    LatchedNode& leaf_node = path.nodes.back();
+    BTreeNode    leaf      = node(leaf_node.page);
+    std::size_t  index     = leaf.lower_bound(key, len, value);
+    if (index == leaf.count() || leaf.compare(index, key, len, value) != 0)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    {
+        PageChange change(txn, leaf_node.page);
+        leaf.remove(index);
+        change.done(rc);
+        if (FAIL(rc)) return;
+    }
+
+    for (std::size_t depth = path.nodes.size() - 1; depth > path.first; --depth)
+    {
+        if (!underflow(node(path.nodes[depth].page)) || !merge(path, depth, rc)) break;
+    }
+    if (FAIL(rc)) return;
+
+    // 根节点只剩一个孩子时降低树高
+    if (path.root_latch)
+    {
+        PageGuard& root_page = path.nodes[0].page;
+        BTreeNode  root      = node(root_page);
+        if (!root.is_leaf() && root.count() == 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(meta_mutex_);
+                root_.store(root.leftmost(), std::memory_order_relaxed);
+                height_.fetch_sub(1, std::memory_order_release);
+                write_meta(txn, rc);
+                if (FAIL(rc)) return;
+            }
+            free_node(txn, root_page, rc);
+        }
+    }
+}
+
+bool BPlusTree::merge(Path& path, std::size_t depth, RC& rc)
+{
+    LatchedNode& current = path.nodes[depth];
+    PageGuard&   parent  = path.nodes[depth - 1].page;
+    BTreeNode    p       = node(parent);
+    if (p.count() == 0) return false;
+
+    // 同层加锁只能从左到右：与左兄弟合并时先放开自己的写锁
+    int                       index         = current.index;
+    bool                      current_left  = index + 1 < static_cast<int>(p.count());
+    int                       separator     = current_left ? index + 1 : index;
+    PageGuard                 sibling       = fetch(p.child_at(current_left ? index + 1 : index - 1), rc);
+    std::optional<WriteGuard> sibling_latch;
+    if (FAIL(rc)) return false;
+    if (current_left)
+        sibling_latch.emplace(sibling.latch().write());
+    else
+    {
+        current.latch.reset();
+        sibling_latch.emplace(sibling.latch().write());
+        current.latch.emplace(current.page.latch().write());
+    }
+
+    PageGuard&  left_page  = current_left ? current.page : sibling;
+    PageGuard&  right_page = current_left ? sibling : current.page;
+    BTreeNode   left       = node(left_page);
+    BTreeNode   right      = node(right_page);
+    std::size_t needed     = right.used_bytes() - sizeof(NodeHeader);
+    if (!left.is_leaf()) needed += BTreeNode::entry_size(p.key_len(separator), false) + BTreeNode::SlotSize;
+    if (left.free_space() < needed) return false;
+
+    PageChange left_change(path.txn, left_page);
+    PageChange parent_change(path.txn, parent);
+    if (left.is_leaf())
+        left.set_next(right.next());
+    else
+        left.insert(left.count(), p.key(separator), p.key_len(separator), p.value(separator), right.leftmost());
+    right.move_to(left, 0);
+    p.remove(separator);
+    left_change.done(rc);
+    if (FAIL(rc)) return false;
+    parent_change.done(rc);
+    if (FAIL(rc)) return false;
+    free_node(path.txn, right_page, rc);
+    if (FAIL(rc)) return false;
+    merges_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void BPlusTree::lookup(const uint8_t* key, std::size_t len, std::vector<uint64_t>& values, RC& rc)
+{
+    if (mode_ == LatchMode::OPTIMISTIC)
+    {
+        lookup_optimistic(key, len, values, rc);
+        return;
+    }
+
+    BPlusTreeIterator it = lower_bound(key, len, rc);
+    while (it.valid() && it.key_len() == len && memcmp(it.key(), key, len) == 0)
+    {
+        values.push_back(it.value());
+        it.next(rc);
+    }
+}
+
+bool BPlusTree::optimistic_read(page_no_t page, OptNode& node, RC& rc)
+{
+    rc                         = RC::SUCCESS;
+    uint64_t             key   = PageId{file_, page}.key();
+    std::atomic<Frame*>& hint  = hints_[page & (HintSlots - 1)];
+    Frame*               frame = hint.load(std::memory_order_acquire);
+    if (!frame || frame->page_key.load(std::memory_order_acquire) != key)
+    {
+        frame = pool_.frame_of({file_, page}, rc);
+        if (!frame) return false;
+        hint.store(frame, std::memory_order_release);
+    }
+    node.frame = frame;
+    node.page  = page;
+    // 帧可能在检查之后被复用：读入新页期间版本号是锁住的，read_begin之后再确认帧中仍是这一页
+    return frame->version.read_begin(node.version) && frame->page_key.load(std::memory_order_acquire) == key;
+}
+
+bool BPlusTree::lock_node(const OptNode& node, LockedNode& locked, RC& rc)
+{
+    locked.page = fetch(node.page, rc);
+    if (FAIL(rc)) return false;
+    // 页面在乐观读之后被淘汰并读入了别的帧
+    if (&locked.page.version() != &node.frame->version) return false;
+    WriteGuard latch = locked.page.latch().try_write(rc);
+    if (FAIL(rc))
+    {
+        rc = RC::SUCCESS;
+        return false;
+    }
+    if (!locked.page.version().upgrade(node.version)) return false;
+    locked.latch.emplace(std::move(latch));
+    locked.locked = true;
+    return true;
+}
+
+bool BPlusTree::optimistic_descend(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value,
+    bool split_full, OptNode& parent, OptNode& leaf, RC& rc)
+{
+    parent         = OptNode{};
+    page_no_t root = root_.load(std::memory_order_acquire);
+    if (!optimistic_read(root, leaf, rc) || root_.load(std::memory_order_acquire) != root) return false;
+
+    // 读到的内容在校验之前可能不一致，只能用来计算，不能据此访问别的节点
+    while (true)
+    {
+        BTreeNode n = node(leaf);
+        if (n.is_leaf()) return leaf.frame->version.validate(leaf.version);
+        page_no_t child = n.child_at(n.child_index(key, len, value));
+        bool      full  = split_full && !insert_safe(n);
+        if (!leaf.frame->version.validate(leaf.version)) return false;
+        if (full)
+        {
+            optimistic_split(txn, parent, leaf, rc);
+            return false;
+        }
+
+        OptNode next;
+        if (!optimistic_read(child, next, rc) || !leaf.frame->version.validate(leaf.version)) return false;
+        parent = leaf;
+        leaf   = next;
+    }
+}
+
+void BPlusTree::optimistic_split(Transaction* txn, const OptNode& parent, const OptNode& node, RC& rc)
+{
+    std::optional<WriteGuard> tree_latch;
+    LockedNode                locked_parent;
+    LockedNode                locked;
+    if (!parent.frame)
+    {
+        tree_latch.emplace(root_latch_.try_write(rc));
+        if (FAIL(rc))
+        {
+            rc = RC::SUCCESS;
+            return;
+        }
+    }
+    else if (!lock_node(parent, locked_parent, rc))
+        return;
+    if (!lock_node(node, locked, rc)) return;
+
+    // 新建根节点时需要两个页，先都分配好
+    PageGuard right_page = allocate_node(txn, 0, rc);
+    if (FAIL(rc)) return;
+    PageGuard root_page;
+    if (!parent.frame)
+    {
+        root_page = allocate_node(txn, 0, rc);
+        if (FAIL(rc))
+        {
+            WriteGuard latch = right_page.latch().write();
+            RC         freed;
+            free_node(txn, right_page, freed);
+            return;
+        }
+    }
+
+    std::vector<uint8_t> up_key;
+    uint64_t             up_value = 0;
+    BTreeNode            left     = this->node(locked.page);
+    PageChange           left_change(txn, locked.page);
+    {
+        WriteGuard right_latch = right_page.latch().write();
+        PageChange right_change(txn, right_page);
+        split_node(left, right_page, up_key, up_value);
+        right_change.done(rc);
+        if (FAIL(rc)) return;
+    }
+    left_change.done(rc);
+    if (FAIL(rc)) return;
+
+    if (parent.frame)
+    {
+        // 下降时确认过父节点放得下任意分隔键，锁定时版本号未变
+        PageChange change(txn, locked_parent.page);
+        BTreeNode  p = this->node(locked_parent.page);
+        p.insert(p.lower_bound(up_key.data(), up_key.size(), up_value), up_key.data(), up_key.size(), up_value,
+            right_page.id().page);
+        change.done(rc);
+        return;
+    }
+
+    {
+        WriteGuard root_latch = root_page.latch().write();
+        PageChange change(txn, root_page);
+        BTreeNode  root = this->node(root_page);
+        root.init(static_cast<uint16_t>(left.level() + 1));
+        root.set_leftmost(locked.page.id().page);
+        root.insert(0, up_key.data(), up_key.size(), up_value, right_page.id().page);
+        change.done(rc);
+        if (FAIL(rc)) return;
+    }
+    // 旧根的版本号解锁之前更新根节点页号，读到旧根的读者随后都会发现根已改变
+    std::lock_guard<std::mutex> lock(meta_mutex_);
+    root_.store(root_page.id().page, std::memory_order_release);
+    height_.fetch_add(1, std::memory_order_release);
+    write_meta(txn, rc);
+}
+
+void BPlusTree::backoff(unsigned int attempt)
+{
+    restarts_.fetch_add(1, std::memory_order_relaxed);
+    if (attempt > 8) std::this_thread::yield();
+}
+
+void BPlusTree::insert_optimistic(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc)
+{
+    for (unsigned int attempt = 0;; ++attempt)
+    {
+        if (attempt) backoff(attempt);
+        OptNode parent, leaf;
+        if (!optimistic_descend(txn, key, len, value, true, parent, leaf, rc))
+        {
+            if (FAIL(rc)) return;
+            continue;
+        }
+        bool fits = node(leaf).fits(len);
+        if (!leaf.frame->version.validate(leaf.version)) continue;
+        if (!fits)
+        {
+            optimistic_split(txn, parent, leaf, rc);
+            if (FAIL(rc)) return;
+            continue;
+        }
+
+        LockedNode locked;
+        if (!lock_node(leaf, locked, rc))
+        {
+            if (FAIL(rc)) return;
+            continue;
+        }
+        BTreeNode   n     = node(locked.page);
+        std::size_t index = n.lower_bound(key, len, value);
+        if (index < n.count() && n.compare(index, key, len, value) == 0)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        PageChange change(txn, locked.page);
+        n.insert(index, key, len, value);
+        change.done(rc);
+        return;
+    }
+}
+
+void BPlusTree::remove_optimistic(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc)
+{
+    for (unsigned int attempt = 0;; ++attempt)
+    {
+        if (attempt) backoff(attempt);
+        OptNode    parent, leaf;
+        LockedNode locked;
+        if (!optimistic_descend(txn, key, len, value, false, parent, leaf, rc) || !lock_node(leaf, locked, rc))
+        {
+            if (FAIL(rc)) return;
+            continue;
+        }
+        BTreeNode   n     = node(locked.page);
+        std::size_t index = n.lower_bound(key, len, value);
+        if (index == n.count() || n.compare(index, key, len, value) != 0)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        PageChange change(txn, locked.page);
+        n.remove(index);
+        change.done(rc);
+        return;
+    }
+}
+
+void BPlusTree::lookup_optimistic(const uint8_t* key, std::size_t len, std::vector<uint64_t>& values, RC& rc)
+{
+    std::size_t base = values.size();
+    for (unsigned int attempt = 0;; ++attempt)
+    {
+        if (attempt) backoff(attempt);
+        values.resize(base);
+        OptNode parent, leaf;
+        if (!optimistic_descend(nullptr, key, len, 0, false, parent, leaf, rc))
+        {
+            if (FAIL(rc)) return;
+            continue;
+        }
+
+        // 同一个键的值可能延续到右兄弟：先进入右兄弟再校验当前叶子，保证右兄弟指针在进入时仍然有效
+        bool        valid = true;
+        std::size_t i     = node(leaf).lower_bound(key, len, 0);
+        while (true)
+        {
+            BTreeNode   n     = node(leaf);
+            std::size_t count = n.count();
+            for (; i < count && n.key_len(i) == len && memcmp(n.key(i), key, len) == 0; ++i)
+                values.push_back(n.value(i));
+            page_no_t next = n.next();
+            if (!leaf.frame->version.validate(leaf.version))
+            {
+                valid = false;
+                break;
+            }
+            if (i < count || next == InvalidPageNo) break;
+
+            OptNode sibling;
+            if (!optimistic_read(next, sibling, rc) || !leaf.frame->version.validate(leaf.version))
+            {
+                valid = false;
+                break;
+            }
+            leaf = sibling;
+            i    = 0;
+        }
+        if (valid || FAIL(rc)) return;
+    }
+}
+
+void BPlusTree::lookup_batch(
+    const SortKeyBuffer& keys, std::vector<std::vector<uint64_t>>& values, ThreadPool& pool, RC& rc)
+{
+    values.assign(keys.size(), {});
+    std::size_t parts = std::min<std::size_t>(pool.Size(), keys.size());
+    rc                = RC::SUCCESS;
+    if (parts == 0) return;
+
+    std::vector<std::future<RC>> results;
+    for (std::size_t part = 0; part < parts; ++part)
+    {
+        std::size_t begin = keys.size() * part / parts;
+        std::size_t end   = keys.size() * (part + 1) / parts;
+        results.push_back(pool.EnQueue([this, &keys, &values, begin, end] {
+            RC lookup_rc = RC::SUCCESS;
+            for (std::size_t i = begin; i < end && SUCC(lookup_rc); ++i)
+                lookup(keys.key(i), keys.length(i), values[i], lookup_rc);
+            return lookup_rc;
+        }));
+    }
+    auto blocking = ThreadPool::ManagedBlock();
+    for (auto& result : results)
+    {
+        RC part_rc = result.get();
+        if (FAIL(part_rc)) rc = part_rc;
+    }
+}
+
+BPlusTreeIterator BPlusTree::seek(const uint8_t* key, std::size_t len, bool read_ahead, RC& rc)
+{
+    BPlusTreeIterator it;
+    it.pool_       = &pool_;
+    it.file_       = file_;
+    it.page_size_  = page_size_;
+    it.read_ahead_ = read_ahead;
+    if (!key) key = EmptyKey;
+    descend_for_read(key, len, 0, it.page_, it.latch_, rc);
+    if (FAIL(rc)) return it;
+    it.index_ = it.node().lower_bound(key, len, 0);
+    it.read_ahead();
+    it.skip_empty(rc);
+    return it;
+}
+
+BPlusTreeIterator BPlusTree::lower_bound(const uint8_t* key, std::size_t len, RC& rc)
+{
+    return seek(key, len, false, rc);
+}
+
+BPlusTreeIterator BPlusTree::begin(RC& rc) { return seek(nullptr, 0, false, rc); }
+
+void BPlusTree::split_range(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len,
+    std::size_t parts, std::vector<std::vector<uint8_t>>& bounds, RC& rc)
+{
+    bounds.clear();
+    rc = RC::SUCCESS;
+    if (parts <= 1) return;
+    if (!lo) lo = EmptyKey;
+
+    // 键的比较忽略值：值都取0时相等的键比较结果为0
+    auto inside = [&](const uint8_t* key, std::size_t len) {
+        return compare_key(lo, lo_len, 0, key, len, 0) < 0 && (!hi || compare_key(key, len, 0, hi, hi_len, 0) < 0);
+    };
+
+    std::vector<page_no_t> level;
+    {
+        ReadGuard tree_latch = root_latch_.read();
+        level.push_back(root_.load(std::memory_order_relaxed));
+    }
+    while (!level.empty())
+    {
+        std::vector<std::vector<uint8_t>> keys;
+        std::vector<page_no_t>            children;
+        for (page_no_t no : level)
+        {
+            PageGuard page = fetch(no, rc);
+            if (FAIL(rc)) return;
+            ReadGuard latch = page.latch().read();
+            BTreeNode n     = node(page);
+            if (n.is_leaf()) break;
+
+            int first = n.child_index(lo, lo_len, 0);
+            int last  = hi ? n.child_index(hi, hi_len, 0) : n.count() - 1;
+            for (int i = first; i <= last; ++i)
+            {
+                if (i >= 0 && inside(n.key(i), n.key_len(i))) keys.emplace_back(n.key(i), n.key(i) + n.key_len(i));
+                if (n.level() > 1) children.push_back(n.child_at(i));
+            }
+        }
+        // 下一层的分隔键更密，只要本层有分隔键就用它替换上一层的结果
+        if (!keys.empty()) bounds = std::move(keys);
+        if (bounds.size() + 1 >= parts) break;
+        level = std::move(children);
+    }
+
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    if (bounds.size() + 1 <= parts) return;
+    std::vector<std::vector<uint8_t>> chosen;
+    for (std::size_t i = 1; i < parts; ++i) chosen.push_back(std::move(bounds[i * bounds.size() / parts]));
+    bounds = std::move(chosen);
+}
+
+void BPlusTree::scan_parts(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len,
+    std::size_t parts, ThreadPool& pool, const ScanVisitor& visit, RC& rc)
+{
+    std::vector<std::vector<uint8_t>> bounds;
+    split_range(lo, lo_len, hi, hi_len, parts, bounds, rc);
+    if (FAIL(rc)) return;
+    if (!lo) lo = EmptyKey;
+
+    auto scan = [&](std::size_t part) {
+        const uint8_t* begin     = part == 0 ? lo : bounds[part - 1].data();
+        std::size_t    begin_len = part == 0 ? lo_len : bounds[part - 1].size();
+        const uint8_t* end       = part == bounds.size() ? hi : bounds[part].data();
+        std::size_t    end_len   = part == bounds.size() ? hi_len : bounds[part].size();
+        RC             scan_rc   = RC::SUCCESS;
+        for (BPlusTreeIterator it = seek(begin, begin_len, true, scan_rc); it.valid(); it.next(scan_rc))
+        {
+            if (end && compare_key(it.key(), it.key_len(), 0, end, end_len, 0) >= 0) break;
+            visit(part, it.key(), it.key_len(), it.value());
+        }
+        return scan_rc;
+    };
+    if (bounds.empty())
+    {
+        rc = scan(0);
+        return;
+    }
+
+    std::vector<std::future<RC>> results;
+    for (std::size_t part = 0; part <= bounds.size(); ++part)
+        results.push_back(pool.EnQueue([&scan, part] { return scan(part); }));
+    auto blocking = ThreadPool::ManagedBlock();
+    for (auto& result : results)
+    {
+        RC part_rc = result.get();
+        if (FAIL(part_rc)) rc = part_rc;
+    }
+}
+
+void BPlusTree::parallel_scan(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len,
+    ThreadPool& pool, const ScanVisitor& visit, RC& rc)
+{
+    scan_parts(lo, lo_len, hi, hi_len, pool.Size(), pool, visit, rc);
+}
+
+void BPlusTree::scan_range(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len,
+    ThreadPool& pool, std::vector<uint64_t>& values, RC& rc)
+{
+    std::size_t                        parts = std::max(1u, pool.Size());
+    std::vector<std::vector<uint64_t>> buffers(parts);
+    scan_parts(
+        lo, lo_len, hi, hi_len, parts, pool,
+        [&](std::size_t part, const uint8_t*, std::size_t, uint64_t value) { buffers[part].push_back(value); }, rc);
+
+    values.clear();
+    std::size_t total = 0;
+    for (auto& buffer : buffers) total += buffer.size();
+    values.reserve(total);
+    for (auto& buffer : buffers) values.insert(values.end(), buffer.begin(), buffer.end());
+}
+
+BPlusTreeStats BPlusTree::stats() const
+{
+    BPlusTreeStats stats;
+    stats.restarts = restarts_.load(std::memory_order_relaxed);
+    stats.splits   = splits_.load(std::memory_order_relaxed);
+    stats.merges   = merges_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "Thread/ReWrLock.h"
+#include "buffer_pool.h"
+#include "bplus_node.h"
+
+enum class RC;
+class SortKeyBuffer;
+class ThreadPool;
+struct Transaction;
+
+/*
+ * 基于缓冲池的并发B+树索引。
+ *
+ * 键是sort_key.h中的规范化排序键，值是64位整数（通常为行号），同一个键可以有多个值。
+ * 每棵树占用一个数据文件：1号页为元数据页，记录根节点、树高与空闲页链表，其余页为节点。
+ *
+ * 并发控制采用锁耦合（latch crabbing），页锁为缓冲池帧上的读写锁，加锁顺序总是自顶向下、同层从左到右：
+ *   - 查找与遍历：持有父节点读锁时获取子节点读锁，随即释放父节点；叶子之间沿右兄弟指针同样交接。
+ *   - 插入与删除先乐观执行：读锁下降，只对叶子加写锁；叶子不需要分裂或合并时直接完成。
+ *   - 否则从根重新下降并对路径加写锁，遇到安全节点（插入时放得下任何分隔键，删除后不会下溢）
+ *     就释放全部祖先，只有可能被结构修改影响的节点一直持有写锁。
+ * 根节点页号由树级的读写锁保护，根分裂与降低树高时持有其写锁。
+ *
+ * 锁耦合的查找在根与上层内部节点的页锁上也要写共享的锁字，线程多时这些缓存行在核间来回传递。
+ * 乐观锁耦合（optimistic lock coupling）模式下点查、插入与删除改用帧的版本号（OptLock）：
+ *   - 读者不加锁也不钉住页面：读节点前记录版本号，读出孩子页号后校验父节点版本号未变再进入孩子，
+ *     校验失败就从根重试。帧指针缓存在按页号直接映射的提示表中，命中时不经过缓冲池的页表。
+ *   - 写者同样乐观下降，只对要修改的节点加写锁并把版本号从读到的值升级为锁定，升级失败说明读过之后
+ *     节点被改过，重试；加锁都不等待，因此不会与其他写者死锁。
+ *   - 插入下降时遇到放不下任意分隔键的内部节点先锁住它与父节点将其分裂再重试，叶子分裂时父节点总有空间，
+ *     一次只需锁住两个节点。删除不合并节点，页面不会被释放，读者不会进入已摘除的节点。
+ * 遍历、范围扫描与批量构建在两种模式下都使用页锁，乐观写者也持有页锁，两者可以并发。
+ *
+ * 传入事务的插入与删除为修改的每个页（叶子、分裂合并涉及的节点、元数据页与空闲页）记日志，见recovery.h。
+ * 撤销按字节恢复页面，未提交事务修改过的节点在它结束之前不能被其他事务修改，通常对整个索引加写锁。
+ * 运行时回滚之后调用reload()重新读取根节点、树高与空闲页链表；回滚掉的新页不会再被分配。
+ * 批量构建不记日志。同一棵树的修改要么都记日志，要么都不记；新建的树在第一个事务之前须写回。
+ */
+
+/**
+ * @brief 并发控制方式
+ */
+enum class LatchMode
+{
+    CRABBING,    ///< 锁耦合
+    OPTIMISTIC,  ///< 乐观锁耦合
+};
+
+/**
+ * @brief B+树统计快照
+ */
+struct BPlusTreeStats
+{
+    uint64_t restarts;  ///< 乐观插入删除失败后悲观重做的次数，乐观锁耦合模式下为重试次数
+    uint64_t splits;    ///< 节点分裂次数
+    uint64_t merges;    ///< 节点合并次数
+};
+
+class BPlusTree;
+
+/**
+ * @brief B+树的正向迭代器
+ *
+ * 持有当前叶子的读锁，遍历期间同一线程不能修改这棵树。可移动，不可复制。
+ */
+class BPlusTreeIterator
+{
+    friend BPlusTree;
+
+  public:
+    BPlusTreeIterator() = default;
+
+    bool valid() const { return page_.valid(); }
+
+    const uint8_t* key() const { return node().key(index_); }
+    std::size_t    key_len() const { return node().key_len(index_); }
+    uint64_t       value() const { return node().value(index_); }
+
+    /**
+     * @brief 移到下一个条目，越过末尾后valid()为false
+     */
+    void next(RC& rc);
+
+  private:
+    BTreeNode node() const { return BTreeNode(const_cast<char*>(page_.data()), page_size_); }
+
+    /**
+     * @brief 当前位置越过叶子末尾时沿右兄弟前进到下一个非空叶子
+     */
+    void skip_empty(RC& rc);
+
+    /**
+     * @brief 开启预读时预读当前叶子的右兄弟
+     */
+    void read_ahead();
+
+    BufferPool*              pool_      = nullptr;  ///< 缓冲池
+    file_id_t                file_      = 0;        ///< 索引文件
+    std::size_t              page_size_ = 0;        ///< 页大小
+    PageGuard                page_;                 ///< 当前叶子
+    std::optional<ReadGuard> latch_;                ///< 当前叶子的读锁，先于page_释放
+    std::size_t              index_      = 0;       ///< 叶子中的条目下标
+    bool                     read_ahead_ = false;   ///< 进入叶子时是否预读右兄弟
+};
+
+/**
+ * @brief 并行范围扫描的回调
+ *
+ * 参数依次为分段号、键、键长与值。不同分段的回调在不同线程上并发执行，同一分段内按(键, 值)升序调用。
+ * 回调期间扫描线程持有叶子的读锁，不能修改这棵树。
+ */
+using ScanVisitor = std::function<void(std::size_t, const uint8_t*, std::size_t, uint64_t)>;
+
+/**
+ * @brief 并发B+树
+ *
+ * 线程安全。
+ */
+class BPlusTree
+{
+    friend class BPlusTreeBuilder;
+
+  public:
+    static constexpr page_no_t MetaPageNo = 1;  ///< 元数据页
+
+    /**
+     * @brief 打开文件中的B+树，文件为空时创建
+     *
+     * @param rc 元数据页损坏时为RC::INVALID_ARGUMENT
+     */
+    BPlusTree(BufferPool& pool, file_id_t file, RC& rc);
+
+    /**
+     * @brief 以指定的并发控制方式打开文件中的B+树
+     */
+    BPlusTree(BufferPool& pool, file_id_t file, LatchMode mode, RC& rc);
+
+    BPlusTree(const BPlusTree&)            = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    void insert(const uint8_t* key, std::size_t len, uint64_t value, RC& rc) { insert(nullptr, key, len, value, rc); }
+
+    /**
+     * @brief 插入(key, value)
+     *
+     * @param txn 记日志的事务，为nullptr时不记日志
+     * @param rc 键超过max_key_size()或(key, value)已存在时为RC::INVALID_ARGUMENT
+     */
+    void insert(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc);
+
+    void remove(const uint8_t* key, std::size_t len, uint64_t value, RC& rc) { remove(nullptr, key, len, value, rc); }
+
+    /**
+     * @brief 删除(key, value)，锁耦合模式下节点下溢且能与兄弟放进一页时合并
+     *
+     * @param txn 记日志的事务，为nullptr时不记日志
+     * @param rc (key, value)不存在时为RC::INVALID_ARGUMENT
+     */
+    void remove(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc);
+
+    /**
+     * @brief 从元数据页重新读取根节点、树高与空闲页链表
+     *
+     * 事务回滚撤销了页面上的结构修改之后调用，期间不能有其他线程访问这棵树。
+     *
+     * @param rc 元数据页损坏时为RC::INVALID_ARGUMENT
+     */
+    void reload(RC& rc);
+
+    /**
+     * @brief 查找键对应的全部值，按值升序追加到values
+     */
+    void lookup(const uint8_t* key, std::size_t len, std::vector<uint64_t>& values, RC& rc);
+
+    /**
+     * @brief 并行查找一批键
+     *
+     * 把键分成pool中线程数个分段，每段由一个任务依次查找。线程池大小由ServerConfig::bplus_tree_threads配置。
+     *
+     * @param values 输出，values[i]为第i个键的全部值
+     */
+    void lookup_batch(const SortKeyBuffer& keys, std::vector<std::vector<uint64_t>>& values, ThreadPool& pool, RC& rc);
+
+    /**
+     * @brief 把键区间[lo, hi)切分为最多parts个子区间
+     *
+     * 从根开始逐层收集落在区间内的分隔键，直到某一层的分隔键足够多或到达叶子的上一层，再从中等距选取。
+     * 只读取内部节点，不访问叶子。分隔键只决定负载划分，结构修改并发进行时结果仍然是有效的切分。
+     *
+     * @param lo 下界，lo_len为0时从第一个条目开始，此时可以为nullptr
+     * @param hi 为nullptr时没有上界
+     * @param bounds 输出，严格位于(lo, hi)内的升序切分点，子区间数为bounds.size() + 1
+     */
+    void split_range(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len, std::size_t parts,
+        std::vector<std::vector<uint8_t>>& bounds, RC& rc);
+
+    /**
+     * @brief 并行扫描键区间[lo, hi)
+     *
+     * 按split_range切分为pool中线程数个子区间，每个子区间由一个任务沿叶子链扫描并预读下一个叶子。
+     * 第i个分段的键都小于第i + 1个分段的键。
+     *
+     * @param hi 为nullptr时没有上界
+     */
+    void parallel_scan(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len, ThreadPool& pool,
+        const ScanVisitor& visit, RC& rc);
+
+    /**
+     * @brief 并行扫描键区间[lo, hi)，按(键, 值)升序输出全部值
+     *
+     * 各分段先写入自己的缓冲区，分段之间不重叠且有序，按分段号依次拼接即为有序结果。
+     */
+    void scan_range(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len, ThreadPool& pool,
+        std::vector<uint64_t>& values, RC& rc);
+
+    /**
+     * @brief 定位到第一个键不小于key的条目
+     */
+    BPlusTreeIterator lower_bound(const uint8_t* key, std::size_t len, RC& rc);
+
+    /**
+     * @brief 定位到第一个条目
+     */
+    BPlusTreeIterator begin(RC& rc);
+
+    /**
+     * @brief 最大键长，保证一页至少放下4个条目
+     */
+    std::size_t max_key_size() const { return max_key_size_; }
+
+    LatchMode      latch_mode() const { return mode_; }
+    uint32_t       height() const { return height_.load(std::memory_order_acquire); }
+    BPlusTreeStats stats() const;
+
+  private:
+    static constexpr std::size_t HintSlots = 4096;  ///< 帧指针提示表的槽数，为2的幂
+
+    /**
+     * @brief 悲观路径上持有写锁的节点
+     */
+    struct LatchedNode
+    {
+        PageGuard                 page;   ///< 节点页
+        std::optional<WriteGuard> latch;  ///< 写锁，先于page释放
+        int                       index;  ///< 在父节点中的孩子下标，-1为leftmost
+    };
+
+    /**
+     * @brief 悲观插入删除持有的路径
+     */
+    struct Path
+    {
+        std::optional<WriteGuard> root_latch;       ///< 树级写锁
+        std::vector<LatchedNode>  nodes;            ///< 自顶向下的节点
+        std::size_t               first = 0;        ///< 仍持有写锁的第一个节点
+        Transaction*              txn   = nullptr;  ///< 记日志的事务
+
+        /**
+         * @brief 释放最后一个节点之前的全部节点与树级写锁
+         */
+        void release_ancestors();
+    };
+
+    /**
+     * @brief 乐观读的节点
+     */
+    struct OptNode
+    {
+        Frame*    frame   = nullptr;        ///< 节点所在的帧，未钉住
+        uint64_t  version = 0;              ///< read_begin得到的版本号
+        page_no_t page    = InvalidPageNo;  ///< 节点页号
+    };
+
+    /**
+     * @brief 乐观写者锁定的节点：钉住、持有写锁并锁住版本号
+     *
+     * 析构时先释放版本号，再释放写锁与钉住。
+     */
+    struct LockedNode
+    {
+        LockedNode() = default;
+        LockedNode(const LockedNode&)            = delete;
+        LockedNode& operator=(const LockedNode&) = delete;
+        ~LockedNode()
+        {
+            if (locked) page.version().unlock();
+        }
+
+        PageGuard                 page;            ///< 节点页
+        std::optional<WriteGuard> latch;           ///< 写锁，先于page释放
+        bool                      locked = false;  ///< 是否锁住了版本号
+    };
+
+    BTreeNode node(PageGuard& page) const { return BTreeNode(page.data(), page_size_); }
+    BTreeNode node(const OptNode& n) const { return BTreeNode(n.frame->data, page_size_); }
+    PageGuard fetch(page_no_t page, RC& rc) { return pool_.fetch_page({file_, page}, rc); }
+
+    /**
+     * @brief 分配一个节点页并初始化，优先复用空闲页
+     *
+     * 空闲页的下一页取自内存副本，持有meta_mutex_时不对任何节点页加锁：释放节点的线程持有节点写锁时
+     * 还要取meta_mutex_，反过来等待页锁会死锁。
+     */
+    PageGuard allocate_node(Transaction* txn, uint16_t level, RC& rc);
+
+    /**
+     * @brief 把已从树中摘除的节点页加入空闲页链表，调用者持有其写锁
+     */
+    void free_node(Transaction* txn, PageGuard& page, RC& rc);
+
+    void write_meta(Transaction* txn, RC& rc);
+
+    /**
+     * @brief 打开已有的树时沿空闲页链表建立free_pages_
+     *
+     * @param rc 链表越出文件或成环时为RC::INVALID_ARGUMENT
+     */
+    void load_free_pages(page_no_t head, RC& rc);
+
+    /**
+     * @brief 读锁下降到可能包含(key, value)的叶子，只对叶子加写锁
+     *
+     * 调用者应在page之后声明latch，保证latch先于page释放。
+     */
+    void descend_for_write(const uint8_t* key, std::size_t len, uint64_t value, PageGuard& page,
+        std::optional<WriteGuard>& latch, RC& rc);
+
+    /**
+     * @brief 读锁下降到可能包含(key, value)的叶子
+     */
+    void descend_for_read(const uint8_t* key, std::size_t len, uint64_t value, PageGuard& page,
+        std::optional<ReadGuard>& latch, RC& rc);
+
+    /**
+     * @brief 定位到第一个键不小于key的条目
+     *
+     * @param read_ahead 遍历时是否预读右兄弟
+     */
+    BPlusTreeIterator seek(const uint8_t* key, std::size_t len, bool read_ahead, RC& rc);
+
+    /**
+     * @brief 把[lo, hi)切分为最多parts段并行扫描
+     */
+    void scan_parts(const uint8_t* lo, std::size_t lo_len, const uint8_t* hi, std::size_t hi_len, std::size_t parts,
+        ThreadPool& pool, const ScanVisitor& visit, RC& rc);
+
+    /**
+     * @brief 写锁下降并建立悲观路径
+     *
+     * @param for_insert 为true时按插入判断安全节点，否则按删除判断
+     */
+    void descend_pessimistic(const uint8_t* key, std::size_t len, uint64_t value, bool for_insert, Path& path, RC& rc);
+
+    bool insert_safe(const BTreeNode& node) const;
+    bool remove_safe(const BTreeNode& node, bool is_root) const;
+    bool underflow(const BTreeNode& node) const { return node.used_bytes() < min_fill_; }
+
+    /**
+     * @brief 在悲观路径上插入，自底向上分裂
+     */
+    void insert_into_path(Path& path, const uint8_t* key, std::size_t len, uint64_t value, RC& rc);
+
+    /**
+     * @brief 把已满的left的右半部分移到新节点right_page
+     *
+     * 调用者持有两者的写锁，right_page已分配，并负责为两页记日志。输出应插入父节点的分隔条目，它指向right_page。
+     */
+    void split_node(BTreeNode& left, PageGuard& right_page, std::vector<uint8_t>& up_key, uint64_t& up_value);
+
+    /**
+     * @brief 合并路径上第depth个节点与它的兄弟
+     *
+     * @return 放不进一页时不合并并返回false
+     */
+    bool merge(Path& path, std::size_t depth, RC& rc);
+
+    /**
+     * @brief 开始乐观读一个节点
+     *
+     * @return 帧正在被复用时返回false并应重试，读页失败时rc为失败码
+     */
+    bool optimistic_read(page_no_t page, OptNode& node, RC& rc);
+
+    /**
+     * @brief 钉住乐观读过的节点，加写锁并把版本号从读到的值升级为锁定，都不等待
+     *
+     * @return 节点已被修改或锁被占用时返回false并应重试
+     */
+    bool lock_node(const OptNode& node, LockedNode& locked, RC& rc);
+
+    /**
+     * @brief 乐观下降到可能包含(key, value)的叶子
+     *
+     * @param split_full 为true时先分裂路径上放不下任意分隔键的内部节点再重试
+     * @param parent 输出叶子的父节点，叶子为根时frame为nullptr
+     * @return 需要重试时返回false
+     */
+    bool optimistic_descend(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, bool split_full,
+        OptNode& parent, OptNode& leaf, RC& rc);
+
+    /**
+     * @brief 锁住乐观读过的节点与它的父节点并分裂，parent.frame为nullptr时节点为根，持有树级写锁新建根节点
+     *
+     * 无论成败调用者都应重新下降。
+     */
+    void optimistic_split(Transaction* txn, const OptNode& parent, const OptNode& node, RC& rc);
+
+    /**
+     * @brief 乐观操作重试前计数，多次失败后让出CPU
+     */
+    void backoff(unsigned int attempt);
+
+    void insert_optimistic(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc);
+    void remove_optimistic(Transaction* txn, const uint8_t* key, std::size_t len, uint64_t value, RC& rc);
+    void lookup_optimistic(const uint8_t* key, std::size_t len, std::vector<uint64_t>& values, RC& rc);
+
+    BufferPool&            pool_;          ///< 缓冲池
+    file_id_t              file_;          ///< 索引文件
+    std::size_t            page_size_;     ///< 页大小
+    std::size_t            max_key_size_;  ///< 最大键长
+    std::size_t            min_fill_;      ///< 非根节点有效数据低于该字节数时尝试合并
+    ReWrLock               root_latch_;    ///< 树级读写锁，保护根节点页号与树高
+    std::atomic<page_no_t> root_;          ///< 根节点页号
+    std::atomic<uint32_t>  height_;        ///< 树高，只有根节点时为1
+    std::mutex             meta_mutex_;    ///< 保护空闲页链表与元数据页的写入
+    std::vector<page_no_t> free_pages_;    ///< 空闲页链表的内存副本，末尾为表头
+    std::atomic<uint64_t>  restarts_{0};   ///< 悲观重做次数
+    std::atomic<uint64_t>  splits_{0};     ///< 分裂次数
+    std::atomic<uint64_t>  merges_{0};     ///< 合并次数
+    LatchMode              mode_;          ///< 并发控制方式
+
+    std::unique_ptr<std::atomic<Frame*>[]> hints_;  ///< 乐观锁耦合模式下按页号直接映射的帧指针提示表
+};
@@ -0,0 +1,578 @@
+#include "buffer_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "Thread/ThreadPool.h"
+#include "log_manager.h"
+#include "ret.h"
+
+static constexpr std::size_t FrameAlignment = 4096;  ///< 帧内存按4KB对齐，便于直接I/O
+static constexpr std::size_t MaxShards      = 64;    ///< 页表分片数上限
+
+/*
+ * 乐观读者读到的可能是正被修改的页面，按其中过期的16位偏移与长度读取时最远越过页首约128KB，
+ * 帧内存之后多分配ReadSlack字节保证这样的读取不越过分配的内存，读到的内容由版本号校验丢弃。
+ */
+static constexpr std::size_t ReadSlack = 2 * 65536 + FrameAlignment;
+
+PageGuard::PageGuard(PageGuard&& other) noexcept : pool_(other.pool_), frame_(other.frame_)
+{
+    other.pool_  = nullptr;
+    other.frame_ = nullptr;
+}
+
+PageGuard& PageGuard::operator=(PageGuard&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        pool_        = other.pool_;
+        frame_       = other.frame_;
+        other.pool_  = nullptr;
+        other.frame_ = nullptr;
+    }
+    return *this;
+}
+
+PageId PageGuard::id() const { return PageId::from_key(frame_->page_key.load(std::memory_order_relaxed)); }
+
+void PageGuard::release()
+{
+    if (!frame_) return;
+    pool_->unpin(*frame_);
+    pool_  = nullptr;
+    frame_ = nullptr;
+}
+
+BufferPool::BufferPool(DiskManager& disk, std::size_t frames, ReplacerKind kind, RC& rc)
+    : disk_(disk),
+      frame_count_(frames),
+      frames_(new Frame[frames]),
+      memory_(nullptr),
+      flush_cursor_(0),
+      flusher_stop_(false),
+      streams_(new Stream[DiskManager::MaxFiles]),
+      read_ahead_max_(0)
+{
+    std::size_t shards = 1;
+    while (shards < MaxShards && shards * 64 < frames) shards *= 2;
+    shards_ = std::vector<Shard>(shards);
+
+    std::size_t bytes =
+        (frames * disk.page_size() + ReadSlack + FrameAlignment - 1) / FrameAlignment * FrameAlignment;
+    memory_           = frames ? static_cast<char*>(std::aligned_alloc(FrameAlignment, bytes)) : nullptr;
+    if (!memory_)
+    {
+        frame_count_ = 0;
+        rc           = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    replacer_ = make_replacer(kind, frames);
+    free_.reserve(frames);
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        frames_[i].data = memory_ + i * disk.page_size();
+        free_.push_back(static_cast<frame_id_t>(frames - 1 - i));
+    }
+    rc = RC::SUCCESS;
+}
+
+BufferPool::~BufferPool()
+{
+    stop_flusher();
+    // 等待进行中的异步读入完成
+    for (std::size_t i = 0; i < frame_count_; ++i)
+    {
+        frames_[i].io_mutex.lock();
+        frames_[i].io_mutex.unlock();
+    }
+    RC rc;
+    flush_all(rc);
+    std::free(memory_);
+}
+
+/**
+ * @brief 解除钉住，引用计数归零时交给置换器
+ *
+ * 与并发的pin之间可能出现置换器认为被钉住的帧可淘汰的情况，acquire_frame在分片锁下会再检查一次引用计数。
+ */
+void BufferPool::unpin(Frame& frame)
+{
+    if (frame.pin_count.fetch_sub(1, std::memory_order_acq_rel) == 1) replacer_->set_evictable(frame_id(frame), true);
+}
+
+Frame* BufferPool::pin_resident(uint64_t key, bool touch)
+{
+    Shard& shard = shard_of(key);
+    Frame* frame;
+    bool   first;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto                        it = shard.table.find(key);
+        if (it == shard.table.end()) return nullptr;
+        frame = &frames_[it->second];
+        first = frame->pin_count.fetch_add(1, std::memory_order_acq_rel) == 0;
+    }
+    // 置换器的操作放在分片锁之外，LRU-K的全局锁不会延长分片锁的持有时间
+    if (first) replacer_->set_evictable(frame_id(*frame), false);
+    if (touch) replacer_->record_access(frame_id(*frame));
+    return frame;
+}
+
+Frame* BufferPool::acquire_frame(RC& rc)
+{
+    {
+        std::lock_guard<std::mutex> lock(free_mutex_);
+        if (!free_.empty())
+        {
+            Frame& frame = frames_[free_.back()];
+            free_.pop_back();
+            frame.pin_count.store(1, std::memory_order_relaxed);
+            frame.io_mutex.lock();
+            frame.version.lock();
+            return &frame;
+        }
+    }
+
+    while (true)
+    {
+        frame_id_t id;
+        if (!replacer_->victim(id))
+        {
+            rc = RC::LOCKED;
+            return nullptr;
+        }
+        Frame&                       frame = frames_[id];
+        uint64_t                     key   = frame.page_key.load(std::memory_order_acquire);
+        Shard&                       shard = shard_of(key);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        if (frame.page_key.load(std::memory_order_relaxed) != key || frame.pin_count.load(std::memory_order_acquire))
+            continue;
+
+        // 先占住帧：引用计数为1时命中的线程仍可以钉住它，并在io_mutex上等待写回完成
+        frame.pin_count.store(1, std::memory_order_relaxed);
+        frame.io_mutex.lock();
+        auto it     = shard.table.find(key);
+        bool mapped = it != shard.table.end() && it->second == id;
+        if (mapped && frame.dirty.load(std::memory_order_acquire))
+        {
+            lock.unlock();
+            // rec_lsn保留到写回完成、帧移出页表时才清除，写回期间做的检查点仍把这一页算作脏页；
+            // 写回期间被钉住的页放弃淘汰，rec_lsn保持较早的保守值
+            RC wrc;
+            frame.dirty.store(false, std::memory_order_relaxed);
+            write_frame(frame, PageId::from_key(key), wrc);
+            if (FAIL(wrc))
+                frame.dirty.store(true, std::memory_order_relaxed);
+            else
+                writebacks_.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+
+            if (FAIL(wrc) || frame.pin_count.load(std::memory_order_acquire) != 1)
+            {
+                // 写回失败或写回期间又被钉住，放弃这一帧
+                frame.io_mutex.unlock();
+                lock.unlock();
+                replacer_->record_access(id);
+                unpin(frame);
+                if (FAIL(wrc))
+                {
+                    rc = wrc;
+                    return nullptr;
+                }
+                continue;
+            }
+            it = shard.table.find(key);
+        }
+        // 先锁住版本号再移出页表：页面在别的帧重新读入之前，仍在读旧帧的乐观读者都会校验失败
+        frame.version.lock();
+        if (mapped) shard.table.erase(it);
+        frame.page_key.store(0, std::memory_order_relaxed);
+        frame.rec_lsn.store(0, std::memory_order_relaxed);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        return &frame;
+    }
+}
+
+bool BufferPool::install(Frame& frame, uint64_t key)
+{
+    Shard& shard = shard_of(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.table.count(key))
+        {
+            frame.page_key.store(key, std::memory_order_release);
+            frame.loaded = false;
+            frame.ahead_mark.store(false, std::memory_order_relaxed);
+            shard.table.emplace(key, frame_id(frame));
+            replacer_->record_access(frame_id(frame));
+            return true;
+        }
+    }
+
+    // 其他线程已经读入了这一页，归还帧
+    frame.version.unlock();
+    frame.io_mutex.unlock();
+    frame.pin_count.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    free_.push_back(frame_id(frame));
+    return false;
+}
+
+PageGuard BufferPool::fetch_page(PageId id, RC& rc)
+{
+    if (id.page == InvalidPageNo)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return {};
+    }
+
+    uint64_t key = id.key();
+    while (true)
+    {
+        if (Frame* frame = pin_resident(key, true))
+        {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            // 等待正在进行的读入或写回完成
+            {
+                std::lock_guard<IoLatch> io(frame->io_mutex);
+                if (!frame->loaded)
+                {
+                    unpin(*frame);
+                    rc = RC::IO_ERROR;
+                    return {};
+                }
+            }
+            if (frame->ahead_mark.load(std::memory_order_relaxed) && frame->ahead_mark.exchange(false))
+                read_ahead_on_mark(id);
+            rc = RC::SUCCESS;
+            return PageGuard(this, frame);
+        }
+
+        Frame* frame = acquire_frame(rc);
+        if (!frame) return {};
+        if (!install(*frame, key)) continue;
+
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        frame->dirty.store(false, std::memory_order_relaxed);
+        frame->rec_lsn.store(0, std::memory_order_relaxed);
+        // 先发出之后的预读再同步读当前页，两者同时进行
+        if (read_ahead_max_ && disk_.async_io()) read_ahead_on_miss(id);
+        disk_.read_page(id, frame->data, rc);
+        finish_load(*frame, rc);
+        if (FAIL(rc))
+        {
+            unpin(*frame);
+            return {};
+        }
+        return PageGuard(this, frame);
+    }
+}
+
+void BufferPool::finish_load(Frame& frame, RC rc)
+{
+    frame.loaded = SUCC(rc);
+    if (FAIL(rc))
+    {
+        uint64_t                    key   = frame.page_key.load(std::memory_order_relaxed);
+        Shard&                      shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.table.erase(key);
+        frame.page_key.store(0, std::memory_order_relaxed);
+    }
+    frame.version.unlock();
+    frame.io_mutex.unlock();
+}
+
+void BufferPool::issue_reads(PageId first, std::size_t pages, bool mark)
+{
+    page_no_t count = disk_.page_count(first.file);
+    if (first.page == InvalidPageNo || first.page >= count) return;
+    std::size_t limit = std::max<std::size_t>(frame_count_ / 4, 1);
+    pages             = std::min({pages, static_cast<std::size_t>(count - first.page), limit});
+
+    std::vector<PageRead> reads;
+    reads.reserve(pages);
+    for (page_no_t page = first.page; page < first.page + pages; ++page)
+    {
+        uint64_t key = PageId{first.file, page}.key();
+        {
+            Shard&                      shard = shard_of(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.table.count(key)) continue;
+        }
+        RC     rc;
+        Frame* frame = acquire_frame(rc);
+        if (!frame) break;
+        if (!install(*frame, key)) continue;
+
+        frame->dirty.store(false, std::memory_order_relaxed);
+        frame->rec_lsn.store(0, std::memory_order_relaxed);
+        if (mark && reads.empty()) frame->ahead_mark.store(true, std::memory_order_relaxed);
+        // 读入完成前帧保持钉住，不会被淘汰
+        reads.push_back({PageId{first.file, page}, frame->data, [this, frame](RC result) {
+                             finish_load(*frame, result);
+                             unpin(*frame);
+                         }});
+    }
+    prefetches_.fetch_add(reads.size(), std::memory_order_relaxed);
+    disk_.read_async(reads);
+}
+
+void BufferPool::read_ahead_on_miss(PageId id)
+{
+    if (id.file >= DiskManager::MaxFiles) return;
+    PageId      from{id.file, id.page + 1};
+    std::size_t pages;
+    {
+        Stream&                     stream = streams_[id.file];
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        // 紧接着上一次的未命中，或落在已发出的预读范围内（预读的页被淘汰或没占到帧）
+        bool sequential = id.page > stream.last && id.page <= std::max<page_no_t>(stream.last + 1, stream.ahead);
+        stream.last     = id.page;
+        if (!sequential)
+        {
+            stream.window = 0;
+            stream.ahead  = InvalidPageNo;
+            return;
+        }
+        stream.window = stream.window ? std::min(stream.window * 2, read_ahead_max_)
+                                      : std::min(InitialWindow, read_ahead_max_);
+        pages         = stream.window;
+        stream.ahead  = std::max<page_no_t>(stream.ahead, from.page + pages);
+    }
+    issue_reads(from, pages, true);
+}
+
+void BufferPool::read_ahead_on_mark(PageId id)
+{
+    PageId      from{id.file, InvalidPageNo};
+    std::size_t pages;
+    {
+        Stream&                     stream = streams_[id.file];
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        // 之后有不连续的未命中时标记已经过期
+        if (stream.window == 0 || id.page < stream.last || id.page >= stream.ahead) return;
+        stream.last   = id.page;
+        stream.window = std::min(stream.window * 2, read_ahead_max_);
+        pages         = stream.window;
+        from.page     = stream.ahead;
+        stream.ahead += pages;
+    }
+    issue_reads(from, pages, true);
+}
+
+PageGuard BufferPool::new_page(file_id_t file, RC& rc)
+{
+    page_no_t page = disk_.allocate_page(file, rc);
+    if (FAIL(rc)) return {};
+
+    uint64_t key = PageId{file, page}.key();
+    Frame*   frame;
+    do
+    {
+        frame = acquire_frame(rc);
+        if (!frame) return {};
+    } while (!install(*frame, key));
+
+    memset(frame->data, 0, disk_.page_size());
+    frame->loaded = true;
+    frame->rec_lsn.store(0, std::memory_order_relaxed);
+    frame->dirty.store(true, std::memory_order_release);
+    frame->version.unlock();
+    frame->io_mutex.unlock();
+    rc = RC::SUCCESS;
+    return PageGuard(this, frame);
+}
+
+Frame* BufferPool::frame_of(PageId id, RC& rc)
+{
+    PageGuard page = fetch_page(id, rc);
+    return page.frame_;
+}
+
+void BufferPool::write_frame(const Frame& frame, PageId id, RC& rc)
+{
+    rc = RC::SUCCESS;
+    if (log_)
+    {
+        // 页面LSN超出日志末尾的页面不是按这份日志修改的，不必等待
+        lsn_t lsn;
+        memcpy(&lsn, frame.data, sizeof(lsn));
+        if (lsn > log_->durable_lsn() && lsn <= log_->end_lsn()) log_->flush(lsn, rc);
+        if (FAIL(rc)) return;
+    }
+    disk_.write_page(id, frame.data, rc);
+}
+
+/**
+ * @brief 持有页锁的读锁写回，期间修改页面的线程等待
+ */
+void BufferPool::flush_frame(Frame& frame, RC& rc)
+{
+    rc = RC::SUCCESS;
+    {
+        std::lock_guard<IoLatch> io(frame.io_mutex);
+        if (!frame.loaded) return;
+    }
+    ReadGuard guard = frame.latch.read();
+    if (!frame.dirty.exchange(false, std::memory_order_acq_rel)) return;
+    uint64_t rec = frame.rec_lsn.load(std::memory_order_acquire);
+    write_frame(frame, PageId::from_key(frame.page_key.load(std::memory_order_relaxed)), rc);
+    if (FAIL(rc))
+    {
+        frame.dirty.store(true, std::memory_order_relaxed);
+        return;
+    }
+    // 写入返回后才清除rec_lsn：检查点在此之前取到的脏页表包含这一页，其sync_all会把这次写入落盘
+    frame.rec_lsn.compare_exchange_strong(rec, 0, std::memory_order_acq_rel);
+    flushes_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BufferPool::prefetch(PageId id, RC& rc)
+{
+    rc = RC::SUCCESS;
+    if (disk_.async_io())
+    {
+        issue_reads(id, 1, false);
+        return;
+    }
+    Shard& shard = shard_of(id.key());
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.table.count(id.key())) return;
+    }
+    prefetches_.fetch_add(1, std::memory_order_relaxed);
+    disk_.prefetch(id, 1, rc);
+}
+
+void BufferPool::read_ahead(PageId first, std::size_t pages, RC& rc)
+{
+    rc = RC::SUCCESS;
+    if (disk_.async_io()) issue_reads(first, pages, false);
+}
+
+void BufferPool::set_read_ahead(std::size_t pages) { read_ahead_max_ = std::min(pages, frame_count_ / 4); }
+
+void BufferPool::flush_page(PageId id, RC& rc)
+{
+    rc           = RC::SUCCESS;
+    Frame* frame = pin_resident(id.key(), false);
+    if (!frame) return;
+    flush_frame(*frame, rc);
+    unpin(*frame);
+}
+
+void BufferPool::flush_dirty(std::size_t batch, RC& rc)
+{
+    rc                  = RC::SUCCESS;
+    std::size_t flushed = 0;
+    for (std::size_t i = 0; i < frame_count_ && flushed < batch; ++i)
+    {
+        Frame& candidate = frames_[flush_cursor_];
+        flush_cursor_    = flush_cursor_ + 1 == frame_count_ ? 0 : flush_cursor_ + 1;
+        if (!candidate.dirty.load(std::memory_order_relaxed)) continue;
+
+        Frame* frame = pin_resident(candidate.page_key.load(std::memory_order_acquire), false);
+        if (!frame) continue;
+        flush_frame(*frame, rc);
+        unpin(*frame);
+        if (FAIL(rc)) return;
+        ++flushed;
+    }
+}
+
+void BufferPool::flush_all(RC& rc)
+{
+    rc = RC::SUCCESS;
+    for (std::size_t i = 0; i < frame_count_; ++i)
+    {
+        if (!frames_[i].dirty.load(std::memory_order_relaxed)) continue;
+        Frame* frame = pin_resident(frames_[i].page_key.load(std::memory_order_acquire), false);
+        if (!frame) continue;
+        RC frc;
+        flush_frame(*frame, frc);
+        unpin(*frame);
+        if (FAIL(frc)) rc = frc;
+    }
+}
+
+void BufferPool::flusher_loop(std::chrono::milliseconds interval, std::size_t batch)
+{
+    std::unique_lock<std::mutex> lock(flusher_mutex_);
+    while (!flusher_stop_)
+    {
+        lock.unlock();
+        {
+            auto blocking = ThreadPool::ManagedBlock();
+            RC   rc;
+            flush_dirty(batch, rc);
+        }
+        lock.lock();
+        auto blocking = ThreadPool::ManagedBlock();
+        flusher_cv_.wait_for(lock, interval, [this] { return flusher_stop_; });
+    }
+}
+
+void BufferPool::start_flusher(ThreadPool& pool, std::chrono::milliseconds interval, std::size_t batch)
+{
+    stop_flusher();
+    {
+        std::lock_guard<std::mutex> lock(flusher_mutex_);
+        flusher_stop_ = false;
+    }
+    flusher_ = pool.EnQueue([this, interval, batch] { flusher_loop(interval, batch); });
+}
+
+void BufferPool::stop_flusher()
+{
+    if (!flusher_.valid()) return;
+    {
+        std::lock_guard<std::mutex> lock(flusher_mutex_);
+        flusher_stop_ = true;
+    }
+    flusher_cv_.notify_all();
+    flusher_.get();
+}
+
+std::vector<std::pair<PageId, uint64_t>> BufferPool::dirty_pages() const
+{
+    std::vector<std::pair<PageId, uint64_t>> pages;
+    for (std::size_t i = 0; i < frame_count_; ++i)
+    {
+        // 帧可能同时被复用：前后两次读到同一页时rec_lsn属于这一页
+        const Frame& frame = frames_[i];
+        uint64_t     key, rec;
+        do
+        {
+            key = frame.page_key.load(std::memory_order_acquire);
+            rec = frame.rec_lsn.load(std::memory_order_acquire);
+        } while (frame.page_key.load(std::memory_order_acquire) != key);
+        // 不看dirty：写回开始时dirty已清除，写入返回前页面仍须留在脏页表中
+        if (key && rec) pages.emplace_back(PageId::from_key(key), rec);
+    }
+    return pages;
+}
+
+BufferPoolStats BufferPool::stats() const
+{
+    BufferPoolStats stats;
+    stats.hits       = hits_.load(std::memory_order_relaxed);
+    stats.misses     = misses_.load(std::memory_order_relaxed);
+    stats.evictions  = evictions_.load(std::memory_order_relaxed);
+    stats.writebacks = writebacks_.load(std::memory_order_relaxed);
+    stats.flushes    = flushes_.load(std::memory_order_relaxed);
+    stats.prefetches = prefetches_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void BufferPool::reset_stats()
+{
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+    evictions_.store(0, std::memory_order_relaxed);
+    writebacks_.store(0, std::memory_order_relaxed);
+    flushes_.store(0, std::memory_order_relaxed);
+    prefetches_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <unordered_map>
+#include <vector>
+#include "Thread/OptLock.h"
+#include "Thread/ReWrLock.h"
+#include "disk_manager.h"
+#include "replacer.h"
+
+enum class RC;
+class LogManager;
+class ThreadPool;
+
+/*
+ * 缓冲池。
+ *
+ * 固定数量的帧缓存磁盘页，帧的内存一次分配、按页大小对齐。页表按页标识的哈希分为若干分片，
+ * 每个分片一把互斥锁，不同分片的查找互不竞争。取页返回PageGuard，持有期间页面被钉住不会被淘汰，
+ * 析构时自动解除。修改页面前须持有页锁的写锁并调用mark_dirty；后台刷写线程持有读锁写回脏页。
+ * 淘汰脏页时由取页的线程同步写回。
+ *
+ * 每帧另有一个版本号供乐观读者使用：帧被复用时从淘汰到新页面读入完成一直锁住版本号，
+ * 需要乐观读者察觉修改的写者在持有写锁期间同样锁住它。乐观读者不钉住页面，读前记录版本号并确认帧中
+ * 仍是要读的页，读完后校验版本号。版本号被锁住的帧总是被钉住的，不会被选为淘汰对象。
+ *
+ * 磁盘管理器启动了异步读时支持预读进缓冲池：预读的页各占一帧，读请求经io_uring批量提交，帧在读入完成前
+ * 保持钉住并锁住io_mutex与版本号，取这些页的线程等待读入完成，由完成线程解锁。扫描可以用read_ahead
+ * 提前请求之后的页；开启顺序预读（set_read_ahead）后缓冲池还按文件检测顺序的未命中，
+ * 检测到时在读当前页之前发出之后一个窗口的预读，并标记窗口的第一页，取到带标记的页时发出下一个窗口，
+ * 窗口从InitialWindow页起每次加倍，直到上限。
+ *
+ * 设置了日志管理器时遵守预写日志规则：页面前8字节为页面LSN，写回前先让日志落盘到该序号。
+ * 记日志的修改在页面变脏时登记日志位置（rec_lsn），检查点据此得到脏页表。
+ */
+
+/**
+ * @brief 缓冲池统计快照
+ */
+struct BufferPoolStats
+{
+    uint64_t hits;        ///< 命中次数
+    uint64_t misses;      ///< 未命中次数
+    uint64_t evictions;   ///< 淘汰次数
+    uint64_t writebacks;  ///< 淘汰时写回的脏页数
+    uint64_t flushes;     ///< 刷写线程与flush写回的脏页数
+    uint64_t prefetches;  ///< 发出的预读请求数
+};
+
+class BufferPool;
+
+/**
+ * @brief 可以由另一个线程解锁的互斥量
+ *
+ * 异步读入时由发起读的线程加锁、完成线程解锁，std::mutex不允许这样使用。满足Lockable，可用于std::unique_lock。
+ */
+class IoLatch
+{
+  public:
+    void lock() { sem_.acquire(); }
+    bool try_lock() { return sem_.try_acquire(); }
+    void unlock() { sem_.release(); }
+
+  private:
+    std::binary_semaphore sem_{1};  ///< 为1时未加锁
+};
+
+/**
+ * @brief 缓冲池中的一帧
+ */
+struct Frame
+{
+    std::atomic<uint64_t> page_key{0};        ///< 帧中页面的PageId::key()
+    std::atomic<uint32_t> pin_count{0};       ///< 引用计数
+    std::atomic<bool>     dirty{false};       ///< 是否为脏页
+    std::atomic<uint64_t> rec_lsn{0};         ///< 使页面变脏的最早一条日志记录的起始偏移，写回完成后清为0
+    std::atomic<bool>     ahead_mark{false};  ///< 预读窗口的第一页，取到时发出下一个窗口
+    bool                  loaded{false};      ///< 页面是否已成功读入
+    IoLatch               io_mutex;           ///< 读入与写回期间持有，命中的线程在此等待读入完成
+    ReWrLock              latch;              ///< 页锁，保护页面内容
+    OptLock               version;            ///< 版本号，页面被修改或帧被复用时递增
+    char*                 data{nullptr};      ///< 页面内容
+};
+
+/**
+ * @brief 钉住页面的守护类
+ *
+ * 可移动，不可复制。析构或release时解除钉住。
+ */
+class PageGuard
+{
+    friend BufferPool;
+
+  public:
+    PageGuard() = default;
+    PageGuard(PageGuard&& other) noexcept;
+    PageGuard& operator=(PageGuard&& other) noexcept;
+    PageGuard(const PageGuard&)            = delete;
+    PageGuard& operator=(const PageGuard&) = delete;
+    ~PageGuard() { release(); }
+
+    /**
+     * @brief 是否钉住了页面
+     */
+    bool valid() const { return frame_ != nullptr; }
+
+    PageId      id() const;
+    char*       data() { return frame_->data; }
+    const char* data() const { return frame_->data; }
+    ReWrLock&   latch() { return frame_->latch; }
+    OptLock&    version() { return frame_->version; }
+
+    /**
+     * @brief 标记为脏页，调用者须持有页锁的写锁
+     */
+    void mark_dirty() { frame_->dirty.store(true, std::memory_order_release); }
+
+    /**
+     * @brief 登记使页面变脏的日志位置，已登记过时不变，调用者须持有页锁的写锁
+     *
+     * 须在追加修改页面的日志记录之前调用，lsn不大于该记录的起始偏移，如LogManager::end_lsn()。
+     */
+    void set_rec_lsn(uint64_t lsn)
+    {
+        if (frame_->rec_lsn.load(std::memory_order_relaxed) == 0) frame_->rec_lsn.store(lsn, std::memory_order_release);
+    }
+
+    /**
+     * @brief 提前解除钉住
+     */
+    void release();
+
+  private:
+    PageGuard(BufferPool* pool, Frame* frame) : pool_(pool), frame_(frame) {}
+
+    BufferPool* pool_  = nullptr;  ///< 所属缓冲池
+    Frame*      frame_ = nullptr;  ///< 钉住的帧
+};
+
+/**
+ * @brief 缓冲池管理器
+ *
+ * 线程安全。
+ */
+class BufferPool
+{
+    friend PageGuard;
+
+  public:
+    /**
+     * @brief 构造函数
+     *
+     * @param disk 磁盘管理器
+     * @param frames 帧数
+     * @param kind 置换策略
+     * @param rc 帧数为0时为RC::INVALID_ARGUMENT
+     */
+    BufferPool(DiskManager& disk, std::size_t frames, ReplacerKind kind, RC& rc);
+
+    /**
+     * @brief 析构函数
+     *
+     * 停止刷写线程并写回全部脏页。
+     */
+    ~BufferPool();
+
+    BufferPool(const BufferPool&)            = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * @brief 取页并钉住
+     *
+     * @param rc 全部帧都被钉住时为RC::LOCKED，读页失败时为磁盘管理器的返回码
+     * @return 失败时返回无效的守护对象
+     */
+    PageGuard fetch_page(PageId id, RC& rc);
+
+    /**
+     * @brief 取得页面所在的帧，供乐观读者使用
+     *
+     * 页面不在缓冲池中时先读入。返回的帧没有被钉住，随时可能被淘汰复用，调用者须在OptLock::read_begin
+     * 之后确认Frame::page_key仍是该页，读完后校验版本号。帧的内存不会释放，读到的只可能是过期内容。
+     *
+     * @return 失败时返回nullptr
+     */
+    Frame* frame_of(PageId id, RC& rc);
+
+    /**
+     * @brief 在文件中分配一个新页并钉住
+     *
+     * 新页内容为全0且已标记为脏页，不读磁盘。
+     */
+    PageGuard new_page(file_id_t file, RC& rc);
+
+    /**
+     * @brief 预读一页
+     *
+     * 页已在缓冲池中时什么也不做。启动了异步读时同read_ahead(id, 1, rc)；否则通过DiskManager::prefetch
+     * 让内核异步读入页缓存，不占用帧，之后的fetch_page仍会未命中，但读入不再等待磁盘。
+     */
+    void prefetch(PageId id, RC& rc);
+
+    /**
+     * @brief 把[first, first + pages)中不在缓冲池中的页异步读入缓冲池，不等待读入完成
+     *
+     * 读请求一次批量提交。一次最多占用四分之一的帧，帧都被钉住时只读入已占到帧的页；超出文件的页被忽略。
+     * 没有启动异步读时什么也不做。
+     */
+    void read_ahead(PageId first, std::size_t pages, RC& rc);
+
+    /**
+     * @brief 设置顺序预读窗口的上限（页数），0为关闭
+     *
+     * 不超过四分之一的帧数；只在启动了异步读时生效。
+     * 须在缓冲池开始使用前设置。
+     */
+    void set_read_ahead(std::size_t pages);
+
+    /**
+     * @brief 顺序预读窗口的上限，扫描据此决定提前请求多少页
+     */
+    std::size_t read_ahead_pages() const { return read_ahead_max_; }
+
+    /**
+     * @brief 写回一页，页不在缓冲池中或不是脏页时什么也不做
+     */
+    void flush_page(PageId id, RC& rc);
+
+    /**
+     * @brief 写回全部脏页
+     */
+    void flush_all(RC& rc);
+
+    /**
+     * @brief 在线程池中启动后台刷写任务
+     *
+     * 刷写任务每隔interval写回最多batch个脏页，等待期间登记为阻塞，线程池会补充线程。
+     */
+    void start_flusher(ThreadPool& pool, std::chrono::milliseconds interval, std::size_t batch);
+
+    /**
+     * @brief 停止后台刷写任务并等待其退出
+     */
+    void stop_flusher();
+
+    /**
+     * @brief 设置写回前须先落盘的日志，为nullptr时不检查
+     *
+     * 须在缓冲池开始使用前设置。
+     */
+    void set_log(LogManager* log) { log_ = log; }
+
+    /**
+     * @brief 登记了日志位置的脏页及其rec_lsn的快照，不加页锁，供检查点使用
+     *
+     * 包括正在写回、写入尚未返回的页面：rec_lsn在写入返回后才清除。
+     */
+    std::vector<std::pair<PageId, uint64_t>> dirty_pages() const;
+
+    BufferPoolStats stats() const;
+    void            reset_stats();
+
+    std::size_t  frame_count() const { return frame_count_; }
+    std::size_t  page_size() const { return disk_.page_size(); }
+    DiskManager& disk() { return disk_; }
+
+  private:
+    /**
+     * @brief 页表分片
+     */
+    struct alignas(64) Shard
+    {
+        std::mutex                               mutex;  ///< 保护table
+        std::unordered_map<uint64_t, frame_id_t> table;  ///< 页标识到帧号
+    };
+
+    /**
+     * @brief 一个文件的顺序访问状态
+     */
+    struct Stream
+    {
+        std::mutex  mutex;                ///< 保护以下各项
+        page_no_t   last{InvalidPageNo};  ///< 最近一次未命中或取到预读标记的页号
+        page_no_t   ahead{InvalidPageNo}; ///< 已发出预读的页号上界
+        std::size_t window{0};            ///< 当前预读窗口，0为尚未判定为顺序访问
+    };
+
+    static constexpr std::size_t InitialWindow = 4;  ///< 判定为顺序访问后的第一个预读窗口
+
+    Shard&     shard_of(uint64_t key) { return shards_[(key * 0x9E3779B97F4A7C15ull >> 32) & (shards_.size() - 1)]; }
+    frame_id_t frame_id(const Frame& frame) const { return static_cast<frame_id_t>(&frame - frames_.get()); }
+
+    void unpin(Frame& frame);
+
+    /**
+     * @brief 钉住已在缓冲池中的页面，不存在时返回nullptr
+     *
+     * @param touch 是否计为一次访问，刷写不计入置换器的访问历史
+     */
+    Frame* pin_resident(uint64_t key, bool touch);
+
+    /**
+     * @brief 取得一个空闲帧
+     *
+     * 返回的帧引用计数为1、持有io_mutex、版本号已锁住、不在页表中。
+     */
+    Frame* acquire_frame(RC& rc);
+
+    /**
+     * @brief 把取得的帧登记到页表
+     *
+     * 页面已被其他线程登记时归还帧并返回false。
+     */
+    bool install(Frame& frame, uint64_t key);
+
+    /**
+     * @brief 结束帧的读入：失败时把页面移出页表，之后解锁版本号与io_mutex，不解除钉住
+     */
+    void finish_load(Frame& frame, RC rc);
+
+    /**
+     * @brief 为[first, first + pages)中不在缓冲池中的页占帧并提交异步读
+     *
+     * @param mark 是否给第一个读入的页加预读标记
+     */
+    void issue_reads(PageId first, std::size_t pages, bool mark);
+
+    /**
+     * @brief 未命中时检测顺序访问，是则发出之后一个窗口的预读
+     */
+    void read_ahead_on_miss(PageId id);
+
+    /**
+     * @brief 取到带预读标记的页时发出下一个窗口的预读
+     */
+    void read_ahead_on_mark(PageId id);
+
+    /**
+     * @brief 先按页面LSN让日志落盘，再把帧的内容写入页面
+     */
+    void write_frame(const Frame& frame, PageId id, RC& rc);
+
+    /**
+     * @brief 写回一个已钉住的页面
+     */
+    void flush_frame(Frame& frame, RC& rc);
+
+    /**
+     * @brief 从cursor开始写回最多batch个脏页
+     */
+    void flush_dirty(std::size_t batch, RC& rc);
+
+    void flusher_loop(std::chrono::milliseconds interval, std::size_t batch);
+
+    DiskManager&              disk_;           ///< 磁盘管理器
+    LogManager*               log_{nullptr};   ///< 写回前须落盘的日志
+    std::size_t               frame_count_;    ///< 帧数
+    std::unique_ptr<Frame[]>  frames_;         ///< 帧数组
+    char*                     memory_;         ///< 全部帧的页面内存
+    std::vector<Shard>        shards_;         ///< 页表分片，数量为2的幂
+    std::unique_ptr<Replacer> replacer_;       ///< 置换器
+    std::vector<frame_id_t>   free_;           ///< 从未使用或已丢弃的帧
+    std::mutex                free_mutex_;     ///< 保护free_
+    std::size_t               flush_cursor_;   ///< 刷写线程下次开始检查的帧
+    std::future<void>         flusher_;        ///< 刷写任务
+    bool                      flusher_stop_;   ///< 通知刷写任务退出
+    std::mutex                flusher_mutex_;  ///< 保护flusher_stop_
+    std::condition_variable   flusher_cv_;     ///< 唤醒刷写任务
+    std::unique_ptr<Stream[]> streams_;        ///< 按文件编号索引的顺序访问状态
+    std::size_t               read_ahead_max_; ///< 顺序预读窗口的上限，0为关闭
+    std::atomic<uint64_t>     hits_{0};        ///< 命中次数
+    std::atomic<uint64_t>     misses_{0};      ///< 未命中次数
+    std::atomic<uint64_t>     evictions_{0};   ///< 淘汰次数
+    std::atomic<uint64_t>     writebacks_{0};  ///< 淘汰时写回的脏页数
+    std::atomic<uint64_t>     flushes_{0};     ///< 主动写回的脏页数
+    std::atomic<uint64_t>     prefetches_{0};  ///< 预读请求数
+};
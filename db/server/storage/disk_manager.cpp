@@ -0,0 +1,421 @@
+#include "disk_manager.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ret.h"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr char     FileMagic[8] = {'M', 'I', 'N', 'I', 'D', 'B', 'P', 'F'};
+static constexpr uint32_t FileVersion  = 1;
+
+/**
+ * @brief 0号页开头的文件头
+ */
+struct FileHeader
+{
+    char     magic[8];    ///< 魔数
+    uint32_t version;     ///< 格式版本
+    uint32_t page_size;   ///< 页大小
+    uint32_t page_count;  ///< 已分配的页数，包括0号页
+    uint32_t reserved;    ///< 保留
+};
+
+/**
+ * @brief 已打开的数据文件
+ */
+struct DiskManager::DiskFile
+{
+    int                    fd;          ///< 文件描述符
+    std::string            name;        ///< 文件名
+    std::atomic<page_no_t> page_count;  ///< 已分配的页数
+    page_no_t              reserved;    ///< 文件中已预留的页数，不小于page_count
+    std::mutex             mutex;       ///< 保护分配页与写文件头
+};
+
+/**
+ * @brief 读满len字节，遇到文件末尾时补0
+ */
+static bool read_full(int fd, char* buf, std::size_t len, off_t offset)
+{
+    while (len > 0)
+    {
+        ssize_t n = pread(fd, buf, len, offset);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0)
+        {
+            memset(buf, 0, len);
+            return true;
+        }
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+/**
+ * @brief 写满len字节
+ */
+static bool write_full(int fd, const char* buf, std::size_t len, off_t offset)
+{
+    while (len > 0)
+    {
+        ssize_t n = pwrite(fd, buf, len, offset);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+static uint64_t elapsed_ns(Clock::time_point begin)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+}
+
+void DiskManager::AtomicIoStat::record(std::size_t size, uint64_t ns)
+{
+    count.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    total_ns.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = max_ns.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+IoStat DiskManager::AtomicIoStat::load() const
+{
+    IoStat stat;
+    stat.count    = count.load(std::memory_order_relaxed);
+    stat.bytes    = bytes.load(std::memory_order_relaxed);
+    stat.total_ns = total_ns.load(std::memory_order_relaxed);
+    stat.max_ns   = max_ns.load(std::memory_order_relaxed);
+    return stat;
+}
+
+void DiskManager::AtomicIoStat::reset()
+{
+    count.store(0, std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    total_ns.store(0, std::memory_order_relaxed);
+    max_ns.store(0, std::memory_order_relaxed);
+}
+
+DiskManager::DiskManager(const std::string& data_dir, std::size_t page_size, std::size_t extent_pages, RC& rc)
+    : data_dir_(data_dir),
+      page_size_(page_size),
+      extent_pages_(extent_pages ? extent_pages : 1),
+      files_(MaxFiles),
+      aio_(std::make_unique<AsyncIo>(0))
+{
+    if (page_size < MinPageSize || page_size > MaxPageSize || (page_size & (page_size - 1)) != 0)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(data_dir_, ec);
+    rc = ec ? RC::IO_ERROR : RC::SUCCESS;
+}
+
+DiskManager::~DiskManager()
+{
+    aio_.reset();
+    RC rc;
+    for (file_id_t id = 0; id < MaxFiles; ++id)
+        if (files_[id].load(std::memory_order_relaxed)) close_file(id, rc);
+}
+
+DiskManager::DiskFile* DiskManager::get_file(file_id_t file, RC& rc) const
+{
+    DiskFile* entry = file < MaxFiles ? files_[file].load(std::memory_order_acquire) : nullptr;
+    rc              = entry ? RC::SUCCESS : RC::INVALID_ARGUMENT;
+    return entry;
+}
+
+file_id_t DiskManager::open_file(const std::string& name, RC& rc)
+{
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    auto                        it = names_.find(name);
+    if (it != names_.end())
+    {
+        rc = RC::SUCCESS;
+        return it->second;
+    }
+
+    file_id_t id = 0;
+    while (id < MaxFiles && files_[id].load(std::memory_order_relaxed)) ++id;
+    if (id == MaxFiles || name.empty() || name.find('/') != std::string::npos)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return 0;
+    }
+
+    std::string path = data_dir_ + "/" + name + ".db";
+    int         fd   = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+        if (fd >= 0) close(fd);
+        rc = RC::IO_ERROR;
+        return 0;
+    }
+
+    auto entry        = std::make_unique<DiskFile>();
+    entry->fd         = fd;
+    entry->name       = name;
+    entry->page_count = 0;
+    entry->reserved   = static_cast<page_no_t>(st.st_size / page_size_);
+
+    if (st.st_size == 0)
+    {
+        // 新文件：预留第一个区，0号页写入文件头
+        reserve_extent(*entry, rc);
+        entry->page_count = 1;
+        if (SUCC(rc)) write_header(*entry, rc);
+    }
+    else
+    {
+        FileHeader header;
+        if (!read_full(fd, reinterpret_cast<char*>(&header), sizeof(header), 0))
+            rc = RC::IO_ERROR;
+        else if (memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion ||
+                 header.page_size != page_size_ || header.page_count == 0 || header.page_count > entry->reserved)
+            rc = RC::INVALID_ARGUMENT;
+        else
+        {
+            entry->page_count = header.page_count;
+            rc                = RC::SUCCESS;
+        }
+    }
+    if (FAIL(rc))
+    {
+        close(fd);
+        return 0;
+    }
+
+    files_[id].store(entry.release(), std::memory_order_release);
+    names_.emplace(name, id);
+    return id;
+}
+
+void DiskManager::close_file(file_id_t file, RC& rc)
+{
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    DiskFile*                   entry = get_file(file, rc);
+    if (FAIL(rc)) return;
+
+    {
+        std::lock_guard<std::mutex> file_lock(entry->mutex);
+        write_header(*entry, rc);
+    }
+    if (close(entry->fd) < 0 && SUCC(rc)) rc = RC::IO_ERROR;
+    names_.erase(entry->name);
+    files_[file].store(nullptr, std::memory_order_release);
+    delete entry;
+}
+
+/**
+ * @brief 写入文件头，调用者持有file.mutex或独占文件
+ */
+void DiskManager::write_header(DiskFile& file, RC& rc)
+{
+    FileHeader header{};
+    memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version    = FileVersion;
+    header.page_size  = static_cast<uint32_t>(page_size_);
+    header.page_count = file.page_count.load(std::memory_order_relaxed);
+    rc = write_full(file.fd, reinterpret_cast<const char*>(&header), sizeof(header), 0) ? RC::SUCCESS : RC::IO_ERROR;
+}
+
+/**
+ * @brief 在文件末尾预留一个区
+ *
+ * 文件系统不支持fallocate时退化为ftruncate，得到稀疏文件。调用者持有file.mutex或独占文件。
+ */
+void DiskManager::reserve_extent(DiskFile& file, RC& rc)
+{
+    off_t offset = static_cast<off_t>(file.reserved) * page_size_;
+    off_t length = static_cast<off_t>(extent_pages_ * page_size_);
+    int   ret;
+    while ((ret = fallocate(file.fd, 0, offset, length)) < 0 && errno == EINTR)
+    {
+    }
+    if (ret < 0 && (errno == EOPNOTSUPP || errno == ENOSYS)) ret = ftruncate(file.fd, offset + length);
+    if (ret < 0)
+    {
+        rc = RC::IO_ERROR;
+        return;
+    }
+    file.reserved += static_cast<page_no_t>(extent_pages_);
+    extents_.fetch_add(1, std::memory_order_relaxed);
+    rc = RC::SUCCESS;
+}
+
+page_no_t DiskManager::allocate_page(file_id_t file, RC& rc)
+{
+    DiskFile* entry = get_file(file, rc);
+    if (FAIL(rc)) return InvalidPageNo;
+
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    page_no_t                   page = entry->page_count.load(std::memory_order_relaxed);
+    if (page == UINT32_MAX)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return InvalidPageNo;
+    }
+    if (page >= entry->reserved)
+    {
+        reserve_extent(*entry, rc);
+        if (FAIL(rc)) return InvalidPageNo;
+    }
+    entry->page_count.store(page + 1, std::memory_order_release);
+    return page;
+}
+
+void DiskManager::read_page(PageId page, char* buf, RC& rc)
+{
+    DiskFile* entry = get_file(page.file, rc);
+    if (FAIL(rc)) return;
+    if (page.page == InvalidPageNo || page.page >= entry->page_count.load(std::memory_order_acquire))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    auto begin = Clock::now();
+    bool ok    = read_full(entry->fd, buf, page_size_, static_cast<off_t>(page.page) * page_size_);
+    reads_.record(page_size_, elapsed_ns(begin));
+    rc = ok ? RC::SUCCESS : RC::IO_ERROR;
+}
+
+void DiskManager::write_page(PageId page, const char* buf, RC& rc)
+{
+    DiskFile* entry = get_file(page.file, rc);
+    if (FAIL(rc)) return;
+    if (page.page == InvalidPageNo || page.page >= entry->page_count.load(std::memory_order_acquire))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    auto begin = Clock::now();
+    bool ok    = write_full(entry->fd, buf, page_size_, static_cast<off_t>(page.page) * page_size_);
+    writes_.record(page_size_, elapsed_ns(begin));
+    rc = ok ? RC::SUCCESS : RC::IO_ERROR;
+}
+
+void DiskManager::prefetch(PageId first, std::size_t pages, RC& rc)
+{
+    DiskFile* entry = get_file(first.file, rc);
+    if (FAIL(rc)) return;
+    page_no_t count = entry->page_count.load(std::memory_order_acquire);
+    if (first.page == InvalidPageNo || first.page >= count) return;
+    pages = std::min<std::size_t>(pages, count - first.page);
+
+    int ret = posix_fadvise(entry->fd, static_cast<off_t>(first.page) * page_size_,
+        static_cast<off_t>(pages * page_size_), POSIX_FADV_WILLNEED);
+    rc = ret == 0 ? RC::SUCCESS : RC::IO_ERROR;
+}
+
+void DiskManager::start_async_io(unsigned int depth) { aio_ = std::make_unique<AsyncIo>(depth); }
+
+void DiskManager::read_async(std::vector<PageRead>& reads)
+{
+    std::vector<AsyncRead> requests;
+    requests.reserve(reads.size());
+    auto begin = Clock::now();
+    for (PageRead& read : reads)
+    {
+        RC        rc;
+        DiskFile* entry = get_file(read.page.file, rc);
+        if (FAIL(rc) || read.page.page == InvalidPageNo ||
+            read.page.page >= entry->page_count.load(std::memory_order_acquire))
+        {
+            read.done(RC::INVALID_ARGUMENT);
+            continue;
+        }
+        off_t     offset = static_cast<off_t>(read.page.page) * page_size_;
+        AsyncRead request{entry->fd, read.buf, page_size_, offset, nullptr};
+        request.done = [this, begin, done = std::move(read.done)](RC result) {
+            if (SUCC(result)) reads_.record(page_size_, elapsed_ns(begin));
+            done(result);
+        };
+        requests.push_back(std::move(request));
+    }
+    aio_->submit(requests);
+}
+
+void DiskManager::sync(file_id_t file, RC& rc)
+{
+    DiskFile* entry = get_file(file, rc);
+    if (FAIL(rc)) return;
+    {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        write_header(*entry, rc);
+    }
+    if (FAIL(rc)) return;
+
+    auto begin = Clock::now();
+    int  ret;
+    while ((ret = fdatasync(entry->fd)) < 0 && errno == EINTR)
+    {
+    }
+    syncs_.record(0, elapsed_ns(begin));
+    rc = ret == 0 ? RC::SUCCESS : RC::IO_ERROR;
+}
+
+void DiskManager::sync_all(RC& rc)
+{
+    rc = RC::SUCCESS;
+    for (file_id_t file = 0; file < MaxFiles; ++file)
+    {
+        if (!files_[file].load(std::memory_order_acquire)) continue;
+        RC frc;
+        sync(file, frc);
+        if (FAIL(frc) && frc != RC::INVALID_ARGUMENT) rc = frc;
+    }
+}
+
+page_no_t DiskManager::page_count(file_id_t file) const
+{
+    RC        rc;
+    DiskFile* entry = get_file(file, rc);
+    return entry ? entry->page_count.load(std::memory_order_acquire) : 0;
+}
+
+DiskStats DiskManager::stats() const
+{
+    DiskStats stats;
+    stats.reads   = reads_.load();
+    stats.writes  = writes_.load();
+    stats.syncs   = syncs_.load();
+    stats.extents = extents_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+AsyncIoStats DiskManager::async_stats() const { return aio_->stats(); }
+
+void DiskManager::reset_stats()
+{
+    reads_.reset();
+    writes_.reset();
+    syncs_.reset();
+    extents_.store(0, std::memory_order_relaxed);
+}
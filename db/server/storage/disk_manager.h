@@ -0,0 +1,254 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "async_io.h"
+
+enum class RC;
+
+/*
+ * 页式磁盘管理。
+ *
+ * 每张表一个数据文件<data_dir>/<name>.db，按固定大小的页读写，页大小由构造函数的page_size指定。
+ * 文件第0页为文件头，记录魔数、页大小与已分配的页数，数据页从1开始编号，0号页同时用作无效页号。
+ * 文件按区（extent_pages个页）用fallocate一次预留，分配页只移动计数，不逐页扩展文件。
+ * 读写使用pread/pwrite，不经过文件偏移，多线程可以同时读写同一文件的不同页。
+ * 启动异步读后可以用read_async经io_uring批量提交读页请求，见async_io.h。
+ */
+
+using file_id_t = uint32_t;  ///< 打开的数据文件编号
+using page_no_t = uint32_t;  ///< 文件内的页号
+
+constexpr page_no_t InvalidPageNo = 0;  ///< 无效页号，0号页为文件头
+
+/**
+ * @brief 页标识
+ */
+struct PageId
+{
+    file_id_t file = 0;              ///< 文件编号
+    page_no_t page = InvalidPageNo;  ///< 页号
+
+    /**
+     * @brief 合并为一个64位整数，用作哈希表的键
+     */
+    uint64_t key() const { return static_cast<uint64_t>(file) << 32 | page; }
+
+    static PageId from_key(uint64_t key) { return {static_cast<file_id_t>(key >> 32), static_cast<page_no_t>(key)}; }
+
+    bool operator==(const PageId& other) const = default;
+};
+
+/**
+ * @brief 一类I/O操作的统计
+ */
+struct IoStat
+{
+    uint64_t count    = 0;  ///< 次数
+    uint64_t bytes    = 0;  ///< 字节数
+    uint64_t total_ns = 0;  ///< 累计耗时（纳秒）
+    uint64_t max_ns   = 0;  ///< 单次最大耗时（纳秒）
+
+    /**
+     * @brief 平均耗时（纳秒）
+     */
+    double avg_ns() const { return count ? static_cast<double>(total_ns) / count : 0; }
+};
+
+/**
+ * @brief 磁盘I/O统计快照
+ */
+struct DiskStats
+{
+    IoStat   reads;    ///< 读页
+    IoStat   writes;   ///< 写页
+    IoStat   syncs;    ///< fdatasync
+    uint64_t extents;  ///< 预留的区数
+};
+
+/**
+ * @brief 异步读页请求
+ */
+struct PageRead
+{
+    PageId                  page;  ///< 页标识
+    char*                   buf;   ///< 输出缓冲区，至少page_size()字节
+    std::function<void(RC)> done;  ///< 完成回调，在完成线程中调用
+};
+
+/**
+ * @brief 页式磁盘管理器
+ *
+ * 线程安全。关闭文件时调用者须保证没有其他线程正在读写该文件。
+ */
+class DiskManager
+{
+  public:
+    static constexpr std::size_t MinPageSize = 512;        ///< 最小页大小
+    static constexpr std::size_t MaxPageSize = 64 * 1024;  ///< 最大页大小
+    static constexpr std::size_t MaxFiles    = 4096;       ///< 同时打开的最大文件数
+
+    /**
+     * @brief 构造函数
+     *
+     * 数据目录不存在时创建。
+     *
+     * @param data_dir 数据目录
+     * @param page_size 页大小，须为MinPageSize~MaxPageSize之间的2的幂
+     * @param extent_pages 每次预留的页数
+     * @param rc 页大小不合法时为RC::INVALID_ARGUMENT，无法创建目录时为RC::IO_ERROR
+     */
+    DiskManager(const std::string& data_dir, std::size_t page_size, std::size_t extent_pages, RC& rc);
+
+    /**
+     * @brief 析构函数
+     *
+     * 写回全部文件头并关闭文件。
+     */
+    ~DiskManager();
+
+    DiskManager(const DiskManager&)            = delete;
+    DiskManager& operator=(const DiskManager&) = delete;
+
+    /**
+     * @brief 打开数据文件，不存在时创建
+     *
+     * 同名文件已经打开时返回已有的编号。
+     *
+     * @param name 文件名（通常为表名），不含目录与扩展名
+     * @param rc 文件头损坏或页大小与配置不一致时为RC::INVALID_ARGUMENT，系统调用失败时为RC::IO_ERROR
+     * @return 文件编号
+     */
+    file_id_t open_file(const std::string& name, RC& rc);
+
+    /**
+     * @brief 写回文件头并关闭文件
+     */
+    void close_file(file_id_t file, RC& rc);
+
+    /**
+     * @brief 分配一个新页
+     *
+     * 新页的内容为全0。已预留的页用完时再预留一个区。
+     *
+     * @return 新页的页号
+     */
+    page_no_t allocate_page(file_id_t file, RC& rc);
+
+    /**
+     * @brief 读取一页
+     *
+     * @param buf 输出缓冲区，至少page_size()字节
+     * @param rc 页号不存在时为RC::INVALID_ARGUMENT
+     */
+    void read_page(PageId page, char* buf, RC& rc);
+
+    /**
+     * @brief 写入一页
+     *
+     * 只写入操作系统缓存，持久化需要再调用sync。
+     */
+    void write_page(PageId page, const char* buf, RC& rc);
+
+    /**
+     * @brief 预读从first开始的pages个页
+     *
+     * 用posix_fadvise通知内核异步读入页缓存，不等待I/O完成，之后的read_page不再阻塞在磁盘上。
+     * 超出已分配页数的部分被忽略。
+     */
+    void prefetch(PageId first, std::size_t pages, RC& rc);
+
+    /**
+     * @brief 启动异步读，须在开始读写前调用
+     *
+     * @param depth 队列深度；为0或io_uring不可用时read_async同步读
+     */
+    void start_async_io(unsigned int depth);
+
+    /**
+     * @brief 是否在用io_uring异步读
+     */
+    bool async_io() const { return aio_->uring(); }
+
+    /**
+     * @brief 批量异步读页，不等待完成
+     *
+     * 全部请求用一次io_uring_enter提交（超出队列深度时分批），计入读页统计的耗时从提交到完成。
+     * 页号不存在的请求以RC::INVALID_ARGUMENT直接完成。请求完成前不能关闭文件。reads中的回调被移走。
+     */
+    void read_async(std::vector<PageRead>& reads);
+
+    /**
+     * @brief 写回文件头并把文件数据落盘
+     */
+    void sync(file_id_t file, RC& rc);
+
+    /**
+     * @brief 落盘全部已打开的文件，不能与close_file并发
+     */
+    void sync_all(RC& rc);
+
+    /**
+     * @brief 文件中已分配的页数，包括0号页
+     */
+    page_no_t page_count(file_id_t file) const;
+
+    std::size_t        page_size() const { return page_size_; }
+    const std::string& data_dir() const { return data_dir_; }
+
+    /**
+     * @brief 取得I/O统计快照
+     */
+    DiskStats stats() const;
+
+    /**
+     * @brief 异步读引擎的统计，未启动异步读时只有同步完成的请求
+     */
+    AsyncIoStats async_stats() const;
+
+    /**
+     * @brief 清零I/O统计
+     */
+    void reset_stats();
+
+  private:
+    struct DiskFile;
+
+    /**
+     * @brief 原子更新的I/O统计
+     */
+    struct AtomicIoStat
+    {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+
+        void   record(std::size_t size, uint64_t ns);
+        IoStat load() const;
+        void   reset();
+    };
+
+    DiskFile* get_file(file_id_t file, RC& rc) const;
+    void      write_header(DiskFile& file, RC& rc);
+    void      reserve_extent(DiskFile& file, RC& rc);
+
+    std::string                                data_dir_;      ///< 数据目录
+    std::size_t                                page_size_;     ///< 页大小
+    std::size_t                                extent_pages_;  ///< 每次预留的页数
+    std::vector<std::atomic<DiskFile*>>        files_;         ///< 按编号索引的已打开文件
+    std::unordered_map<std::string, file_id_t> names_;         ///< 文件名到编号
+    std::mutex                                 files_mutex_;   ///< 保护打开与关闭文件
+    AtomicIoStat                               reads_;         ///< 读页统计
+    AtomicIoStat                               writes_;        ///< 写页统计
+    AtomicIoStat                               syncs_;         ///< 落盘统计
+    std::atomic<uint64_t>                      extents_{0};    ///< 预留的区数
+    std::unique_ptr<AsyncIo>                   aio_;           ///< 异步读引擎
+};
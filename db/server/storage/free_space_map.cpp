@@ -0,0 +1,152 @@
+#include "free_space_map.h"
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include "ret.h"
+
+static constexpr char MapMagic[8] = {'M', 'I', 'N', 'I', 'H', 'E', 'A', 'P'};
+
+FreeSpaceMap::FreeSpaceMap(BufferPool& pool, file_id_t file, RC& rc)
+    : pool_(pool),
+      file_(file),
+      group_(pool.page_size() - sizeof(MapHeader)),
+      unit_(pool.page_size() / Levels),
+      pages_(0)
+{
+    std::fill(std::begin(head_), std::end(head_), InvalidPageNo);
+    std::fill(std::begin(nonempty_), std::end(nonempty_), 0);
+
+    page_no_t count = pool.disk().page_count(file);
+    if (count <= 1)
+    {
+        PageGuard page = pool_.new_page(file_, rc);
+        if (FAIL(rc)) return;
+        if (page.id().page != 1)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        init_map_page(page);
+        count = 2;
+    }
+    level_.assign(count, 0);
+    prev_.assign(count, InvalidPageNo);
+    next_.assign(count, InvalidPageNo);
+
+    for (page_no_t map = 1; map < count; map += static_cast<page_no_t>(group_ + 1))
+    {
+        PageGuard page = pool_.fetch_page({file_, map}, rc);
+        if (FAIL(rc)) return;
+        MapHeader header;
+        memcpy(&header, page.data(), sizeof(header));
+        static constexpr char Zero[sizeof(MapMagic)] = {};
+        if (memcmp(header.magic, Zero, sizeof(Zero)) == 0)
+            // 映射页不记日志，崩溃恢复重做后面的数据页时扩展出的全0映射页重新初始化，空闲空间在修改数据页时补上
+            init_map_page(page);
+        else if (memcmp(header.magic, MapMagic, sizeof(MapMagic)) != 0)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        ReadGuard latch = page.latch().read();
+        const uint8_t* levels = reinterpret_cast<const uint8_t*>(page.data() + sizeof(MapHeader));
+        for (page_no_t data = map + 1; data < count && data - map <= group_; ++data)
+        {
+            ++pages_;
+            if (levels[data - map - 1]) link(data, levels[data - map - 1]);
+        }
+    }
+    rc = RC::SUCCESS;
+}
+
+void FreeSpaceMap::init_map_page(PageGuard& page)
+{
+    WriteGuard latch = page.latch().write();
+    MapHeader  header{};
+    memcpy(header.magic, MapMagic, sizeof(MapMagic));
+    memcpy(page.data(), &header, sizeof(header));
+    page.mark_dirty();
+}
+
+void FreeSpaceMap::link(page_no_t page, uint8_t level)
+{
+    level_[page] = level;
+    prev_[page]  = InvalidPageNo;
+    next_[page]  = head_[level];
+    if (head_[level] != InvalidPageNo) prev_[head_[level]] = page;
+    head_[level] = page;
+    nonempty_[level / 64] |= 1ull << (level % 64);
+}
+
+void FreeSpaceMap::unlink(page_no_t page)
+{
+    uint8_t level = level_[page];
+    if (level == 0) return;
+    if (prev_[page] != InvalidPageNo)
+        next_[prev_[page]] = next_[page];
+    else
+        head_[level] = next_[page];
+    if (next_[page] != InvalidPageNo) prev_[next_[page]] = prev_[page];
+    if (head_[level] == InvalidPageNo) nonempty_[level / 64] &= ~(1ull << (level % 64));
+    level_[page] = 0;
+}
+
+page_no_t FreeSpaceMap::find(std::size_t size)
+{
+    std::size_t                 need = std::max<std::size_t>(1, (size + unit_ - 1) / unit_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t word = need / 64; word < Levels / 64; ++word)
+    {
+        uint64_t bits = nonempty_[word];
+        if (word == need / 64) bits &= ~0ull << (need % 64);
+        if (bits) return head_[word * 64 + std::countr_zero(bits)];
+    }
+    return InvalidPageNo;
+}
+
+void FreeSpaceMap::update(page_no_t page, std::size_t free, RC& rc)
+{
+    uint8_t                     level = level_of(free);
+    std::lock_guard<std::mutex> lock(mutex_);
+    rc = RC::SUCCESS;
+    if (page >= level_.size() || is_map_page(page) || level_[page] == level) return;
+    unlink(page);
+    if (level) link(page, level);
+
+    page_no_t map   = map_page(page);
+    PageGuard guard = pool_.fetch_page({file_, map}, rc);
+    if (FAIL(rc)) return;
+    WriteGuard latch = guard.latch().write();
+    guard.data()[sizeof(MapHeader) + (page - map - 1)] = static_cast<char>(level);
+    guard.mark_dirty();
+}
+
+PageGuard FreeSpaceMap::allocate(RC& rc)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (true)
+    {
+        PageGuard page = pool_.new_page(file_, rc);
+        if (FAIL(rc)) return {};
+        page_no_t no = page.id().page;
+        if (no >= level_.size())
+        {
+            level_.resize(no + 1, 0);
+            prev_.resize(no + 1, InvalidPageNo);
+            next_.resize(no + 1, InvalidPageNo);
+        }
+        if (is_map_page(no))
+        {
+            init_map_page(page);
+            continue;
+        }
+        ++pages_;
+        return page;
+    }
+}
+
+std::size_t FreeSpaceMap::pages() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pages_;
+}
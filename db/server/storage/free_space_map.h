@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "buffer_pool.h"
+
+enum class RC;
+
+/*
+ * 堆文件的空闲空间映射（free space map）。
+ *
+ * 每个数据页的空闲字节数以页大小的1/256为单位向下取整，记为一个字节的等级，持久化在堆文件的映射页中：
+ * 1号页与之后每隔Group + 1页是一个映射页，依次记录紧随其后的Group个数据页的等级。
+ * 内存中每个等级维护一个数据页的双向链表，另用一个256位的位图标记非空的链表：
+ * 找能放下n字节的页时从ceil(n / 单位)级开始取第一个置位的等级的链表头，代价与文件大小无关；
+ * 页的等级变化时在链表之间摘挂，同样是常数时间。等级只会低估空闲空间，找到的页一定放得下，
+ * 除非它在找到之后被其他线程填充，调用者在页锁下确认并用update纠正。
+ */
+
+/**
+ * @brief 空闲空间映射
+ *
+ * 线程安全。
+ */
+class FreeSpaceMap
+{
+  public:
+    static constexpr std::size_t Levels = 256;  ///< 等级数
+
+    /**
+     * @brief 从文件中的映射页加载，文件为空时创建第一个映射页
+     *
+     * @param rc 映射页损坏时为RC::INVALID_ARGUMENT
+     */
+    FreeSpaceMap(BufferPool& pool, file_id_t file, RC& rc);
+
+    FreeSpaceMap(const FreeSpaceMap&)            = delete;
+    FreeSpaceMap& operator=(const FreeSpaceMap&) = delete;
+
+    /**
+     * @brief 是否为映射页
+     */
+    bool is_map_page(page_no_t page) const { return page != InvalidPageNo && (page - 1) % (group_ + 1) == 0; }
+
+    /**
+     * @brief 找一个空闲空间不少于size字节的数据页
+     *
+     * @return 没有时返回InvalidPageNo
+     */
+    page_no_t find(std::size_t size);
+
+    /**
+     * @brief 记录数据页的空闲字节数，等级变化时写入映射页
+     *
+     * 调用者持有数据页的写锁，同一页的更新按修改顺序到达。
+     */
+    void update(page_no_t page, std::size_t free, RC& rc);
+
+    /**
+     * @brief 在文件末尾分配一个数据页并钉住，需要时先分配新的映射页
+     *
+     * 新页内容为全0，在第一次update之前不会被find返回。
+     */
+    PageGuard allocate(RC& rc);
+
+    /**
+     * @brief 文件中的数据页数
+     */
+    std::size_t pages() const;
+
+  private:
+    /**
+     * @brief 映射页页头
+     */
+    struct MapHeader
+    {
+        uint64_t lsn;       ///< 最后修改该页的日志序号
+        char     magic[8];  ///< 魔数
+    };
+
+    uint8_t level_of(std::size_t free) const { return static_cast<uint8_t>(std::min(free / unit_, Levels - 1)); }
+
+    /**
+     * @brief 数据页所在的映射页
+     */
+    page_no_t map_page(page_no_t page) const { return page - (page - 1) % (group_ + 1); }
+
+    void link(page_no_t page, uint8_t level);
+    void unlink(page_no_t page);
+
+    /**
+     * @brief 初始化新分配的映射页
+     */
+    void init_map_page(PageGuard& page);
+
+    BufferPool&            pool_;                   ///< 缓冲池
+    file_id_t              file_;                   ///< 堆文件
+    std::size_t            group_;                  ///< 每个映射页覆盖的数据页数
+    std::size_t            unit_;                   ///< 一个等级对应的字节数
+    mutable std::mutex     mutex_;                  ///< 保护以下成员与映射页的写入
+    std::vector<uint8_t>   level_;                  ///< 按页号索引的等级，为0的页不在链表中
+    std::vector<page_no_t> prev_;                   ///< 同等级链表中的前一页
+    std::vector<page_no_t> next_;                   ///< 同等级链表中的后一页
+    page_no_t              head_[Levels];           ///< 各等级链表头
+    uint64_t               nonempty_[Levels / 64];  ///< 链表非空的等级位图
+    std::size_t            pages_;                  ///< 数据页数
+};
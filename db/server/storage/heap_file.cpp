@@ -0,0 +1,327 @@
+#include "heap_file.h"
+#include <algorithm>
+#include <thread>
+#include "recovery.h"
+#include "ret.h"
+
+RecordId HeapIterator::rid() const
+{
+    HeapPage p = page();
+    if (p.kind(slot_) == RecordKind::MOVED) return p.rid(slot_);
+    return {page_no_, static_cast<uint16_t>(slot_)};
+}
+
+void HeapIterator::settle(RC& rc)
+{
+    rc = RC::SUCCESS;
+    while (true)
+    {
+        if (page_.valid())
+        {
+            HeapPage p = page();
+            for (; slot_ < p.slot_count(); ++slot_)
+                if (p.used(slot_) && p.kind(slot_) != RecordKind::FORWARD) return;
+            latch_.reset();
+            page_.release();
+        }
+
+        // 下一个数据页，跳过映射页
+        ++page_no_;
+        while (page_no_ < end_ && file_->fsm_.is_map_page(page_no_)) ++page_no_;
+        if (page_no_ >= end_) return;
+        // 读到已请求范围的后一半时再请求一个窗口，当前页不在其中时从当前页开始
+        std::size_t window = file_->pool_.read_ahead_pages();
+        if (window && page_no_ + window / 2 >= ahead_ && ahead_ < end_)
+        {
+            RC        arc;
+            page_no_t from  = std::max(ahead_, page_no_);
+            page_no_t pages = static_cast<page_no_t>(std::min<std::size_t>(window, end_ - from));
+            file_->pool_.read_ahead({file_->file_, from}, pages, arc);
+            ahead_ = from + pages;
+        }
+        page_ = file_->pool_.fetch_page({file_->file_, page_no_}, rc);
+        if (FAIL(rc)) return;
+        latch_.emplace(page_.latch().read());
+        slot_ = 0;
+    }
+}
+
+void HeapIterator::next(RC& rc)
+{
+    ++slot_;
+    settle(rc);
+}
+
+HeapFile::HeapFile(BufferPool& pool, file_id_t file, RC& rc)
+    : pool_(pool),
+      file_(file),
+      page_size_(pool.page_size()),
+      max_record_size_(HeapPage::max_record_size(page_size_)),
+      fsm_(pool, file, rc)
+{
+}
+
+PageGuard HeapFile::fetch(page_no_t page, RC& rc)
+{
+    if (page == InvalidPageNo || page >= pool_.disk().page_count(file_) || fsm_.is_map_page(page))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return {};
+    }
+    return pool_.fetch_page({file_, page}, rc);
+}
+
+void HeapFile::report(PageGuard& guard, RC& rc) { fsm_.update(guard.id().page, page(guard).free_space(), rc); }
+
+void HeapFile::backoff()
+{
+    retries_.fetch_add(1, std::memory_order_relaxed);
+    std::this_thread::yield();
+}
+
+void HeapFile::find_page(
+    Transaction* txn, std::size_t size, bool wait, PageGuard& page, std::optional<WriteGuard>& latch, RC& rc)
+{
+    while (true)
+    {
+        page_no_t no = fsm_.find(size);
+        if (no == InvalidPageNo) break;
+        page = pool_.fetch_page({file_, no}, rc);
+        if (FAIL(rc)) return;
+        if (wait)
+            latch.emplace(page.latch().write());
+        else
+        {
+            WriteGuard guard = page.latch().try_write(rc);
+            if (FAIL(rc)) break;
+            latch.emplace(std::move(guard));
+        }
+        if (this->page(page).free_space() >= size) return;
+
+        // 找到之后被其他线程填充了，纠正映射再找
+        report(page, rc);
+        latch.reset();
+        page.release();
+        if (FAIL(rc)) return;
+    }
+
+    // 新页在登记到映射之前只有当前线程可见。回滚到全0的页会被映射当作有空闲空间的数据页，初始化只重做
+    page = fsm_.allocate(rc);
+    if (FAIL(rc)) return;
+    latch.emplace(page.latch().write());
+    PageChange change(txn, page, true);
+    this->page(page).init();
+    change.done(rc);
+}
+
+RecordId HeapFile::insert(Transaction* txn, const char* data, std::size_t len, RC& rc)
+{
+    if (len > max_record_size_)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return {};
+    }
+
+    PageGuard                 guard;
+    std::optional<WriteGuard> latch;
+    find_page(txn, HeapPage::record_size(RecordKind::NORMAL, len), true, guard, latch, rc);
+    if (FAIL(rc)) return {};
+    PageChange change(txn, guard);
+    RecordId   rid{guard.id().page, page(guard).insert(RecordKind::NORMAL, {}, data, len)};
+    change.done(rc);
+    if (FAIL(rc)) return {};
+    report(guard, rc);
+    return rid;
+}
+
+void HeapFile::get(RecordId rid, std::vector<char>& record, RC& rc)
+{
+    while (true)
+    {
+        PageGuard home = fetch(rid.page, rc);
+        if (FAIL(rc)) return;
+        ReadGuard latch = home.latch().read();
+        HeapPage  p     = page(home);
+        if (!p.used(rid.slot) || p.kind(rid.slot) == RecordKind::MOVED)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        if (p.kind(rid.slot) == RecordKind::NORMAL)
+        {
+            record.assign(p.data(rid.slot), p.data(rid.slot) + p.length(rid.slot));
+            return;
+        }
+
+        // 持有原位置的读锁，转发桩在读取期间不会改变
+        RecordId  target = p.rid(rid.slot);
+        PageGuard moved  = fetch(target.page, rc);
+        if (FAIL(rc)) return;
+        ReadGuard moved_latch = moved.latch().try_read(rc);
+        if (FAIL(rc))
+        {
+            backoff();
+            continue;
+        }
+        HeapPage m = page(moved);
+        record.assign(m.data(target.slot), m.data(target.slot) + m.length(target.slot));
+        forward_reads_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+}
+
+void HeapFile::update(Transaction* txn, RecordId rid, const char* data, std::size_t len, RC& rc)
+{
+    if (len > max_record_size_)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    while (true)
+    {
+        PageGuard home = fetch(rid.page, rc);
+        if (FAIL(rc)) return;
+        WriteGuard latch = home.latch().write();
+        HeapPage   p     = page(home);
+        if (!p.used(rid.slot) || p.kind(rid.slot) == RecordKind::MOVED)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+
+        PageGuard                 moved;
+        std::optional<WriteGuard> moved_latch;
+        std::optional<PageChange> moved_change;
+        RecordId                  target;
+        if (p.kind(rid.slot) == RecordKind::FORWARD)
+        {
+            target = p.rid(rid.slot);
+            moved  = fetch(target.page, rc);
+            if (FAIL(rc)) return;
+            WriteGuard guard = moved.latch().try_write(rc);
+            if (FAIL(rc))
+            {
+                backoff();
+                continue;
+            }
+            moved_latch.emplace(std::move(guard));
+            moved_change.emplace(txn, moved);
+        }
+
+        // 原位置放得下时写在原位置，被转发的记录随之搬回
+        PageChange home_change(txn, home);
+        if (p.update(rid.slot, RecordKind::NORMAL, {}, data, len))
+        {
+            home_change.done(rc);
+            if (FAIL(rc)) return;
+            report(home, rc);
+            if (moved.valid())
+            {
+                page(moved).erase(target.slot);
+                moved_change->done(rc);
+                if (FAIL(rc)) return;
+                report(moved, rc);
+            }
+            return;
+        }
+        if (moved.valid() && page(moved).update(target.slot, RecordKind::MOVED, rid, data, len))
+        {
+            home_change.done(rc);
+            if (FAIL(rc)) return;
+            moved_change->done(rc);
+            if (FAIL(rc)) return;
+            report(moved, rc);
+            return;
+        }
+
+        // 放不下时两页都可能已被整理，先记下来。搬到新的页：先让映射知道这两页放不下，找页时不会再拿到它们
+        home_change.done(rc);
+        if (FAIL(rc)) return;
+        if (moved.valid()) moved_change->done(rc);
+        if (FAIL(rc)) return;
+        report(home, rc);
+        if (moved.valid()) report(moved, rc);
+        PageGuard                 fresh;
+        std::optional<WriteGuard> fresh_latch;
+        find_page(txn, HeapPage::record_size(RecordKind::MOVED, len), false, fresh, fresh_latch, rc);
+        if (FAIL(rc)) return;
+        PageChange fresh_change(txn, fresh);
+        RecordId   to{fresh.id().page, page(fresh).insert(RecordKind::MOVED, rid, data, len)};
+        fresh_change.done(rc);
+        if (FAIL(rc)) return;
+        report(fresh, rc);
+        p.update(rid.slot, RecordKind::FORWARD, to, nullptr, 0);
+        home_change.done(rc);
+        if (FAIL(rc)) return;
+        report(home, rc);
+        if (moved.valid())
+        {
+            page(moved).erase(target.slot);
+            moved_change->done(rc);
+            if (FAIL(rc)) return;
+            report(moved, rc);
+        }
+        forwards_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+}
+
+void HeapFile::remove(Transaction* txn, RecordId rid, RC& rc)
+{
+    while (true)
+    {
+        PageGuard home = fetch(rid.page, rc);
+        if (FAIL(rc)) return;
+        WriteGuard latch = home.latch().write();
+        HeapPage   p     = page(home);
+        if (!p.used(rid.slot) || p.kind(rid.slot) == RecordKind::MOVED)
+        {
+            rc = RC::INVALID_ARGUMENT;
+            return;
+        }
+        if (p.kind(rid.slot) == RecordKind::FORWARD)
+        {
+            RecordId  target = p.rid(rid.slot);
+            PageGuard moved  = fetch(target.page, rc);
+            if (FAIL(rc)) return;
+            WriteGuard moved_latch = moved.latch().try_write(rc);
+            if (FAIL(rc))
+            {
+                backoff();
+                continue;
+            }
+            PageChange change(txn, moved);
+            page(moved).erase(target.slot);
+            change.done(rc);
+            if (FAIL(rc)) return;
+            report(moved, rc);
+        }
+        PageChange change(txn, home);
+        p.erase(rid.slot);
+        change.done(rc);
+        if (FAIL(rc)) return;
+        report(home, rc);
+        return;
+    }
+}
+
+HeapIterator HeapFile::begin(RC& rc)
+{
+    HeapIterator it;
+    it.file_      = this;
+    it.page_size_ = page_size_;
+    it.end_       = pool_.disk().page_count(file_);
+    it.page_no_   = 1;
+    it.settle(rc);
+    return it;
+}
+
+HeapFileStats HeapFile::stats() const
+{
+    HeapFileStats stats;
+    stats.forwards      = forwards_.load(std::memory_order_relaxed);
+    stats.forward_reads = forward_reads_.load(std::memory_order_relaxed);
+    stats.retries       = retries_.load(std::memory_order_relaxed);
+    return stats;
+}
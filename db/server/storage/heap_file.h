@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Thread/ReWrLock.h"
+#include "buffer_pool.h"
+#include "free_space_map.h"
+#include "heap_page.h"
+
+enum class RC;
+struct Transaction;
+
+/*
+ * 基于缓冲池的堆文件，行存表的记录存储。
+ *
+ * 每张表一个数据文件，记录是变长字节串（如编码后的一行，CHARS列按实际长度存放），由RecordId标识。
+ * 数据页布局见heap_page.h，空闲空间由free_space_map.h中的映射管理：插入向映射要一个放得下的页，
+ * 找不到时在文件末尾分配新页，插入代价不随表的增长而变化。删除留下的空间通过映射被之后的插入复用。
+ *
+ * 更新原地改写；记录变长后本页放不下时搬到别的页，原位置改为转发桩，RecordId保持不变。
+ * 被转发的记录之后变短到原页放得下时搬回原位置。
+ *
+ * 并发控制使用页锁，任何时候最多阻塞等待一个页锁：需要第二个页时（跟随转发桩、为搬动的记录找新页）
+ * 只尝试加锁，失败就放开全部页锁重试，或换一个新页，因此不会死锁。
+ *
+ * 传入事务的插入、更新与删除通过恢复管理器为数据页的修改记日志（见recovery.h），新页的初始化只重做；
+ * 空闲空间映射只是提示，不记日志，恢复或回滚之后与页面不符的空闲空间在找页或下一次修改该页时纠正。
+ * 同一个堆文件的修改要么都记日志，要么都不记；新建的堆文件在第一个事务之前须写回。
+ */
+
+/**
+ * @brief 堆文件统计快照
+ */
+struct HeapFileStats
+{
+    uint64_t forwards;       ///< 更新时搬到别的页的次数
+    uint64_t forward_reads;  ///< 读取时跟随转发桩的次数
+    uint64_t retries;        ///< 第二个页锁加锁失败后重试的次数
+};
+
+class HeapFile;
+
+/**
+ * @brief 堆文件的顺序扫描迭代器
+ *
+ * 按页号顺序访问创建时已有的数据页，被转发的记录在它所在的页上按原RecordId报告，转发桩被跳过。
+ * 持有当前页的读锁，遍历期间同一线程不能修改这个堆文件。与并发的修改一起进行时，
+ * 扫描期间被搬动的记录可能被漏掉或报告两次。缓冲池开启了预读时提前请求之后BufferPool::read_ahead_pages()
+ * 个页。可移动，不可复制。
+ */
+class HeapIterator
+{
+    friend HeapFile;
+
+  public:
+    HeapIterator() = default;
+
+    bool valid() const { return page_.valid(); }
+
+    /**
+     * @brief 当前记录的RecordId
+     */
+    RecordId rid() const;
+
+    const char* data() const { return page().data(slot_); }
+    std::size_t length() const { return page().length(slot_); }
+
+    /**
+     * @brief 移到下一条记录，越过末尾后valid()为false
+     */
+    void next(RC& rc);
+
+  private:
+    HeapPage page() const { return HeapPage(const_cast<char*>(page_.data()), page_size_); }
+
+    /**
+     * @brief 从当前位置起找到下一条要报告的记录
+     */
+    void settle(RC& rc);
+
+    HeapFile*                file_      = nullptr;  ///< 所属堆文件
+    std::size_t              page_size_ = 0;        ///< 页大小
+    page_no_t                end_       = 0;        ///< 扫描的页号上界
+    page_no_t                page_no_   = 0;        ///< 当前页号
+    page_no_t                ahead_     = 0;        ///< 已请求预读的页号上界
+    std::size_t              slot_      = 0;        ///< 当前槽号
+    PageGuard                page_;                 ///< 当前页
+    std::optional<ReadGuard> latch_;                ///< 当前页的读锁，先于page_释放
+};
+
+/**
+ * @brief 堆文件
+ *
+ * 线程安全。
+ */
+class HeapFile
+{
+    friend HeapIterator;
+
+  public:
+    /**
+     * @brief 打开文件中的堆文件，文件为空时创建
+     *
+     * @param rc 映射页损坏时为RC::INVALID_ARGUMENT
+     */
+    HeapFile(BufferPool& pool, file_id_t file, RC& rc);
+
+    HeapFile(const HeapFile&)            = delete;
+    HeapFile& operator=(const HeapFile&) = delete;
+
+    RecordId insert(const char* data, std::size_t len, RC& rc) { return insert(nullptr, data, len, rc); }
+
+    /**
+     * @brief 插入一条记录
+     *
+     * @param txn 记日志的事务，为nullptr时不记日志
+     * @param rc 记录超过max_record_size()时为RC::INVALID_ARGUMENT
+     * @return 记录的RecordId
+     */
+    RecordId insert(Transaction* txn, const char* data, std::size_t len, RC& rc);
+
+    /**
+     * @brief 读取一条记录
+     *
+     * @param record 输出记录内容
+     * @param rc 记录不存在时为RC::INVALID_ARGUMENT
+     */
+    void get(RecordId rid, std::vector<char>& record, RC& rc);
+
+    void update(RecordId rid, const char* data, std::size_t len, RC& rc) { update(nullptr, rid, data, len, rc); }
+
+    /**
+     * @brief 改写一条记录，RecordId不变
+     *
+     * @param txn 记日志的事务，为nullptr时不记日志
+     * @param rc 记录不存在或新内容超过max_record_size()时为RC::INVALID_ARGUMENT
+     */
+    void update(Transaction* txn, RecordId rid, const char* data, std::size_t len, RC& rc);
+
+    void remove(RecordId rid, RC& rc) { remove(nullptr, rid, rc); }
+
+    /**
+     * @brief 删除一条记录，它的槽之后可能被新记录复用
+     *
+     * @param txn 记日志的事务，为nullptr时不记日志
+     * @param rc 记录不存在时为RC::INVALID_ARGUMENT
+     */
+    void remove(Transaction* txn, RecordId rid, RC& rc);
+
+    /**
+     * @brief 定位到第一条记录
+     */
+    HeapIterator begin(RC& rc);
+
+    /**
+     * @brief 最长记录，空页能放下的被转发记录
+     */
+    std::size_t max_record_size() const { return max_record_size_; }
+
+    /**
+     * @brief 文件中的数据页数
+     */
+    std::size_t pages() const { return fsm_.pages(); }
+
+    HeapFileStats stats() const;
+
+  private:
+    HeapPage page(PageGuard& guard) const { return HeapPage(guard.data(), page_size_); }
+
+    /**
+     * @brief 钉住RecordId所在的数据页
+     *
+     * @param rc 页号不是已分配的数据页时为RC::INVALID_ARGUMENT
+     */
+    PageGuard fetch(page_no_t page, RC& rc);
+
+    /**
+     * @brief 找一个放得下size字节的数据页并加写锁，找不到时分配新页
+     *
+     * @param wait 为false时只尝试加锁，失败则改用新页；调用者已持有其他页锁时必须为false
+     */
+    void find_page(Transaction* txn, std::size_t size, bool wait, PageGuard& page, std::optional<WriteGuard>& latch,
+        RC& rc);
+
+    /**
+     * @brief 把页的空闲空间报告给映射，调用者持有该页的写锁
+     */
+    void report(PageGuard& guard, RC& rc);
+
+    /**
+     * @brief 第二个页锁加锁失败后的重试计数，让出CPU
+     */
+    void backoff();
+
+    BufferPool&           pool_;              ///< 缓冲池
+    file_id_t             file_;              ///< 堆文件
+    std::size_t           page_size_;         ///< 页大小
+    std::size_t           max_record_size_;   ///< 最长记录
+    FreeSpaceMap          fsm_;               ///< 空闲空间映射
+    std::atomic<uint64_t> forwards_{0};       ///< 搬动次数
+    std::atomic<uint64_t> forward_reads_{0};  ///< 跟随转发桩的次数
+    std::atomic<uint64_t> retries_{0};        ///< 重试次数
+};
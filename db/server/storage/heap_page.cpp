@@ -0,0 +1,136 @@
+#include "heap_page.h"
+#include <vector>
+
+void HeapPage::init()
+{
+    HeapPageHeader& h = header();
+    h.lsn             = 0;
+    h.slot_count      = 0;
+    h.free_slots      = 0;
+    h.heap_begin      = static_cast<uint32_t>(page_size_);
+    h.garbage         = 0;
+}
+
+RecordId HeapPage::rid(std::size_t slot) const
+{
+    const char* p = page_ + offset(slot) + 1;
+    return {load<page_no_t>(p), load<uint16_t>(p + sizeof(page_no_t))};
+}
+
+std::size_t HeapPage::free_space() const
+{
+    const HeapPageHeader& h = header();
+    if (h.free_slots == 0 && h.slot_count == UINT16_MAX) return 0;
+    std::size_t total = h.heap_begin - slots_end() + h.garbage;
+    std::size_t slot  = h.free_slots ? 0 : SlotSize;
+    return total > slot ? total - slot : 0;
+}
+
+uint16_t HeapPage::allocate(std::size_t size)
+{
+    HeapPageHeader& h = header();
+    if (h.heap_begin - slots_end() < size) compact();
+    h.heap_begin -= static_cast<uint32_t>(size);
+    return static_cast<uint16_t>(h.heap_begin);
+}
+
+void HeapPage::write(
+    std::size_t slot, uint16_t offset, RecordKind kind, const RecordId& rid, const char* data, std::size_t len)
+{
+    char*       p    = page_ + offset;
+    std::size_t head = 1;
+    p[0]             = static_cast<char>(kind);
+    if (kind != RecordKind::NORMAL)
+    {
+        store<page_no_t>(p + 1, rid.page);
+        store<uint16_t>(p + 1 + sizeof(page_no_t), rid.slot);
+        head += RidSize;
+    }
+    if (len) memcpy(p + head, data, len);
+    store<uint16_t>(slot_ptr(slot), offset);
+    store<uint16_t>(slot_ptr(slot) + 2, static_cast<uint16_t>(head + len));
+}
+
+uint16_t HeapPage::insert(RecordKind kind, const RecordId& rid, const char* data, std::size_t len)
+{
+    HeapPageHeader& h    = header();
+    std::size_t     size = record_size(kind, len);
+    std::size_t     slot = h.slot_count;
+    if (h.free_slots)
+    {
+        for (slot = 0; offset(slot) != 0; ++slot)
+        {
+        }
+        --h.free_slots;
+    }
+    else
+    {
+        // 槽数组增长前先腾出连续空间，否则新槽会覆盖记录区最前面的记录
+        if (h.heap_begin - slots_end() < SlotSize + size) compact();
+        ++h.slot_count;
+        store<uint16_t>(slot_ptr(slot), 0);
+    }
+    write(slot, allocate(size), kind, rid, data, len);
+    return static_cast<uint16_t>(slot);
+}
+
+bool HeapPage::update(std::size_t slot, RecordKind kind, const RecordId& rid, const char* data, std::size_t len)
+{
+    HeapPageHeader& h    = header();
+    std::size_t     size = record_size(kind, len);
+    std::size_t     old  = allocated(slot);
+    if (size <= old)
+    {
+        write(slot, offset(slot), kind, rid, data, len);
+        h.garbage += static_cast<uint32_t>(old - size);
+        return true;
+    }
+    if (h.heap_begin - slots_end() + h.garbage + old < size) return false;
+
+    // 原记录成为空洞，整理时不再保留，槽号不变
+    store<uint16_t>(slot_ptr(slot), 0);
+    h.garbage += static_cast<uint32_t>(old);
+    write(slot, allocate(size), kind, rid, data, len);
+    return true;
+}
+
+void HeapPage::erase(std::size_t slot)
+{
+    HeapPageHeader& h = header();
+    h.garbage += static_cast<uint32_t>(allocated(slot));
+    store<uint16_t>(slot_ptr(slot), 0);
+    ++h.free_slots;
+
+    // 末尾的空槽直接收回
+    while (h.slot_count && offset(h.slot_count - 1) == 0)
+    {
+        --h.slot_count;
+        --h.free_slots;
+    }
+    if (h.slot_count == 0)
+    {
+        h.heap_begin = static_cast<uint32_t>(page_size_);
+        h.garbage    = 0;
+    }
+}
+
+void HeapPage::compact()
+{
+    HeapPageHeader& h = header();
+    if (h.garbage == 0) return;
+
+    // 按槽的顺序把记录复制到临时缓冲区末尾，再整体拷回
+    std::vector<char> buf(page_size_);
+    std::size_t       end = page_size_;
+    for (std::size_t i = 0; i < h.slot_count; ++i)
+    {
+        if (offset(i) == 0) continue;
+        std::size_t size = allocated(i);
+        end -= size;
+        memcpy(buf.data() + end, page_ + offset(i), size);
+        store<uint16_t>(slot_ptr(i), static_cast<uint16_t>(end));
+    }
+    memcpy(page_ + end, buf.data() + end, page_size_ - end);
+    h.heap_begin = static_cast<uint32_t>(end);
+    h.garbage    = 0;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "disk_manager.h"
+
+/*
+ * 堆文件数据页的页面布局（slotted page）。
+ *
+ *   [HeapPageHeader][槽数组，(偏移, 长度) × slot_count，向高地址增长] ... 空闲 ... [记录区，向低地址增长]
+ *
+ * 记录由(页号, 槽号)标识，记录存在期间槽号不变：删除只清空槽（偏移为0），空槽留给之后的插入复用；
+ * 记录区的空洞在空间不足时由compact整理，整理只改变槽中的偏移。每条记录以一个类型字节开头：
+ *   - NORMAL：普通记录，后跟记录内容。
+ *   - FORWARD：转发桩。记录变长后本页放不下时搬到别的页，原位置只留新位置的RecordId。
+ *   - MOVED：被转发的记录，后跟原位置的RecordId与记录内容，顺序扫描时按原位置报告。
+ * 每条记录至少占用一个转发桩的大小，任何记录都能原地改写为转发桩；被转发的记录再次搬动时
+ * 直接修改原位置的转发桩，转发最多一跳。
+ */
+
+/**
+ * @brief 记录标识
+ */
+struct RecordId
+{
+    page_no_t page = InvalidPageNo;  ///< 页号
+    uint16_t  slot = 0;              ///< 槽号
+
+    bool operator==(const RecordId& other) const = default;
+};
+
+/**
+ * @brief 记录类型
+ */
+enum class RecordKind : uint8_t
+{
+    NORMAL,   ///< 普通记录
+    FORWARD,  ///< 转发桩
+    MOVED,    ///< 被转发的记录
+};
+
+/**
+ * @brief 数据页页头
+ */
+struct HeapPageHeader
+{
+    uint64_t lsn;         ///< 最后修改该页的日志序号
+    uint16_t slot_count;  ///< 槽数，包括空槽
+    uint16_t free_slots;  ///< 空槽数
+    uint32_t heap_begin;  ///< 记录区起始偏移
+    uint32_t garbage;     ///< 记录区中已删除记录占用的字节数
+};
+
+/**
+ * @brief 页面上的堆文件数据页视图
+ *
+ * 不拥有页面内存，调用者负责钉住页面并持有相应的页锁。
+ */
+class HeapPage
+{
+  public:
+    static constexpr std::size_t SlotSize = 4;            ///< 每个槽的字节数：偏移与长度各一个uint16_t
+    static constexpr std::size_t RidSize  = 6;            ///< 页内存储的RecordId字节数
+    static constexpr std::size_t StubSize = 1 + RidSize;  ///< 转发桩的字节数，也是每条记录的最小占用
+
+    HeapPage(char* page, std::size_t page_size) : page_(page), page_size_(page_size) {}
+
+    /**
+     * @brief 初始化为空页
+     */
+    void init();
+
+    /**
+     * @brief 记录在记录区中占用的字节数，不含槽
+     *
+     * @param len 记录内容的长度，转发桩为0
+     */
+    static std::size_t record_size(RecordKind kind, std::size_t len)
+    {
+        std::size_t size = 1 + (kind == RecordKind::NORMAL ? 0 : RidSize) + len;
+        return size < StubSize ? StubSize : size;
+    }
+
+    /**
+     * @brief 空页能放下的最长记录
+     */
+    static std::size_t max_record_size(std::size_t page_size)
+    {
+        return page_size - sizeof(HeapPageHeader) - SlotSize - 1 - RidSize;
+    }
+
+    uint16_t slot_count() const { return header().slot_count; }
+
+    /**
+     * @brief 槽中是否有记录
+     */
+    bool used(std::size_t slot) const { return slot < slot_count() && offset(slot) != 0; }
+
+    RecordKind kind(std::size_t slot) const { return static_cast<RecordKind>(page_[offset(slot)]); }
+
+    /**
+     * @brief 转发桩指向的新位置，或被转发记录的原位置
+     */
+    RecordId rid(std::size_t slot) const;
+
+    /**
+     * @brief 记录内容，转发桩没有内容
+     */
+    const char* data(std::size_t slot) const
+    {
+        return page_ + offset(slot) + 1 + (kind(slot) == RecordKind::NORMAL ? 0 : RidSize);
+    }
+    std::size_t length(std::size_t slot) const
+    {
+        return stored(slot) - 1 - (kind(slot) == RecordKind::NORMAL ? 0 : RidSize);
+    }
+
+    /**
+     * @brief 能再插入的最大记录占用字节数，已计入新槽
+     */
+    std::size_t free_space() const;
+
+    /**
+     * @brief 能否插入一条记录
+     */
+    bool fits(RecordKind kind, std::size_t len) const { return record_size(kind, len) <= free_space(); }
+
+    /**
+     * @brief 插入记录，优先复用空槽，调用者须先用fits确认空间足够
+     *
+     * @param rid 转发桩与被转发记录的RecordId，普通记录忽略
+     * @return 槽号
+     */
+    uint16_t insert(RecordKind kind, const RecordId& rid, const char* data, std::size_t len);
+
+    /**
+     * @brief 改写槽中的记录，槽号不变
+     *
+     * @return 本页放不下时返回false，页面不变
+     */
+    bool update(std::size_t slot, RecordKind kind, const RecordId& rid, const char* data, std::size_t len);
+
+    /**
+     * @brief 删除槽中的记录
+     */
+    void erase(std::size_t slot);
+
+    /**
+     * @brief 整理记录区，消除删除留下的空洞
+     */
+    void compact();
+
+  private:
+    template <class T>
+    static T load(const char* p)
+    {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    template <class T>
+    static void store(char* p, T value)
+    {
+        memcpy(p, &value, sizeof(T));
+    }
+
+    HeapPageHeader&       header() { return *reinterpret_cast<HeapPageHeader*>(page_); }
+    const HeapPageHeader& header() const { return *reinterpret_cast<const HeapPageHeader*>(page_); }
+    std::size_t           slots_end() const { return sizeof(HeapPageHeader) + header().slot_count * SlotSize; }
+    char*                 slot_ptr(std::size_t slot) { return page_ + sizeof(HeapPageHeader) + slot * SlotSize; }
+    const char*           slot_ptr(std::size_t slot) const { return page_ + sizeof(HeapPageHeader) + slot * SlotSize; }
+    uint16_t              offset(std::size_t slot) const { return load<uint16_t>(slot_ptr(slot)); }
+    uint16_t              stored(std::size_t slot) const { return load<uint16_t>(slot_ptr(slot) + 2); }
+
+    /**
+     * @brief 槽中记录在记录区中占用的字节数
+     */
+    std::size_t allocated(std::size_t slot) const { return stored(slot) < StubSize ? StubSize : stored(slot); }
+
+    /**
+     * @brief 从记录区分配size字节，连续空间不足时先整理
+     */
+    uint16_t allocate(std::size_t size);
+
+    /**
+     * @brief 在offset处写入记录并登记到槽
+     */
+    void write(std::size_t slot, uint16_t offset, RecordKind kind, const RecordId& rid, const char* data,
+        std::size_t len);
+
+    char*       page_;       ///< 页面内存
+    std::size_t page_size_;  ///< 页大小
+};
@@ -0,0 +1,682 @@
+#include "log_manager.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <nmmintrin.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include "Thread/ThreadPool.h"
+#include "ret.h"
+
+static constexpr char        ControlMagic[8] = {'M', 'I', 'N', 'I', 'W', 'A', 'L', 'C'};
+static constexpr std::size_t ReadChunk       = 1 << 20;  ///< 读取日志时每次读入的字节数
+static constexpr int         PublishSpins    = 64;       ///< 发布时等待前面的记录的自旋次数，之后让出CPU
+
+/**
+ * @brief 控制文件内容
+ */
+struct LogControl
+{
+    char     magic[8];      ///< 魔数
+    uint64_t segment_size;  ///< 段文件大小
+    lsn_t    begin;         ///< 日志起点
+    lsn_t    checkpoint;    ///< 最近一次检查点的起始偏移
+    uint32_t checksum;      ///< 以上字段的CRC32C
+    uint32_t reserved;      ///< 保留
+};
+
+/**
+ * @brief 按字节查表的CRC32C（Castagnoli多项式）
+ */
+static uint32_t crc32c_table(uint32_t crc, const char* data, std::size_t len)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    for (std::size_t i = 0; i < len; ++i) crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+/**
+ * @brief 用SSE4.2的crc32指令计算CRC32C，每次8字节
+ */
+__attribute__((target("sse4.2"))) static uint32_t crc32c_sse42(uint32_t crc, const char* data, std::size_t len)
+{
+    uint64_t c = crc;
+    for (; len >= 8; data += 8, len -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        c = _mm_crc32_u64(c, word);
+    }
+    crc = static_cast<uint32_t>(c);
+    for (; len > 0; ++data, --len) crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+    return crc;
+}
+
+static uint32_t crc32c(uint32_t crc, const void* data, std::size_t len)
+{
+    static const bool sse42 = __builtin_cpu_supports("sse4.2");
+    const char*       p     = static_cast<const char*>(data);
+    return sse42 ? crc32c_sse42(crc, p, len) : crc32c_table(crc, p, len);
+}
+
+/**
+ * @brief 记录头中size与lsn字段加上记录内容的校验和
+ */
+static uint32_t record_checksum(const LogRecordHeader& header, const char* data, std::size_t len)
+{
+    uint32_t crc = crc32c(~0u, &header.size, sizeof(header.size));
+    crc          = crc32c(crc, &header.lsn, sizeof(header.lsn));
+    return ~crc32c(crc, data, len);
+}
+
+static uint32_t control_checksum(const LogControl& control)
+{
+    return ~crc32c(~0u, &control, offsetof(LogControl, checksum));
+}
+
+static std::size_t align_up(std::size_t n) { return (n + LogManager::Alignment - 1) & ~(LogManager::Alignment - 1); }
+
+/**
+ * @brief 读满len字节，遇到文件末尾时补0
+ */
+static bool read_full(int fd, char* buf, std::size_t len, off_t offset)
+{
+    while (len > 0)
+    {
+        ssize_t n = pread(fd, buf, len, offset);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0)
+        {
+            memset(buf, 0, len);
+            return true;
+        }
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+/**
+ * @brief 写满len字节
+ */
+static bool write_full(int fd, const char* buf, std::size_t len, off_t offset)
+{
+    while (len > 0)
+    {
+        ssize_t n = pwrite(fd, buf, len, offset);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+static bool sync_fd(int fd)
+{
+    int ret;
+    while ((ret = fdatasync(fd)) < 0 && errno == EINTR)
+    {
+    }
+    return ret == 0;
+}
+
+/**
+ * @brief 落盘目录，使其中新建与改名的文件持久化
+ */
+static bool sync_dir(const std::string& dir)
+{
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief 原子地写入控制文件：写临时文件并落盘后改名，再落盘目录
+ */
+static bool write_control(const std::string& dir, LogControl control)
+{
+    memcpy(control.magic, ControlMagic, sizeof(ControlMagic));
+    control.checksum = control_checksum(control);
+    std::string tmp  = dir + "/control.tmp";
+    int         fd   = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = write_full(fd, reinterpret_cast<const char*>(&control), sizeof(control), 0) && sync_fd(fd);
+    close(fd);
+    return ok && rename(tmp.c_str(), (dir + "/control").c_str()) == 0 && sync_dir(dir);
+}
+
+static std::string segment_file(const std::string& dir, uint64_t segment)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.log", static_cast<unsigned long long>(segment));
+    return dir + name;
+}
+
+LogReader::LogReader(
+    const std::string& dir, std::size_t segment_size, std::size_t max_size, lsn_t floor, lsn_t from, lsn_t limit)
+    : dir_(dir), segment_size_(segment_size), max_size_(max_size), floor_(floor), limit_(limit), pos_(from)
+{
+}
+
+bool LogReader::load(lsn_t pos, std::size_t len, RC& rc)
+{
+    rc = RC::SUCCESS;
+    if (pos + len > limit_) return false;
+    if (pos >= buf_begin_ && pos + len <= buf_begin_ + buf_.size()) return true;
+
+    // 从pos开始读入至少len字节，逐个段文件读取；向前跳转时从pos之前半个读取块开始，
+    // 接下来再往前的记录多半也在读入的范围内
+    lsn_t start = pos;
+    if (pos < buf_begin_ && pos >= floor_ && len <= ReadChunk / 2)
+        start = std::max(floor_, pos > ReadChunk / 2 ? pos - ReadChunk / 2 : 0);
+    len              = static_cast<std::size_t>(pos + len - start);
+    pos              = start;
+    std::size_t want = std::max(len, ReadChunk);
+    if (limit_ - pos < want) want = static_cast<std::size_t>(limit_ - pos);
+    buf_.resize(want);
+    buf_begin_       = pos;
+    std::size_t done = 0;
+    while (done < want)
+    {
+        lsn_t       at      = pos + done;
+        uint64_t    segment = at / segment_size_;
+        std::size_t offset  = at % segment_size_;
+        std::size_t n       = std::min(want - done, segment_size_ - offset);
+        int         fd      = open(segment_file(dir_, segment).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != ENOENT) rc = RC::IO_ERROR;
+            break;
+        }
+        bool ok = read_full(fd, buf_.data() + done, n, static_cast<off_t>(offset));
+        close(fd);
+        if (!ok)
+        {
+            rc = RC::IO_ERROR;
+            break;
+        }
+        done += n;
+    }
+    buf_.resize(done);
+    return done >= len;
+}
+
+void LogReader::parse(RC& rc)
+{
+    valid_ = false;
+    LogRecordHeader header;
+    if (!load(pos_, sizeof(header), rc)) return;
+    memcpy(&header, buf_.data() + (pos_ - buf_begin_), sizeof(header));
+    if (header.size < sizeof(header) || header.size > max_size_) return;
+    if (header.lsn != pos_ + align_up(header.size)) return;
+    if (!load(pos_, header.size, rc)) return;
+
+    const char* data = buf_.data() + (pos_ - buf_begin_) + sizeof(header);
+    std::size_t len  = header.size - sizeof(header);
+    if (record_checksum(header, data, len) != header.checksum) return;
+    lsn_    = header.lsn;
+    length_ = len;
+    valid_  = true;
+}
+
+void LogReader::next(RC& rc)
+{
+    pos_ = lsn_;
+    parse(rc);
+}
+
+void LogReader::seek(lsn_t from, RC& rc)
+{
+    pos_ = from;
+    parse(rc);
+}
+
+LogManager::LogManager(const std::string& dir, std::size_t segment_size, std::size_t buffer_size,
+    std::chrono::microseconds commit_delay, RC& rc)
+    : dir_(dir),
+      segment_size_(segment_size),
+      buffer_size_(align_up(buffer_size)),
+      commit_delay_(commit_delay),
+      requested_(0),
+      flusher_stop_(false)
+{
+    if (segment_size == 0 || segment_size % 4096 != 0 || buffer_size_ < 4096)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    if (ec)
+    {
+        rc = RC::IO_ERROR;
+        return;
+    }
+
+    // 控制文件记录段文件大小、日志起点与检查点，新日志先落盘控制文件
+    LogControl control{};
+    int        fd = open((dir_ + "/control").c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0 && errno == ENOENT)
+    {
+        control.segment_size = segment_size_;
+        control.begin        = Alignment;
+        rc                   = write_control(dir_, control) ? RC::SUCCESS : RC::IO_ERROR;
+    }
+    else if (fd < 0 || !read_full(fd, reinterpret_cast<char*>(&control), sizeof(control), 0))
+        rc = RC::IO_ERROR;
+    else if (memcmp(control.magic, ControlMagic, sizeof(ControlMagic)) != 0 ||
+             control.checksum != control_checksum(control) || control.segment_size != segment_size_)
+        rc = RC::INVALID_ARGUMENT;
+    else
+        rc = RC::SUCCESS;
+    if (fd >= 0) close(fd);
+    if (FAIL(rc)) return;
+    begin_.store(control.begin, std::memory_order_relaxed);
+    checkpoint_.store(control.checkpoint, std::memory_order_relaxed);
+
+    // 找到日志末尾
+    LogReader reader(dir_, segment_size_, buffer_size_, control.begin, control.begin, UINT64_MAX);
+    lsn_t     end = control.begin;
+    for (reader.parse(rc); SUCC(rc) && reader.valid(); reader.next(rc)) end = reader.lsn();
+    if (FAIL(rc)) return;
+
+    // 末尾之后最多一个缓冲区的内容可能是崩溃前未完整写入的一轮，清零后落盘
+    std::vector<char> zeros(std::min<std::size_t>(buffer_size_, segment_size_));
+    for (lsn_t at = end; at < end + buffer_size_;)
+    {
+        uint64_t    segment = at / segment_size_;
+        std::size_t offset  = at % segment_size_;
+        std::size_t n       = std::min<std::size_t>(end + buffer_size_ - at, segment_size_ - offset);
+        int         sfd     = open(segment_path(segment).c_str(), O_WRONLY | O_CLOEXEC);
+        if (sfd >= 0)
+        {
+            bool ok = write_full(sfd, zeros.data(), n, static_cast<off_t>(offset)) && sync_fd(sfd);
+            close(sfd);
+            if (!ok)
+            {
+                rc = RC::IO_ERROR;
+                return;
+            }
+        }
+        else if (errno != ENOENT)
+        {
+            rc = RC::IO_ERROR;
+            return;
+        }
+        at += n;
+    }
+
+    buffer_.reset(new char[buffer_size_]);
+    reserved_.store(end, std::memory_order_relaxed);
+    filled_.store(end, std::memory_order_relaxed);
+    written_.store(end, std::memory_order_relaxed);
+    durable_.store(end, std::memory_order_relaxed);
+    rc = RC::SUCCESS;
+}
+
+LogManager::~LogManager()
+{
+    stop_flusher();
+    RC rc;
+    if (buffer_) write_out(filled_.load(std::memory_order_acquire), true, rc);
+    for (auto& [segment, fd] : segments_) close(fd);
+}
+
+std::string LogManager::segment_path(uint64_t segment) const { return segment_file(dir_, segment); }
+
+int LogManager::segment_fd(uint64_t segment, RC& rc)
+{
+    rc      = RC::SUCCESS;
+    auto it = segments_.find(segment);
+    if (it != segments_.end()) return it->second;
+
+    std::string path = segment_path(segment);
+    int         fd   = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+        if (fd >= 0) close(fd);
+        rc = RC::IO_ERROR;
+        return -1;
+    }
+    if (static_cast<std::size_t>(st.st_size) < segment_size_)
+    {
+        // 新段文件：一次预留全部空间，再落盘目录使文件本身持久化
+        int ret;
+        while ((ret = fallocate(fd, 0, 0, static_cast<off_t>(segment_size_))) < 0 && errno == EINTR)
+        {
+        }
+        if (ret < 0 && (errno == EOPNOTSUPP || errno == ENOSYS)) ret = ftruncate(fd, static_cast<off_t>(segment_size_));
+        if (ret < 0 || !sync_fd(fd) || !sync_dir(dir_))
+        {
+            close(fd);
+            rc = RC::IO_ERROR;
+            return -1;
+        }
+    }
+    segments_.emplace(segment, fd);
+    return fd;
+}
+
+void LogManager::write_stream(lsn_t from, const char* data, std::size_t len, RC& rc)
+{
+    rc = RC::SUCCESS;
+    while (len > 0)
+    {
+        uint64_t    segment = from / segment_size_;
+        std::size_t offset  = from % segment_size_;
+        std::size_t n       = std::min(len, segment_size_ - offset);
+        int         fd      = segment_fd(segment, rc);
+        if (FAIL(rc)) return;
+        if (!write_full(fd, data, n, static_cast<off_t>(offset)))
+        {
+            rc = RC::IO_ERROR;
+            return;
+        }
+        from += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void LogManager::write_out(lsn_t target, bool sync, RC& rc)
+{
+    rc = RC::SUCCESS;
+    {
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        if (failed_)
+        {
+            rc = RC::IO_ERROR;
+            return;
+        }
+
+        // 缓冲区是环形的，跨越缓冲区末尾时分两次写
+        lsn_t from = written_.load(std::memory_order_relaxed);
+        if (target > from)
+        {
+            while (SUCC(rc) && from < target)
+            {
+                std::size_t index = from % buffer_size_;
+                std::size_t n     = std::min<std::size_t>(target - from, buffer_size_ - index);
+                write_stream(from, buffer_.get() + index, n, rc);
+                from += n;
+            }
+            writes_.fetch_add(1, std::memory_order_relaxed);
+            if (SUCC(rc)) written_.store(target, std::memory_order_release);
+        }
+
+        lsn_t written = written_.load(std::memory_order_relaxed);
+        if (SUCC(rc) && sync && durable_.load(std::memory_order_relaxed) < written)
+        {
+            // 打开的段文件都含有未落盘的内容，落盘后关闭已写满的段
+            for (auto& [segment, fd] : segments_)
+                if (!sync_fd(fd)) rc = RC::IO_ERROR;
+            syncs_.fetch_add(1, std::memory_order_relaxed);
+            if (SUCC(rc))
+            {
+                durable_.store(written, std::memory_order_release);
+                for (auto it = segments_.begin(); it != segments_.end() && (it->first + 1) * segment_size_ <= written;)
+                {
+                    close(it->second);
+                    it = segments_.erase(it);
+                }
+            }
+        }
+        if (FAIL(rc)) failed_ = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    done_cv_.notify_all();
+}
+
+void LogManager::wake_flusher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    flusher_cv_.notify_one();
+}
+
+lsn_t LogManager::append(const char* data, std::size_t len, RC& rc)
+{
+    std::size_t size   = sizeof(LogRecordHeader) + len;
+    std::size_t padded = align_up(size);
+    if (padded > buffer_size_ || size > UINT32_MAX)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return InvalidLsn;
+    }
+
+    // 预留：一次fetch_add，追加的线程之间没有锁。预留按顺序同步，预留之前的写入（如缓冲池登记的脏页位置）
+    // 对之后预留的线程（如检查点）可见
+    lsn_t start = reserved_.fetch_add(padded, std::memory_order_acq_rel);
+    lsn_t end   = start + padded;
+    rc          = RC::SUCCESS;
+
+    // 缓冲区中这段空间上一轮的内容还没有写出时等待刷写
+    if (end - written_.load(std::memory_order_acquire) > buffer_size_)
+    {
+        buffer_full_.fetch_add(1, std::memory_order_relaxed);
+        while (SUCC(rc) && end - written_.load(std::memory_order_acquire) > buffer_size_)
+        {
+            if (flusher_running_.load(std::memory_order_acquire))
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_wanted_.store(true, std::memory_order_relaxed);
+                flusher_cv_.notify_one();
+                done_cv_.wait(lock, [&] {
+                    return failed_ || !flusher_running_.load(std::memory_order_relaxed) ||
+                           end - written_.load(std::memory_order_acquire) <= buffer_size_;
+                });
+                if (failed_) rc = RC::IO_ERROR;
+            }
+            else
+            {
+                // 没有刷写任务时自己写出，排在前面的记录还在复制时让出CPU
+                write_out(filled_.load(std::memory_order_acquire), false, rc);
+                if (end - written_.load(std::memory_order_acquire) > buffer_size_) std::this_thread::yield();
+            }
+        }
+    }
+
+    // 复制：失败时空间不能复用，只发布不复制，之后的写出都会失败
+    if (SUCC(rc))
+    {
+        LogRecordHeader header{static_cast<uint32_t>(size), 0, end};
+        header.checksum         = record_checksum(header, data, len);
+        static const char zeros[Alignment]{};
+        auto              copy  = [this](lsn_t at, const char* src, std::size_t n) {
+            std::size_t index = at % buffer_size_;
+            std::size_t first = std::min(n, buffer_size_ - index);
+            memcpy(buffer_.get() + index, src, first);
+            memcpy(buffer_.get(), src + first, n - first);
+        };
+        copy(start, reinterpret_cast<const char*>(&header), sizeof(header));
+        copy(start + sizeof(header), data, len);
+        copy(start + size, zeros, padded - size);
+    }
+
+    // 发布：按预留顺序推进filled_，只等待排在前面仍在复制的记录
+    for (int spins = 0; filled_.load(std::memory_order_acquire) != start; ++spins)
+        if (spins >= PublishSpins) std::this_thread::yield();
+    filled_.store(end, std::memory_order_release);
+    records_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(padded, std::memory_order_relaxed);
+    if (FAIL(rc)) return InvalidLsn;
+
+    // 未写出的部分超过缓冲区一半时提前唤醒刷写任务，追加的线程尽量不必等待空间
+    if (flusher_running_.load(std::memory_order_relaxed) &&
+        end - written_.load(std::memory_order_relaxed) > buffer_size_ / 2 &&
+        !space_wanted_.load(std::memory_order_relaxed) && !space_wanted_.exchange(true))
+        wake_flusher();
+    return end;
+}
+
+void LogManager::flush(lsn_t lsn, RC& rc)
+{
+    rc = RC::SUCCESS;
+    if (lsn > filled_.load(std::memory_order_acquire))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    if (durable_.load(std::memory_order_acquire) >= lsn) return;
+    commits_.fetch_add(1, std::memory_order_relaxed);
+
+    if (flusher_running_.load(std::memory_order_acquire))
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (requested_ < lsn)
+        {
+            requested_ = lsn;
+            flusher_cv_.notify_one();
+        }
+        auto blocking = ThreadPool::ManagedBlock();
+        done_cv_.wait(lock, [&] {
+            return failed_ || !flusher_running_.load(std::memory_order_relaxed) ||
+                   durable_.load(std::memory_order_acquire) >= lsn;
+        });
+        if (durable_.load(std::memory_order_acquire) >= lsn) return;
+        if (failed_)
+        {
+            rc = RC::IO_ERROR;
+            return;
+        }
+    }
+
+    // 没有刷写任务：第一个拿到io_mutex_的线程写出全部已发布的记录，其余线程随之完成
+    auto blocking = ThreadPool::ManagedBlock();
+    while (SUCC(rc) && durable_.load(std::memory_order_acquire) < lsn)
+        write_out(filled_.load(std::memory_order_acquire), true, rc);
+}
+
+LogReader LogManager::read(lsn_t from, RC& rc) const
+{
+    LogReader reader(dir_, segment_size_, buffer_size_, begin_lsn(), from, durable_.load(std::memory_order_acquire));
+    reader.parse(rc);
+    return reader;
+}
+
+void LogManager::set_checkpoint(lsn_t checkpoint, lsn_t begin, RC& rc)
+{
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    lsn_t                       old = begin_lsn();
+    if (begin < old || begin > checkpoint || checkpoint >= durable_.load(std::memory_order_acquire))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    LogControl control{};
+    control.segment_size = segment_size_;
+    control.begin        = begin;
+    control.checkpoint   = checkpoint;
+    if (!write_control(dir_, control))
+    {
+        rc = RC::IO_ERROR;
+        return;
+    }
+    begin_.store(begin, std::memory_order_release);
+    checkpoint_.store(checkpoint, std::memory_order_release);
+
+    // 整段位于新起点之前的段文件都已落盘并关闭，删除失败不影响正确性
+    for (uint64_t segment = old / segment_size_; segment < begin / segment_size_; ++segment)
+        unlink(segment_path(segment).c_str());
+    rc = RC::SUCCESS;
+}
+
+void LogManager::flusher_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        {
+            auto blocking = ThreadPool::ManagedBlock();
+            flusher_cv_.wait(lock, [this] {
+                return flusher_stop_ ||
+                       (!failed_ && (requested_ > durable_.load(std::memory_order_acquire) ||
+                                        space_wanted_.load(std::memory_order_relaxed)));
+            });
+        }
+        if (flusher_stop_) break;
+
+        // 组提交：有提交在等待时可以再等commit_delay_，让更多提交赶上这一轮
+        bool commit = requested_ > durable_.load(std::memory_order_acquire);
+        if (commit && commit_delay_.count() > 0 && !space_wanted_.load(std::memory_order_relaxed))
+        {
+            auto blocking = ThreadPool::ManagedBlock();
+            flusher_cv_.wait_for(lock, commit_delay_,
+                [this] { return flusher_stop_ || space_wanted_.load(std::memory_order_relaxed); });
+        }
+        space_wanted_.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        RC rc;
+        write_out(filled_.load(std::memory_order_acquire), commit, rc);
+        lock.lock();
+    }
+    flusher_running_.store(false, std::memory_order_release);
+    lock.unlock();
+    done_cv_.notify_all();
+}
+
+void LogManager::start_flusher(ThreadPool& pool)
+{
+    stop_flusher();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flusher_stop_ = false;
+        flusher_running_.store(true, std::memory_order_release);
+    }
+    flusher_ = pool.EnQueue([this] { flusher_loop(); });
+}
+
+void LogManager::stop_flusher()
+{
+    if (!flusher_.valid()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flusher_stop_ = true;
+    }
+    flusher_cv_.notify_all();
+    flusher_.get();
+    RC rc;
+    write_out(filled_.load(std::memory_order_acquire), true, rc);
+}
+
+LogStats LogManager::stats() const
+{
+    LogStats stats;
+    stats.records     = records_.load(std::memory_order_relaxed);
+    stats.bytes       = bytes_.load(std::memory_order_relaxed);
+    stats.writes      = writes_.load(std::memory_order_relaxed);
+    stats.syncs       = syncs_.load(std::memory_order_relaxed);
+    stats.commits     = commits_.load(std::memory_order_relaxed);
+    stats.buffer_full = buffer_full_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class RC;
+class ThreadPool;
+
+/*
+ * 预写日志（write-ahead log）。
+ *
+ * 日志是一个只追加的字节流，按固定大小切分为段文件<log_dir>/<段号，16位十六进制>.log，段文件创建时
+ * 一次预留全部空间。每条记录带记录头，按8字节对齐存放，日志序号（LSN）是记录末尾在字节流中的偏移：
+ * 序号不大于已落盘序号的记录都已持久化，页面上记录的LSN不大于已落盘序号时页面可以写回，0为无效序号。
+ *
+ * 追加分三步：用一次fetch_add在日志缓冲区（环形）中预留空间，各线程并行把记录复制进缓冲区，
+ * 再按预留的顺序发布，发布只等待排在前面、仍在复制的记录。缓冲区中已发布的部分由刷写任务写入段文件。
+ *
+ * 组提交：提交的事务调用flush等待自己的记录落盘。刷写任务每轮把全部已发布的记录写入段文件后只调用
+ * 一次fdatasync，同一轮等待的提交一起完成；一轮fdatasync期间到达的提交在下一轮一起落盘。
+ * commit_delay大于0时刷写任务被唤醒后再等这么久，让更多提交赶上同一轮。没有启动刷写任务时
+ * 由调用flush的线程自己写入并落盘，同时等待的线程中只有一个执行，其余随之完成。
+ *
+ * 打开时从控制文件记录的起点顺序读取，第一条不完整或校验失败的记录处即为日志末尾，其后的残留内容
+ * （崩溃前未完整写入的一轮）被清零，避免之后追加的记录与残留的旧记录接续。
+ *
+ * 新日志从偏移Alignment开始，任何记录的起始偏移都不为0，0可以表示“没有上一条记录”。
+ * 控制文件另记录最近一次完成的检查点，更新检查点时截断日志起点，删除之前的段文件。
+ */
+
+using lsn_t = uint64_t;  ///< 日志序号
+
+constexpr lsn_t InvalidLsn = 0;  ///< 无效日志序号
+
+/**
+ * @brief 日志记录头
+ */
+struct LogRecordHeader
+{
+    uint32_t size;      ///< 记录字节数，含记录头，不含对齐填充
+    uint32_t checksum;  ///< 记录头其余字段与记录内容的CRC32C
+    lsn_t    lsn;       ///< 记录的日志序号，读取时据此识别错位与残留的记录
+};
+
+/**
+ * @brief 日志统计快照
+ */
+struct LogStats
+{
+    uint64_t records;      ///< 追加的记录数
+    uint64_t bytes;        ///< 追加的字节数，含记录头与对齐填充
+    uint64_t writes;       ///< 写入段文件的次数
+    uint64_t syncs;        ///< fdatasync次数
+    uint64_t commits;      ///< 调用flush等待落盘的次数
+    uint64_t buffer_full;  ///< 追加时等待缓冲区空间的次数
+};
+
+class LogManager;
+
+/**
+ * @brief 顺序读取日志记录
+ *
+ * 读到已落盘的末尾、或第一条不完整或校验失败的记录时结束。不可复制。
+ */
+class LogReader
+{
+    friend LogManager;
+
+  public:
+    LogReader(const LogReader&)            = delete;
+    LogReader& operator=(const LogReader&) = delete;
+    LogReader(LogReader&&)                 = default;
+
+    bool valid() const { return valid_; }
+
+    /**
+     * @brief 当前记录的日志序号
+     */
+    lsn_t lsn() const { return lsn_; }
+
+    /**
+     * @brief 当前记录的起始偏移，即上一条记录的日志序号
+     */
+    lsn_t begin() const { return pos_; }
+
+    const char* data() const { return buf_.data() + (pos_ - buf_begin_) + sizeof(LogRecordHeader); }
+    std::size_t length() const { return length_; }
+
+    /**
+     * @brief 移到下一条记录
+     *
+     * @param rc 读文件失败时为RC::IO_ERROR
+     */
+    void next(RC& rc);
+
+    /**
+     * @brief 移到起始偏移为from的记录
+     *
+     * from可以在当前记录之前，向前跳转时读入from前后的一段，沿事务的记录链逐条回溯不必每次重新读文件。
+     */
+    void seek(lsn_t from, RC& rc);
+
+  private:
+    LogReader(const std::string& dir, std::size_t segment_size, std::size_t max_size, lsn_t floor, lsn_t from,
+        lsn_t limit);
+
+    /**
+     * @brief 把[pos, pos + len)读入缓冲区，文件不存在或越过limit_时返回false
+     */
+    bool load(lsn_t pos, std::size_t len, RC& rc);
+
+    /**
+     * @brief 解析pos_处的记录
+     */
+    void parse(RC& rc);
+
+    std::string       dir_;                ///< 日志目录
+    std::size_t       segment_size_;       ///< 段文件大小
+    std::size_t       max_size_;           ///< 记录字节数上限，超过时视为损坏
+    lsn_t             floor_;              ///< 读取的下界，即日志起点
+    lsn_t             limit_;              ///< 读取的上界
+    std::vector<char> buf_;                ///< 读入的日志片段
+    lsn_t             buf_begin_ = 0;      ///< buf_首字节在字节流中的偏移
+    lsn_t             pos_       = 0;      ///< 当前记录的起始偏移
+    lsn_t             lsn_       = 0;      ///< 当前记录的日志序号
+    std::size_t       length_    = 0;      ///< 当前记录内容的长度
+    bool              valid_     = false;  ///< 是否指向一条记录
+};
+
+/**
+ * @brief 日志管理器
+ *
+ * 线程安全。
+ */
+class LogManager
+{
+  public:
+    static constexpr std::size_t Alignment = 8;  ///< 记录的对齐字节数
+
+    /**
+     * @brief 打开日志目录中的日志，不存在时创建
+     *
+     * @param dir 日志目录，不存在时创建
+     * @param segment_size 段文件大小，须为4096的倍数，
+     *                     打开已有的日志时须与创建时一致
+     * @param buffer_size 日志缓冲区大小，单条记录不能超过它
+     * @param commit_delay 刷写任务被提交唤醒后的等待时间，0为不等待
+     * @param rc 参数不合法或控制文件损坏时为RC::INVALID_ARGUMENT，系统调用失败时为RC::IO_ERROR
+     */
+    LogManager(const std::string& dir, std::size_t segment_size, std::size_t buffer_size,
+        std::chrono::microseconds commit_delay, RC& rc);
+
+    /**
+     * @brief 析构函数
+     *
+     * 停止刷写任务，把已追加的记录写入段文件并落盘。
+     */
+    ~LogManager();
+
+    LogManager(const LogManager&)            = delete;
+    LogManager& operator=(const LogManager&) = delete;
+
+    /**
+     * @brief 追加一条记录
+     *
+     * 返回时记录已在日志缓冲区中，尚未落盘。缓冲区满时等待刷写。
+     *
+     * @param rc 记录超过缓冲区大小时为RC::INVALID_ARGUMENT，写文件失败时为RC::IO_ERROR
+     * @return 记录的日志序号
+     */
+    lsn_t append(const char* data, std::size_t len, RC& rc);
+
+    /**
+     * @brief len字节的记录在日志中占用的字节数，含记录头与对齐填充
+     *
+     * append返回的日志序号减去它即为记录的起始偏移。
+     */
+    static std::size_t footprint(std::size_t len)
+    {
+        return (sizeof(LogRecordHeader) + len + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    /**
+     * @brief 等待日志序号不大于lsn的记录全部落盘
+     *
+     * @param rc 写文件或落盘失败时为RC::IO_ERROR，之后的调用都会失败
+     */
+    void flush(lsn_t lsn, RC& rc);
+
+    /**
+     * @brief 已落盘的日志序号
+     */
+    lsn_t durable_lsn() const { return durable_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 已发布的日志末尾，之后追加的记录的日志序号都大于它
+     */
+    lsn_t end_lsn() const { return filled_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 日志的起点，控制文件记录的第一条记录的起始偏移
+     */
+    lsn_t begin_lsn() const { return begin_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 控制文件记录的最近一次检查点的起始偏移，没有检查点时为InvalidLsn
+     */
+    lsn_t checkpoint_lsn() const { return checkpoint_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 记录一次完成的检查点并截断日志
+     *
+     * 原子地改写控制文件（写临时文件、落盘、改名、落盘目录），再删除整段位于begin之前的段文件。
+     *
+     * @param checkpoint 检查点开始记录的起始偏移，须已落盘
+     * @param begin 新的日志起点，须为一条记录的起始偏移，不大于checkpoint且不小于当前起点
+     * @param rc 参数不满足上述条件时为RC::INVALID_ARGUMENT，写控制文件失败时为RC::IO_ERROR
+     */
+    void set_checkpoint(lsn_t checkpoint, lsn_t begin, RC& rc);
+
+    /**
+     * @brief 从偏移from开始顺序读取已落盘的记录
+     *
+     * @param from 一条记录的起始偏移，如begin_lsn()或某条记录的日志序号
+     */
+    LogReader read(lsn_t from, RC& rc) const;
+
+    /**
+     * @brief 在线程池中启动刷写任务
+     *
+     * 刷写任务等待提交时登记为阻塞，线程池会补充线程。
+     */
+    void start_flusher(ThreadPool& pool);
+
+    /**
+     * @brief 停止刷写任务并等待其退出，退出前写入并落盘已追加的记录
+     */
+    void stop_flusher();
+
+    std::size_t segment_size() const { return segment_size_; }
+    std::size_t buffer_size() const { return buffer_size_; }
+
+    LogStats stats() const;
+
+  private:
+    /**
+     * @brief 段文件路径
+     */
+    std::string segment_path(uint64_t segment) const;
+
+    /**
+     * @brief 打开段文件，不存在时创建并预留空间，调用者持有io_mutex_
+     */
+    int segment_fd(uint64_t segment, RC& rc);
+
+    /**
+     * @brief 把[from, from + len)写入段文件，跨越段边界时分段写入，调用者持有io_mutex_
+     */
+    void write_stream(lsn_t from, const char* data, std::size_t len, RC& rc);
+
+    /**
+     * @brief 把缓冲区中到target为止的记录写入段文件，sync为true时再落盘
+     *
+     * 调用者不能持有mutex_。
+     */
+    void write_out(lsn_t target, bool sync, RC& rc);
+
+    /**
+     * @brief 唤醒刷写任务写出缓冲区
+     */
+    void wake_flusher();
+
+    void flusher_loop();
+
+    std::string               dir_;                     ///< 日志目录
+    std::size_t               segment_size_;            ///< 段文件大小
+    std::size_t               buffer_size_;             ///< 日志缓冲区大小
+    std::chrono::microseconds commit_delay_;            ///< 组提交等待时间
+    std::atomic<lsn_t>        begin_{0};                ///< 日志起点
+    std::atomic<lsn_t>        checkpoint_{0};           ///< 最近一次检查点
+    std::mutex                control_mutex_;           ///< 串行化改写控制文件
+    std::unique_ptr<char[]>   buffer_;                  ///< 环形日志缓冲区
+    std::atomic<lsn_t>        reserved_{0};             ///< 已预留的末尾
+    std::atomic<lsn_t>        filled_{0};               ///< 已发布的末尾，之前的记录都已复制进缓冲区
+    std::atomic<lsn_t>        written_{0};              ///< 已写入段文件的末尾，之前的缓冲区空间可以复用
+    std::atomic<lsn_t>        durable_{0};              ///< 已落盘的末尾
+    std::mutex                io_mutex_;                ///< 串行化写段文件与落盘，保护segments_
+    std::map<uint64_t, int>   segments_;                ///< 打开的段文件，段号到文件描述符
+    std::mutex                mutex_;                   ///< 保护以下刷写任务状态，配合条件变量
+    std::condition_variable   flusher_cv_;              ///< 唤醒刷写任务
+    std::condition_variable   done_cv_;                 ///< 一轮写出完成，唤醒等待落盘与缓冲区空间的线程
+    lsn_t                     requested_;               ///< 提交等待落盘的最大日志序号
+    bool                      flusher_stop_;            ///< 通知刷写任务退出
+    std::atomic<bool>         failed_{false};           ///< 写文件或落盘失败过
+    std::atomic<bool>         space_wanted_{false};     ///< 有线程等待缓冲区空间或缓冲区已过半
+    std::atomic<bool>         flusher_running_{false};  ///< 刷写任务是否在运行
+    std::future<void>         flusher_;                 ///< 刷写任务
+    std::atomic<uint64_t>     records_{0};              ///< 追加的记录数
+    std::atomic<uint64_t>     bytes_{0};                ///< 追加的字节数
+    std::atomic<uint64_t>     writes_{0};               ///< 写入次数
+    std::atomic<uint64_t>     syncs_{0};                ///< 落盘次数
+    std::atomic<uint64_t>     commits_{0};              ///< 等待落盘次数
+    std::atomic<uint64_t>     buffer_full_{0};          ///< 等待缓冲区空间次数
+};
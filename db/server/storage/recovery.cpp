@@ -0,0 +1,588 @@
+#include "recovery.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <unordered_set>
+#include "Thread/ThreadPool.h"
+#include "ret.h"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t RedoChunk = 16384;  ///< 重做时每批分发的页面修改记录数
+
+/**
+ * @brief CHECKPOINT_END记录的内容，紧跟在LogEntry之后，其后依次为活动事务与脏页
+ */
+struct CheckpointHeader
+{
+    lsn_t    begin;     ///< 对应的CHECKPOINT_BEGIN记录的起始偏移
+    txn_id_t next_txn;  ///< 下一个事务编号
+    uint32_t txns;      ///< 活动事务数
+    uint32_t pages;     ///< 脏页数
+};
+
+struct CheckpointTxn
+{
+    txn_id_t id;         ///< 事务编号
+    lsn_t    first;      ///< 第一条记录的起始偏移
+    lsn_t    last;       ///< 最后一条记录的起始偏移
+    uint64_t committed;  ///< 是否已写COMMIT记录
+};
+
+struct CheckpointPage
+{
+    uint64_t page;     ///< PageId::key()
+    lsn_t    rec_lsn;  ///< 使页面变脏的最早一条记录的起始偏移
+};
+
+/**
+ * @brief 一条待重放的页面修改，内容在RedoBatch::bytes中
+ */
+struct RedoItem
+{
+    uint64_t    page;    ///< PageId::key()
+    lsn_t       begin;   ///< 记录的起始偏移
+    lsn_t       lsn;     ///< 记录的日志序号
+    uint32_t    offset;  ///< 页内偏移
+    uint32_t    length;  ///< 字节数
+    std::size_t data;    ///< 内容在bytes中的偏移
+};
+
+/**
+ * @brief 分给一个重做线程的一批页面修改
+ */
+struct RecoveryManager::RedoBatch
+{
+    std::vector<RedoItem> items;  ///< 按日志顺序排列
+    std::vector<char>     bytes;  ///< 修改后的内容
+};
+
+template <class T>
+static void put(std::vector<char>& out, const T& value)
+{
+    std::size_t at = out.size();
+    out.resize(at + sizeof(T));
+    memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <class T>
+static T load(const char* p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+static std::vector<char> make_entry(LogType type, txn_id_t txn, lsn_t prev)
+{
+    std::vector<char> record;
+    put(record, LogEntry{type, {}, txn, prev});
+    return record;
+}
+
+static lsn_t page_lsn(const char* page) { return load<lsn_t>(page); }
+static void  set_page_lsn(char* page, lsn_t lsn) { memcpy(page, &lsn, sizeof(lsn)); }
+
+static double elapsed_ms(Clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+RecoveryManager::RecoveryManager(BufferPool& pool, LogManager& log) : pool_(pool), log_(log) { pool_.set_log(&log_); }
+
+Transaction* RecoveryManager::begin()
+{
+    auto         txn = std::make_unique<Transaction>();
+    Transaction* ptr = txn.get();
+    txn->owner       = this;
+    txn->id          = next_txn_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(txns_mutex_);
+    txns_.emplace(ptr->id, std::move(txn));
+    return ptr;
+}
+
+void RecoveryManager::finish(Transaction* txn)
+{
+    std::lock_guard<std::mutex> lock(txns_mutex_);
+    txns_.erase(txn->id);
+}
+
+lsn_t RecoveryManager::append(Transaction& txn, const std::vector<char>& record, RC& rc)
+{
+    lsn_t lsn = log_.append(record.data(), record.size(), rc);
+    if (FAIL(rc)) return InvalidLsn;
+    lsn_t begin = lsn - LogManager::footprint(record.size());
+    if (txn.first == InvalidLsn) txn.first = begin;
+    txn.last = begin;
+    return lsn;
+}
+
+lsn_t RecoveryManager::append_change(Transaction& txn, PageGuard& page, LogType type, lsn_t undo_next,
+    std::size_t offset, const char* before, const char* after, std::size_t len, RC& rc)
+{
+    std::vector<char> record = make_entry(type, txn.id, txn.last);
+    put(record, PageUpdate{page.id().key(), undo_next, static_cast<uint32_t>(offset), static_cast<uint32_t>(len)});
+    if (before) record.insert(record.end(), before, before + len);
+    record.insert(record.end(), after, after + len);
+
+    // 先登记脏页位置再追加：检查点在这条记录之后取快照时一定能看到这一页
+    page.set_rec_lsn(log_.end_lsn());
+    return append(txn, record, rc);
+}
+
+void RecoveryManager::update(
+    Transaction& txn, PageGuard& page, std::size_t offset, const char* data, std::size_t len, RC& rc)
+{
+    if (offset < sizeof(lsn_t) || offset > pool_.page_size() || len > pool_.page_size() - offset)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(txn.mutex);
+    lsn_t lsn = append_change(txn, page, LogType::UPDATE, InvalidLsn, offset, page.data() + offset, data, len, rc);
+    if (FAIL(rc)) return;
+    memcpy(page.data() + offset, data, len);
+    set_page_lsn(page.data(), lsn);
+    page.mark_dirty();
+}
+
+void RecoveryManager::log_update(
+    Transaction& txn, PageGuard& page, std::size_t offset, const char* before, std::size_t len, RC& rc)
+{
+    if (offset < sizeof(lsn_t) || offset > pool_.page_size() || len > pool_.page_size() - offset)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(txn.mutex);
+    lsn_t lsn = append_change(txn, page, LogType::UPDATE, InvalidLsn, offset, before, page.data() + offset, len, rc);
+    if (FAIL(rc)) return;
+    set_page_lsn(page.data(), lsn);
+    page.mark_dirty();
+}
+
+void RecoveryManager::log_redo(Transaction& txn, PageGuard& page, std::size_t offset, std::size_t len, RC& rc)
+{
+    if (offset < sizeof(lsn_t) || offset > pool_.page_size() || len > pool_.page_size() - offset)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(txn.mutex);
+    lsn_t lsn = append_change(txn, page, LogType::CLR, txn.last, offset, nullptr, page.data() + offset, len, rc);
+    if (FAIL(rc)) return;
+    set_page_lsn(page.data(), lsn);
+    page.mark_dirty();
+}
+
+void RecoveryManager::commit(Transaction* txn, RC& rc)
+{
+    rc        = RC::SUCCESS;
+    lsn_t lsn = InvalidLsn;
+    {
+        std::lock_guard<std::mutex> lock(txn->mutex);
+        // 只读事务没有写过日志，直接结束
+        if (txn->last != InvalidLsn)
+        {
+            lsn            = append(*txn, make_entry(LogType::COMMIT, txn->id, txn->last), rc);
+            txn->committed = SUCC(rc);
+        }
+    }
+    if (lsn != InvalidLsn) log_.flush(lsn, rc);
+    if (SUCC(rc) && lsn != InvalidLsn)
+    {
+        // END记录不必等待落盘：丢失时恢复会补写
+        std::lock_guard<std::mutex> lock(txn->mutex);
+        RC                          erc;
+        append(*txn, make_entry(LogType::END, txn->id, txn->last), erc);
+    }
+    finish(txn);
+}
+
+void RecoveryManager::abort(Transaction* txn, RC& rc)
+{
+    rc = RC::SUCCESS;
+    lsn_t last;
+    {
+        std::lock_guard<std::mutex> lock(txn->mutex);
+        last = txn->last;
+    }
+    // 回滚从段文件读回事务的记录，先让它们落盘
+    if (last != InvalidLsn) log_.flush(log_.end_lsn(), rc);
+    if (SUCC(rc) && last != InvalidLsn) rollback(*txn, last, rc);
+    finish(txn);
+}
+
+void RecoveryManager::rollback(Transaction& txn, lsn_t from, RC& rc)
+{
+    LogReader reader = log_.read(from, rc);
+    for (lsn_t next = from; SUCC(rc) && next != InvalidLsn;)
+    {
+        reader.seek(next, rc);
+        if (FAIL(rc)) return;
+        if (!reader.valid() || reader.begin() != next || reader.length() < sizeof(LogEntry))
+        {
+            rc = RC::IO_ERROR;
+            return;
+        }
+        const char* payload = reader.data();
+        LogEntry    entry   = load<LogEntry>(payload);
+        if (entry.type != LogType::UPDATE && entry.type != LogType::CLR)
+        {
+            next = entry.prev;
+            continue;
+        }
+        PageUpdate change = load<PageUpdate>(payload + sizeof(LogEntry));
+        if (entry.type == LogType::CLR)
+        {
+            // 补偿记录与只重做的记录不撤销，跳到undo_next
+            next = change.undo_next;
+            continue;
+        }
+
+        const char* before = payload + sizeof(LogEntry) + sizeof(PageUpdate);
+        PageGuard   page   = fetch_or_extend(PageId::from_key(change.page), rc);
+        if (FAIL(rc)) return;
+        WriteGuard                  guard = page.latch().write();
+        std::lock_guard<std::mutex> lock(txn.mutex);
+        lsn_t                       lsn =
+            append_change(txn, page, LogType::CLR, entry.prev, change.offset, nullptr, before, change.length, rc);
+        if (FAIL(rc)) return;
+        // 乐观锁耦合的读者不加页锁，锁住版本号让读到一半的读者重试
+        bool locked = page.version().lock();
+        memcpy(page.data() + change.offset, before, change.length);
+        set_page_lsn(page.data(), lsn);
+        if (locked) page.version().unlock();
+        page.mark_dirty();
+        undone_.fetch_add(1, std::memory_order_relaxed);
+        next = entry.prev;
+    }
+    if (FAIL(rc)) return;
+    std::lock_guard<std::mutex> lock(txn.mutex);
+    append(txn, make_entry(LogType::END, txn.id, txn.last), rc);
+}
+
+void RecoveryManager::checkpoint(RC& rc)
+{
+    std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+    std::vector<char>           record = make_entry(LogType::CHECKPOINT_BEGIN, 0, InvalidLsn);
+    lsn_t                       lsn    = log_.append(record.data(), record.size(), rc);
+    if (FAIL(rc)) return;
+    lsn_t begin = lsn - LogManager::footprint(record.size());
+
+    // 快照：活动事务表只短暂加锁，脏页表不加页锁。日志至少要保留到检查点、脏页最早的rec_lsn
+    // 与活动事务的第一条记录中最早的位置
+    lsn_t                       bound = begin;
+    std::vector<CheckpointTxn>  txns;
+    {
+        std::lock_guard<std::mutex> lock(txns_mutex_);
+        for (auto& [id, txn] : txns_)
+        {
+            std::lock_guard<std::mutex> txn_lock(txn->mutex);
+            if (txn->last == InvalidLsn) continue;
+            txns.push_back({id, txn->first, txn->last, txn->committed});
+            bound = std::min(bound, txn->first);
+        }
+    }
+    std::vector<std::pair<PageId, uint64_t>> pages = pool_.dirty_pages();
+    for (auto& [id, rec_lsn] : pages) bound = std::min(bound, rec_lsn);
+    // rec_lsn是追加记录前登记的保守值，可能早于上一次截断后的起点，真正的记录都在起点之后
+    bound = std::max(bound, log_.begin_lsn());
+
+    record = make_entry(LogType::CHECKPOINT_END, 0, InvalidLsn);
+    put(record, CheckpointHeader{begin, next_txn_.load(std::memory_order_relaxed), static_cast<uint32_t>(txns.size()),
+                    static_cast<uint32_t>(pages.size())});
+    for (auto& txn : txns) put(record, txn);
+    for (auto& [id, rec_lsn] : pages) put(record, CheckpointPage{id.key(), rec_lsn});
+    lsn = log_.append(record.data(), record.size(), rc);
+    if (FAIL(rc)) return;
+    log_.flush(lsn, rc);
+    if (FAIL(rc)) return;
+
+    // 快照之前写回的页面只在操作系统缓存中，落盘后才能截断它们的记录
+    pool_.disk().sync_all(rc);
+    if (FAIL(rc)) return;
+    log_.set_checkpoint(begin, bound, rc);
+    if (SUCC(rc)) checkpoints_.fetch_add(1, std::memory_order_relaxed);
+}
+
+PageGuard RecoveryManager::fetch_or_extend(PageId id, RC& rc)
+{
+    PageGuard page = pool_.fetch_page(id, rc);
+    if (rc != RC::INVALID_ARGUMENT) return page;
+    {
+        std::lock_guard<std::mutex> lock(extend_mutex_);
+        DiskManager&                disk = pool_.disk();
+        while (disk.page_count(id.file) <= id.page)
+        {
+            disk.allocate_page(id.file, rc);
+            if (FAIL(rc)) return {};
+        }
+    }
+    return pool_.fetch_page(id, rc);
+}
+
+bool RecoveryManager::redo(uint64_t key, lsn_t begin, lsn_t lsn, uint32_t offset, const char* data, uint32_t len,
+    RC& rc)
+{
+    PageGuard page = fetch_or_extend(PageId::from_key(key), rc);
+    if (FAIL(rc)) return false;
+    WriteGuard guard = page.latch().write();
+    if (page_lsn(page.data()) >= lsn) return false;
+    page.set_rec_lsn(begin);
+    memcpy(page.data() + offset, data, len);
+    set_page_lsn(page.data(), lsn);
+    page.mark_dirty();
+    return true;
+}
+
+void RecoveryManager::recover(ThreadPool& workers, RC& rc)
+{
+    recovery_ = RecoveryStats{};
+
+    // 分析：从最近的检查点读到日志末尾
+    struct TxnState
+    {
+        lsn_t first;
+        lsn_t last;
+        bool  committed;
+    };
+    auto                                   started = Clock::now();
+    std::unordered_map<txn_id_t, TxnState> att;
+    std::unordered_set<txn_id_t>           ended;
+    std::unordered_map<uint64_t, lsn_t>    dpt;
+    txn_id_t                               next_txn = 1;
+    lsn_t                                  start =
+        log_.checkpoint_lsn() != InvalidLsn ? log_.checkpoint_lsn() : log_.begin_lsn();
+    for (LogReader reader = log_.read(start, rc); SUCC(rc) && reader.valid(); reader.next(rc))
+    {
+        ++recovery_.analyzed;
+        if (reader.length() < sizeof(LogEntry)) continue;
+        const char* payload = reader.data();
+        LogEntry    entry   = load<LogEntry>(payload);
+        next_txn            = std::max(next_txn, entry.txn + 1);
+        switch (entry.type)
+        {
+        case LogType::UPDATE:
+        case LogType::CLR:
+        case LogType::COMMIT:
+        {
+            if (entry.type != LogType::COMMIT)
+                dpt.try_emplace(load<PageUpdate>(payload + sizeof(LogEntry)).page, reader.begin());
+            TxnState& state = att.try_emplace(entry.txn, TxnState{reader.begin(), 0, false}).first->second;
+            state.last      = reader.begin();
+            state.committed |= entry.type == LogType::COMMIT;
+            break;
+        }
+        case LogType::END:
+            att.erase(entry.txn);
+            ended.insert(entry.txn);
+            break;
+        case LogType::CHECKPOINT_END:
+        {
+            // 快照与检查点开始之后读到的记录合并：快照中已结束的事务不再加入，事务链取较新的末尾，
+            // 脏页取较早的rec_lsn
+            const char*      p      = payload + sizeof(LogEntry);
+            CheckpointHeader header = load<CheckpointHeader>(p);
+            p += sizeof(header);
+            next_txn = std::max(next_txn, header.next_txn);
+            for (uint32_t i = 0; i < header.txns; ++i, p += sizeof(CheckpointTxn))
+            {
+                CheckpointTxn txn = load<CheckpointTxn>(p);
+                if (ended.count(txn.id)) continue;
+                auto [it, fresh] = att.try_emplace(txn.id, TxnState{txn.first, txn.last, txn.committed != 0});
+                it->second.first = txn.first;
+                it->second.committed |= txn.committed != 0;
+            }
+            for (uint32_t i = 0; i < header.pages; ++i, p += sizeof(CheckpointPage))
+            {
+                CheckpointPage page = load<CheckpointPage>(p);
+                auto [it, fresh]    = dpt.try_emplace(page.page, page.rec_lsn);
+                it->second          = std::min(it->second, page.rec_lsn);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    if (FAIL(rc)) return;
+    next_txn_.store(next_txn, std::memory_order_relaxed);
+    recovery_.dirty_pages = dpt.size();
+    recovery_.analysis_ms = elapsed_ms(started);
+
+    // 重做：同一页面的记录总是分给同一个线程，按日志顺序重放；一批全部完成后才分发下一批
+    started             = Clock::now();
+    lsn_t     redo_from = log_.end_lsn();
+    for (auto& [page, rec_lsn] : dpt) redo_from = std::min(redo_from, rec_lsn);
+    redo_from           = std::max(redo_from, log_.begin_lsn());
+    recovery_.redo_from = redo_from;
+
+    std::size_t                    parts = std::max(1u, workers.Size());
+    std::vector<RedoBatch>         batches[2];
+    std::vector<std::future<void>> pending;
+    std::atomic<uint64_t>          applied{0};
+    std::atomic<bool>              failed{false};
+    int                            current = 0;
+    std::size_t                    queued  = 0;
+    batches[0].resize(parts);
+    batches[1].resize(parts);
+    auto wait = [&] {
+        auto blocking = ThreadPool::ManagedBlock();
+        for (auto& f : pending) f.get();
+        pending.clear();
+    };
+    auto submit = [&] {
+        wait();
+        for (RedoBatch& batch : batches[current])
+        {
+            if (batch.items.empty()) continue;
+            pending.push_back(workers.EnQueue([this, &batch, &applied, &failed] {
+                for (const RedoItem& item : batch.items)
+                {
+                    RC irc;
+                    if (redo(item.page, item.begin, item.lsn, item.offset, batch.bytes.data() + item.data,
+                            item.length, irc))
+                        applied.fetch_add(1, std::memory_order_relaxed);
+                    if (FAIL(irc)) failed.store(true, std::memory_order_relaxed);
+                }
+                batch.items.clear();
+                batch.bytes.clear();
+            }));
+        }
+        current ^= 1;
+        queued = 0;
+    };
+
+    LogReader reader = log_.read(redo_from, rc);
+    for (; !dpt.empty() && SUCC(rc) && reader.valid(); reader.next(rc))
+    {
+        if (reader.length() < sizeof(LogEntry)) continue;
+        const char* payload = reader.data();
+        LogEntry    entry   = load<LogEntry>(payload);
+        if (entry.type != LogType::UPDATE && entry.type != LogType::CLR) continue;
+
+        // 不在脏页表中、或早于页面变脏位置的修改已经写回
+        PageUpdate change = load<PageUpdate>(payload + sizeof(LogEntry));
+        auto       it     = dpt.find(change.page);
+        if (it == dpt.end() || reader.begin() < it->second) continue;
+        ++recovery_.redo_checked;
+        const char* after = payload + sizeof(LogEntry) + sizeof(PageUpdate);
+        if (entry.type == LogType::UPDATE) after += change.length;
+
+        RedoBatch& batch = batches[current][(change.page * 0x9E3779B97F4A7C15ull >> 32) % parts];
+        batch.items.push_back(
+            {change.page, reader.begin(), reader.lsn(), change.offset, change.length, batch.bytes.size()});
+        batch.bytes.insert(batch.bytes.end(), after, after + change.length);
+        if (++queued == RedoChunk) submit();
+    }
+    submit();
+    wait();
+    if (FAIL(rc)) return;
+    if (failed)
+    {
+        rc = RC::IO_ERROR;
+        return;
+    }
+    recovery_.redo_applied = applied.load(std::memory_order_relaxed);
+    recovery_.redo_ms      = elapsed_ms(started);
+
+    // 撤销：已提交的事务补写END，未提交的逐个回滚
+    started = Clock::now();
+    for (auto& [id, state] : att)
+    {
+        Transaction txn;
+        txn.id    = id;
+        txn.first = state.first;
+        txn.last  = state.last;
+        if (state.committed)
+            append(txn, make_entry(LogType::END, id, txn.last), rc);
+        else
+        {
+            ++recovery_.losers;
+            rollback(txn, state.last, rc);
+        }
+        if (FAIL(rc)) return;
+    }
+    log_.flush(log_.end_lsn(), rc);
+    if (FAIL(rc)) return;
+    recovery_.undo_ms = elapsed_ms(started);
+    checkpoint(rc);
+}
+
+std::size_t RecoveryManager::active() const
+{
+    std::lock_guard<std::mutex> lock(txns_mutex_);
+    return txns_.size();
+}
+
+RecoveryStats RecoveryManager::stats() const
+{
+    RecoveryStats stats = recovery_;
+    stats.undone        = undone_.load(std::memory_order_relaxed);
+    stats.checkpoints   = checkpoints_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief 两段变化之间相同的字节少于一条记录的头部时合并为一段
+ */
+static constexpr std::size_t MergeGap = sizeof(LogEntry) + sizeof(PageUpdate);
+
+PageChange::PageChange(Transaction* txn, PageGuard& page, bool redo_only)
+    : txn_(txn && txn->owner ? txn : nullptr), page_(page), redo_only_(redo_only)
+{
+    if (txn_) before_.assign(page.data(), page.data() + txn_->owner->page_size());
+}
+
+PageChange::~PageChange()
+{
+    if (!txn_) return;
+    char*       data = page_.data() + sizeof(lsn_t);
+    std::size_t len  = before_.size() - sizeof(lsn_t);
+    if (memcmp(data, before_.data() + sizeof(lsn_t), len) != 0) memcpy(data, before_.data() + sizeof(lsn_t), len);
+}
+
+void PageChange::done(RC& rc)
+{
+    rc = RC::SUCCESS;
+    if (!txn_)
+    {
+        page_.mark_dirty();
+        return;
+    }
+
+    // 页面LSN之后逐段比较，相隔很近的两段合并为一条记录
+    const char* after = page_.data();
+    std::size_t size  = before_.size();
+    std::size_t begin = sizeof(lsn_t);
+    while (true)
+    {
+        while (begin < size && after[begin] == before_[begin]) ++begin;
+        if (begin == size) return;
+        std::size_t end = begin + 1, same = 0;
+        for (std::size_t i = end; i < size && same < MergeGap; ++i)
+        {
+            if (after[i] != before_[i])
+            {
+                end  = i + 1;
+                same = 0;
+            }
+            else
+                ++same;
+        }
+        if (redo_only_)
+            txn_->owner->log_redo(*txn_, page_, begin, end - begin, rc);
+        else
+            txn_->owner->log_update(*txn_, page_, begin, before_.data() + begin, end - begin, rc);
+        if (FAIL(rc))
+        {
+            // 页面内容与日志保持一致：没有记录的修改撤回，由调用者回滚已记录的部分
+            memcpy(page_.data() + begin, before_.data() + begin, size - begin);
+            return;
+        }
+        memcpy(before_.data() + begin, after + begin, end - begin);
+        begin = end;
+    }
+}
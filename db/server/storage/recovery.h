@@ -0,0 +1,299 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "buffer_pool.h"
+#include "log_manager.h"
+
+enum class RC;
+class RecoveryManager;
+class ThreadPool;
+
+/*
+ * 事务日志与崩溃恢复（ARIES）。
+ *
+ * 事务对页面的每次修改先写一条UPDATE记录（页面、页内偏移、修改前与修改后的内容），再改页面并把记录的
+ * 日志序号写入页面前8字节（页面LSN）；同一事务的记录通过prev串成链。缓冲池写回页面前让日志落盘到
+ * 页面LSN，提交时写COMMIT记录并等待它落盘（组提交），之后写END记录。回滚沿记录链逆序撤销，
+ * 每撤销一条写一条补偿记录（CLR），CLR的undo_next指向下一条要撤销的记录，CLR本身从不撤销，
+ * 回滚或恢复中途再次崩溃也不会重复撤销。
+ *
+ * 模糊检查点不加页锁、不写回页面：写CHECKPOINT_BEGIN记录，再取活动事务表与缓冲池中的脏页表
+ * （页面及其rec_lsn）的快照写入CHECKPOINT_END记录，落盘日志与数据文件后更新控制文件。
+ * 期间前台的修改照常进行，快照之后的修改由恢复时的分析阶段从日志中补上。
+ * 日志截断到检查点、脏页的最小rec_lsn与活动事务的第一条记录三者中最早的位置。
+ *
+ * 恢复分三个阶段：
+ *  1. 分析：从最近的检查点顺序读到日志末尾，重建崩溃时的活动事务表与脏页表；
+ *  2. 重做：从脏页表中最小的rec_lsn开始重放页面修改，页面LSN不小于记录序号的页面已经包含这次修改，
+ *     跳过。重做按页面哈希分给线程池中的各个线程并行进行，同一页面的记录由同一线程按日志顺序重放，
+ *     读下一批记录与上一批的重放同时进行；
+ *  3. 撤销：逐个回滚崩溃时未提交的事务，写CLR与END记录，最后做一次检查点。
+ *
+ * 页面标识在日志中按PageId::key()记录，文件编号须在重启后保持不变：恢复前按崩溃前相同的顺序打开
+ * 数据文件。事务在提交或回滚前须持有所修改数据的锁，不同的未提交事务不会修改同一处内容，
+ * 各事务可以各自按逆序撤销。
+ *
+ * 堆文件与B+树用PageChange记日志：修改前保存页面的前像，修改后为变化的字节写UPDATE记录。
+ * 撤销按字节恢复，页头、槽数组与B+树的结构修改都在其中，未提交事务修改过的页在它结束之前
+ * 不能被其他事务修改（如对表与索引加写锁到事务结束）。撤销之后会使页面失效的修改（堆文件新页的初始化）
+ * 记为只重做的记录，回滚时跳过。
+ */
+
+using txn_id_t = uint64_t;  ///< 事务编号
+
+/**
+ * @brief 日志记录类型
+ */
+enum class LogType : uint8_t
+{
+    UPDATE = 1,        ///< 页面修改
+    CLR,               ///< 补偿记录，撤销一条页面修改；也用于只重做的页面修改
+    COMMIT,            ///< 提交
+    END,               ///< 事务结束，提交或回滚已完成
+    CHECKPOINT_BEGIN,  ///< 检查点开始
+    CHECKPOINT_END,    ///< 检查点结束，含活动事务表与脏页表
+};
+
+/**
+ * @brief 日志记录内容的公共头
+ */
+struct LogEntry
+{
+    LogType  type;         ///< 记录类型
+    uint8_t  reserved[7];  ///< 保留
+    txn_id_t txn;          ///< 事务编号，检查点记录为0
+    lsn_t    prev;         ///< 同一事务上一条记录的起始偏移，没有时为InvalidLsn
+};
+
+/**
+ * @brief UPDATE与CLR记录中的页面修改，紧跟在LogEntry之后
+ *
+ * 其后UPDATE为修改前与修改后的内容各length字节，CLR为写入的内容length字节。
+ */
+struct PageUpdate
+{
+    uint64_t page;       ///< PageId::key()
+    lsn_t    undo_next;  ///< CLR：下一条要撤销的记录的起始偏移；UPDATE不使用
+    uint32_t offset;     ///< 页内偏移，不小于页面LSN的8字节
+    uint32_t length;     ///< 修改的字节数
+};
+
+/**
+ * @brief 事务
+ *
+ * 由RecoveryManager::begin创建，commit或abort返回后失效。同一事务同一时刻只能由一个线程使用。
+ */
+struct Transaction
+{
+    RecoveryManager* owner{nullptr};     ///< 创建事务的恢复管理器
+    txn_id_t         id;                 ///< 事务编号
+    lsn_t            first{InvalidLsn};  ///< 第一条记录的起始偏移
+    lsn_t            last{InvalidLsn};   ///< 最后一条记录的起始偏移
+    bool             committed{false};   ///< 是否已写COMMIT记录
+    std::mutex       mutex;              ///< 保护first、last与committed，检查点取快照时与追加记录互斥
+};
+
+/**
+ * @brief 恢复与检查点统计快照
+ */
+struct RecoveryStats
+{
+    uint64_t analyzed;      ///< 分析阶段读取的记录数
+    uint64_t redo_checked;  ///< 重做阶段检查的页面修改记录数
+    uint64_t redo_applied;  ///< 重做时写入页面的记录数，其余的修改页面上已有
+    uint64_t dirty_pages;   ///< 分析得到的脏页数
+    uint64_t losers;        ///< 撤销的未提交事务数
+    uint64_t undone;        ///< 撤销的页面修改数，含运行时的回滚
+    uint64_t checkpoints;   ///< 完成的检查点数
+    lsn_t    redo_from;     ///< 重做的起点
+    double   analysis_ms;   ///< 分析耗时
+    double   redo_ms;       ///< 重做耗时
+    double   undo_ms;       ///< 撤销耗时
+};
+
+/**
+ * @brief 事务日志与恢复管理器
+ *
+ * 线程安全。构造时把日志设置给缓冲池，缓冲池写回页面前先落盘日志。
+ */
+class RecoveryManager
+{
+  public:
+    /**
+     * @brief 构造函数
+     *
+     * @param pool 缓冲池，生命期须长于恢复管理器
+     * @param log 日志，生命期须长于缓冲池写回页面的最后一刻
+     */
+    RecoveryManager(BufferPool& pool, LogManager& log);
+
+    RecoveryManager(const RecoveryManager&)            = delete;
+    RecoveryManager& operator=(const RecoveryManager&) = delete;
+
+    /**
+     * @brief 开始一个事务，第一次修改前不写日志
+     */
+    Transaction* begin();
+
+    /**
+     * @brief 记日志地修改页面
+     *
+     * 写UPDATE记录后把data写入页面的[offset, offset + len)，更新页面LSN并标记为脏页。
+     * 调用者须持有页锁的写锁。
+     *
+     * @param rc 修改范围越出页面或覆盖页面LSN时为RC::INVALID_ARGUMENT，日志失败时为日志的返回码
+     */
+    void update(Transaction& txn, PageGuard& page, std::size_t offset, const char* data, std::size_t len, RC& rc);
+
+    /**
+     * @brief 为已经写入页面的修改写UPDATE记录
+     *
+     * 页面的[offset, offset + len)已是修改后的内容，before为修改前的内容。写记录后更新页面LSN并标记为脏页。
+     * 调用者从修改页面之前到返回一直持有页锁的写锁，期间页面不会被写回。
+     */
+    void log_update(
+        Transaction& txn, PageGuard& page, std::size_t offset, const char* before, std::size_t len, RC& rc);
+
+    /**
+     * @brief 为已经写入页面的修改写只重做的记录
+     *
+     * 记为undo_next指向事务上一条记录的CLR，回滚时跳过，恢复时照常重做。调用要求同log_update。
+     */
+    void log_redo(Transaction& txn, PageGuard& page, std::size_t offset, std::size_t len, RC& rc);
+
+    /**
+     * @brief 提交事务，返回时COMMIT记录已落盘
+     *
+     * 无论成败txn都失效；失败时事务的结果由恢复决定。
+     */
+    void commit(Transaction* txn, RC& rc);
+
+    /**
+     * @brief 回滚事务，撤销全部修改后写END记录
+     *
+     * 须在不持有任何页锁时调用。无论成败txn都失效。
+     */
+    void abort(Transaction* txn, RC& rc);
+
+    /**
+     * @brief 做一次模糊检查点并截断日志
+     *
+     * 可以与事务并发进行；同一时刻只有一个检查点。
+     */
+    void checkpoint(RC& rc);
+
+    /**
+     * @brief 崩溃恢复：分析、并行重做、撤销，最后做一次检查点
+     *
+     * 须在打开数据文件之后、开始任何事务之前调用。
+     *
+     * @param workers 并行重做使用的线程池
+     */
+    void recover(ThreadPool& workers, RC& rc);
+
+    std::size_t page_size() const { return pool_.page_size(); }
+
+    /**
+     * @brief 活动事务数
+     */
+    std::size_t active() const;
+
+    RecoveryStats stats() const;
+
+  private:
+    struct RedoBatch;
+
+    /**
+     * @brief 追加txn的一条记录并推进其记录链，调用者持有txn.mutex
+     *
+     * @return 记录的日志序号
+     */
+    lsn_t append(Transaction& txn, const std::vector<char>& record, RC& rc);
+
+    /**
+     * @brief 为页面修改写一条记录，先登记页面的rec_lsn，调用者持有txn.mutex
+     *
+     * @param before UPDATE记录的前像，CLR为nullptr
+     * @param after 修改后的内容
+     * @return 记录的日志序号
+     */
+    lsn_t append_change(Transaction& txn, PageGuard& page, LogType type, lsn_t undo_next, std::size_t offset,
+        const char* before, const char* after, std::size_t len, RC& rc);
+
+    /**
+     * @brief 从from开始沿记录链撤销txn的修改，写CLR后写END记录
+     */
+    void rollback(Transaction& txn, lsn_t from, RC& rc);
+
+    /**
+     * @brief 在页面上重放一条页面修改，页面LSN不小于lsn时跳过
+     *
+     * @param begin 记录的起始偏移，页面因此变脏时作为rec_lsn
+     * @return 是否写入了页面
+     */
+    bool redo(uint64_t key, lsn_t begin, lsn_t lsn, uint32_t offset, const char* data, uint32_t len, RC& rc);
+
+    /**
+     * @brief 取页，页号超出文件时先扩展文件：崩溃前分配的页可能还没有写入文件头
+     */
+    PageGuard fetch_or_extend(PageId id, RC& rc);
+
+    /**
+     * @brief 结束事务：移出活动事务表并释放
+     */
+    void finish(Transaction* txn);
+
+    BufferPool&                                                pool_;              ///< 缓冲池
+    LogManager&                                                log_;               ///< 日志
+    std::atomic<txn_id_t>                                      next_txn_{1};       ///< 下一个事务编号
+    mutable std::mutex                                         txns_mutex_;        ///< 保护txns_
+    std::unordered_map<txn_id_t, std::unique_ptr<Transaction>> txns_;              ///< 活动事务表
+    std::mutex                                                 checkpoint_mutex_;  ///< 串行化检查点
+    std::mutex                                                 extend_mutex_;      ///< 串行化重做时扩展文件
+    std::atomic<uint64_t>                                      checkpoints_{0};    ///< 完成的检查点数
+    std::atomic<uint64_t>                                      undone_{0};         ///< 撤销的页面修改数
+    RecoveryStats                                              recovery_{};        ///< 最近一次恢复的统计
+};
+
+/**
+ * @brief 记日志地修改一个页面
+ *
+ * 构造时保存页面的前像，之后调用者直接在页面上修改，done()比较前后的内容，为每段变化的字节写一条记录，
+ * 更新页面LSN并标记为脏页；之后可以继续修改并再次done()。txn为nullptr时不记日志，done()只标记脏页。
+ * 调用者从构造到析构一直持有页锁的写锁。
+ */
+class PageChange
+{
+  public:
+    /**
+     * @param redo_only 为true时写只重做的记录，见RecoveryManager::log_redo
+     */
+    PageChange(Transaction* txn, PageGuard& page, bool redo_only = false);
+
+    /**
+     * @brief 没有记日志的修改恢复为修改前的内容，提前返回时页面与日志保持一致
+     */
+    ~PageChange();
+
+    PageChange(const PageChange&)            = delete;
+    PageChange& operator=(const PageChange&) = delete;
+
+    /**
+     * @brief 为上一次done()之后的修改写日志并标记脏页
+     *
+     * @param rc 日志失败时为日志的返回码，尚未写入日志的字节恢复为修改前的内容
+     */
+    void done(RC& rc);
+
+  private:
+    Transaction*      txn_;        ///< 记日志的事务
+    PageGuard&        page_;       ///< 修改的页面
+    bool              redo_only_;  ///< 是否只重做
+    std::vector<char> before_;     ///< 上一次done()时页面的内容
+};
@@ -0,0 +1,122 @@
+#include "replacer.h"
+
+ClockReplacer::ClockReplacer(std::size_t frames)
+    : referenced_(new std::atomic<uint8_t>[frames]), evictable_(new std::atomic<uint8_t>[frames]), frames_(frames),
+      hand_(0)
+{
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        referenced_[i].store(0, std::memory_order_relaxed);
+        evictable_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void ClockReplacer::record_access(frame_id_t frame)
+{
+    // 命中路径只写一个字节，已经置位时不再写，避免热页面的缓存行在核间来回传递
+    if (!referenced_[frame].load(std::memory_order_relaxed)) referenced_[frame].store(1, std::memory_order_relaxed);
+}
+
+void ClockReplacer::set_evictable(frame_id_t frame, bool evictable)
+{
+    evictable_[frame].store(evictable, std::memory_order_release);
+}
+
+bool ClockReplacer::victim(frame_id_t& frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 转两圈：第一圈清除引用位，第二圈一定能找到可淘汰的帧（如果存在）
+    for (std::size_t step = 0; step < 2 * frames_; ++step)
+    {
+        std::size_t current = hand_;
+        hand_               = hand_ + 1 == frames_ ? 0 : hand_ + 1;
+        if (!evictable_[current].load(std::memory_order_acquire)) continue;
+        if (referenced_[current].load(std::memory_order_relaxed))
+        {
+            referenced_[current].store(0, std::memory_order_relaxed);
+            continue;
+        }
+        evictable_[current].store(0, std::memory_order_relaxed);
+        frame = static_cast<frame_id_t>(current);
+        return true;
+    }
+    return false;
+}
+
+void ClockReplacer::remove(frame_id_t frame)
+{
+    referenced_[frame].store(0, std::memory_order_relaxed);
+    evictable_[frame].store(0, std::memory_order_relaxed);
+}
+
+LruKReplacer::LruKReplacer(std::size_t frames, std::size_t k) : entries_(frames), k_(k ? k : 1), clock_(0)
+{
+    for (auto& entry : entries_) entry.history.resize(k_);
+}
+
+/**
+ * @brief 排序时间：不足K次时为第一次访问的时间，否则为倒数第K次访问的时间
+ */
+uint64_t LruKReplacer::order_key(const Entry& entry) const
+{
+    return entry.history[entry.accesses < k_ ? 0 : entry.accesses % k_];
+}
+
+void LruKReplacer::detach(frame_id_t frame)
+{
+    const Entry& entry = entries_[frame];
+    (entry.accesses < k_ ? history_ : cache_).erase({order_key(entry), frame});
+}
+
+void LruKReplacer::attach(frame_id_t frame)
+{
+    const Entry& entry = entries_[frame];
+    (entry.accesses < k_ ? history_ : cache_).insert({order_key(entry), frame});
+}
+
+void LruKReplacer::record_access(frame_id_t frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry&                      entry = entries_[frame];
+    if (entry.evictable) detach(frame);
+    entry.history[entry.accesses % k_] = ++clock_;
+    ++entry.accesses;
+    if (entry.evictable) attach(frame);
+}
+
+void LruKReplacer::set_evictable(frame_id_t frame, bool evictable)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry&                      entry = entries_[frame];
+    if (entry.evictable == evictable) return;
+    if (entry.evictable) detach(frame);
+    entry.evictable = evictable;
+    if (entry.evictable) attach(frame);
+}
+
+bool LruKReplacer::victim(frame_id_t& frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::set<Key>&              from = history_.empty() ? cache_ : history_;
+    if (from.empty()) return false;
+    frame = from.begin()->second;
+    from.erase(from.begin());
+    entries_[frame].evictable = false;
+    entries_[frame].accesses  = 0;
+    return true;
+}
+
+void LruKReplacer::remove(frame_id_t frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry&                      entry = entries_[frame];
+    if (entry.evictable) detach(frame);
+    entry.evictable = false;
+    entry.accesses  = 0;
+}
+
+std::unique_ptr<Replacer> make_replacer(ReplacerKind kind, std::size_t frames, std::size_t k)
+{
+    if (kind == ReplacerKind::CLOCK) return std::make_unique<ClockReplacer>(frames);
+    return std::make_unique<LruKReplacer>(frames, k);
+}
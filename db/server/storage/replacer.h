@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+/*
+ * 缓冲池的页面置换策略。
+ *
+ * 置换器只跟踪帧号：缓冲池在帧被访问时调用record_access，在帧的引用计数归零或变为非零时
+ * 调用set_evictable，需要腾出帧时调用victim。置换器不知道帧中是哪一页。
+ */
+
+using frame_id_t = uint32_t;  ///< 缓冲池中的帧号
+
+/**
+ * @brief 置换策略
+ */
+enum class ReplacerKind
+{
+    CLOCK,  ///< 时钟算法，命中时只设置引用位，不加锁
+    LRU_K,  ///< LRU-K，按倒数第K次访问的时间淘汰，只访问过一次的页面先被淘汰，能抵抗全表扫描
+};
+
+/**
+ * @brief 置换器接口
+ *
+ * 线程安全。
+ */
+class Replacer
+{
+  public:
+    virtual ~Replacer() = default;
+
+    /**
+     * @brief 记录一次访问
+     */
+    virtual void record_access(frame_id_t frame) = 0;
+
+    /**
+     * @brief 设置帧是否可被淘汰
+     */
+    virtual void set_evictable(frame_id_t frame, bool evictable) = 0;
+
+    /**
+     * @brief 选出一个可淘汰的帧，并把它置为不可淘汰、清除访问历史
+     *
+     * @return 没有可淘汰的帧时返回false
+     */
+    virtual bool victim(frame_id_t& frame) = 0;
+
+    /**
+     * @brief 清除帧的访问历史，并置为不可淘汰
+     *
+     * 帧中的页面被丢弃时调用。
+     */
+    virtual void remove(frame_id_t frame) = 0;
+};
+
+/**
+ * @brief 时钟置换器
+ *
+ * 每帧一个引用位。时钟指针扫过可淘汰的帧，引用位为1时清零并跳过，为0时选中。
+ */
+class ClockReplacer : public Replacer
+{
+  public:
+    explicit ClockReplacer(std::size_t frames);
+
+    void record_access(frame_id_t frame) override;
+    void set_evictable(frame_id_t frame, bool evictable) override;
+    bool victim(frame_id_t& frame) override;
+    void remove(frame_id_t frame) override;
+
+  private:
+    std::unique_ptr<std::atomic<uint8_t>[]> referenced_;  ///< 引用位
+    std::unique_ptr<std::atomic<uint8_t>[]> evictable_;   ///< 是否可淘汰
+    std::size_t                             frames_;      ///< 帧数
+    std::size_t                             hand_;        ///< 时钟指针
+    std::mutex                              mutex_;       ///< 保护时钟指针
+};
+
+/**
+ * @brief LRU-K置换器
+ *
+ * 访问次数不足K次的帧的后向K距离视为无穷大，按第一次访问的先后淘汰；
+ * 其余帧按倒数第K次访问的时间从早到晚淘汰。一次性扫描的页面只被访问一次，
+ * 总是先于被反复访问的热页面淘汰。
+ */
+class LruKReplacer : public Replacer
+{
+  public:
+    LruKReplacer(std::size_t frames, std::size_t k);
+
+    void record_access(frame_id_t frame) override;
+    void set_evictable(frame_id_t frame, bool evictable) override;
+    bool victim(frame_id_t& frame) override;
+    void remove(frame_id_t frame) override;
+
+  private:
+    using Key = std::pair<uint64_t, frame_id_t>;  ///< (排序时间, 帧号)
+
+    /**
+     * @brief 帧的访问历史
+     */
+    struct Entry
+    {
+        std::vector<uint64_t> history;            ///< 最近K次访问的时间，环形存放
+        std::size_t           accesses  = 0;      ///< 访问次数
+        bool                  evictable = false;  ///< 是否可淘汰
+    };
+
+    uint64_t order_key(const Entry& entry) const;
+    void     detach(frame_id_t frame);
+    void     attach(frame_id_t frame);
+
+    std::vector<Entry> entries_;  ///< 按帧号索引的访问历史
+    std::set<Key>      history_;  ///< 访问不足K次的可淘汰帧，按第一次访问排序
+    std::set<Key>      cache_;    ///< 访问满K次的可淘汰帧，按倒数第K次访问排序
+    std::size_t        k_;        ///< K
+    uint64_t           clock_;    ///< 逻辑时间
+    std::mutex         mutex_;    ///< 保护全部状态
+};
+
+/**
+ * @brief 创建置换器
+ *
+ * @param k LRU-K的K，CLOCK忽略
+ */
+std::unique_ptr<Replacer> make_replacer(ReplacerKind kind, std::size_t frames, std::size_t k = 2);
@@ -0,0 +1,116 @@
+#include "BRLock.h"
+#include <thread>
+
+/**
+ * @brief 为每个线程分配槽位序号的计数器
+ */
+static std::atomic<unsigned int> NextSlotIndex{0};
+
+/**
+ * @brief 读锁守护构造函数
+ *
+ * @param slot 获取读锁时使用的读者槽位
+ */
+BRLock::ReadGuard::ReadGuard(std::atomic<int>* slot) : slot{slot} {}
+
+/**
+ * @brief 读锁守护移动构造函数
+ *
+ * @param other 被移动的守护对象
+ */
+BRLock::ReadGuard::ReadGuard(ReadGuard&& other) noexcept : slot{other.slot} { other.slot = nullptr; }
+
+/**
+ * @brief 读锁守护析构函数
+ *
+ * 在获取锁时的槽位上撤销登记。释放语义保证临界区内的读操作先于撤销完成。
+ */
+BRLock::ReadGuard::~ReadGuard()
+{
+    if (slot) slot->fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief 写锁守护构造函数
+ *
+ * @param lock 大读者锁对象
+ */
+BRLock::WriteGuard::WriteGuard(BRLock* lock) : lock{lock} {}
+
+/**
+ * @brief 写锁守护移动构造函数
+ *
+ * @param other 被移动的守护对象
+ */
+BRLock::WriteGuard::WriteGuard(WriteGuard&& other) noexcept : lock{other.lock} { other.lock = nullptr; }
+
+/**
+ * @brief 写锁守护析构函数
+ *
+ * 清除写者标志并释放写者互斥锁，被阻塞的读者随之重试。
+ */
+BRLock::WriteGuard::~WriteGuard()
+{
+    if (!lock) return;
+    lock->writer.store(false, std::memory_order_release);
+    lock->write_mtx.unlock();
+}
+
+/**
+ * @brief 大读者锁构造函数
+ */
+BRLock::BRLock() : writer{false}
+{
+    unsigned int count = 1;
+    while (count < std::thread::hardware_concurrency()) count <<= 1;
+    slots     = std::make_unique<Slot[]>(count);
+    slot_mask = count - 1;
+}
+
+/**
+ * @brief 当前线程使用的槽位
+ *
+ * 线程首次使用时按轮转方式分配序号，此后固定不变，
+ * 因此同一线程的加锁与解锁总在同一槽位上，不受线程迁移CPU的影响。
+ */
+std::atomic<int>* BRLock::local_slot()
+{
+    static thread_local unsigned int index = NextSlotIndex.fetch_add(1, std::memory_order_relaxed);
+    return &slots[index & slot_mask].readers;
+}
+
+/**
+ * @brief 获取读锁
+ *
+ * 槽位计数加一与读取写者标志之间需要全序（seq_cst），
+ * 与写者“设置标志后检查槽位”构成Dekker式握手，保证两者至少有一方看到对方。
+ * @return 读锁守护对象
+ */
+BRLock::ReadGuard BRLock::read()
+{
+    std::atomic<int>* slot = local_slot();
+    while (true)
+    {
+        slot->fetch_add(1, std::memory_order_seq_cst);
+        if (!writer.load(std::memory_order_seq_cst)) return ReadGuard(slot);
+
+        slot->fetch_sub(1, std::memory_order_release);
+        std::lock_guard<std::mutex> wait_writer(write_mtx);
+    }
+}
+
+/**
+ * @brief 获取写锁
+ *
+ * @return 写锁守护对象
+ */
+BRLock::WriteGuard BRLock::write()
+{
+    write_mtx.lock();
+    writer.store(true, std::memory_order_seq_cst);
+    for (unsigned int i = 0; i <= slot_mask; ++i)
+    {
+        while (slots[i].readers.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+    }
+    return WriteGuard(this);
+}
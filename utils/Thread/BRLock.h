@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief 缓存行大小，用于填充以避免伪共享
+ */
+constexpr std::size_t CacheLineSize = 64;
+
+/**
+ * @brief 大读者锁类
+ *
+ * 为读多写极少的共享状态（目录、配置等每条查询都要访问的数据）设计的读写锁。
+ * 每个线程固定映射到一个独占缓存行的读者槽位，获取读锁只需对本槽位做一次原子加并检查写者标志，
+ * 没有写者时读者之间不共享任何被写入的缓存行。
+ * 写者代价较高：需要设置写者标志并等待所有槽位清零。
+ */
+class BRLock
+{
+  public:
+    /**
+     * @brief 读锁守护类
+     *
+     * 记录获取锁时使用的槽位，析构时在同一槽位上释放。
+     */
+    class ReadGuard
+    {
+        friend BRLock;
+
+      public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard(const ReadGuard&)            = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard();
+
+      private:
+        ReadGuard(std::atomic<int>* slot);
+
+        std::atomic<int>* slot;  ///< 获取读锁时使用的读者槽位
+    };
+
+    /**
+     * @brief 写锁守护类
+     */
+    class WriteGuard
+    {
+        friend BRLock;
+
+      public:
+        WriteGuard(WriteGuard&& other) noexcept;
+        WriteGuard(const WriteGuard&)            = delete;
+        WriteGuard& operator=(const WriteGuard&) = delete;
+        ~WriteGuard();
+
+      private:
+        WriteGuard(BRLock* lock);
+
+        BRLock* lock;  ///< 关联的大读者锁对象
+    };
+
+    /**
+     * @brief 构造函数
+     *
+     * 槽位数取硬件线程数向上取整到2的幂。
+     */
+    BRLock();
+
+    /**
+     * @brief 获取读锁
+     *
+     * 在本线程的槽位上登记，若发现写者则撤销登记，等待写者结束后重试。
+     * @return 读锁守护对象
+     */
+    ReadGuard read();
+
+    /**
+     * @brief 获取写锁
+     *
+     * 写者之间通过互斥锁串行化；设置写者标志后等待所有读者槽位清零。
+     * @return 写锁守护对象
+     */
+    WriteGuard write();
+
+  private:
+    /**
+     * @brief 独占一个缓存行的读者槽位
+     */
+    struct alignas(CacheLineSize) Slot
+    {
+        std::atomic<int> readers{0};  ///< 映射到该槽位的活跃读者数
+    };
+
+    /**
+     * @brief 当前线程使用的槽位
+     */
+    std::atomic<int>* local_slot();
+
+    std::unique_ptr<Slot[]> slots;      ///< 读者槽位数组
+    unsigned int            slot_mask;  ///< 槽位数减一
+    std::atomic<bool>       writer;     ///< 是否有写者持有或正在获取锁，读者只读不写
+    std::mutex              write_mtx;  ///< 写者互斥锁，读者遇到写者时也在其上阻塞等待
+};
@@ -0,0 +1,257 @@
+#include "IoScheduler.h"
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "ret.h"
+
+/**
+ * @brief 切换到线程池执行
+ *
+ * @param handle 挂起的协程
+ */
+void IoScheduler::ScheduleAwaiter::await_suspend(std::coroutine_handle<> handle) { scheduler->Resume(handle); }
+
+/**
+ * @brief fd就绪awaiter构造函数
+ *
+ * @param scheduler 所属调度器
+ * @param fd 文件描述符
+ * @param events 等待的epoll事件
+ */
+IoScheduler::IoAwaiter::IoAwaiter(IoScheduler* scheduler, int fd, unsigned int events)
+    : scheduler(scheduler), fd(fd), events(events), rc(RC::SUCCESS), handle(nullptr)
+{}
+
+/**
+ * @brief 向epoll注册一次性事件并挂起
+ *
+ * 注册成功后协程可能立刻在其他线程上被恢复，因此注册之后不能再访问本对象。
+ * @param handle 挂起的协程
+ * @return 注册失败时返回false，协程不挂起
+ */
+bool IoScheduler::IoAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    this->handle = handle;
+
+    epoll_event event{};
+    event.events   = events | EPOLLONESHOT;
+    event.data.ptr = this;
+
+    if (epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0) return true;
+    if (errno == ENOENT && epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0) return true;
+
+    rc = RC::OTHER_RET;
+    return false;
+}
+
+/**
+ * @brief 定时等待挂起
+ *
+ * @param handle 挂起的协程
+ */
+void IoScheduler::SleepAwaiter::await_suspend(std::coroutine_handle<> handle) { scheduler->AddTimer(deadline, handle); }
+
+/**
+ * @brief 协程I/O调度器构造函数
+ *
+ * @param pool 执行协程的线程池
+ */
+IoScheduler::IoScheduler(ThreadPool& pool) : pool(pool), stop(false)
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) throw std::runtime_error("Failed to create epoll instance");
+
+    epoll_event event{};
+    event.events   = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    reactor = std::thread(&IoScheduler::Reactor, this);
+}
+
+/**
+ * @brief 协程I/O调度器析构函数
+ */
+IoScheduler::~IoScheduler()
+{
+    stop = true;
+    Wake();
+    reactor.join();
+    close(wake_fd);
+    close(epoll_fd);
+}
+
+/**
+ * @brief 等待fd可读
+ *
+ * @param fd 文件描述符
+ */
+IoScheduler::IoAwaiter IoScheduler::Readable(int fd) { return IoAwaiter(this, fd, EPOLLIN | EPOLLRDHUP); }
+
+/**
+ * @brief 等待fd可写
+ *
+ * @param fd 文件描述符
+ */
+IoScheduler::IoAwaiter IoScheduler::Writable(int fd) { return IoAwaiter(this, fd, EPOLLOUT); }
+
+/**
+ * @brief 异步读
+ *
+ * @return 读取的字节数，0表示对端关闭，-1表示出错
+ */
+Task<ssize_t> IoScheduler::AsyncRead(int fd, void* buf, size_t len)
+{
+    while (true)
+    {
+        ssize_t n = read(fd, buf, len);
+        if (n >= 0) co_return n;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) co_return -1;
+        if (co_await Readable(fd) != RC::SUCCESS) co_return -1;
+    }
+}
+
+/**
+ * @brief 异步写
+ *
+ * @return 写入的字节数，-1表示出错
+ */
+Task<ssize_t> IoScheduler::AsyncWrite(int fd, const void* buf, size_t len)
+{
+    size_t written = 0;
+    while (written < len)
+    {
+        ssize_t n = write(fd, static_cast<const char*>(buf) + written, len - written);
+        if (n >= 0)
+        {
+            written += n;
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) co_return -1;
+        if (co_await Writable(fd) != RC::SUCCESS) co_return -1;
+    }
+    co_return static_cast<ssize_t>(written);
+}
+
+/**
+ * @brief 异步接受连接
+ *
+ * @return 新连接的fd，-1表示出错
+ */
+Task<int> IoScheduler::AsyncAccept(int listen_fd)
+{
+    while (true)
+    {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) co_return fd;
+        if (errno == EINTR || errno == ECONNABORTED) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) co_return -1;
+        if (co_await Readable(listen_fd) != RC::SUCCESS) co_return -1;
+    }
+}
+
+/**
+ * @brief 将fd设为非阻塞模式
+ *
+ * @return 成功返回RC::SUCCESS，否则返回RC::OTHER_RET
+ */
+RC IoScheduler::SetNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return RC::OTHER_RET;
+    return RC::SUCCESS;
+}
+
+/**
+ * @brief 把协程恢复提交到线程池
+ *
+ * @param handle 挂起的协程
+ */
+void IoScheduler::Resume(std::coroutine_handle<> handle)
+{
+    pool.Post([handle] { handle.resume(); });
+}
+
+/**
+ * @brief 添加定时器
+ *
+ * 新定时器早于原先最早的定时器时，唤醒反应器重新计算epoll_wait的超时。
+ */
+void IoScheduler::AddTimer(Clock::time_point deadline, std::coroutine_handle<> handle)
+{
+    bool earliest;
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex);
+        earliest = timers.empty() || deadline < timers.top().deadline;
+        timers.push(TimerEntry{deadline, handle});
+    }
+    if (earliest) Wake();
+}
+
+/**
+ * @brief 唤醒阻塞在epoll_wait上的反应器线程
+ */
+void IoScheduler::Wake()
+{
+    uint64_t one = 1;
+    ssize_t  ret = write(wake_fd, &one, sizeof(one));
+    (void)ret;
+}
+
+/**
+ * @brief 反应器线程主循环
+ *
+ * 等待fd事件或最早的定时器到期，把就绪的协程交给线程池恢复。
+ */
+void IoScheduler::Reactor()
+{
+    constexpr int MaxEvents = 64;
+    epoll_event   events[MaxEvents];
+
+    while (!stop)
+    {
+        int timeout = -1;
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            if (!timers.empty())
+            {
+                auto wait = timers.top().deadline - Clock::now();
+                timeout   = wait <= Clock::duration::zero()
+                                ? 0
+                                : std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+            }
+        }
+
+        int n = epoll_wait(epoll_fd, events, MaxEvents, timeout);
+        for (int i = 0; i < n; ++i)
+        {
+            if (events[i].data.ptr == nullptr)
+            {
+                uint64_t count;
+                ssize_t  ret = read(wake_fd, &count, sizeof(count));
+                (void)ret;
+                continue;
+            }
+            Resume(static_cast<IoAwaiter*>(events[i].data.ptr)->handle);
+        }
+
+        std::vector<std::coroutine_handle<>> expired;
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            auto                        now = Clock::now();
+            while (!timers.empty() && timers.top().deadline <= now)
+            {
+                expired.push_back(timers.top().handle);
+                timers.pop();
+            }
+        }
+        for (auto handle : expired) Resume(handle);
+    }
+}
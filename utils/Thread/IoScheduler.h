@@ -0,0 +1,281 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include "ThreadPool.h"
+#include "Task.h"
+
+enum class RC;
+
+namespace TaskDetail
+{
+    /**
+     * @brief 脱离调用者独立运行的协程
+     *
+     * 初始挂起，由IoScheduler::Spawn交给线程池启动；结束时自动销毁协程帧。
+     */
+    struct Detached
+    {
+        struct promise_type
+        {
+            Detached get_return_object()
+            {
+                return Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_never  final_suspend() const noexcept { return {}; }
+            void                return_void() const noexcept {}
+            void                unhandled_exception() const noexcept { std::terminate(); }
+        };
+
+        std::coroutine_handle<promise_type> handle;  ///< 协程句柄
+    };
+
+    /**
+     * @brief 运行任务并把结果或异常写入promise
+     */
+    template <class T>
+    Detached RunDetached(Task<T> task, std::promise<T> result)
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                co_await task;
+                result.set_value();
+            }
+            else
+                result.set_value(co_await task);
+        } catch (...)
+        {
+            result.set_exception(std::current_exception());
+        }
+    }
+}  // namespace TaskDetail
+
+/**
+ * @brief 协程I/O调度器
+ *
+ * 在ThreadPool之上运行Task协程：协程在等待socket/磁盘就绪或定时器时挂起，不占用工作线程，
+ * 事件就绪后由反应器线程把协程的恢复提交回线程池。
+ * 这样一个工作线程可以交替推进大量进行中的请求，而不是阻塞在read()上。
+ *
+ * 反应器基于epoll（EPOLLONESHOT）实现，同一fd同一时刻只能有一个协程在等待。
+ * 析构时仍挂起的协程不会被恢复。
+ */
+class IoScheduler
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 切换到线程池执行的awaiter
+     */
+    class ScheduleAwaiter
+    {
+        friend IoScheduler;
+
+      public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+
+      private:
+        ScheduleAwaiter(IoScheduler* scheduler) : scheduler(scheduler) {}
+
+        IoScheduler* scheduler;  ///< 所属调度器
+    };
+
+    /**
+     * @brief 等待fd可读/可写的awaiter
+     *
+     * co_await的结果为RC::SUCCESS表示fd已就绪（或出错/对端关闭，由后续读写得到具体错误），
+     * 注册失败时为RC::OTHER_RET。
+     */
+    class IoAwaiter
+    {
+        friend IoScheduler;
+
+      public:
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        RC   await_resume() const noexcept { return rc; }
+
+      private:
+        IoAwaiter(IoScheduler* scheduler, int fd, unsigned int events);
+
+        IoScheduler*            scheduler;  ///< 所属调度器
+        int                     fd;         ///< 等待的文件描述符
+        unsigned int            events;     ///< 等待的epoll事件
+        RC                      rc;         ///< 等待结果
+        std::coroutine_handle<> handle;     ///< 挂起的协程
+    };
+
+    /**
+     * @brief 定时等待的awaiter
+     */
+    class SleepAwaiter
+    {
+        friend IoScheduler;
+
+      public:
+        bool await_ready() const noexcept { return deadline <= Clock::now(); }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+
+      private:
+        SleepAwaiter(IoScheduler* scheduler, Clock::time_point deadline) : scheduler(scheduler), deadline(deadline) {}
+
+        IoScheduler*      scheduler;  ///< 所属调度器
+        Clock::time_point deadline;   ///< 唤醒时间
+    };
+
+    /**
+     * @brief 构造函数
+     *
+     * 创建epoll实例并启动反应器线程。
+     *
+     * @param pool 执行协程的线程池
+     */
+    IoScheduler(ThreadPool& pool);
+
+    /**
+     * @brief 析构函数
+     *
+     * 停止反应器线程。
+     */
+    ~IoScheduler();
+
+    IoScheduler(const IoScheduler&)            = delete;
+    IoScheduler& operator=(const IoScheduler&) = delete;
+
+    /**
+     * @brief 在线程池上启动一个协程任务
+     *
+     * @tparam T 任务返回值类型
+     * @param task 协程任务
+     * @return std::future<T> 任务的返回值
+     */
+    template <class T>
+    std::future<T> Spawn(Task<T> task);
+
+    /**
+     * @brief 切换到线程池执行
+     */
+    ScheduleAwaiter Schedule() { return ScheduleAwaiter(this); }
+
+    /**
+     * @brief 等待fd可读
+     *
+     * @param fd 文件描述符
+     */
+    IoAwaiter Readable(int fd);
+
+    /**
+     * @brief 等待fd可写
+     *
+     * @param fd 文件描述符
+     */
+    IoAwaiter Writable(int fd);
+
+    /**
+     * @brief 挂起一段时间
+     *
+     * @param duration 挂起时长
+     */
+    SleepAwaiter Sleep(Clock::duration duration) { return SleepAwaiter(this, Clock::now() + duration); }
+
+    /**
+     * @brief 异步读，fd需为非阻塞模式
+     *
+     * @return 读取的字节数，0表示对端关闭，-1表示出错（errno有效）
+     */
+    Task<ssize_t> AsyncRead(int fd, void* buf, size_t len);
+
+    /**
+     * @brief 异步写，写完全部数据或出错时返回，fd需为非阻塞模式
+     *
+     * @return 写入的字节数，-1表示出错（errno有效）
+     */
+    Task<ssize_t> AsyncWrite(int fd, const void* buf, size_t len);
+
+    /**
+     * @brief 异步接受连接，监听fd需为非阻塞模式
+     *
+     * @return 新连接的fd（已设为非阻塞），-1表示出错（errno有效）
+     */
+    Task<int> AsyncAccept(int listen_fd);
+
+    /**
+     * @brief 将fd设为非阻塞模式
+     *
+     * @return 成功返回RC::SUCCESS
+     */
+    static RC SetNonBlocking(int fd);
+
+  private:
+    /**
+     * @brief 定时器项
+     */
+    struct TimerEntry
+    {
+        Clock::time_point       deadline;  ///< 唤醒时间
+        std::coroutine_handle<> handle;    ///< 挂起的协程
+
+        bool operator>(const TimerEntry& other) const { return deadline > other.deadline; }
+    };
+
+    using TimerHeap = std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>>;
+
+    /**
+     * @brief 把协程恢复提交到线程池
+     */
+    void Resume(std::coroutine_handle<> handle);
+
+    /**
+     * @brief 添加定时器，必要时唤醒反应器重新计算等待时间
+     */
+    void AddTimer(Clock::time_point deadline, std::coroutine_handle<> handle);
+
+    /**
+     * @brief 唤醒阻塞在epoll_wait上的反应器线程
+     */
+    void Wake();
+
+    /**
+     * @brief 反应器线程主循环
+     */
+    void Reactor();
+
+    ThreadPool&       pool;         ///< 执行协程的线程池
+    int               epoll_fd;     ///< epoll实例
+    int               wake_fd;      ///< 唤醒反应器的eventfd
+    std::atomic<bool> stop;         ///< 停止标志
+    std::mutex        timer_mutex;  ///< 定时器堆的互斥锁
+    TimerHeap         timers;       ///< 定时器堆
+    std::thread       reactor;      ///< 反应器线程
+};
+
+/**
+ * @brief 在线程池上启动一个协程任务
+ *
+ * @tparam T 任务返回值类型
+ * @param task 协程任务
+ * @return std::future<T> 任务的返回值
+ */
+template <class T>
+std::future<T> IoScheduler::Spawn(Task<T> task)
+{
+    std::promise<T> result;
+    std::future<T>  future  = result.get_future();
+    auto            wrapper = TaskDetail::RunDetached(std::move(task), std::move(result));
+    Resume(wrapper.handle);
+    return future;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @brief 乐观版本锁类
+ *
+ * 读者不写共享内存：读前记录版本号，读完后校验版本号未变即可认为读到了一致的数据，
+ * 否则重试。写者通过独占模式修改数据，释放时版本号加一。
+ * 是索引结构中乐观锁耦合（optimistic lock coupling）的基础：遍历路径上的读者不会使内部节点的缓存行失效。
+ *
+ * 版本字布局：第0位为废弃位（节点已被删除/合并，持有者应从头重试），第1位为独占位，其余位为版本计数。
+ *
+ * 注意：乐观读期间被保护的数据可能被并发修改，读者只能读取到局部变量，
+ * 在validate成功之前不得解引用读到的指针或依赖读到的值做不可撤销的操作。
+ */
+class OptLock
+{
+  public:
+    static constexpr uint64_t ObsoleteBit = 1;  ///< 废弃位
+    static constexpr uint64_t LockedBit   = 2;  ///< 独占位
+
+    OptLock() : version{0} {}
+    OptLock(const OptLock&)            = delete;
+    OptLock& operator=(const OptLock&) = delete;
+
+    /**
+     * @brief 开始一次乐观读
+     *
+     * 若当前处于独占状态则自旋等待。
+     * @param v 输出读开始时的版本号
+     * @return 锁已废弃时返回false，调用者应重试整个操作
+     */
+    bool read_begin(uint64_t& v) const
+    {
+        v = version.load(std::memory_order_acquire);
+        for (unsigned int spin = 0; v & LockedBit; ++spin)
+        {
+            if (spin >= 64) std::this_thread::yield();
+            v = version.load(std::memory_order_acquire);
+        }
+        return !(v & ObsoleteBit);
+    }
+
+    /**
+     * @brief 校验乐观读期间版本号未变化
+     *
+     * @param v read_begin得到的版本号
+     * @return 期间没有写者修改过数据时返回true
+     */
+    bool validate(uint64_t v) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version.load(std::memory_order_relaxed) == v;
+    }
+
+    /**
+     * @brief 将乐观读升级为独占
+     *
+     * @param v read_begin得到的版本号
+     * @return 版本号未变化且成功加锁时返回true，否则调用者应重试
+     */
+    bool upgrade(uint64_t v)
+    {
+        return version.compare_exchange_strong(v, v + LockedBit, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 以独占模式加锁
+     *
+     * @return 锁已废弃时返回false且不持有锁
+     */
+    bool lock()
+    {
+        while (true)
+        {
+            uint64_t v;
+            if (!read_begin(v)) return false;
+            if (upgrade(v)) return true;
+        }
+    }
+
+    /**
+     * @brief 尝试以独占模式加锁，不等待
+     *
+     * @return 成功加锁时返回true
+     */
+    bool try_lock()
+    {
+        uint64_t v = version.load(std::memory_order_relaxed);
+        if (v & (LockedBit | ObsoleteBit)) return false;
+        return upgrade(v);
+    }
+
+    /**
+     * @brief 释放独占，版本号加一
+     */
+    void unlock() { version.fetch_add(LockedBit, std::memory_order_release); }
+
+    /**
+     * @brief 释放独占并标记为废弃
+     *
+     * 之后所有read_begin/lock都会失败，持有旧版本号的读者校验也会失败。
+     */
+    void unlock_obsolete() { version.fetch_add(LockedBit | ObsoleteBit, std::memory_order_release); }
+
+    /**
+     * @brief 是否处于独占状态
+     */
+    bool is_locked() const { return version.load(std::memory_order_relaxed) & LockedBit; }
+
+    /**
+     * @brief 是否已废弃
+     */
+    bool is_obsolete() const { return version.load(std::memory_order_relaxed) & ObsoleteBit; }
+
+  private:
+    std::atomic<uint64_t> version;  ///< 版本字
+};
@@ -1,80 +1,295 @@
 #include "ReWrLock.h"
+#include "ret.h"
 
 /**
  * @brief 读锁守护构造函数
  *
- * @param lock 读写锁对象
+ * @param lock 读写锁对象，为nullptr表示未获取到锁
  */
-ReadGuard::ReadGuard(ReWrLock& lock) : lock{lock} {}
+ReadGuard::ReadGuard(ReWrLock* lock) : lock{lock} {}
+
+/**
+ * @brief 读锁守护移动构造函数
+ *
+ * @param other 被移动的守护对象
+ */
+ReadGuard::ReadGuard(ReadGuard&& other) noexcept : lock{other.lock} { other.lock = nullptr; }
 
 /**
  * @brief 写锁守护构造函数
  *
- * @param lock 读写锁对象
+ * @param lock 读写锁对象，为nullptr表示未获取到锁
+ */
+WriteGuard::WriteGuard(ReWrLock* lock) : lock{lock} {}
+
+/**
+ * @brief 写锁守护移动构造函数
+ *
+ * @param other 被移动的守护对象
+ */
+WriteGuard::WriteGuard(WriteGuard&& other) noexcept : lock{other.lock} { other.lock = nullptr; }
+
+/**
+ * @brief 可升级读锁守护构造函数
+ *
+ * @param lock 读写锁对象，为nullptr表示未获取到锁
+ */
+UpgradeGuard::UpgradeGuard(ReWrLock* lock) : lock{lock} {}
+
+/**
+ * @brief 可升级读锁守护移动构造函数
+ *
+ * @param other 被移动的守护对象
  */
-WriteGuard::WriteGuard(ReWrLock& lock) : lock{lock} {}
+UpgradeGuard::UpgradeGuard(UpgradeGuard&& other) noexcept : lock{other.lock} { other.lock = nullptr; }
 
 /**
  * @brief 读写锁构造函数
  *
  * 初始化读写锁的读者和写者计数。
  */
-ReWrLock::ReWrLock() : reader_count{}, writer_count{} {}
+ReWrLock::ReWrLock()
+    : reader_count{}, writers_waiting{}, writer_active{}, upgrader_active{}, upgrading{}
+{}
 
 /**
  * @brief 获取读锁
  *
- * 如果存在写者，则等待。增加读者计数并返回读锁守护对象。
+ * 如果存在写者或有写者在等待，则等待。增加读者计数并返回读锁守护对象。
  * @return 读锁守护对象
  */
 ReadGuard ReWrLock::read()
 {
     std::unique_lock<std::mutex> lock_guard(mtx);
 
-    while (writer_count > 0) { cond_var.wait(lock_guard); }
+    reader_cv.wait(lock_guard, [this] { return can_read(); });
 
     ++reader_count;
-    ReadGuard guard(*this);
-    return guard;
+    return ReadGuard(this);
 }
 
 /**
  * @brief 获取写锁
  *
- * 如果存在读者或写者，则等待。增加写者计数并返回写锁守护对象。
+ * 登记为等待中的写者以阻止新的读者进入，等待读者、写者和可升级读者全部离开。
  * @return 写锁守护对象
  */
 WriteGuard ReWrLock::write()
 {
     std::unique_lock<std::mutex> lock_guard(mtx);
 
-    while (reader_count > 0 || writer_count > 0) { cond_var.wait(lock_guard); }
+    ++writers_waiting;
+    writer_cv.wait(lock_guard, [this] { return can_write(); });
+    --writers_waiting;
+
+    writer_active = true;
+    return WriteGuard(this);
+}
+
+/**
+ * @brief 获取可升级读锁
+ *
+ * @return 可升级读锁守护对象
+ */
+UpgradeGuard ReWrLock::upgradable_read()
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+
+    reader_cv.wait(lock_guard, [this] { return can_upgradable_read(); });
+
+    upgrader_active = true;
+    return UpgradeGuard(this);
+}
+
+/**
+ * @brief 尝试获取读锁，不等待
+ *
+ * @param rc 成功为RC::SUCCESS，否则为RC::LOCKED
+ * @return 读锁守护对象，失败时不持有锁
+ */
+ReadGuard ReWrLock::try_read(RC& rc)
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+
+    if (!can_read())
+    {
+        rc = RC::LOCKED;
+        return ReadGuard(nullptr);
+    }
+
+    ++reader_count;
+    rc = RC::SUCCESS;
+    return ReadGuard(this);
+}
+
+/**
+ * @brief 尝试获取写锁，不等待
+ *
+ * @param rc 成功为RC::SUCCESS，否则为RC::LOCKED
+ * @return 写锁守护对象，失败时不持有锁
+ */
+WriteGuard ReWrLock::try_write(RC& rc)
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+
+    if (!can_write())
+    {
+        rc = RC::LOCKED;
+        return WriteGuard(nullptr);
+    }
+
+    writer_active = true;
+    rc            = RC::SUCCESS;
+    return WriteGuard(this);
+}
+
+/**
+ * @brief 限时获取读锁
+ *
+ * @param timeout 最长等待时间
+ * @param rc 成功为RC::SUCCESS，超时为RC::LOCKED
+ * @return 读锁守护对象，超时时不持有锁
+ */
+ReadGuard ReWrLock::read_for(std::chrono::microseconds timeout, RC& rc)
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+
+    if (!reader_cv.wait_for(lock_guard, timeout, [this] { return can_read(); }))
+    {
+        rc = RC::LOCKED;
+        return ReadGuard(nullptr);
+    }
+
+    ++reader_count;
+    rc = RC::SUCCESS;
+    return ReadGuard(this);
+}
+
+/**
+ * @brief 限时获取写锁
+ *
+ * 超时放弃时，若已没有其他写者在等待，需要唤醒被本写者挡住的读者。
+ * @param timeout 最长等待时间
+ * @param rc 成功为RC::SUCCESS，超时为RC::LOCKED
+ * @return 写锁守护对象，超时时不持有锁
+ */
+WriteGuard ReWrLock::write_for(std::chrono::microseconds timeout, RC& rc)
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+
+    ++writers_waiting;
+    bool acquired = writer_cv.wait_for(lock_guard, timeout, [this] { return can_write(); });
+    --writers_waiting;
+
+    if (!acquired)
+    {
+        wake_after_writer();
+        rc = RC::LOCKED;
+        return WriteGuard(nullptr);
+    }
+
+    writer_active = true;
+    rc            = RC::SUCCESS;
+    return WriteGuard(this);
+}
+
+/**
+ * @brief 写者离开或放弃等待后唤醒下一批等待者
+ *
+ * 仍有写者在等待时只唤醒一个写者，否则唤醒所有读者和可升级读者。
+ */
+void ReWrLock::wake_after_writer()
+{
+    if (writers_waiting > 0)
+    {
+        if (can_write()) writer_cv.notify_one();
+    }
+    else
+        reader_cv.notify_all();
+}
+
+/**
+ * @brief 释放读锁
+ *
+ * 最后一个读者离开时，优先唤醒等待升级的可升级读者，其次唤醒一个写者。
+ */
+void ReWrLock::unlock_read()
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+    if (--reader_count > 0) return;
+
+    if (upgrading)
+        upgrade_cv.notify_one();
+    else if (writers_waiting > 0 && can_write())
+        writer_cv.notify_one();
+}
+
+/**
+ * @brief 释放写锁
+ */
+void ReWrLock::unlock_write()
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+    writer_active = false;
+    wake_after_writer();
+}
+
+/**
+ * @brief 释放可升级读锁
+ */
+void ReWrLock::unlock_upgradable_read()
+{
+    std::unique_lock<std::mutex> lock_guard(mtx);
+    upgrader_active = false;
+    wake_after_writer();
+}
+
+/**
+ * @brief 升级为写锁
+ *
+ * @return 写锁守护对象
+ */
+WriteGuard UpgradeGuard::upgrade()
+{
+    ReWrLock* target = lock;
+    lock             = nullptr;
+    if (!target) return WriteGuard(nullptr);
 
-    ++writer_count;
-    WriteGuard guard(*this);
-    return guard;
+    std::unique_lock<std::mutex> lock_guard(target->mtx);
+    target->upgrading = true;
+    target->upgrade_cv.wait(lock_guard, [target] { return target->reader_count == 0; });
+    target->upgrading       = false;
+    target->upgrader_active = false;
+    target->writer_active   = true;
+    return WriteGuard(target);
 }
 
 /**
  * @brief 读锁守护析构函数
  *
- * 在对象销毁时减少读者计数，如果没有读者，则通知等待的写者。
+ * 在对象销毁时减少读者计数，最后一个读者离开时唤醒等待的写者或升级者。
  */
 ReadGuard::~ReadGuard()
 {
-    std::unique_lock<std::mutex> lock_guard(lock.mtx);
-    --lock.reader_count;
-    if (lock.reader_count < 1) { lock.cond_var.notify_one(); }
+    if (lock) lock->unlock_read();
 }
 
 /**
  * @brief 写锁守护析构函数
  *
- * 在对象销毁时减少写者计数，通知所有等待的线程。
+ * 在对象销毁时释放写锁，唤醒下一个写者或所有读者。
  */
 WriteGuard::~WriteGuard()
 {
-    std::unique_lock<std::mutex> lock_guard(lock.mtx);
-    --lock.writer_count;
-    lock.cond_var.notify_all();
+    if (lock) lock->unlock_write();
+}
+
+/**
+ * @brief 可升级读锁守护析构函数
+ *
+ * 在对象销毁时释放可升级读锁。
+ */
+UpgradeGuard::~UpgradeGuard()
+{
+    if (lock) lock->unlock_upgradable_read();
 }
@@ -1,20 +1,28 @@
 #pragma once
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
 #include <stdio.h>
 
+enum class RC;
+
 class ReWrLock;
+class UpgradeGuard;
 
 /**
  * @brief 读锁守护类
  *
- * 用于管理读锁的生命周期。
+ * 用于管理读锁的生命周期。可移动，不可复制；try/限时获取失败时不持有锁。
  */
 class ReadGuard
 {
     friend ReWrLock;
 
   public:
+    ReadGuard(ReadGuard&& other) noexcept;
+    ReadGuard(const ReadGuard&)            = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
     /**
      * @brief 析构函数
      *
@@ -22,27 +30,37 @@ class ReadGuard
      */
     ~ReadGuard();
 
+    /**
+     * @brief 是否持有读锁
+     */
+    bool owns() const { return lock != nullptr; }
+
   private:
     /**
      * @brief 构造函数
      *
-     * @param lock 读写锁对象
+     * @param lock 读写锁对象，为nullptr表示未获取到锁
      */
-    ReadGuard(ReWrLock& lock);
+    ReadGuard(ReWrLock* lock);
 
-    ReWrLock& lock;  ///< 引用关联的读写锁对象
+    ReWrLock* lock;  ///< 关联的读写锁对象
 };
 
 /**
  * @brief 写锁守护类
  *
- * 用于管理写锁的生命周期。
+ * 用于管理写锁的生命周期。可移动，不可复制；try/限时获取失败时不持有锁。
  */
 class WriteGuard
 {
     friend ReWrLock;
+    friend UpgradeGuard;
 
   public:
+    WriteGuard(WriteGuard&& other) noexcept;
+    WriteGuard(const WriteGuard&)            = delete;
+    WriteGuard& operator=(const WriteGuard&) = delete;
+
     /**
      * @brief 析构函数
      *
@@ -50,32 +68,115 @@ class WriteGuard
      */
     ~WriteGuard();
 
+    /**
+     * @brief 是否持有写锁
+     */
+    bool owns() const { return lock != nullptr; }
+
   private:
     /**
      * @brief 构造函数
      *
-     * @param lock 读写锁对象
+     * @param lock 读写锁对象，为nullptr表示未获取到锁
      */
-    WriteGuard(ReWrLock& lock);
+    WriteGuard(ReWrLock* lock);
 
-    ReWrLock& lock;  ///< 引用关联的读写锁对象
+    ReWrLock* lock;  ///< 关联的读写锁对象
+};
+
+/**
+ * @brief 可升级读锁守护类
+ *
+ * 可升级读锁与普通读锁共存，但与写锁及其他可升级读锁互斥。
+ * 持有者可以在不释放锁的情况下升级为写锁，升级后本对象不再持有锁。
+ */
+class UpgradeGuard
+{
+    friend ReWrLock;
+
+  public:
+    UpgradeGuard(UpgradeGuard&& other) noexcept;
+    UpgradeGuard(const UpgradeGuard&)            = delete;
+    UpgradeGuard& operator=(const UpgradeGuard&) = delete;
+
+    /**
+     * @brief 析构函数
+     *
+     * 若未升级，在对象销毁时释放可升级读锁。
+     */
+    ~UpgradeGuard();
+
+    /**
+     * @brief 是否持有可升级读锁
+     */
+    bool owns() const { return lock != nullptr; }
+
+    /**
+     * @brief 升级为写锁
+     *
+     * 阻止新的读者进入，等待现有读者全部离开后获得写锁。
+     * @return 写锁守护对象
+     */
+    WriteGuard upgrade();
+
+  private:
+    /**
+     * @brief 构造函数
+     *
+     * @param lock 读写锁对象，为nullptr表示未获取到锁
+     */
+    UpgradeGuard(ReWrLock* lock);
+
+    ReWrLock* lock;  ///< 关联的读写锁对象
 };
 
 /**
  * @brief 读写锁类
  *
  * 提供读写锁的功能，允许多个读者或者单个写者访问资源。
+ * 采用写者优先策略：只要有写者在等待，新的读者就会阻塞，避免源源不断的读者饿死写者。
+ * 读者、写者、升级者分别在各自的条件变量上等待，释放锁时只唤醒应当被唤醒的一方。
  */
 class ReWrLock
 {
     friend WriteGuard;
     friend ReadGuard;
+    friend UpgradeGuard;
 
   private:
-    std::mutex              mtx;           ///< 互斥锁，用于保护共享资源
-    std::condition_variable cond_var;      ///< 条件变量，用于同步
-    int                     reader_count;  ///< 当前持有读锁的数量
-    int                     writer_count;  ///< 当前持有写锁的数量
+    std::mutex              mtx;              ///< 互斥锁，用于保护锁状态
+    std::condition_variable reader_cv;        ///< 读者与可升级读者等待的条件变量
+    std::condition_variable writer_cv;        ///< 写者等待的条件变量
+    std::condition_variable upgrade_cv;       ///< 升级者等待读者离开的条件变量
+    int                     reader_count;     ///< 当前持有读锁的数量
+    int                     writers_waiting;  ///< 正在等待写锁的数量
+    bool                    writer_active;    ///< 是否有写者持有锁
+    bool                    upgrader_active;  ///< 是否有可升级读者持有锁
+    bool                    upgrading;        ///< 可升级读者是否正在等待升级
+
+    /**
+     * @brief 读者能否进入（调用者需持有mtx）
+     */
+    bool can_read() const { return !writer_active && writers_waiting == 0 && !upgrading; }
+
+    /**
+     * @brief 可升级读者能否进入（调用者需持有mtx）
+     */
+    bool can_upgradable_read() const { return can_read() && !upgrader_active; }
+
+    /**
+     * @brief 写者能否进入（调用者需持有mtx）
+     */
+    bool can_write() const { return !writer_active && reader_count == 0 && !upgrader_active; }
+
+    /**
+     * @brief 写者离开或放弃等待后唤醒下一批等待者（调用者需持有mtx）
+     */
+    void wake_after_writer();
+
+    void unlock_read();
+    void unlock_write();
+    void unlock_upgradable_read();
 
   public:
     /**
@@ -88,7 +189,7 @@ class ReWrLock
     /**
      * @brief 获取读锁
      *
-     * 如果存在写者，则等待。
+     * 如果存在写者或有写者在等待，则等待。
      * @return 读锁守护对象
      */
     ReadGuard read();
@@ -100,4 +201,46 @@ class ReWrLock
      * @return 写锁守护对象
      */
     WriteGuard write();
+
+    /**
+     * @brief 获取可升级读锁
+     *
+     * 如果存在写者、有写者在等待或已有可升级读者，则等待。
+     * @return 可升级读锁守护对象
+     */
+    UpgradeGuard upgradable_read();
+
+    /**
+     * @brief 尝试获取读锁，不等待
+     *
+     * @param rc 成功为RC::SUCCESS，否则为RC::LOCKED
+     * @return 读锁守护对象，失败时不持有锁
+     */
+    ReadGuard try_read(RC& rc);
+
+    /**
+     * @brief 尝试获取写锁，不等待
+     *
+     * @param rc 成功为RC::SUCCESS，否则为RC::LOCKED
+     * @return 写锁守护对象，失败时不持有锁
+     */
+    WriteGuard try_write(RC& rc);
+
+    /**
+     * @brief 限时获取读锁
+     *
+     * @param timeout 最长等待时间
+     * @param rc 成功为RC::SUCCESS，超时为RC::LOCKED
+     * @return 读锁守护对象，超时时不持有锁
+     */
+    ReadGuard read_for(std::chrono::microseconds timeout, RC& rc);
+
+    /**
+     * @brief 限时获取写锁
+     *
+     * @param timeout 最长等待时间
+     * @param rc 成功为RC::SUCCESS，超时为RC::LOCKED
+     * @return 写锁守护对象，超时时不持有锁
+     */
+    WriteGuard write_for(std::chrono::microseconds timeout, RC& rc);
 };
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+template <class T>
+class Task;
+
+namespace TaskDetail
+{
+    /**
+     * @brief 协程结束时恢复等待者的awaiter
+     *
+     * 通过对称转移直接切换到等待者，避免嵌套调用导致栈增长。
+     */
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+        {
+            auto continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Task的promise公共部分
+     */
+    struct PromiseBase
+    {
+        std::coroutine_handle<> continuation;  ///< 等待本协程结束的协程
+        std::exception_ptr      exception;     ///< 协程体抛出的异常
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter        final_suspend() const noexcept { return {}; }
+        void                unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+}  // namespace TaskDetail
+
+/**
+ * @brief 协程任务类
+ *
+ * 惰性启动：创建后不执行，直到被co_await或交给IoScheduler::Spawn。
+ * 被co_await时，任务结束后通过对称转移恢复等待者，协程体抛出的异常在co_await处重新抛出。
+ *
+ * @tparam T 协程返回值类型
+ */
+template <class T = void>
+class Task
+{
+  public:
+    struct promise_type : TaskDetail::PromiseBase
+    {
+        std::optional<T> value;  ///< 协程返回值
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        template <class U>
+        void return_value(U&& result)
+        {
+            value.emplace(std::forward<U>(result));
+        }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume()
+    {
+        if (handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+        return std::move(*handle.promise().value);
+    }
+
+  private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;  ///< 协程句柄
+};
+
+/**
+ * @brief 无返回值的协程任务类
+ */
+template <>
+class Task<void>
+{
+  public:
+    struct promise_type : TaskDetail::PromiseBase
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_void() const noexcept {}
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    void await_resume()
+    {
+        if (handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+    }
+
+  private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;  ///< 协程句柄
+};
@@ -1,4 +1,10 @@
 #include "ThreadPool.h"
+#include <algorithm>
+
+/**
+ * @brief 当前线程所属的线程池，非工作线程为nullptr
+ */
+static thread_local ThreadPool* CurrentPool = nullptr;
 
 /**
  * @brief 线程入口函数
@@ -8,20 +14,71 @@
  */
 void* ThreadEntry(void* args)
 {
-    auto* Pool = static_cast<ThreadPool*>(args);
+    auto* Pool  = static_cast<ThreadPool*>(args);
+    CurrentPool = Pool;
     Pool->Run();
     return nullptr;
 }
 
+/**
+ * @brief 监控线程入口函数
+ *
+ * @param args 线程池对象
+ * @return void* 返回值
+ */
+void* MonitorEntry(void* args)
+{
+    auto* Pool = static_cast<ThreadPool*>(args);
+    Pool->Monitor();
+    return nullptr;
+}
+
+/**
+ * @brief 阻塞登记守护构造函数
+ *
+ * @param pool 登记阻塞的线程池，可以为nullptr
+ */
+ThreadPool::BlockingGuard::BlockingGuard(ThreadPool* pool) : Pool(pool)
+{
+    if (Pool) Pool->BeginBlocking();
+}
+
+/**
+ * @brief 阻塞登记守护移动构造函数
+ *
+ * @param other 被移动的守护对象
+ */
+ThreadPool::BlockingGuard::BlockingGuard(BlockingGuard&& other) noexcept : Pool(other.Pool) { other.Pool = nullptr; }
+
+/**
+ * @brief 阻塞登记守护析构函数
+ */
+ThreadPool::BlockingGuard::~BlockingGuard()
+{
+    if (Pool) Pool->EndBlocking();
+}
+
 /**
  * @brief 线程池构造函数
  *
  * @param ThreadNum 线程池中的线程数量
  */
-ThreadPool::ThreadPool(unsigned int ThreadNum) : Stop(0), ActiveTasks(0)
+ThreadPool::ThreadPool(unsigned int ThreadNum)
+    : Stop(0),
+      ActiveTasks(0),
+      TargetThreads(std::max(ThreadNum, 1u)),
+      MinThreads(TargetThreads),
+      MaxThreads(TargetThreads * 4),
+      IdleWorkers(0),
+      BlockedWorkers(0),
+      Adaptive(0),
+      Options{},
+      MonitorThread{},
+      WaitTotal{},
+      WaitSamples(0)
 {
-    Workers.resize(ThreadNum);
-    for (auto& Worker : Workers) { pthread_create(&Worker, nullptr, ThreadEntry, this); }
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    SpawnWorkers();
 }
 
 /**
@@ -29,41 +86,83 @@ ThreadPool::ThreadPool(unsigned int ThreadNum) : Stop(0), ActiveTasks(0)
  */
 ThreadPool::~ThreadPool()
 {
+    DisableAdaptive();
+    std::vector<pthread_t> Threads;
     {
         std::unique_lock<std::mutex> Lock(QueueMutex);
         Stop = 1;
+        Threads.swap(Workers);
+        Threads.insert(Threads.end(), Retired.begin(), Retired.end());
+        Retired.clear();
     }
     CondVar.notify_all();
-    for (auto& Worker : Workers) { pthread_join(Worker, nullptr); }
+    for (auto& Worker : Threads) { pthread_join(Worker, nullptr); }
 }
 
 /**
  * @brief 运行线程池中的线程
  *
  * 线程从任务队列中获取任务并执行。
+ * 当可运行线程多于目标值，或自适应模式下空闲超时，线程退出。
  */
 void ThreadPool::Run()
 {
+    std::unique_lock<std::mutex> Lock(QueueMutex);
     while (true)
     {
-        std::function<void()> Task;
+        auto Ready    = [this] { return Stop || !Tasks.empty() || ShouldRetire(); };
+        bool TimedOut = false;
+        ++IdleWorkers;
+        if (Adaptive)
+            TimedOut = !CondVar.wait_for(Lock, Options.KeepAlive, Ready);
+        else
+            CondVar.wait(Lock, Ready);
+        --IdleWorkers;
+
+        if (Stop && Tasks.empty()) break;
+        if (!Stop && ShouldRetire())
         {
-            std::unique_lock<std::mutex> Lock(QueueMutex);
-            CondVar.wait(Lock, [this] { return Stop || !Tasks.empty(); });
-            if (Stop && Tasks.empty()) break;
-            Task = std::move(Tasks.front());
-            Tasks.pop();
-            ++ActiveTasks;
+            RetireSelf();
+            break;
         }
-        Task();
+        if (TimedOut && Tasks.empty() && TargetThreads > MinThreads)
         {
-            std::unique_lock<std::mutex> Lock(QueueMutex);
-            --ActiveTasks;
-            if (ActiveTasks == 0 && Tasks.empty()) FinishedVar.notify_all();
+            --TargetThreads;
+            RetireSelf();
+            break;
         }
+        if (Tasks.empty()) continue;
+
+        TaskItem Task = std::move(Tasks.front());
+        Tasks.pop();
+        ++ActiveTasks;
+        WaitTotal += Clock::now() - Task.EnqueueTime;
+        ++WaitSamples;
+
+        Lock.unlock();
+        Task.Func();
+        Lock.lock();
+
+        --ActiveTasks;
+        if (ActiveTasks == 0 && Tasks.empty()) FinishedVar.notify_all();
     }
 }
 
+/**
+ * @brief 提交不需要返回值的任务
+ *
+ * @param Func 任务函数
+ */
+void ThreadPool::Post(std::function<void()> Func)
+{
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        Tasks.push(TaskItem{std::move(Func), Clock::now()});
+        MaybeCompensate();
+    }
+    CondVar.notify_one();
+}
+
 /**
  * @brief 同步等待所有任务完成
  */
@@ -87,3 +186,180 @@ void ThreadPool::StopPool()
     CondVar.notify_all();
     Sync();
 }
+
+/**
+ * @brief 调整线程池的目标线程数
+ *
+ * @param ThreadNum 新的目标线程数，至少为1
+ */
+void ThreadPool::Resize(unsigned int ThreadNum)
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    if (Stop) return;
+    TargetThreads = std::max(ThreadNum, 1u);
+    MinThreads    = std::min(MinThreads, TargetThreads);
+    MaxThreads    = std::max(MaxThreads, TargetThreads);
+    SpawnWorkers();
+    CondVar.notify_all();
+    ReapRetired(Lock);
+}
+
+/**
+ * @brief 开启自适应模式
+ *
+ * @param options 自适应模式参数
+ */
+void ThreadPool::EnableAdaptive(const AdaptiveOptions& options)
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    if (Stop || Adaptive) return;
+    Options            = options;
+    Options.MinThreads = std::max(Options.MinThreads, 1u);
+    Options.MaxThreads = std::max(Options.MaxThreads, Options.MinThreads);
+    MinThreads         = Options.MinThreads;
+    MaxThreads         = Options.MaxThreads;
+    TargetThreads      = std::clamp(TargetThreads, MinThreads, MaxThreads);
+    WaitTotal          = Clock::duration::zero();
+    WaitSamples        = 0;
+    Adaptive           = true;
+    SpawnWorkers();
+    pthread_create(&MonitorThread, nullptr, MonitorEntry, this);
+    CondVar.notify_all();
+}
+
+/**
+ * @brief 关闭自适应模式
+ */
+void ThreadPool::DisableAdaptive()
+{
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        if (!Adaptive) return;
+        Adaptive = false;
+    }
+    MonitorVar.notify_all();
+    pthread_join(MonitorThread, nullptr);
+}
+
+/**
+ * @brief 获取当前存活的工作线程数
+ */
+unsigned int ThreadPool::Size()
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    return Workers.size();
+}
+
+/**
+ * @brief 登记当前工作线程进入阻塞
+ *
+ * 顺便回收已退出的线程：调用者即将阻塞，回收的等待不会影响吞吐。
+ */
+void ThreadPool::BeginBlocking()
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    ++BlockedWorkers;
+    MaybeCompensate();
+    ReapRetired(Lock);
+}
+
+/**
+ * @brief 取消当前工作线程的阻塞登记
+ *
+ * 若此时可运行线程多于目标值，唤醒一个空闲线程使其退出。
+ */
+void ThreadPool::EndBlocking()
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    --BlockedWorkers;
+    if (ShouldRetire()) CondVar.notify_one();
+}
+
+/**
+ * @brief 为当前线程登记一段阻塞区间
+ *
+ * @return 阻塞登记守护对象
+ */
+ThreadPool::BlockingGuard ThreadPool::ManagedBlock() { return BlockingGuard(CurrentPool); }
+
+/**
+ * @brief 创建工作线程，直到存活线程数达到目标值
+ */
+void ThreadPool::SpawnWorkers()
+{
+    while (!Stop && Workers.size() < TargetThreads + BlockedWorkers && Workers.size() < MaxThreads)
+    {
+        pthread_t Worker;
+        if (pthread_create(&Worker, nullptr, ThreadEntry, this) != 0) break;
+        Workers.push_back(Worker);
+    }
+}
+
+/**
+ * @brief 存在排队任务但没有空闲线程时补充线程
+ */
+void ThreadPool::MaybeCompensate()
+{
+    if (BlockedWorkers == 0 || IdleWorkers > 0 || Tasks.empty()) return;
+    SpawnWorkers();
+}
+
+/**
+ * @brief 判断当前是否有多余的可运行线程
+ */
+bool ThreadPool::ShouldRetire() const { return Workers.size() > TargetThreads + BlockedWorkers; }
+
+/**
+ * @brief 将当前线程从存活列表移入待回收列表
+ */
+void ThreadPool::RetireSelf()
+{
+    pthread_t Self = pthread_self();
+    auto      It   = std::find_if(Workers.begin(), Workers.end(), [Self](pthread_t T) { return pthread_equal(T, Self); });
+    if (It == Workers.end()) return;
+    Workers.erase(It);
+    Retired.push_back(Self);
+}
+
+/**
+ * @brief 回收已退出的线程
+ *
+ * @param Lock 已持有的QueueMutex锁，回收期间会暂时释放
+ */
+void ThreadPool::ReapRetired(std::unique_lock<std::mutex>& Lock)
+{
+    if (Retired.empty()) return;
+    std::vector<pthread_t> Reaped;
+    Reaped.swap(Retired);
+    Lock.unlock();
+    for (auto& Worker : Reaped) { pthread_join(Worker, nullptr); }
+    Lock.lock();
+}
+
+/**
+ * @brief 监控线程主循环
+ *
+ * 每个采样周期计算出队任务的平均排队时间（队首任务的已等待时间也计入），
+ * 超过阈值且没有空闲线程时将目标线程数加一。
+ */
+void ThreadPool::Monitor()
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    while (true)
+    {
+        MonitorVar.wait_for(Lock, Options.SampleInterval, [this] { return Stop || !Adaptive; });
+        if (Stop || !Adaptive) break;
+
+        Clock::duration AvgWait = WaitSamples ? WaitTotal / WaitSamples : Clock::duration::zero();
+        if (!Tasks.empty()) AvgWait = std::max(AvgWait, Clock::now() - Tasks.front().EnqueueTime);
+        WaitTotal   = Clock::duration::zero();
+        WaitSamples = 0;
+
+        if (AvgWait > Options.WaitThreshold && IdleWorkers == 0 && TargetThreads < MaxThreads)
+        {
+            ++TargetThreads;
+            SpawnWorkers();
+        }
+        ReapRetired(Lock);
+    }
+}
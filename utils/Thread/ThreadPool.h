@@ -9,6 +9,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <type_traits>
+#include <chrono>
 
 /**
  * @brief 类型定义，用于获取函数的返回类型
@@ -19,18 +20,80 @@ using RetType = typename std::invoke_result<F, Args...>::type;
 /**
  * @brief 线程池类
  *
- * 提供一个固定数量的线程来执行任务，支持任务的异步提交和同步等待。
+ * 提供一组工作线程来执行任务，支持任务的异步提交和同步等待。
+ * 线程数量可以在运行时调整，也可以开启自适应模式，由监控线程根据任务排队时间增加线程、
+ * 由空闲超时的线程自行退出。
+ * 工作线程在执行可能阻塞的操作（磁盘、网络）前可以登记阻塞，线程池会临时补充线程，
+ * 保证可运行的线程数不低于目标值。
  */
 class ThreadPool
 {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 自适应模式参数
+     */
+    struct AdaptiveOptions
+    {
+        unsigned int              MinThreads;           ///< 线程数下限
+        unsigned int              MaxThreads;           ///< 线程数上限
+        std::chrono::microseconds WaitThreshold{1000};  ///< 平均排队时间超过该值时增加线程
+        std::chrono::milliseconds KeepAlive{5000};      ///< 线程空闲超过该时间后退出
+        std::chrono::milliseconds SampleInterval{100};  ///< 监控线程采样周期
+    };
+
+    /**
+     * @brief 阻塞登记守护类
+     *
+     * 构造时登记当前工作线程进入阻塞，析构时取消登记。
+     * 若当前线程不属于任何线程池，则不做任何事。
+     */
+    class BlockingGuard
+    {
+        friend ThreadPool;
+
+      public:
+        BlockingGuard(BlockingGuard&& other) noexcept;
+        BlockingGuard(const BlockingGuard&)            = delete;
+        BlockingGuard& operator=(const BlockingGuard&) = delete;
+        ~BlockingGuard();
+
+      private:
+        BlockingGuard(ThreadPool* pool);
+
+        ThreadPool* Pool;  ///< 登记阻塞的线程池
+    };
+
   private:
-    std::vector<pthread_t>            Workers;      ///< 工作线程
-    std::queue<std::function<void()>> Tasks;        ///< 任务队列
-    std::mutex                        QueueMutex;   ///< 任务队列的互斥锁
-    std::condition_variable           CondVar;      ///< 任务队列的条件变量
-    std::condition_variable           FinishedVar;  ///< 所有任务完成的条件变量
-    bool                              Stop;         ///< 停止线程池的标志
-    unsigned int                      ActiveTasks;  ///< 活跃任务计数
+    /**
+     * @brief 任务队列中的元素
+     */
+    struct TaskItem
+    {
+        std::function<void()> Func;         ///< 任务函数
+        Clock::time_point     EnqueueTime;  ///< 入队时间，用于统计排队时间
+    };
+
+    std::vector<pthread_t>  Workers;         ///< 存活的工作线程
+    std::vector<pthread_t>  Retired;         ///< 已退出但尚未回收的工作线程
+    std::queue<TaskItem>    Tasks;           ///< 任务队列
+    std::mutex              QueueMutex;      ///< 任务队列的互斥锁
+    std::condition_variable CondVar;         ///< 任务队列的条件变量
+    std::condition_variable FinishedVar;     ///< 所有任务完成的条件变量
+    std::condition_variable MonitorVar;      ///< 监控线程的条件变量
+    bool                    Stop;            ///< 停止线程池的标志
+    unsigned int            ActiveTasks;     ///< 活跃任务计数
+    unsigned int            TargetThreads;   ///< 目标可运行线程数
+    unsigned int            MinThreads;      ///< 线程数下限
+    unsigned int            MaxThreads;      ///< 线程数上限（含阻塞补偿线程）
+    unsigned int            IdleWorkers;     ///< 正在等待任务的线程数
+    unsigned int            BlockedWorkers;  ///< 登记阻塞的线程数
+    bool                    Adaptive;        ///< 是否开启自适应模式
+    AdaptiveOptions         Options;         ///< 自适应模式参数
+    pthread_t               MonitorThread;   ///< 监控线程
+    Clock::duration         WaitTotal;       ///< 采样周期内出队任务的排队时间总和
+    long                    WaitSamples;     ///< 采样周期内出队任务数
 
   public:
     /**
@@ -59,6 +122,15 @@ class ThreadPool
     template <class F, class... Args>
     std::future<RetType<F, Args...>> EnQueue(F&& ThFunc, Args&&... args);
 
+    /**
+     * @brief 提交不需要返回值的任务
+     *
+     * 不创建future，开销低于EnQueue，供协程恢复等内部调度使用。
+     *
+     * @param Func 任务函数
+     */
+    void Post(std::function<void()> Func);
+
     /**
      * @brief 运行线程池中的线程
      *
@@ -77,6 +149,90 @@ class ThreadPool
      * 停止所有线程并等待所有任务完成。
      */
     void StopPool();
+
+    /**
+     * @brief 调整线程池的目标线程数
+     *
+     * 增大时立即创建线程，减小时多余的线程在执行完当前任务后退出。
+     *
+     * @param ThreadNum 新的目标线程数，至少为1
+     */
+    void Resize(unsigned int ThreadNum);
+
+    /**
+     * @brief 开启自适应模式
+     *
+     * 启动监控线程，当任务平均排队时间超过阈值时增加线程，空闲超时的线程自行退出。
+     *
+     * @param options 自适应模式参数
+     */
+    void EnableAdaptive(const AdaptiveOptions& options);
+
+    /**
+     * @brief 关闭自适应模式
+     *
+     * 停止监控线程，线程数保持当前值。
+     */
+    void DisableAdaptive();
+
+    /**
+     * @brief 获取当前存活的工作线程数
+     */
+    unsigned int Size();
+
+    /**
+     * @brief 登记当前工作线程进入阻塞
+     *
+     * 若有任务排队且没有空闲线程，则补充一个线程。应与EndBlocking成对调用，推荐使用ManagedBlock。
+     */
+    void BeginBlocking();
+
+    /**
+     * @brief 取消当前工作线程的阻塞登记
+     */
+    void EndBlocking();
+
+    /**
+     * @brief 为当前线程登记一段阻塞区间
+     *
+     * @return 阻塞登记守护对象，析构时取消登记
+     */
+    static BlockingGuard ManagedBlock();
+
+  private:
+    /**
+     * @brief 创建工作线程，直到存活线程数达到目标值（调用者需持有QueueMutex）
+     */
+    void SpawnWorkers();
+
+    /**
+     * @brief 存在排队任务但没有空闲线程时补充线程（调用者需持有QueueMutex）
+     */
+    void MaybeCompensate();
+
+    /**
+     * @brief 判断当前是否有多余的可运行线程（调用者需持有QueueMutex）
+     */
+    bool ShouldRetire() const;
+
+    /**
+     * @brief 将当前线程从存活列表移入待回收列表（调用者需持有QueueMutex）
+     */
+    void RetireSelf();
+
+    /**
+     * @brief 回收已退出的线程
+     *
+     * @param Lock 已持有的QueueMutex锁，回收期间会暂时释放
+     */
+    void ReapRetired(std::unique_lock<std::mutex>& Lock);
+
+    /**
+     * @brief 监控线程主循环
+     */
+    void Monitor();
+
+    friend void* MonitorEntry(void* args);
 };
 
 #include "ThreadPool.tpp"
@@ -16,7 +16,8 @@ std::future<RetType<F, Args...>> ThreadPool::EnQueue(F&& ThFunc, Args&&... args)
     std::future<RetType<F, Args...>> Res = Task->get_future();
     {
         std::unique_lock<std::mutex> Lock(QueueMutex);
-        Tasks.emplace([Task] { (*Task)(); });
+        Tasks.push(TaskItem{[Task] { (*Task)(); }, Clock::now()});
+        MaybeCompensate();
     }
     CondVar.notify_one();
     return Res;
@@ -1,10 +1,14 @@
 #include "Trans/date.h"
-#include <sstream>
-#include <iomanip>
+#include <cstring>
 #include "ret.h"
 
 const int MinInt = 0x80000000;
 
+/**
+ * @brief 支持的最大年份绝对值，保证天数不超出int范围
+ */
+const int MaxYear = 5000000;
+
 /**
  * @brief 判断是否为闰年
  *
@@ -27,11 +31,96 @@ bool IsLeapYear(int Year)
  */
 bool IsDateValid(int y, int m, int d)
 {
-    if (y > 5000000) return 0;
-    int MonthDays[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    if (IsLeapYear(y)) MonthDays[2] = 29;
+    if (y > MaxYear || y < -MaxYear) return 0;
+    static const int MonthDays[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (m < 1 || m > 12 || d < 1) return 0;
+
+    return d <= MonthDays[m] + (m == 2 && IsLeapYear(y));
+}
+
+/**
+ * @brief 由年月日计算距1970-01-01的天数
+ *
+ * 以3月1日为一年之始，把闰日放到年末；再以400年（146097天）为周期计算，
+ * 年内天数由 (153 * m + 2) / 5 直接得出，全程无循环。
+ */
+int DaysFromCivil(int Year, int Month, int Day)
+{
+    Year -= Month <= 2;
+    const int      Era = (Year >= 0 ? Year : Year - 399) / 400;
+    const unsigned Yoe = static_cast<unsigned>(Year - Era * 400);                        // [0, 399]
+    const unsigned Doy = (153 * (Month > 2 ? Month - 3 : Month + 9) + 2) / 5 + Day - 1;  // [0, 365]
+    const unsigned Doe = Yoe * 365 + Yoe / 4 - Yoe / 100 + Doy;                          // [0, 146096]
+    return Era * 146097 + static_cast<int>(Doe) - 719468;
+}
+
+/**
+ * @brief 由距1970-01-01的天数计算年月日
+ *
+ * DaysFromCivil的逆运算。中间结果用64位计算，任意int输入都不会溢出。
+ */
+void CivilFromDays(int IntDate, int& Year, int& Month, int& Day)
+{
+    const long long Days = static_cast<long long>(IntDate) + 719468;
+    const long long Era  = (Days >= 0 ? Days : Days - 146096) / 146097;
+    const unsigned  Doe  = static_cast<unsigned>(Days - Era * 146097);                // [0, 146096]
+    const unsigned  Yoe  = (Doe - Doe / 1460 + Doe / 36524 - Doe / 146096) / 365;     // [0, 399]
+    const unsigned  Doy  = Doe - (365 * Yoe + Yoe / 4 - Yoe / 100);                   // [0, 365]
+    const unsigned  Mp   = (5 * Doy + 2) / 153;                                       // [0, 11]
+    Day                  = static_cast<int>(Doy - (153 * Mp + 2) / 5 + 1);
+    Month                = static_cast<int>(Mp < 10 ? Mp + 3 : Mp - 9);
+    Year                 = static_cast<int>(Yoe + Era * 400) + (Month <= 2);
+}
 
-    return m > 0 && m <= 12 && d > 0 && d <= MonthDays[m];
+/**
+ * @brief 解析一段十进制数字
+ *
+ * @param Cur 当前位置，解析后移动到数字之后
+ * @param End 字符串结尾
+ * @param MaxDigits 最多允许的位数
+ * @param Value 输出的数值
+ * @return 至少解析到一位数字且未超过位数限制时返回true
+ */
+static bool ParseDigits(const char*& Cur, const char* End, int MaxDigits, int& Value)
+{
+    const char* Begin = Cur;
+    Value             = 0;
+    while (Cur < End && static_cast<unsigned>(*Cur - '0') < 10)
+    {
+        if (Cur - Begin == MaxDigits) return false;
+        Value = Value * 10 + (*Cur - '0');
+        ++Cur;
+    }
+    return Cur != Begin;
+}
+
+/**
+ * @brief 将给定长度的字符串日期转换为整数日期
+ *
+ * 接受可带负号的年份、一到两位的月和日，例如"2024-03-07"、"2024-3-7"。
+ */
+void StrDate2IntDate(const char* StrDate, std::size_t Len, int& IntDate, RC& rc)
+{
+    const char* Cur = StrDate;
+    const char* End = StrDate + Len;
+
+    bool Negative = Cur < End && *Cur == '-';
+    Cur += Negative;
+
+    int  Year, Month, Day;
+    bool Parsed = ParseDigits(Cur, End, 7, Year) && Cur < End && *Cur++ == '-' && ParseDigits(Cur, End, 2, Month) &&
+                  Cur < End && *Cur++ == '-' && ParseDigits(Cur, End, 2, Day) && Cur == End;
+    if (Negative) Year = -Year;
+
+    if (!Parsed || !IsDateValid(Year, Month, Day))
+    {
+        IntDate = MinInt;
+        rc      = RC::INVALID_DATE;
+        return;
+    }
+
+    IntDate = DaysFromCivil(Year, Month, Day);
+    rc      = RC::SUCCESS;
 }
 
 /**
@@ -42,30 +131,60 @@ bool IsDateValid(int y, int m, int d)
  * @param rc 返回码，用于指示转换是否成功
  */
 void StrDate2IntDate(const char* StrDate, int& IntDate, RC& rc)
+{
+    StrDate2IntDate(StrDate, strlen(StrDate), IntDate, rc);
+}
+
+/**
+ * @brief 两位数字查找表，"00"~"99"
+ */
+static const char DigitPairs[] = "00010203040506070809"
+                                 "10111213141516171819"
+                                 "20212223242526272829"
+                                 "30313233343536373839"
+                                 "40414243444546474849"
+                                 "50515253545556575859"
+                                 "60616263646566676869"
+                                 "70717273747576777879"
+                                 "80818283848586878889"
+                                 "90919293949596979899";
+
+/**
+ * @brief 将整数日期格式化到调用者提供的缓冲区
+ *
+ * 年份至少输出四位（不足补零），负年份前加负号。
+ */
+std::size_t IntDate2StrDate(int IntDate, char* Buf)
 {
     int Year, Month, Day;
-    sscanf(StrDate, "%d-%d-%d", &Year, &Month, &Day);
-    if (!IsDateValid(Year, Month, Day))
+    CivilFromDays(IntDate, Year, Month, Day);
+
+    char* Out = Buf;
+    if (Year < 0)
     {
-        IntDate = MinInt;
-        rc      = RC::INVALID_DATE;
-        return;
+        *Out++ = '-';
+        Year   = -Year;
     }
 
-    bool IsBefore1970 = Year < 1970;
-    IntDate           = 0;
-    if (IsBefore1970)
-        for (int y = 1969; y > Year; --y) IntDate -= (IsLeapYear(y) ? 366 : 365);
-    else
-        for (int y = 1970; y < Year; ++y) IntDate += (IsLeapYear(y) ? 366 : 365);
-
-    int MonthDays[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    if (IsLeapYear(Year)) MonthDays[2] = 29;
+    char     Digits[8];
+    int      Count = 0;
+    unsigned Y     = static_cast<unsigned>(Year);
+    do
+    {
+        Digits[Count++] = static_cast<char>('0' + Y % 10);
+        Y /= 10;
+    } while (Y);
+    while (Count < 4) Digits[Count++] = '0';
+    while (Count) *Out++ = Digits[--Count];
 
-    for (int i = 0; i < Month - 1; ++i) IntDate += MonthDays[i + 1];
-    IntDate += Day - 1;
+    *Out++ = '-';
+    memcpy(Out, DigitPairs + 2 * Month, 2);
+    Out += 2;
+    *Out++ = '-';
+    memcpy(Out, DigitPairs + 2 * Day, 2);
+    Out += 2;
 
-    if (IsBefore1970) IntDate = IntDate - 365 - (IsLeapYear(Year) ? 1 : 0);
+    return Out - Buf;
 }
 
 /**
@@ -76,35 +195,8 @@ void StrDate2IntDate(const char* StrDate, int& IntDate, RC& rc)
  */
 std::string IntDate2StrDate(int IntDate)
 {
-    int Year = 1970;
-    while (IntDate < 0 || IntDate >= (IsLeapYear(Year) ? 366 : 365))
-    {
-        if (IntDate < 0)
-        {
-            --Year;
-            IntDate += IsLeapYear(Year) ? 366 : 365;
-        }
-        else
-        {
-            IntDate -= IsLeapYear(Year) ? 366 : 365;
-            ++Year;
-        }
-    }
-
-    int MonthDays[] = {31, IsLeapYear(Year) ? 29 : 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    int Month       = 0;
-    while (IntDate >= MonthDays[Month])
-    {
-        IntDate -= MonthDays[Month];
-        ++Month;
-    }
-    int Day = IntDate + 1;
-    Month += 1;
-    std::ostringstream oss;
-    oss << std::setw(4) << std::setfill('0') << Year << "-" << std::setw(2) << std::setfill('0') << Month << "-"
-        << std::setw(2) << std::setfill('0') << Day;
-
-    return oss.str();
+    char Buf[MaxDateStrLen];
+    return std::string(Buf, IntDate2StrDate(IntDate, Buf));
 }
 
 /**
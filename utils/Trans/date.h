@@ -1,12 +1,43 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * @brief 返回码枚举
  */
 enum class RC;
 
+/**
+ * @brief 日期字符串的最大长度（不含结尾的'\0'），如"-5000000-12-31"
+ */
+constexpr std::size_t MaxDateStrLen = 14;
+
+/**
+ * @brief 由年月日计算距1970-01-01的天数
+ *
+ * 常数时间，不检查日期是否有效。
+ *
+ * @param Year 年
+ * @param Month 月，1~12
+ * @param Day 日，1~31
+ * @return 距1970-01-01的天数
+ */
+int DaysFromCivil(int Year, int Month, int Day);
+
+/**
+ * @brief 由距1970-01-01的天数计算年月日
+ *
+ * 常数时间。
+ *
+ * @param IntDate 距1970-01-01的天数
+ * @param Year 输出的年
+ * @param Month 输出的月
+ * @param Day 输出的日
+ */
+void CivilFromDays(int IntDate, int& Year, int& Month, int& Day);
+
 /**
  * @brief 将字符串日期转换为整数日期
  *
@@ -16,6 +47,18 @@ enum class RC;
  */
 void StrDate2IntDate(const char* StrDate, int& IntDate, RC& rc);
 
+/**
+ * @brief 将给定长度的字符串日期转换为整数日期
+ *
+ * 不要求字符串以'\0'结尾，便于直接解析输入缓冲区中的字段。
+ *
+ * @param StrDate 输入的字符串日期，格式为"YYYY-MM-DD"
+ * @param Len 字符串长度
+ * @param IntDate 输出的整数日期
+ * @param rc 返回码，用于指示转换是否成功
+ */
+void StrDate2IntDate(const char* StrDate, std::size_t Len, int& IntDate, RC& rc);
+
 /**
  * @brief 将整数日期转换为字符串日期
  *
@@ -23,3 +66,41 @@ void StrDate2IntDate(const char* StrDate, int& IntDate, RC& rc);
  * @return 转换后的字符串日期，格式为"YYYY-MM-DD"
  */
 std::string IntDate2StrDate(int IntDate);
+
+/**
+ * @brief 将整数日期格式化到调用者提供的缓冲区
+ *
+ * 不分配内存，不写结尾的'\0'。
+ *
+ * @param IntDate 输入的整数日期
+ * @param Buf 输出缓冲区，至少MaxDateStrLen字节
+ * @return 写入的字节数
+ */
+std::size_t IntDate2StrDate(int IntDate, char* Buf);
+
+/**
+ * @brief 批量将字符串日期转换为整数日期
+ *
+ * 对固定格式"YYYY-MM-DD"的行，在支持AVX2的CPU上每次用SIMD校验并提取8行的数字，
+ * 其余行（及不支持AVX2时）逐行解析，结果与StrDate2IntDate一致。
+ *
+ * @param StrDates 字符串日期数组，不要求以'\0'结尾
+ * @param Lens 各字符串的长度
+ * @param Count 行数
+ * @param IntDates 输出的整数日期，非法行为0x80000000
+ * @param Invalid 输出位图，共(Count + 63) / 64个字，第i位为1表示第i行为RC::INVALID_DATE
+ * @return 全部有效时返回RC::SUCCESS，否则返回RC::INVALID_DATE
+ */
+RC StrDates2IntDates(
+    const char* const* StrDates, const std::size_t* Lens, std::size_t Count, int* IntDates, uint64_t* Invalid);
+
+/**
+ * @brief 批量将整数日期格式化到连续缓冲区
+ *
+ * @param IntDates 输入的整数日期
+ * @param Count 行数
+ * @param Buf 输出缓冲区，至少Count * MaxDateStrLen字节
+ * @param Offsets 输出各行在Buf中的起始偏移，共Count + 1项，最后一项为总长度
+ * @return 写入的总字节数
+ */
+std::size_t IntDates2StrDates(const int* IntDates, std::size_t Count, char* Buf, std::size_t* Offsets);
@@ -0,0 +1,215 @@
+#include "Trans/date.h"
+#include <cstring>
+#include <immintrin.h>
+#include "ret.h"
+
+/**
+ * @brief 非法日期的占位值，与StrDate2IntDate一致
+ */
+static const int InvalidDate = static_cast<int>(0x80000000);
+
+/**
+ * @brief 逐行解析[Begin, End)，返回非法行数
+ */
+static std::size_t ParseRows(const char* const* StrDates, const std::size_t* Lens, std::size_t Begin, std::size_t End,
+    int* IntDates, uint64_t* Invalid)
+{
+    std::size_t Bad = 0;
+    for (std::size_t i = Begin; i < End; ++i)
+    {
+        RC rc;
+        StrDate2IntDate(StrDates[i], Lens[i], IntDates[i], rc);
+        if (rc != RC::SUCCESS)
+        {
+            Invalid[i / 64] |= uint64_t(1) << (i % 64);
+            ++Bad;
+        }
+    }
+    return Bad;
+}
+
+/**
+ * @brief 把两行10字节的日期放入一个256位寄存器的两个128位通道
+ */
+__attribute__((target("avx2"))) static inline __m256i LoadTwo(const char* A, const char* B)
+{
+    uint16_t TailA, TailB;
+    memcpy(&TailA, A + 8, 2);
+    memcpy(&TailB, B + 8, 2);
+    __m128i Lo = _mm_insert_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(A)), TailA, 4);
+    __m128i Hi = _mm_insert_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(B)), TailB, 4);
+    return _mm256_set_m128i(Hi, Lo);
+}
+
+/**
+ * @brief 校验两行的格式并提取数字
+ *
+ * @param V 两行日期
+ * @param FormatOk 输出两位掩码，第k位表示第k行格式正确
+ * @return 每个128位通道为[年, 月, 日, 0]四个32位整数
+ */
+__attribute__((target("avx2"))) static inline __m256i ExtractTwo(__m256i V, unsigned& FormatOk)
+{
+    const __m256i Digits = _mm256_sub_epi8(V, _mm256_set1_epi8('0'));
+    const __m256i Nine   = _mm256_set1_epi8(9);
+
+    // 数字位必须在0~9之间，第4、7位必须为'-'，第10位之后不关心
+    const __m256i DigitPos = _mm256_setr_epi8(
+        -1, -1, -1, -1, 0, -1, -1, 0, -1, -1, 0, 0, 0, 0, 0, 0, -1, -1, -1, -1, 0, -1, -1, 0, -1, -1, 0, 0, 0, 0, 0, 0);
+    const __m256i DashPos = _mm256_setr_epi8(
+        0, 0, 0, 0, -1, 0, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i IgnorePos = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, -1, -1, -1, -1, -1);
+
+    __m256i DigitOk = _mm256_cmpeq_epi8(_mm256_max_epu8(Digits, Nine), Nine);
+    __m256i DashOk  = _mm256_cmpeq_epi8(V, _mm256_set1_epi8('-'));
+    __m256i Ok      = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(DigitOk, DigitPos), _mm256_and_si256(DashOk, DashPos)), IgnorePos);
+    unsigned Bits = static_cast<unsigned>(_mm256_movemask_epi8(Ok));
+    FormatOk      = ((Bits & 0xFFFF) == 0xFFFF) | (((Bits >> 16) == 0xFFFF) << 1);
+
+    // 重排为[Y0 Y1 Y2 Y3 M0 M1 _ _ D0 D1 _ ...]，两两乘加得到[YY, YY, MM, 0, DD, 0, 0, 0]，再乘加得到[年, 月, 日, 0]
+    const __m256i Shuffle = _mm256_setr_epi8(
+        0, 1, 2, 3, 5, 6, -1, -1, 8, 9, -1, -1, -1, -1, -1, -1, 0, 1, 2, 3, 5, 6, -1, -1, 8, 9, -1, -1, -1, -1, -1, -1);
+    const __m256i Pairs = _mm256_setr_epi8(
+        10, 1, 10, 1, 10, 1, 0, 0, 10, 1, 0, 0, 0, 0, 0, 0, 10, 1, 10, 1, 10, 1, 0, 0, 10, 1, 0, 0, 0, 0, 0, 0);
+    const __m256i Fields = _mm256_setr_epi16(100, 1, 1, 0, 1, 0, 0, 0, 100, 1, 1, 0, 1, 0, 0, 0);
+
+    __m256i Packed = _mm256_shuffle_epi8(Digits, Shuffle);
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(Packed, Pairs), Fields);
+}
+
+/**
+ * @brief 用AVX2解析8行固定格式的日期
+ *
+ * 年份限于0~9999，除法均换成在该范围内精确的乘法加移位。
+ * @return 8位掩码，第k位为1表示第k行需要逐行重新解析（格式不符或日期非法）
+ */
+__attribute__((target("avx2"))) static unsigned ParseEight(const char* const* StrDates, int* IntDates)
+{
+    unsigned OkAB, OkCE, OkFG, OkHI;
+    __m256i  AB = ExtractTwo(LoadTwo(StrDates[0], StrDates[1]), OkAB);
+    __m256i  CE = ExtractTwo(LoadTwo(StrDates[2], StrDates[3]), OkCE);
+    __m256i  FG = ExtractTwo(LoadTwo(StrDates[4], StrDates[5]), OkFG);
+    __m256i  HI = ExtractTwo(LoadTwo(StrDates[6], StrDates[7]), OkHI);
+    unsigned FormatOk = OkAB | (OkCE << 2) | (OkFG << 4) | (OkHI << 6);
+
+    // 转置为按行排列的年、月、日向量，通道顺序为行[0, 2, 4, 6, 1, 3, 5, 7]，最后统一恢复
+    __m256i Lo1 = _mm256_unpacklo_epi32(AB, CE);
+    __m256i Hi1 = _mm256_unpackhi_epi32(AB, CE);
+    __m256i Lo2 = _mm256_unpacklo_epi32(FG, HI);
+    __m256i Hi2 = _mm256_unpackhi_epi32(FG, HI);
+    __m256i Y   = _mm256_unpacklo_epi64(Lo1, Lo2);
+    __m256i M   = _mm256_unpackhi_epi64(Lo1, Lo2);
+    __m256i D   = _mm256_unpacklo_epi64(Hi1, Hi2);
+
+    const __m256i Order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    Y                   = _mm256_permutevar8x32_epi32(Y, Order);
+    M                   = _mm256_permutevar8x32_epi32(M, Order);
+    D                   = _mm256_permutevar8x32_epi32(D, Order);
+
+    const __m256i One     = _mm256_set1_epi32(1);
+    const __m256i Zero    = _mm256_setzero_si256();
+    const __m256i Magic   = _mm256_set1_epi32(5243);  // x * 5243 >> 19 == x / 100，x * 5243 >> 21 == x / 400
+    const __m256i Hundred = _mm256_set1_epi32(100);
+
+    // 闰年：能被4整除且（不能被100整除或能被400整除）
+    __m256i YMagic = _mm256_mullo_epi32(Y, Magic);
+    __m256i Rem100 = _mm256_sub_epi32(Y, _mm256_mullo_epi32(_mm256_srli_epi32(YMagic, 19), Hundred));
+    __m256i Rem400 = _mm256_sub_epi32(Y, _mm256_mullo_epi32(_mm256_srli_epi32(YMagic, 21), _mm256_set1_epi32(400)));
+    __m256i Leap   = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(Y, _mm256_set1_epi32(3)), Zero),
+        _mm256_or_si256(
+            _mm256_xor_si256(_mm256_cmpeq_epi32(Rem100, Zero), _mm256_set1_epi32(-1)), _mm256_cmpeq_epi32(Rem400, Zero)));
+
+    // 每月天数：28 + ((0x3BBEECC >> 2m) & 3)，闰年二月再加一
+    __m256i MonthOk = _mm256_and_si256(_mm256_cmpgt_epi32(M, Zero), _mm256_cmpgt_epi32(_mm256_set1_epi32(13), M));
+    __m256i MDays   = _mm256_add_epi32(_mm256_set1_epi32(28),
+        _mm256_and_si256(
+            _mm256_srlv_epi32(_mm256_set1_epi32(0x3BBEECC), _mm256_slli_epi32(M, 1)), _mm256_set1_epi32(3)));
+    MDays           = _mm256_sub_epi32(MDays, _mm256_and_si256(Leap, _mm256_cmpeq_epi32(M, _mm256_set1_epi32(2))));
+    __m256i DayOk   = _mm256_andnot_si256(_mm256_cmpgt_epi32(D, MDays), _mm256_cmpgt_epi32(D, Zero));
+    __m256i Valid   = _mm256_and_si256(MonthOk, DayOk);
+
+    // DaysFromCivil：年份先加400保证非负
+    __m256i Early = _mm256_cmpgt_epi32(_mm256_set1_epi32(3), M);
+    __m256i Yr    = _mm256_add_epi32(_mm256_add_epi32(Y, Early), _mm256_set1_epi32(400));
+    __m256i Era   = _mm256_srli_epi32(_mm256_mullo_epi32(Yr, Magic), 21);
+    __m256i Yoe   = _mm256_sub_epi32(Yr, _mm256_mullo_epi32(Era, _mm256_set1_epi32(400)));
+    __m256i Mp    = _mm256_add_epi32(M, _mm256_blendv_epi8(_mm256_set1_epi32(-3), _mm256_set1_epi32(9), Early));
+    __m256i Doy   = _mm256_srli_epi32(
+        _mm256_mullo_epi32(
+            _mm256_add_epi32(_mm256_mullo_epi32(Mp, _mm256_set1_epi32(153)), _mm256_set1_epi32(2)), _mm256_set1_epi32(13108)),
+        16);
+    Doy           = _mm256_sub_epi32(_mm256_add_epi32(Doy, D), One);
+    __m256i Doe   = _mm256_add_epi32(_mm256_mullo_epi32(Yoe, _mm256_set1_epi32(365)), _mm256_srli_epi32(Yoe, 2));
+    Doe           = _mm256_add_epi32(
+        _mm256_sub_epi32(Doe, _mm256_srli_epi32(_mm256_mullo_epi32(Yoe, Magic), 19)), Doy);
+    __m256i Days  = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(Era, One), _mm256_set1_epi32(146097)),
+        _mm256_sub_epi32(Doe, _mm256_set1_epi32(719468)));
+
+    unsigned ValidBits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(Valid))) & FormatOk;
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(IntDates),
+        _mm256_blendv_epi8(_mm256_set1_epi32(InvalidDate), Days, Valid));
+    return ~ValidBits & 0xFF;
+}
+
+/**
+ * @brief 是否可以使用AVX2
+ */
+static bool HasAvx2()
+{
+    static const bool Supported = __builtin_cpu_supports("avx2");
+    return Supported;
+}
+
+/**
+ * @brief 批量将字符串日期转换为整数日期
+ */
+RC StrDates2IntDates(
+    const char* const* StrDates, const std::size_t* Lens, std::size_t Count, int* IntDates, uint64_t* Invalid)
+{
+    memset(Invalid, 0, (Count + 63) / 64 * sizeof(uint64_t));
+
+    std::size_t Bad = 0;
+    std::size_t i   = 0;
+    if (HasAvx2())
+    {
+        for (; i + 8 <= Count; i += 8)
+        {
+            bool Fixed = true;
+            for (std::size_t k = 0; k < 8; ++k) Fixed &= Lens[i + k] == 10;
+            if (!Fixed)
+            {
+                Bad += ParseRows(StrDates, Lens, i, i + 8, IntDates, Invalid);
+                continue;
+            }
+
+            // SIMD判为非法的行可能只是格式不同（如负年份），交给逐行解析定夺
+            unsigned Retry = ParseEight(StrDates + i, IntDates + i);
+            while (Retry)
+            {
+                std::size_t k = i + __builtin_ctz(Retry);
+                Bad += ParseRows(StrDates, Lens, k, k + 1, IntDates, Invalid);
+                Retry &= Retry - 1;
+            }
+        }
+    }
+    Bad += ParseRows(StrDates, Lens, i, Count, IntDates, Invalid);
+
+    return Bad ? RC::INVALID_DATE : RC::SUCCESS;
+}
+
+/**
+ * @brief 批量将整数日期格式化到连续缓冲区
+ */
+std::size_t IntDates2StrDates(const int* IntDates, std::size_t Count, char* Buf, std::size_t* Offsets)
+{
+    std::size_t Offset = 0;
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        Offsets[i] = Offset;
+        Offset += IntDate2StrDate(IntDates[i], Buf + Offset);
+    }
+    Offsets[Count] = Offset;
+    return Offset;
+}
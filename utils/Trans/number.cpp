@@ -0,0 +1,92 @@
+#include "Trans/number.h"
+#include <charconv>
+#include <system_error>
+#include "ret.h"
+
+std::size_t Int2Str(int Value, char* Buf) { return std::to_chars(Buf, Buf + MaxIntStrLen, Value).ptr - Buf; }
+
+std::size_t BigInt2Str(int64_t Value, char* Buf) { return std::to_chars(Buf, Buf + MaxBigIntStrLen, Value).ptr - Buf; }
+
+/**
+ * @brief 将浮点数格式化为最短往返表示
+ *
+ * 不指定格式时to_chars在定点与科学计数法中取较短者，结果与区域设置无关。
+ */
+std::size_t Float2Str(float Value, char* Buf) { return std::to_chars(Buf, Buf + MaxFloatStrLen, Value).ptr - Buf; }
+
+/**
+ * @brief 去掉from_chars不接受的正号
+ *
+ * 正号之后还必须有内容，且不能是另一个符号。
+ */
+static bool SkipPlus(const char*& Cur, const char* End)
+{
+    if (Cur == End || *Cur != '+') return true;
+    ++Cur;
+    return Cur != End && *Cur != '-' && *Cur != '+';
+}
+
+/**
+ * @brief 用from_chars解析整个字符串
+ */
+template <class T, class... Args>
+static void ParseWhole(const char* Str, std::size_t Len, T& Value, RC& rc, Args... args)
+{
+    const char* Cur = Str;
+    const char* End = Str + Len;
+    T           Parsed{};
+    if (!SkipPlus(Cur, End))
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+
+    auto Result = std::from_chars(Cur, End, Parsed, args...);
+    if (Result.ec != std::errc() || Result.ptr != End)
+    {
+        rc = RC::INVALID_ARGUMENT;
+        return;
+    }
+    Value = Parsed;
+    rc    = RC::SUCCESS;
+}
+
+void Str2Int(const char* Str, std::size_t Len, int& Value, RC& rc) { ParseWhole(Str, Len, Value, rc); }
+
+void Str2BigInt(const char* Str, std::size_t Len, int64_t& Value, RC& rc) { ParseWhole(Str, Len, Value, rc); }
+
+void Str2Float(const char* Str, std::size_t Len, float& Value, RC& rc)
+{
+    ParseWhole(Str, Len, Value, rc, std::chars_format::general);
+}
+
+/**
+ * @brief 批量格式化的公共部分
+ */
+template <class T, std::size_t (*Format)(T, char*)>
+static std::size_t FormatAll(const T* Values, std::size_t Count, char* Buf, std::size_t* Offsets)
+{
+    std::size_t Offset = 0;
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        Offsets[i] = Offset;
+        Offset += Format(Values[i], Buf + Offset);
+    }
+    Offsets[Count] = Offset;
+    return Offset;
+}
+
+std::size_t Ints2Strs(const int* Values, std::size_t Count, char* Buf, std::size_t* Offsets)
+{
+    return FormatAll<int, Int2Str>(Values, Count, Buf, Offsets);
+}
+
+std::size_t BigInts2Strs(const int64_t* Values, std::size_t Count, char* Buf, std::size_t* Offsets)
+{
+    return FormatAll<int64_t, BigInt2Str>(Values, Count, Buf, Offsets);
+}
+
+std::size_t Floats2Strs(const float* Values, std::size_t Count, char* Buf, std::size_t* Offsets)
+{
+    return FormatAll<float, Float2Str>(Values, Count, Buf, Offsets);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 返回码枚举
+ */
+enum class RC;
+
+/*
+ * 与区域设置无关的数值与字符串转换，基于std::to_chars与std::from_chars，
+ * 不分配内存、不经过iostream，直接读写调用者的缓冲区。
+ */
+
+/**
+ * @brief int字符串的最大长度（不含结尾的'\0'），如"-2147483648"
+ */
+constexpr std::size_t MaxIntStrLen = 11;
+
+/**
+ * @brief int64_t字符串的最大长度，如"-9223372036854775808"
+ */
+constexpr std::size_t MaxBigIntStrLen = 20;
+
+/**
+ * @brief float最短往返表示的最大长度，如"-1.17549435e-38"
+ */
+constexpr std::size_t MaxFloatStrLen = 16;
+
+/**
+ * @brief 将整数格式化到调用者提供的缓冲区
+ *
+ * 不写结尾的'\0'。
+ *
+ * @param Value 输入的整数
+ * @param Buf 输出缓冲区，至少MaxIntStrLen字节
+ * @return 写入的字节数
+ */
+std::size_t Int2Str(int Value, char* Buf);
+
+/**
+ * @brief 将64位整数格式化到调用者提供的缓冲区
+ *
+ * @param Buf 输出缓冲区，至少MaxBigIntStrLen字节
+ */
+std::size_t BigInt2Str(int64_t Value, char* Buf);
+
+/**
+ * @brief 将浮点数格式化为能精确还原的最短十进制表示
+ *
+ * 整数值不带小数点，如"3"；极大或极小的值使用科学计数法；非有限值为"inf"、"-inf"与"nan"。
+ *
+ * @param Buf 输出缓冲区，至少MaxFloatStrLen字节
+ */
+std::size_t Float2Str(float Value, char* Buf);
+
+/**
+ * @brief 将给定长度的字符串转换为整数
+ *
+ * 接受可选的正负号与十进制数字，不接受空白与多余字符，不要求以'\0'结尾。
+ *
+ * @param Str 输入字符串
+ * @param Len 字符串长度
+ * @param Value 输出的整数
+ * @param rc 格式错误或超出范围时为RC::INVALID_ARGUMENT
+ */
+void Str2Int(const char* Str, std::size_t Len, int& Value, RC& rc);
+
+/**
+ * @brief 将给定长度的字符串转换为64位整数
+ */
+void Str2BigInt(const char* Str, std::size_t Len, int64_t& Value, RC& rc);
+
+/**
+ * @brief 将给定长度的字符串转换为浮点数
+ *
+ * 接受定点与科学计数法、"inf"与"nan"，以及可选的正号。
+ */
+void Str2Float(const char* Str, std::size_t Len, float& Value, RC& rc);
+
+/**
+ * @brief 批量将整数格式化到连续缓冲区
+ *
+ * @param Values 输入的整数
+ * @param Count 行数
+ * @param Buf 输出缓冲区，至少Count * MaxIntStrLen字节
+ * @param Offsets 输出各行在Buf中的起始偏移，共Count + 1项，最后一项为总长度
+ * @return 写入的总字节数
+ */
+std::size_t Ints2Strs(const int* Values, std::size_t Count, char* Buf, std::size_t* Offsets);
+
+/**
+ * @brief 批量将64位整数格式化到连续缓冲区
+ *
+ * @param Buf 输出缓冲区，至少Count * MaxBigIntStrLen字节
+ */
+std::size_t BigInts2Strs(const int64_t* Values, std::size_t Count, char* Buf, std::size_t* Offsets);
+
+/**
+ * @brief 批量将浮点数格式化到连续缓冲区
+ *
+ * @param Buf 输出缓冲区，至少Count * MaxFloatStrLen字节
+ */
+std::size_t Floats2Strs(const float* Values, std::size_t Count, char* Buf, std::size_t* Offsets);